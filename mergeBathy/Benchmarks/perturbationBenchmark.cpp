@@ -0,0 +1,275 @@
+/**
+* @file			perturbationBenchmark.cpp
+* @brief		Counts the heap allocations and times scalecInterpPerturbations_Compute per node with and without a PERTURB_SCRATCH.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* Builds one synthetic tile in smoothing scale units, as scalecInterpTile_ProcessA
+* scales it, and interpolates a regular grid of nodes over it twice:
+*	- without scratch buffers, so each node allocates its own as before;
+*	- with one PERTURB_SCRATCH reused by every node.
+* The global operator new is replaced to count allocations.  Both runs are done
+* with the spatial index and with a full scan of the tile, and the outputs of
+* the two runs are compared bit for bit.  Then the tile is interpolated with one
+* scalecInterpPerturbations_ComputeTile sweep and compared with the node by node
+* outputs, and last by scalecInterpPerturbations_ComputeTileFFT, whose outputs
+* differ from the node by node ones by the approximation of its lattice.
+*
+* Build with "make benchmarks" and run as
+*	perturbationBenchmark [numberOfPoints] [tileSize] [nodeSpacing]
+*/
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+#include "../scalecInterpPerturbations.h"
+#include "../spatialIndex.h"
+
+using namespace std;
+
+//************************************************************************************
+// SUBROUTINE I: Allocation counter.  The benchmark is single threaded.
+//************************************************************************************
+static long long allocationCount = 0;
+
+void *operator new(size_t size)
+{
+	allocationCount++;
+	void *p = malloc(size > 0 ? size : 1);
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p)
+{
+	free(p);
+}
+
+//************************************************************************************
+// SUBROUTINE II: Build a synthetic tile.
+//************************************************************************************
+static void makeTile(int numPoints, double tileSize, vector<double> *x, vector<double> *y, vector<double> *z, vector<double> *e, vector<double> *h, vector<double> *v)
+{
+	srand(12345);
+	for (int i = 0; i < numPoints; i++)
+	{
+		double xi = tileSize * rand() / RAND_MAX;
+		double yi = tileSize * rand() / RAND_MAX;
+		(*x).push_back(xi);
+		(*y).push_back(yi);
+		(*z).push_back(20.0 + 0.1 * xi + 2.0 * sin(xi / 4.0) * cos(yi / 5.5) + 0.05 * rand() / RAND_MAX);
+		(*e).push_back(pow(0.2 + 0.002 * (i % 50), 2));
+		(*h).push_back(0.5);
+		(*v).push_back(0.25);
+	}
+}
+
+static double wallClock()
+{
+#ifdef WIN32
+	return (double)clock() / CLOCKS_PER_SEC;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + 1e-6 * (double)tv.tv_usec;
+#endif
+}
+
+//************************************************************************************
+// SUBROUTINE III: Interpolate every node, returning the depth, error and Kalman depth of each.
+//************************************************************************************
+static void interpolate(const vector<double> &x, const vector<double> &y, const vector<double> &z, const vector<double> &e, const vector<double> &h, const vector<double> &v, const vector<double> &weights, PERTURBS *perturb, const vector<double> &nodesX, const vector<double> &nodesY, const spatialIndex *dataIndex, PERTURB_SCRATCH *scratch, vector<double> *out, double *seconds, long long *allocations)
+{
+	dgrid Xiii(1,2);
+	double xg, yg;
+
+	(*out).assign(3 * nodesX.size(), 0.0);
+	long long allocationsBefore = allocationCount;
+	double start = wallClock();
+	for (int n = 0; n < (const int)nodesX.size(); n++)
+	{
+		xg = nodesX[n];
+		yg = nodesY[n];
+		Xiii(0,0) = xg;
+		Xiii(0,1) = yg;
+		(*perturb).perturbationZ = 0.0;
+		(*perturb).perturbationE = 1.0;
+		(*perturb).perturbationNEi = 1.0;
+		(*perturb).perturbationREi = 1.0;
+		(*perturb).perturbationZ0 = 0.0;
+		(*perturb).perturbationE0 = 1.0;
+		(*perturb).perturbationZK = 0.0;
+		(*perturb).perturbationEK = 1.0;
+		scalecInterpPerturbations_Compute(&x, &y, &z, &e, &h, &v, &xg, &yg, &weights, 0.1, 1.0, 0.0, &x, &y, &Xiii, perturb, true, true, true, false, dataIndex, scratch);
+		(*out)[3*n] = (*perturb).perturbationZ;
+		(*out)[3*n+1] = (*perturb).perturbationE;
+		(*out)[3*n+2] = (*perturb).perturbationZK;
+	}
+	(*seconds) = wallClock() - start;
+	(*allocations) = allocationCount - allocationsBefore;
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Interpolate every node with one scalecInterpPerturbations_ComputeTile call.
+//************************************************************************************
+static void interpolateTile(const vector<double> &x, const vector<double> &y, const vector<double> &z, const vector<double> &e, const vector<double> &h, const vector<double> &v, const vector<double> &weights, PERTURBS *perturb, const vector<double> &nodesX, const vector<double> &nodesY, const spatialIndex *dataIndex, PERTURB_SCRATCH *scratch, vector<double> *out, double *seconds, long long *allocations)
+{
+	OUTPUT_DATA tileOut;
+	vector<double> slopes(nodesX.size(), 0.0);
+
+	(*out).assign(3 * nodesX.size(), 0.0);
+	long long allocationsBefore = allocationCount;
+	double start = wallClock();
+	scalecInterpPerturbations_ComputeTile(&x, &y, &z, &e, &h, &v, &nodesX, &nodesY, &nodesX, &nodesY, &slopes, &weights, 0.1, 1.0, &x, &y, perturb, true, true, true, &tileOut, dataIndex, scratch);
+	(*seconds) = wallClock() - start;
+	(*allocations) = allocationCount - allocationsBefore;
+	for (int n = 0; n < (const int)nodesX.size(); n++)
+	{
+		(*out)[3*n] = tileOut.depth[n];
+		(*out)[3*n+1] = tileOut.error[n];
+		(*out)[3*n+2] = tileOut.depthK[n];
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE V: Interpolate every node with one scalecInterpPerturbations_ComputeTileFFT call.
+//	The nodes are in columns of nodeRows nodes.
+//************************************************************************************
+static void interpolateTileFFT(const vector<double> &x, const vector<double> &y, const vector<double> &z, const vector<double> &e, const vector<double> &h, const vector<double> &v, const vector<double> &weights, PERTURBS *perturb, const vector<double> &nodesX, const vector<double> &nodesY, int nodeRows, const spatialIndex *dataIndex, PERTURB_SCRATCH *scratch, vector<double> *out, double *seconds)
+{
+	OUTPUT_DATA tileOut;
+	vector<double> slopes(nodesX.size(), 0.0);
+
+	(*out).assign(3 * nodesX.size(), 0.0);
+	double start = wallClock();
+	scalecInterpPerturbations_ComputeTileFFT(&x, &y, &z, &e, &h, &v, &nodesX, &nodesY, &nodesX, &nodesY, &slopes, nodeRows, &weights, 0.1, 1.0, &x, &y, perturb, true, false, false, &tileOut, dataIndex, scratch);
+	(*seconds) = wallClock() - start;
+	for (int n = 0; n < (const int)nodesX.size(); n++)
+	{
+		(*out)[3*n] = tileOut.depth[n];
+		(*out)[3*n+1] = tileOut.error[n];
+	}
+}
+
+//Count the bit identical outputs of two runs and their largest relative difference.
+static void compare(const vector<double> &a, const vector<double> &b, const char *what)
+{
+	long long identical = 0;
+	double worst = 0.0;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (memcmp(&a[i], &b[i], sizeof(double)) == 0)
+			identical++;
+		else
+			worst = max(worst, fabs(a[i] - b[i]) / max(fabs(a[i]), 1e-300));
+	}
+	cout << "  " << identical << " of " << a.size() << " " << what << " bit identical, largest relative difference "
+		<< scientific << setprecision(2) << worst << fixed << endl;
+}
+
+//************************************************************************************
+// SUBROUTINE VI: Main.
+//************************************************************************************
+int main(int argc, char **argv)
+{
+	int numPoints = (argc > 1) ? atoi(argv[1]) : 100000;
+	double tileSize = (argc > 2) ? atof(argv[2]) : 64.0;
+	double nodeSpacing = (argc > 3) ? atof(argv[3]) : 0.5;
+	if (numPoints < 3 || tileSize <= 0 || nodeSpacing <= 0)
+	{
+		cerr << "Usage: perturbationBenchmark [numberOfPoints] [tileSize] [nodeSpacing]" << endl;
+		return 1;
+	}
+
+	//A. Build the tile, its weights and window table, and the nodes
+	vector<double> x, y, z, e, h, v, weights, nodesX, nodesY;
+	makeTile(numPoints, tileSize, &x, &y, &z, &e, &h, &v);
+	PERTURBS perturb;
+	perturb.kernelName = "hann";
+	perturb.perturbationNEi = 1.0;
+	weights.assign(numPoints, 2);
+	scalecInterpPerturbations_PreCompute(&z, &e, &weights, &perturb);
+	//	The nodes are laid out in columns as scalecInterpTile_ProcessA gathers them.
+	int nodeRows = 0;
+	for (int i = 0; i * nodeSpacing <= tileSize; i++)
+	{
+		for (nodeRows = 0; nodeRows * nodeSpacing <= tileSize; nodeRows++)
+		{
+			nodesX.push_back(i * nodeSpacing);
+			nodesY.push_back(nodeRows * nodeSpacing);
+		}
+	}
+	spatialIndex dataIndex;
+	dataIndex.build(&x, &y, 1.0);
+	cout << "Points: " << numPoints << "  Nodes: " << nodesX.size() << endl << endl;
+	cout << setw(28) << left << "run" << right << setw(10) << "seconds" << setw(18) << "allocations/node" << endl;
+
+	//B. Each search with and without scratch buffers
+	const char *searches[2] = {"spatial index", "full scan"};
+	for (int s = 0; s < 2; s++)
+	{
+		const spatialIndex *index = (s == 0) ? &dataIndex : NULL;
+		if ((s == 1) && (nodesX.size() * (double)numPoints > 2e10))
+		{
+			cout << setw(28) << left << searches[s] << right << "skipped, too many nodes times points" << endl;
+			continue;
+		}
+		vector<double> before, after;
+		double seconds;
+		long long allocations;
+		PERTURB_SCRATCH scratch;
+		string name;
+
+		interpolate(x, y, z, e, h, v, weights, &perturb, nodesX, nodesY, index, NULL, &before, &seconds, &allocations);
+		name = string(searches[s]) + ", no scratch";
+		cout << setw(28) << left << name << right << setw(10) << fixed << setprecision(3) << seconds
+			<< setw(18) << setprecision(2) << (double)allocations / nodesX.size() << endl;
+
+		interpolate(x, y, z, e, h, v, weights, &perturb, nodesX, nodesY, index, &scratch, &after, &seconds, &allocations);
+		name = string(searches[s]) + ", scratch";
+		cout << setw(28) << left << name << right << setw(10) << fixed << setprecision(3) << seconds
+			<< setw(18) << setprecision(2) << (double)allocations / nodesX.size() << endl;
+
+		//C. The buffers do not change the arithmetic
+		compare(before, after, "outputs");
+	}
+
+	//D. Point-centric sweep of the whole tile against the spatial index, node by node
+	vector<double> nodeByNode, swept;
+	double seconds;
+	long long allocations;
+	PERTURB_SCRATCH scratch;
+	interpolate(x, y, z, e, h, v, weights, &perturb, nodesX, nodesY, &dataIndex, &scratch, &nodeByNode, &seconds, &allocations);
+	interpolateTile(x, y, z, e, h, v, weights, &perturb, nodesX, nodesY, &dataIndex, &scratch, &swept, &seconds, &allocations);
+	cout << setw(28) << left << "tile sweep" << right << setw(10) << fixed << setprecision(3) << seconds
+		<< setw(18) << setprecision(2) << (double)allocations / nodesX.size() << endl;
+	compare(nodeByNode, swept, "outputs");
+
+	//E. Lattice convolution of the whole tile against the sweep
+	vector<double> convolved;
+	PERTURB_SCRATCH scratchFFT;
+	interpolateTileFFT(x, y, z, e, h, v, weights, &perturb, nodesX, nodesY, nodeRows, &dataIndex, &scratchFFT, &convolved, &seconds);
+	cout << setw(28) << left << "tile FFT" << right << setw(10) << fixed << setprecision(3) << seconds << endl;
+	vector<double> depthSwept, depthConvolved, errorSwept, errorConvolved;
+	for (int n = 0; n < (const int)nodesX.size(); n++)
+	{
+		depthSwept.push_back(swept[3*n]);
+		depthConvolved.push_back(convolved[3*n]);
+		errorSwept.push_back(swept[3*n+1]);
+		errorConvolved.push_back(convolved[3*n+1]);
+	}
+	compare(depthSwept, depthConvolved, "depths");
+	compare(errorSwept, errorConvolved, "errors");
+	return 0;
+}
@@ -0,0 +1,278 @@
+/**
+* @file			subsampleBenchmark.cpp
+* @brief		Times subsampleData with hash binning against the Quicksort on dgrid version it replaced.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* Builds a synthetic survey of parallel swaths and subsamples it three ways:
+*	- the previous subsampleData, which filled Ji and J dgrids, sorted the cell
+*	  indices with Quicksort and accumulated the sums of each cell in zvectors,
+*	  kept here as the baseline;
+*	- subsampleData on one thread;
+*	- subsampleData on numThreads threads.
+* The time of each is reported with the peak resident memory of the process
+* after it, and every output column is compared with the baseline.  Run one
+* method at a time to see the peak memory of each on its own.
+*
+* Build with "make benchmarks" and run as
+*	subsampleBenchmark [numberOfPoints] [numThreads] [all|legacy|binned] [gridSpacing]
+*/
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifndef WIN32
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+#include "../subSampleData.h"
+#include "../consistentWeights.h"
+
+using namespace std;
+
+//************************************************************************************
+// SUBROUTINE I: Build a synthetic survey of parallel swaths.
+//************************************************************************************
+static void makeSurvey(int numPoints, vector<double> *x, vector<double> *y, vector<double> *z, vector<double> *e, vector<double> *h, vector<double> *v)
+{
+	const int beamsPerPing = 256;
+	const int pingsPerLine = 4000;
+	srand(12345);
+	for (int i = 0; i < numPoints; i++)
+	{
+		int ping = i / beamsPerPing;
+		int line = ping / pingsPerLine;
+		double along = (ping % pingsPerLine) * 0.5;
+		double across = line * 90.0 + 100.0 * ((double)(i % beamsPerPing) / (beamsPerPing - 1) - 0.5);
+		(*x).push_back(along + 0.05 * ((double)rand() / RAND_MAX - 0.5));
+		(*y).push_back(across + 0.05 * ((double)rand() / RAND_MAX - 0.5));
+		(*z).push_back(20.0 + 0.01 * across + 2.0 * sin(along / 40.0) * cos(across / 55.0) + 0.05 * rand() / RAND_MAX);
+		(*e).push_back(0.2 + 0.002 * (i % 50));
+		(*h).push_back(0.5);
+		(*v).push_back(0.25);
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE II: The previous subsampleData.
+//************************************************************************************
+static void legacySubsample(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, double DX, double DY, double inX0, double inY0, vector< vector<double> > *subsampledData)
+{
+	double wtol = 0.10000, s3Value;
+	double x0 = (floor(inX0/DX))*(DX);
+	double y0 = (floor(inY0/DY))*(DY);
+	uint inputDataXSize = (uint)(*inputDataX).size();
+	unsigned int i, j, count;
+	int jProd = 1;
+	dgrid Ji(inputDataXSize,2,1);
+	dgrid J(inputDataXSize,2,0);
+	vector<double> weights = vector<double>(inputDataXSize, 2.00);
+
+	double jMaxX = round(1.00+(((*inputDataX)[0] - x0)/DX));
+	double jMaxY = round(1.00+(((*inputDataY)[0] - y0)/DY));
+	for (i = 0; i < inputDataXSize; i++){
+		(*inputDataE)[i] = pow((*inputDataE)[i], 2);
+		Ji(i,0) = 1;
+		Ji(i,1) = i;
+		J(i,0) = round(1.00+(((*inputDataX)[i] - x0)/DX));
+		J(i,1) = round(1.00+(((*inputDataY)[i] - y0)/DY));
+		if (J(i,0) > jMaxX)
+			jMaxX = J(i,0);
+		if (J(i,1) > jMaxY)
+			jMaxY = J(i,1);
+	}
+	consistentWeights(inputDataZ, inputDataE, &wtol, &weights, &s3Value);
+
+	for (i = 0; i < 2; i++){
+		for (j = 0; j < (uint)inputDataXSize; j++)
+			Ji(j,0) = Ji(j,0) + ((J(j,i) - 1) * (double)jProd);
+		jProd = jProd * (int)((i == 0) ? jMaxX : jMaxY);
+	}
+	Quicksort(&Ji, 0, inputDataXSize - 1);
+
+	vector<int> JiVector = vector<int>(inputDataXSize,0);
+	for (i = 0; i < inputDataXSize; i++)
+		JiVector[i] = (int)Ji(i,0);
+	JiVector.resize(unique(JiVector.begin(), JiVector.end()) - JiVector.begin());
+
+	size_t M = JiVector.size();
+	zvector zi(M,0.0), ni(M,0.0), wi(M,0.0), w2zi(M,0.0), w2ei(M,0.0), w2i(M,0.0), si(M,0.0);
+	dvector JiNew(M,0.0);
+	JiNew[0] = Ji(0,0);
+	for (int c = 0; c < 7; c++)
+		(*subsampledData)[c] = vector<double>(M, 0.0);
+
+	count = 0;
+	for (i = 0; i < inputDataXSize; i++){
+		if(Ji(i,0) > JiNew[count]){
+			count = count + 1;
+			JiNew[count] = Ji(i,0);
+		}
+		int k = (int)Ji(i,1);
+		ni[count] = ni[count].real() + 1;
+		wi[count] = wi[count].real() + weights[k];
+		w2i[count] = w2i[count].real() + pow(weights[k],2);
+		zi[count] = zi[count].real() + (*inputDataZ)[k] * weights[k];
+		w2zi[count] = w2zi[count].real() + (*inputDataZ)[k] * pow(weights[k],2);
+		si[count] = si[count].real() + pow((*inputDataZ)[k] * weights[k], 2);
+		w2ei[count] = w2ei[count] + (*inputDataE)[k] * pow(weights[k],2);
+		(*subsampledData)[0][count] += (*inputDataX)[k] * weights[k];
+		(*subsampledData)[1][count] += (*inputDataY)[k] * weights[k];
+		(*subsampledData)[5][count] += pow((*inputDataHErr)[k] * weights[k],2);
+		(*subsampledData)[6][count] += pow((*inputDataVErr)[k] * weights[k],2);
+	}
+
+	for (i = 0; i < (uint)M; i++){
+		if(wi[i].real()==0){
+			zi[i] = 0;
+			(*subsampledData)[0][i] = 0;
+			(*subsampledData)[1][i] = 0;
+			(*subsampledData)[5][i] = 0;
+			(*subsampledData)[6][i] = sqrt(DEFAULT_E);
+		}
+		else{
+			zi[i] = zi[i].real() / wi[i].real();
+			(*subsampledData)[0][i] = (*subsampledData)[0][i] / wi[i].real();
+			(*subsampledData)[1][i] = (*subsampledData)[1][i] / wi[i].real();
+			(*subsampledData)[5][i] = sqrt((*subsampledData)[5][i] / w2i[i].real());
+			(*subsampledData)[6][i] = sqrt((*subsampledData)[6][i] / w2i[i].real());
+		}
+		si[i] = (si[i].real() - (2.00 * zi[i].real() * w2zi[i].real()) + (w2i[i].real() * pow(zi[i].real(),2)))/(ni[i].real());
+		si[i] = (si[i].real())/(1.00 + ni[i].real());
+		if(w2i[i].real()==0)
+			si[i] = ((ni[i].real() - 1.00) * si[i])/(ni[i].real());
+		else
+			si[i] = (((ni[i].real() - 1.00) * si[i]) + (w2ei[i].real()/w2i[i].real()))/(ni[i].real());
+		si[i] = (std::complex<double>)sqrt(si[i]);
+		(*subsampledData)[2][i] = (double)zi[i].real();
+		(*subsampledData)[3][i] = (double)si[i].real();
+		(*subsampledData)[4][i] = pow((double)si[i].real(),2);
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE III: Wall clock time and peak resident memory.
+//************************************************************************************
+static double wallClock()
+{
+#ifdef WIN32
+	return (double)clock() / CLOCKS_PER_SEC;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + 1e-6 * (double)tv.tv_usec;
+#endif
+}
+
+static double peakMB()
+{
+#ifdef WIN32
+	return 0.0;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Compare the output columns of two subsamplings.
+//************************************************************************************
+static void compare(const char *name, vector< vector<double> > &a, vector< vector<double> > &b)
+{
+	if (a[0].size() != b[0].size())
+	{
+		cout << name << ": " << a[0].size() << " cells against " << b[0].size() << " cells" << endl;
+		return;
+	}
+	double worst = 0.0;
+	long long identical = 0, total = 0;
+	for (int c = 0; c < 7; c++)
+	{
+		for (size_t i = 0; i < a[c].size(); i++)
+		{
+			total++;
+			if (memcmp(&a[c][i], &b[c][i], sizeof(double)) == 0)
+				identical++;
+			else
+				worst = max(worst, fabs(a[c][i] - b[c][i]) / max(fabs(a[c][i]), 1e-300));
+		}
+	}
+	cout << name << ": " << identical << " of " << total << " values bit identical, largest relative difference "
+		<< scientific << setprecision(2) << worst << fixed << endl;
+}
+
+//************************************************************************************
+// SUBROUTINE V: Main.
+//************************************************************************************
+int main(int argc, char **argv)
+{
+	int numPoints = (argc > 1) ? atoi(argv[1]) : 5000000;
+	int numThreads = (argc > 2) ? atoi(argv[2]) : 4;
+	string method = (argc > 3) ? argv[3] : "all";
+	double spacing = (argc > 4) ? atof(argv[4]) : 2.0;
+	if (numPoints < 1 || numThreads < 1 || spacing <= 0 || (method != "all" && method != "legacy" && method != "binned"))
+	{
+		cerr << "Usage: subsampleBenchmark [numberOfPoints] [numThreads] [all|legacy|binned] [gridSpacing]" << endl;
+		return 1;
+	}
+
+	//A. Build the survey.  Every method squares the errors in place, so each gets a fresh copy.
+	vector<double> x, y, z, e, h, v;
+	makeSurvey(numPoints, &x, &y, &z, &e, &h, &v);
+	double x0 = *min_element(x.begin(), x.end());
+	double y0 = *min_element(y.begin(), y.end());
+	cout << "Points: " << numPoints << "  Grid spacing: " << spacing << "  Memory after building the survey: "
+		<< fixed << setprecision(1) << peakMB() << " MB" << endl << endl;
+	cout << setw(24) << left << "method" << right << setw(10) << "seconds" << setw(10) << "cells" << setw(16) << "peak MB" << endl;
+
+	vector< vector<double> > legacy(7), serial(7), threaded(7);
+	vector<double> eCopy;
+	double start, sx0, sy0;
+	char threadedName[64];
+	sprintf(threadedName, "hash binned, %d threads", numThreads);
+
+	//B. Time each method
+	if (method != "binned")
+	{
+		eCopy = e;
+		start = wallClock();
+		legacySubsample(&x, &y, &z, &eCopy, &h, &v, spacing, spacing, x0, y0, &legacy);
+		cout << setw(24) << left << "Quicksort on dgrid" << right << setw(10) << setprecision(3) << wallClock() - start
+			<< setw(10) << legacy[0].size() << setw(16) << setprecision(1) << peakMB() << endl;
+	}
+	if (method != "legacy")
+	{
+		eCopy = e;
+		sx0 = x0;
+		sy0 = y0;
+		start = wallClock();
+		subsampleData(&x, &y, &z, &eCopy, &h, &v, spacing, spacing, sx0, sy0, 0, 0, false, &serial, 1);
+		cout << setw(24) << left << "hash binned, 1 thread" << right << setw(10) << setprecision(3) << wallClock() - start
+			<< setw(10) << serial[0].size() << setw(16) << setprecision(1) << peakMB() << endl;
+
+		eCopy = e;
+		sx0 = x0;
+		sy0 = y0;
+		start = wallClock();
+		subsampleData(&x, &y, &z, &eCopy, &h, &v, spacing, spacing, sx0, sy0, 0, 0, false, &threaded, numThreads);
+		cout << setw(24) << left << threadedName << right << setw(10) << setprecision(3) << wallClock() - start
+			<< setw(10) << threaded[0].size() << setw(16) << setprecision(1) << peakMB() << endl;
+	}
+
+	//C. Compare with the baseline.  Cells sum their points in a different order, so values may differ in the last bits.
+	if (method == "all")
+	{
+		cout << endl;
+		compare("1 thread against Quicksort", legacy, serial);
+		sprintf(threadedName, "%d threads against Quicksort", numThreads);
+		compare(threadedName, legacy, threaded);
+	}
+	return 0;
+}
@@ -0,0 +1,179 @@
+/**
+* @file			textReaderBenchmark.cpp
+* @brief		Times parsing of a _xyzhv_mc.dat sounding file with the line by line sscanf parser and with textRecordReader.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* Writes a synthetic Longitude Latitude Depth Horizontal_Error Vertical_Error
+* file with a mix of tab and space delimiters, then reads it three ways:
+*	- the parser readXYZHV used before textRecordReader (128 byte getline,
+*	  strtok and one sscanf per field), kept here as the baseline;
+*	- textRecordReader alone;
+*	- readXYZHV, which adds the bounding box, error scaling and sums.
+* The MB/s of each is reported and the fields parsed by the two parsers are
+* compared bit for bit.
+*
+* Build with "make benchmarks" and run as
+*	textReaderBenchmark [numberOfRecords] [scratchDirectory]
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../fileReader.h"
+#include "../textRecordReader.h"
+
+#ifndef _MSC_VER
+#define strtok_s strtok_r
+#define sscanf_s sscanf
+#endif
+
+using namespace std;
+
+//************************************************************************************
+// SUBROUTINE I: Write a synthetic survey.
+//************************************************************************************
+static double writeSurvey(const string &fileName, int numRecords)
+{
+	FILE *fp = fopen(fileName.c_str(), "wb");
+	if (fp == NULL)
+		return 0;
+	srand(12345);
+	for (int i = 0; i < numRecords; i++)
+	{
+		double lon = -117.28 + 0.05 * ((double)rand() / RAND_MAX);
+		double lat = 32.84 + 0.05 * ((double)rand() / RAND_MAX);
+		double depth = 20.0 + 15.0 * ((double)rand() / RAND_MAX);
+		//Alternate the delimiters the way hand edited files do
+		if (i % 3 == 0)
+			fprintf(fp, "%.9f\t%.9f\t%.3f\t%.3f\t%.3f\n", lon, lat, depth, 0.5 + 0.001 * (i % 100), 0.25);
+		else if (i % 3 == 1)
+			fprintf(fp, "%.9f %.9f %.3f %.3f %.3f\n", lon, lat, depth, 0.5 + 0.001 * (i % 100), 0.25);
+		else
+			fprintf(fp, "  %.9f \t%.9f  %.3f\t %.3f %.3f\r\n", lon, lat, depth, 0.5 + 0.001 * (i % 100), 0.25);
+	}
+	double bytes = (double)ftell(fp);
+	fclose(fp);
+	return bytes;
+}
+
+//************************************************************************************
+// SUBROUTINE II: The previous readXYZHV parser.
+//************************************************************************************
+static void legacyParse(const string &fileName, vector<double> *fields)
+{
+	char inputFileChar[128];
+	char delim[] = " \t";
+	char *next_token;
+	double value;
+	ifstream inFile;
+
+	inFile.open(fileName.c_str(), ios::in);
+	inFile.getline(inputFileChar, 128);
+	while (inFile.gcount() > 3)
+	{
+		next_token = NULL;
+		char *token = strtok_s(inputFileChar, delim, &next_token);
+		for (int f = 0; f < 5; f++)
+		{
+			if (sscanf_s(token, "%lf", &value) <= 0)
+				return;
+			(*fields).push_back(value);
+			token = strtok_s(NULL, delim, &next_token);
+		}
+		if (inFile.eof())
+			break;
+		inFile.getline(inputFileChar, 128);
+	}
+	inFile.close();
+}
+
+//************************************************************************************
+// SUBROUTINE III: Parse with textRecordReader.
+//************************************************************************************
+static void blockParse(const string &fileName, vector<double> *fields)
+{
+	textRecordReader inFile;
+	double values[5];
+
+	inFile.open(fileName);
+	while (inFile.nextRecord(values, 5) == 5)
+		(*fields).insert((*fields).end(), values, values + 5);
+	inFile.close();
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Print the time and throughput of one parser.
+//************************************************************************************
+static void report(const char *name, double bytes, double seconds, int numRecords)
+{
+	cout << setw(28) << left << name << right << fixed << setprecision(3) << setw(10) << seconds
+		<< setw(12) << setprecision(1) << (seconds > 0 ? bytes / 1048576.0 / seconds : 0.0)
+		<< setw(14) << setprecision(0) << (seconds > 0 ? numRecords / seconds : 0.0) << endl;
+}
+
+//************************************************************************************
+// SUBROUTINE V: Main.
+//************************************************************************************
+int main(int argc, char **argv)
+{
+	int numRecords = (argc > 1) ? atoi(argv[1]) : 2000000;
+	string directory = (argc > 2) ? argv[2] : ".";
+	if (numRecords < 1)
+	{
+		cerr << "Usage: textReaderBenchmark [numberOfRecords] [scratchDirectory]" << endl;
+		return 1;
+	}
+
+	//A. Write the survey
+	string fileName = directory + "/textReaderBenchmark_xyzhv_mc.dat";
+	double bytes = writeSurvey(fileName, numRecords);
+	if (bytes == 0)
+	{
+		cerr << "Unable to write " << fileName << endl;
+		return 1;
+	}
+	cout << "Records: " << numRecords << "  File size: " << fixed << setprecision(1) << bytes / 1048576.0 << " MB" << endl << endl;
+	cout << setw(28) << left << "parser" << right << setw(10) << "seconds" << setw(12) << "MB/s" << setw(14) << "records/s" << endl;
+
+	//B. Time each parser
+	vector<double> legacyFields, blockFields;
+	clock_t start = clock();
+	legacyParse(fileName, &legacyFields);
+	report("getline/strtok/sscanf", bytes, (double)(clock() - start) / CLOCKS_PER_SEC, numRecords);
+
+	start = clock();
+	blockParse(fileName, &blockFields);
+	report("textRecordReader", bytes, (double)(clock() - start) / CLOCKS_PER_SEC, numRecords);
+
+	vector<TRUE_DATA> inputData = vector<TRUE_DATA>(1);
+	BOUNDING_BOX bbox;
+	bbox.doBoundingBox = false;
+	int pos = 0;
+	string readName = fileName;
+	start = clock();
+	int retVal = readXYZHV(readName, bbox, &inputData, pos, 0, 0, 0);
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	cout << endl;
+	report("readXYZHV", bytes, seconds, numRecords);
+
+	//C. Both parsers must read the same numbers
+	int mismatches = (legacyFields.size() == blockFields.size()) ? 0 : -1;
+	for (int i = 0; mismatches >= 0 && i < (const int)legacyFields.size(); i++)
+	{
+		if (memcmp(&legacyFields[i], &blockFields[i], sizeof(double)) != 0)
+			mismatches++;
+	}
+	cout << endl << "Fields parsed: " << legacyFields.size() << " / " << blockFields.size()
+		<< "  Mismatched fields: " << mismatches
+		<< "  readXYZHV records: " << inputData[0].lon.size() << (retVal == SUCCESS ? "" : " (read failed)") << endl;
+
+	remove(fileName.c_str());
+	return (mismatches == 0 && retVal == SUCCESS) ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/**
+* @file			tinLocateBenchmark.cpp
+* @brief		Times TIN point location for a full output raster with and without the located-edge hint.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* Builds a synthetic multibeam survey, triangulates it with SHullDelaunay and
+* queries every node of a regular raster through InterpGrid::estimate, first
+* walking every query in from startingEdge and then walking from the last
+* located edge.  Both the bilinear (locate) and nearest neighbor (locate3NN)
+* paths are timed and the depths of the two walks are compared.  The build time
+* of each TinBuildMode and the memory held by the TIN vertices are reported first.
+*
+* Build with "make benchmarks" and run as
+*	tinLocateBenchmark [numberOfPings] [beamsPerPing] [rasterSpacing]
+*/
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "../Error_Estimator/Bathy_Grid.h"
+
+using namespace std;
+
+//************************************************************************************
+// SUBROUTINE I: Build a synthetic survey of parallel swaths over a sloping, rippled seafloor.
+//************************************************************************************
+static void makeSurvey(int numPings, int numBeams, vector<double> *x, vector<double> *y, vector<double> *z, vector<double> *h, vector<double> *v)
+{
+	const double pingSpacing = 2.0;
+	const double swathWidth = 200.0;
+	const double lineSpacing = 150.0;
+	const int pingsPerLine = 500;
+	int line, ping;
+	double along, across, depth;
+
+	srand(12345);
+	for (int p = 0; p < numPings; p++)
+	{
+		line = p / pingsPerLine;
+		ping = p % pingsPerLine;
+		//Alternate the heading of each line as a survey vessel would.
+		if (line % 2)
+			ping = pingsPerLine - 1 - ping;
+		along = ping * pingSpacing;
+		for (int b = 0; b < numBeams; b++)
+		{
+			across = line * lineSpacing + swathWidth * ((double)b / (numBeams - 1) - 0.5);
+			across += 0.05 * ((double)rand() / RAND_MAX - 0.5);
+			depth = 20.0 + 0.01 * across + 2.0 * sin(along / 40.0) * cos(across / 55.0);
+			(*x).push_back(along + 0.05 * ((double)rand() / RAND_MAX - 0.5));
+			(*y).push_back(across);
+			(*z).push_back(depth);
+			(*h).push_back(0.5);
+			(*v).push_back(0.25);
+		}
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE II: Time one pass over the raster with the chosen walk strategy.
+//************************************************************************************
+static void timeStrategy(Bathy_Grid *bathyGrid, vector<double> *xs, vector<double> *ys, string interpMethod, bool fromHint, vector<double> *zOut)
+{
+	vector<double> zs = vector<double>((*xs).size(), 0.0);
+	InterpGrid grid(GMT);
+	SHullDelaunay *tin = bathyGrid->getTin();
+	TinCursor cursor;
+
+	tin->setLocateFromHint(fromHint);
+
+	clock_t start = clock();
+	grid.estimate(xs, ys, &zs, 1.96, 2.00, 0, tin, interpMethod, "bilinear", "none", &cursor);
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	int nodes = (const int)(*xs).size();
+	cout << setw(10) << interpMethod << setw(14) << (fromHint ? "hint" : "startingEdge")
+		<< setw(12) << fixed << setprecision(3) << seconds
+		<< setw(14) << setprecision(0) << (seconds > 0 ? nodes / seconds : 0.0)
+		<< setw(14) << setprecision(2) << (double)cursor.walkSteps / nodes << endl;
+
+	*zOut = *grid.getZ();
+}
+
+//************************************************************************************
+// SUBROUTINE III: Largest depth difference between two strategies.
+//************************************************************************************
+static double maxDifference(const vector<double>& a, const vector<double>& b)
+{
+	double worst = 0;
+	for (int i = 0; i < (const int)a.size(); i++)
+		worst = max(worst, fabs(a[i] - b[i]));
+	return worst;
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Main.
+//************************************************************************************
+int main(int argc, char **argv)
+{
+	int numPings = (argc > 1) ? atoi(argv[1]) : 2000;
+	int numBeams = (argc > 2) ? atoi(argv[2]) : 101;
+	double spacing = (argc > 3) ? atof(argv[3]) : 2.0;
+	if (numPings < 1 || numBeams < 2 || spacing <= 0)
+	{
+		cerr << "Usage: tinLocateBenchmark [numberOfPings] [beamsPerPing] [rasterSpacing]" << endl;
+		return 1;
+	}
+
+	//A. Build and triangulate the survey
+	vector<double> x, y, z, h, v;
+	makeSurvey(numPings, numBeams, &x, &y, &z, &h, &v);
+
+	const char *modeNames[3] = { "sweep, global flips", "sweep, local flips", "BRIO, local flips" };
+	cout << "Soundings: " << x.size() << endl;
+	for (int mode = SWEEP_GLOBAL_FLIP; mode <= BRIO_LOCAL_FLIP; mode++)
+	{
+		Bathy_Grid buildGrid;
+		SHullDelaunay::setDefaultBuildMode((TinBuildMode)mode);
+		clock_t start = clock();
+		buildGrid.Construct_Tin(&x, &y, &z, &h, &v);
+		cout << "TIN build (" << modeNames[mode] << "): " << fixed << setprecision(3)
+			<< (double)(clock() - start) / CLOCKS_PER_SEC << " s, " << buildGrid.getTin()->getNumFlips() << " flips" << endl;
+	}
+	SHullDelaunay::setDefaultBuildMode(SWEEP_GLOBAL_FLIP);
+	Bathy_Grid bathyGrid;
+	bathyGrid.Construct_Tin(&x, &y, &z, &h, &v);
+	cout << "TIN vertex storage: " << fixed << setprecision(1) << bathyGrid.getTin()->getVertexMemory() / 1048576.0
+		<< " MB (" << setprecision(0) << (double)bathyGrid.getTin()->getVertexMemory() / x.size() << " bytes per sounding)" << endl;
+
+	//B. Lay out the output raster over the survey extent in row order
+	double xmin = x[0], xmax = x[0], ymin = y[0], ymax = y[0];
+	for (int i = 1; i < (const int)x.size(); i++)
+	{
+		xmin = min(xmin, x[i]); xmax = max(xmax, x[i]);
+		ymin = min(ymin, y[i]); ymax = max(ymax, y[i]);
+	}
+	vector<double> xs, ys;
+	for (double yy = ymin; yy <= ymax; yy += spacing)
+	{
+		for (double xx = xmin; xx <= xmax; xx += spacing)
+		{
+			xs.push_back(xx);
+			ys.push_back(yy);
+		}
+	}
+	cout << "Raster nodes: " << xs.size() << endl << endl;
+
+	//C. Compare the walk strategies
+	cout << setw(10) << "method" << setw(14) << "walk start" << setw(12) << "seconds"
+		<< setw(14) << "nodes/s" << setw(14) << "steps/node" << endl;
+	vector<double> zStart, zHint;
+	timeStrategy(&bathyGrid, &xs, &ys, "bilinear", false, &zStart);
+	timeStrategy(&bathyGrid, &xs, &ys, "bilinear", true, &zHint);
+	double bilinearDiff = maxDifference(zStart, zHint);
+	timeStrategy(&bathyGrid, &xs, &ys, "NN", false, &zStart);
+	timeStrategy(&bathyGrid, &xs, &ys, "NN", true, &zHint);
+	double nnDiff = maxDifference(zStart, zHint);
+
+	//D. Both walks must land in the same triangles
+	cout << endl << "Max depth difference: bilinear " << scientific << bilinearDiff << "  NN " << nnDiff << endl;
+
+	return 0;
+}
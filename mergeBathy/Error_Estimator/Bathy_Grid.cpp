@@ -146,7 +146,7 @@ void Bathy_Grid::Construct_Tin(vector<double> *xInit, vector<double> *yInit, vec
 	//std::cout << "Done initializing" << std::endl;
 }
 
-void InterpGrid::estimate(vector<double> *xSurf, vector<double> *ySurf, vector<double> *zSurf, const double& sH, const double& alpha, const double& deltaMin, SHullDelaunay* tin, string depthInterpMethod, string errorInterpMethod, string extrapMethod)
+void InterpGrid::estimate(vector<double> *xSurf, vector<double> *ySurf, vector<double> *zSurf, const double& sH, const double& alpha, const double& deltaMin, SHullDelaunay* tin, string depthInterpMethod, string errorInterpMethod, string extrapMethod, TinCursor *cursor)
 {
 	ptlSurface = new PointList();
 	ptlSurface->setFromVectors(*xSurf, *ySurf, *zSurf, tin->getOffsetX(), tin->getOffsetY());
@@ -165,7 +165,7 @@ void InterpGrid::estimate(vector<double> *xSurf, vector<double> *ySurf, vector<d
 	this->scaleFactor = sH;
 	this->alpha = alpha;
 	this->deltaMin = deltaMin;
-	vector<Point> pVec(tin->determinePingLocationInTriangle(*ptlSurface, sH, alpha, deltaMin,*grads, triangles, depthInterpMethod, errorInterpMethod, extrapMethod));
+	vector<Point> pVec(tin->determinePingLocationInTriangle(*ptlSurface, sH, alpha, deltaMin,*grads, triangles, depthInterpMethod, errorInterpMethod, extrapMethod, cursor));
 
 	e.reserve(pVec.size());
 	e2.reserve(pVec.size());
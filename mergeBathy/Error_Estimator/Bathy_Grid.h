@@ -80,7 +80,8 @@ class InterpGrid
 		void clear();
 
 		// Calculate uncertainties function
-		void estimate(std::vector<double> *xSurf, std::vector<double> *ySurf, std::vector<double> *zSurf, const double& sH, const double& alpha, const double& deltaMin, SHullDelaunay* tin, string depthInterpMethod, string errorInterpMethod, string extrapMethod);
+		// cursor - Optional walk state passed to SHullDelaunay::determinePingLocationInTriangle (Returned).
+		void estimate(std::vector<double> *xSurf, std::vector<double> *ySurf, std::vector<double> *zSurf, const double& sH, const double& alpha, const double& deltaMin, SHullDelaunay* tin, string depthInterpMethod, string errorInterpMethod, string extrapMethod, TinCursor *cursor = NULL);
 
 		//void InterpGrid::estimate(vector<double> *xSurf, vector<double> *ySurf, vector<double> *zSurf,vector<double> *eSurf,vector<double> *hSurf,vector<double> *vSurf, vector<double> *nmseiSurf,vector<double> *reiSurf,const double& sH, const double& alpha, const double& deltaMin, SHullDelaunay* tin, string interpMethod);
 		friend class Bathy_Grid;
@@ -15,7 +15,7 @@
 #include<list>
 #include<iostream>
 #include<iomanip>
-#include<assert.h>
+#include<stdexcept>
 #include<vector>
 #include "../standardOperations.h"
 //#include"pointList.h"
@@ -212,15 +212,42 @@ void Ping::print() const
 */
 #pragma endregion Ping Class
 
+#pragma region -- Vertex2d Class
+/*
+	Class Vertex2d
+*/
+double Vertex2d::distance2d(const Vertex2d& p) const
+{
+	return sqrt((((x - p.x) * (x - p.x)) +
+		((y - p.y) * (y - p.y))));
+}
+
+Vector2d Vertex2d::operator-(const Vertex2d& p) const
+{
+	return Vector2d(x - p.x, y - p.y);
+}
+
+bool Vertex2d::eq2d(const Vertex2d& p) const
+{
+	if(x == p.x && y == p.y)
+		return true;
+	return false;
+}
+/*
+	End Class Vertex2d
+*/
+#pragma endregion Vertex2d Class
+
 #pragma region -- Point Class
 /*
 	Class Point
 */
-Point::Point(const double& x, const double& y, const double& z) : x(x), y(y), z(z) {}
+Point::Point(const double& x, const double& y, const double& z) : Vertex2d(x, y), z(z),
+	u(0), u2(0), u3(0), u4(0), u5(0), s(0), id(0), hU(0), vU(0),
+	z0(0), e0(0), zK(0), eK(0), nei(0), rei(0) {}
 
-Point::Point(const Point& p)
+Point::Point(const Point& p) : Vertex2d(p.x, p.y)
 {
-	x = p.x;
 	y = p.y;
 	z = p.z;
 	u = p.u;
@@ -311,97 +338,179 @@ bool Point::operator<(const Point& p) const
 	return true;
 }
 
-double Point::distance2d(const Point& p) const
+bool Point::eqErr(const Point& p, const double err) const
 {
-	return sqrt((((x - p.x) * (x - p.x)) +
-		((y - p.y) * (y - p.y))));
+	if(fabs(x - p.x) < err && fabs(y - p.y) < err)
+		return true;
+	return false;
 }
 
-Vector2d Point::operator-(const Point& p) const
+void Point::print() const
 {
-	return Vector2d(x - p.x, y - p.y);
+	cout << setprecision(15) << "X: " << x << " Y: " << y << " Z: " << z << endl;
 }
+/*
+	End Class Point
+*/
+#pragma endregion Point Class
 
-bool Point::eq2d(const Point& p) const
+#pragma region -- TinVertices Class
+/*
+	Class TinVertices
+*/
+void TinVertices::reserve(int n)
 {
-	if(x == p.x && y == p.y)
-		return true;
-	return false;
+	xy.reserve(n);
+	z.reserve(n);
+	hU.reserve(n);
+	vU.reserve(n);
 }
 
-bool Point::eqErr(const Point& p, const double err) const
+Vertex2d* TinVertices::add(const Point& p)
 {
-	if(fabs(x - p.x) < err && fabs(y - p.y) < err)
-		return true;
-	return false;
+	int n = size();
+	//Edges hold pointers into xy, so it must never reallocate.  This is checked in
+	//release builds too since a reallocation would leave every Edge dangling.
+	if(n >= (const int)xy.capacity())
+		throw std::length_error("TinVertices::add: more vertices than were reserved");
+	xy.push_back(Vertex2d(p.x, p.y));
+	z.push_back(p.z);
+	hU.push_back(p.hU);
+	vU.push_back(p.vU);
+
+	//Raster columns are only kept once a vertex carries raster values.  The
+	//vertices before it are filled with zeros.
+	if(!rasterColumns && (p.u != 0 || p.nei != 0 || p.rei != 0 || p.z0 != 0 || p.e0 != 0 || p.zK != 0 || p.eK != 0))
+	{
+		int cap = (const int)xy.capacity();
+		std::vector<double>* cols[7] = { &u, &nei, &rei, &z0, &e0, &zK, &eK };
+		for(int k = 0; k < 7; k++)
+		{
+			(*cols[k]).reserve(cap);
+			(*cols[k]).assign(n, 0.0);
+		}
+		rasterColumns = true;
+	}
+	if(rasterColumns)
+	{
+		u.push_back(p.u);
+		nei.push_back(p.nei);
+		rei.push_back(p.rei);
+		z0.push_back(p.z0);
+		e0.push_back(p.e0);
+		zK.push_back(p.zK);
+		eK.push_back(p.eK);
+	}
+	return &xy[n];
 }
 
-void Point::print() const
+Point TinVertices::point(int id) const
 {
-	cout << setprecision(15) << "X: " << x << " Y: " << y << " Z: " << z << endl;
+	if(id < 0)
+		return Point();
+
+	Point p(xy[id].x, xy[id].y, z[id]);
+	p.hU = hU[id];
+	p.vU = vU[id];
+	p.id = id;
+	if(rasterColumns)
+	{
+		p.u = u[id];
+		p.nei = nei[id];
+		p.rei = rei[id];
+		p.z0 = z0[id];
+		p.e0 = e0[id];
+		p.zK = zK[id];
+		p.eK = eK[id];
+	}
+	return p;
+}
+
+void TinVertices::clear()
+{
+	std::vector<Vertex2d>().swap(xy);
+	std::vector<double>* cols[10] = { &z, &hU, &vU, &u, &nei, &rei, &z0, &e0, &zK, &eK };
+	for(int k = 0; k < 10; k++)
+		std::vector<double>().swap(*cols[k]);
+	rasterColumns = false;
+}
+
+size_t TinVertices::memory() const
+{
+	size_t bytes = xy.capacity() * sizeof(Vertex2d);
+	const std::vector<double>* cols[10] = { &z, &hU, &vU, &u, &nei, &rei, &z0, &e0, &zK, &eK };
+	for(int k = 0; k < 10; k++)
+		bytes += (*cols[k]).capacity() * sizeof(double);
+	return bytes;
 }
 /*
-	End Class Point
+	End Class TinVertices
 */
-#pragma endregion Point Class
+#pragma endregion TinVertices Class
 
 #pragma region -- Triangle Class
 /*
 	Class Triangle
 */
-// Construct a triangle with 3 Pings
-Triangle::Triangle(const Point& V1, const Point& V2, const Point& V3) : v1(V1), v2(V2), v3(V3) {}
+// Construct a triangle from 3 vertex ids
+Triangle::Triangle(const TinVertices *verts, int V1, int V2, int V3) : verts(verts), v1(V1), v2(V2), v3(V3) {}
 
 // Construct a triangle at all zeros
-Triangle::Triangle() {}
+Triangle::Triangle() : verts(NULL), v1(-1), v2(-1), v3(-1) {}
+
+// Loads vertex 1, 2 or 3
+Point Triangle::vertex(int k) const
+{
+	if(verts == NULL)
+		return Point();
+	return (*verts).point((k == 1) ? v1 : ((k == 2) ? v2 : v3));
+}
 
 // Returns the midpoint of the triangle's hypotenuse (Used with rTin)
 Point Triangle::midHyp() const
 {
-	return Point(((v2.x + v3.x) / 2), ((v2.y + v3.y) / 2), ((v2.z + v3.z) / 2));
+	Point b = vertex(2), c = vertex(3);
+	return Point(((b.x + c.x) / 2), ((b.y + c.y) / 2), ((b.z + c.z) / 2));
 }
 
 double Triangle::edgeLen() const
 {
-	return sqrt((v1.x - v2.x) * (v1.x - v2.x) + (v1.y - v2.y) * (v1.y - v2.y));
+	Point a = vertex(1), b = vertex(2);
+	return sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
 }
 
-// Sets all pings in triangle
-void Triangle::set(Point p1, Point p2, Point p3)
+// Sets all vertices in triangle
+void Triangle::set(const TinVertices *verts, int p1, int p2, int p3)
 {
+	this->verts = verts;
 	v1 = p1;
 	v2 = p2;
 	v3 = p3;
 }
 
-Triangle Triangle::operator=(const Triangle& t)
-{
-	v1 = t.v1;
-	v2 = t.v2;
-	v3 = t.v3;
-	return t;
-}
-
 // Returns true if point is inside triangle
 // ignores depth
 // might have some error with
 // 	points that lie really close to an edge
 bool Triangle::isInside(const Point& p) const
 {
-	return pointInTriangle(p, v1, v2, v3);
+	return pointInTriangle(p, vertex(1), vertex(2), vertex(3));
 }
 
 // Overloads < operator for sorting, simply adds values of all vertices
 // and finds the triangle with the lowest total
 bool Triangle::operator<(const Triangle& t) const
 {
-	double selfAvgLong = (v1.x + v2.x + v3.x) / 3;
-	double selfAvgLat = (v1.y + v2.y + v3.y) / 3;
-	double selfAvgDepth = (v1.z + v2.z + v3.z) / 3;
+	Point a = vertex(1), b = vertex(2), c = vertex(3);
+	Point ta = t.vertex(1), tb = t.vertex(2), tc = t.vertex(3);
 
-	double tAvgLong = (t.v1.x + t.v2.x + t.v3.x) / 3;
-	double tAvgLat = (t.v1.y + t.v2.y + t.v3.y) / 3;
-	double tAvgDepth = (t.v1.z + t.v2.z + t.v3.z) / 3;
+	double selfAvgLong = (a.x + b.x + c.x) / 3;
+	double selfAvgLat = (a.y + b.y + c.y) / 3;
+	double selfAvgDepth = (a.z + b.z + c.z) / 3;
+
+	double tAvgLong = (ta.x + tb.x + tc.x) / 3;
+	double tAvgLat = (ta.y + tb.y + tc.y) / 3;
+	double tAvgDepth = (ta.z + tb.z + tc.z) / 3;
 
 	if(tAvgLong < selfAvgLong)
 		return false;
@@ -421,19 +530,22 @@ bool Triangle::operator<(const Triangle& t) const
 // Overloads == operator for Boolean comparison
 bool Triangle::operator==(const Triangle& t) const
 {
-	if(v1 == t.v1)
+	Point a = vertex(1), b = vertex(2), c = vertex(3);
+	Point ta = t.vertex(1), tb = t.vertex(2), tc = t.vertex(3);
+
+	if(a == ta)
 	{
-		if(v2 == t.v2 && v3 == t.v3)
+		if(b == tb && c == tc)
 			return true;
 	}
-	else if(v1 == t.v2)
+	else if(a == tb)
 	{
-		if(v2 == t.v3 && v3 == t.v1)
+		if(b == tc && c == ta)
 			return true;
 	}
-	else if(v1 == t.v3)
+	else if(a == tc)
 	{
-		if(v2 == t.v1 && v3 == t.v2)
+		if(b == ta && c == tb)
 			return true;
 	}
 		return false;
@@ -441,12 +553,12 @@ bool Triangle::operator==(const Triangle& t) const
 
 double Triangle::sample(const Point& p) const
 {
-	return samplePlane(p, v1, v2, v3);
+	return samplePlane(p, vertex(1), vertex(2), vertex(3));
 }
 
 Gradient Triangle::getGradient() const
 {
-	return gradient(v1, v2, v3);
+	return gradient(vertex(1), vertex(2), vertex(3));
 }
 
 #pragma endregion Traingle Class
@@ -531,11 +643,11 @@ Edge* Edge::rNext() { return rot()->oNext()->invRot(); }
 Edge* Edge::rPrev() { return sym()->oNext(); }
 
 // Access Pointers //
-Point* Edge::org() { return data; }
-Point* Edge::dest() { return sym()->data; }
-const Point& Edge::org2d() const { return *data; }
-const Point& Edge::dest2d() const { return (num < 2) ? *((this+2)->data) : *((this - 2)->data); }
-void Edge::endPoints(Point* org, Point* dest)
+Vertex2d* Edge::org() { return data; }
+Vertex2d* Edge::dest() { return sym()->data; }
+const Vertex2d& Edge::org2d() const { return *data; }
+const Vertex2d& Edge::dest2d() const { return (num < 2) ? *((this+2)->data) : *((this - 2)->data); }
+void Edge::endPoints(Vertex2d* org, Vertex2d* dest)
 {
 	data = org;
 	sym()->data = dest;
@@ -571,7 +683,7 @@ QuadEdge::QuadEdge()
 
 Line::Line(){}
 
-Line::Line(const Point& p, const Point& q)
+Line::Line(const Vertex2d& p, const Vertex2d& q)
 {
 	Vector2d t = q - p;
 	double len = t.norm();
@@ -580,12 +692,12 @@ Line::Line(const Point& p, const Point& q)
 	c = -(a*p.x + b*p.y);
 }
 
-double Line::eval(const Point& p) const
+double Line::eval(const Vertex2d& p) const
 {
 	return (a * p.x + b * p.y + c);
 }
 
-int Line::classify(const Point& p) const
+int Line::classify(const Vertex2d& p) const
 {
 	double d = eval(p);
 	return (d < -EPS) ? -1 : (d > EPS ? 1 : 0);
@@ -677,7 +789,7 @@ void swap(Edge* e)
 
 #pragma region --Delaunay Geo Predicates
 /*************** Geometric Predicates for Delaunay Diagrams *****************/
-double triArea(const Point& a, const Point& b, const Point& c)
+double triArea(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c)
 // Returns twice the area of the oriented triangle (a, b, c), i.e., the
 // area is positive if the triangle is oriented counterclockwise.
 {//SJZ added
@@ -690,7 +802,7 @@ double triArea(const Point& a, const Point& b, const Point& c)
 
 // Returns TRUE if the point d is inside the circle defined by the
 // points a, b, c. See Guibas and Stolfi (1985) p.107.
-int inCircle(const Point& a, const Point& b, const Point& c, const Point& d)
+int inCircle(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c, const Vertex2d& d)
 {
 	double val2= (a.x-d.x)*(b.y-d.y)*(((c.x*c.x)-(d.x*d.x))+((c.y*c.y)-(d.y*d.y)))+
 	(a.y-d.y)*(c.x-d.x)*(((b.x*b.x)-(d.x*d.x))+((b.y*b.y)-(d.y*d.y)))+
@@ -711,7 +823,7 @@ int inCircle(const Point& a, const Point& b, const Point& c, const Point& d)
 	(c.x*c.x + c.y*c.y) * triArea(a, b, d) -
 	(d.x*d.x + d.y*d.y) * triArea(a, b, c) > 0;
 }
-int isConvexQuad(const Point& a, const Point& b, const Point& c, const Point& d)
+int isConvexQuad(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c, const Vertex2d& d)
 {
 	if ((ccw(a,b,c) && ccw(b,c,d)) && (ccw(c,d,a) && ccw(d,a,b)))
 		return 1;
@@ -721,22 +833,22 @@ int isConvexQuad(const Point& a, const Point& b, const Point& c, const Point& d)
 	else return 0;
 }
 // Returns TRUE if the points a, b, c are in a counterclockwise order
-int ccw(const Point& a, const Point& b, const Point& c)
+int ccw(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c)
 {
 	return (triArea(a, b, c) > 0);
 }
 
-int rightOf(const Point& x, Edge* e)
+int rightOf(const Vertex2d& x, Edge* e)
 {
 	return ccw(x, e->dest2d(), e->org2d());
 }
 
-int LeftOf(const Point& x, Edge* e)
+int LeftOf(const Vertex2d& x, Edge* e)
 {
 	return ccw(x, e->org2d(), e->dest2d());
 }
 
-int onEdge(const Point& x, Edge* e)
+int onEdge(const Vertex2d& x, Edge* e)
 // A predicate that determines if the point x is on the edge e.
 // The point is considered on if it is in the EPS-neighborhood
 // of the edge.
@@ -760,18 +872,20 @@ int onEdge(const Point& x, Edge* e)
 */
 double differenceInPlanes(const Triangle& t1, const Triangle& t2)
 {
-	double A1 = (t1.v1.y * (t1.v2.z - t1.v3.z)) +
-			(t1.v2.y * (t1.v3.z - t1.v1.z)) + (t1.v3.y * (t1.v1.z - t1.v2.z));
-	double B1 = (t1.v1.z * (t1.v2.x - t1.v3.x)) +
-			(t1.v2.z * (t1.v3.x - t1.v1.x)) + (t1.v3.z * (t1.v1.x - t1.v2.x));
-	double C1 = (t1.v1.x * (t1.v2.y - t1.v3.y)) +
-			(t1.v2.x * (t1.v3.y - t1.v1.y)) + (t1.v3.x * (t1.v1.y - t1.v2.y));
-	double A2 = (t2.v1.y * (t2.v2.z - t2.v3.z)) +
-			(t2.v2.y * (t2.v3.z - t2.v1.z)) + (t2.v3.y * (t2.v1.z - t2.v2.z));
-	double B2 = (t2.v1.z * (t2.v2.x - t2.v3.x)) +
-			(t2.v2.z * (t2.v3.x - t2.v1.x)) + (t2.v3.z * (t2.v1.x - t2.v2.x));
-	double C2 = (t2.v1.x * (t2.v2.y - t2.v3.y)) +
-			(t2.v2.x * (t2.v3.y - t2.v1.y)) + (t2.v3.x * (t2.v1.y - t2.v2.y));
+	Point t1v1 = t1.vertex(1), t1v2 = t1.vertex(2), t1v3 = t1.vertex(3);
+	Point t2v1 = t2.vertex(1), t2v2 = t2.vertex(2), t2v3 = t2.vertex(3);
+	double A1 = (t1v1.y * (t1v2.z - t1v3.z)) +
+			(t1v2.y * (t1v3.z - t1v1.z)) + (t1v3.y * (t1v1.z - t1v2.z));
+	double B1 = (t1v1.z * (t1v2.x - t1v3.x)) +
+			(t1v2.z * (t1v3.x - t1v1.x)) + (t1v3.z * (t1v1.x - t1v2.x));
+	double C1 = (t1v1.x * (t1v2.y - t1v3.y)) +
+			(t1v2.x * (t1v3.y - t1v1.y)) + (t1v3.x * (t1v1.y - t1v2.y));
+	double A2 = (t2v1.y * (t2v2.z - t2v3.z)) +
+			(t2v2.y * (t2v3.z - t2v1.z)) + (t2v3.y * (t2v1.z - t2v2.z));
+	double B2 = (t2v1.z * (t2v2.x - t2v3.x)) +
+			(t2v2.z * (t2v3.x - t2v1.x)) + (t2v3.z * (t2v1.x - t2v2.x));
+	double C2 = (t2v1.x * (t2v2.y - t2v3.y)) +
+			(t2v2.x * (t2v3.y - t2v1.y)) + (t2v3.x * (t2v1.y - t2v2.y));
 	double num = fabs(A1 * A2 + B1 * B2 + C1 * C2);
 	double den = sqrt(pow(A1, 2) + pow(B1, 2) + pow(C1, 2)) *
 							sqrt(pow(A2, 2) + pow(B2, 2) + pow(C2, 2));
@@ -782,12 +896,12 @@ double differenceInPlanes(const Triangle& t1, const Triangle& t2)
 
 // Returns positive number if the point P1 is on one side of the line
 // and returns a negative number if it is on the other
-double sign(const Point& p1, const Point& p2, const Point& p3)
+double sign(const Vertex2d& p1, const Vertex2d& p2, const Vertex2d& p3)
 {
 	return (p3.x - p2.x) * (p1.y - p2.y) - (p3.y - p2.y) * (p1.x - p2.x);
 }
 
-bool pointInTriangle(const Point& p, const Point& v1, const Point& v2, const Point& v3)
+bool pointInTriangle(const Vertex2d& p, const Vertex2d& v1, const Vertex2d& v2, const Vertex2d& v3)
 {
 	bool b1, b2, b3;
 	b1 = sign(p, v1, v2) < 0.0f;
@@ -853,7 +967,7 @@ double radiusOfCircumCircle(const Point& p1, const Point& p2, const Point& p3)
 #pragma endregion Delaunay Geo Predicates
 
 #pragma region --SJZ Added
-int collinear(const Point& x, Edge* e)
+int collinear(const Vertex2d& x, Edge* e)
 {
 	return triArea(x, e->dest2d(), e->org2d()) == 0;
 }
@@ -320,6 +320,46 @@ class Gradient//SJZ
 		}
 };
 
+/**
+* Class for storing the 2d position of a Point.  A TIN only needs x and y to walk
+* and test its edges, so its vertices are stored as a dense array of Vertex2d and the
+* geometric predicates below take Vertex2d, which a full Point also is.
+*/
+class Vertex2d
+{
+	public:
+		/** X position of the Vertex */
+		double x;
+
+		/** Y position of the Vertex */
+		double y;
+
+		/** Constructor for the Vertex
+		* @param x - value for x.
+		* @param y - value for y.
+		*/
+		Vertex2d(const double& x = 0, const double& y = 0) : x(x), y(y) {}
+
+		/** Calculates and returns the distance between "this" Vertex and the Vertex p
+		* @param p - Argument Vertex for finding distance from "this" Vertex
+		* @return Distance from "this" Vertex to Vertex p
+		*/
+		double distance2d(const Vertex2d& p) const;
+
+		/** Overloads the - operator for minus operations that returns
+		* a resulting 2d vector (Vector2d) obect of Vertex1 - Vertex2.
+		* @param p - Argument Vertex to subtract from "this" Vertex
+		* @return Vector2d result of the minus operation.
+		*/
+		Vector2d operator-(const Vertex2d& p) const;
+
+		/** A Boolean function for testing with two vertices are at the same position.
+		* @param p - Argument Vertex to compare to "this" Vertex.
+		* @return True if the x and y values are equal, false otherwise
+		*/
+		bool eq2d(const Vertex2d& p) const;
+};
+
 /**
 * Class for storing a Point in a surface (Normalized version of Ping)
 * By normalized I mean that it has been converted to meters using the
@@ -327,15 +367,9 @@ class Gradient//SJZ
 * Can also be used for synthetic data points that may or may not be
 * represented as data in meters.
 */
-class Point
+class Point : public Vertex2d
 {
 	public:
-		/** X position of the Point */
-		double x;
-
-		/** Y position of the Point */
-		double y;
-
 		/** Z Position of the Point */
 		double z;
 
@@ -367,7 +401,7 @@ class Point
 		double nei;
 		double rei;
 
-		/** Constructor for the Point
+		/** Constructor for the Point.  All other values are set to 0.
 		* @param x - value for x.
 		* @param y - value for y.
 		* @param z - value for z.
@@ -400,26 +434,6 @@ class Point
 		*/
 		bool operator<(const Point& p) const;
 
-		/** Calculates and returns the distance between "this" Point and the Point p (ignores z)
-		* @param p - Argument Point for finding distance from "this" Point
-		* @return Distance from "this" Point to Point p
-		*/
-		double distance2d(const Point& p) const;
-
-		/** Overloads the - operator for minus operations that returns
-		* a resulting 2d vector (Vector2d) obect of Point1 - Point2.
-		* @param p - Argument Point to subtract from "this" ping
-		* @return Vector2d result of the minus operation.
-		*/
-		Vector2d operator-(const Point& p) const;
-
-		/** A Boolean function for testing with two pings are equivalent
-		* while ignoring the depth.
-		* @param p - Argument Point to compare to "this" Point.
-		* @return True if the x and y values are equal, false otherwise
-		*/
-		bool eq2d(const Point& p) const;
-
 		/** A Boolean function for testing equality with a provided amount of "give"
 		* @param p - Point being compared to this Point for equality.
 		* @param err - The amount of allowed error for the equality test.
@@ -431,34 +445,108 @@ class Point
 		void print() const;
 };
 
+/** Vertex storage for a TIN.  Positions are kept in one dense array indexed by
+* vertex id so that point location only touches x and y.  Depth and uncertainty
+* are kept in separate columns and only read when a located triangle is
+* interpolated.  The raster columns stay empty until a vertex carrying raster
+* values is added.
+*/
+class TinVertices
+{
+	public:
+		/** Positions of the vertices. */
+		std::vector<Vertex2d> xy;
+
+		/** Depth, horizontal and vertical uncertainty of the vertices. */
+		std::vector<double> z;
+		std::vector<double> hU;
+		std::vector<double> vU;
+
+		/** Raster values of the vertices, empty when none were given. */
+		std::vector<double> u;
+		std::vector<double> nei;
+		std::vector<double> rei;
+		std::vector<double> z0;
+		std::vector<double> e0;
+		std::vector<double> zK;
+		std::vector<double> eK;
+
+		/** True once the raster columns are allocated.  Set by the first vertex carrying raster values. */
+		bool rasterColumns;
+
+		/** A constructor for TinVertices. */
+		TinVertices() : rasterColumns(false) {}
+
+		/** Reserves room for n vertices.  Edges point into xy, so the TIN
+		* must reserve every vertex it will add before adding the first one.
+		* @param n - Number of vertices.
+		*/
+		void reserve(int n);
+
+		/** Appends the position and values of p.
+		* @param p - Point to add.
+		* @return Pointer to the position of the new vertex.
+		* @throws std::length_error if the vertices reserved are already added.
+		*/
+		Vertex2d* add(const Point& p);
+
+		/** Assembles a Point from the columns of vertex id.  The id of the Point is set to the vertex id.
+		* @param id - Vertex id.  Ids below 0 return a Point of zeros.
+		* @return Point holding the position and values of the vertex.
+		*/
+		Point point(int id) const;
+
+		/** Returns the vertex id of a position stored in xy.
+		* @param v - Position pointer returned by add or held by an Edge.
+		* @return Vertex id.
+		*/
+		int idOf(const Vertex2d* v) const { return (int)(v - &xy[0]); }
+
+		/** Returns the number of vertices. */
+		int size() const { return (const int)xy.size(); }
+
+		/** Removes all vertices and releases their memory. */
+		void clear();
+
+		/** Returns the bytes held by the vertex columns. */
+		size_t memory() const;
+};
+
 /** A Triangle class for representing and manipulating the vertices of
-* a triangle as Points. Each vertice of the triangle is represented as
-* a Point.
+* a triangle.  The vertices are referenced by id in a TinVertices, so a
+* Triangle stays small however many values each vertex carries; use vertex()
+* to load a full Point.
 * The class offers helpful functions for sorting, storing, and retrieving
 * information to and from the triangle.
 */
 class Triangle
 {
 	public:
-		/** Vertex 1 of the Triangle */
-		Point v1;
+		/** Vertices the ids refer to. */
+		const TinVertices *verts;
 
-		/** Vertex 2 of the Triangle */
-		Point v2;
+		/** Vertex ids of the Triangle, -1 when unset. */
+		int v1;
+		int v2;
+		int v3;
 
-		/** Third vertice of the Triangle */
-		Point v3;
-
-		/**Constructor that takes in 3 Points and forms the Triangle.
+		/**Constructor that takes in 3 vertex ids and forms the Triangle.
+		* @param verts - Vertices the ids refer to.
 	 	* @param V1 - Vertex 1
 	 	* @param V2 - Vertex 2
 	 	* @param V3 - Vertex 3
 		*/
-		Triangle(const Point& V1, const Point& V2, const Point& V3);
+		Triangle(const TinVertices *verts, int V1, int V2, int V3);
 
 		/** Constructor that generates a triangle at vertices containing all zeros. */
 		Triangle();
 
+		/** Loads a vertex of the Triangle.
+		* @param k - 1, 2 or 3.
+		* @return Point holding the vertex, all zeros if the Triangle is unset.
+		*/
+		Point vertex(int k) const;
+
 		/** Returns the midpoint of the Triangle's hypotenuse, (Assumes Triangle was formed for an rTin).
 		* @return Midpoint of hypotenuse
 		*/
@@ -469,17 +557,13 @@ class Triangle
 		*/
 		double edgeLen() const;
 
-		/** Sets the values of all vertices at once.
+		/** Sets all vertices at once.
+		* @param verts - Vertices the ids refer to.
 		* @param p1 - New vertex 1.
 		* @param p2 - New vertex 2.
 		* @param p3 - New vertex 3.
 		*/
-		void set(Point p1, Point p2, Point p3);
-
-		/** Overloads the = operator for assignment operations on Triangles.
-		* @param t - Triangle to be stored.
-		*/
-		Triangle operator=(const Triangle& t);
+		void set(const TinVertices *verts, int p1, int p2, int p3);
 
 		/** Returns whether the Point p is inside "this" Triangle, ignoring depth.
 		* @param p - Argument Point to test inclusion in "this" Triangle.
@@ -544,8 +628,8 @@ class Edge
 		/** Pointer to the next edge in the Quad-Edge structure. */
 		Edge *next;
 
-		/** Pointer to the data contained within "this" Edge. */
-		Point *data;
+		/** Pointer to the position of the origin of "this" Edge. */
+		Vertex2d *data;
 
 		/** Constructor for instantianting the Edge. */
 		Edge();
@@ -610,28 +694,28 @@ class Edge
 		/** Return the origin of the edge.
 		* @return Origin of the edge.
 		*/
-		Point* org();
+		Vertex2d* org();
 
 		/** Return the destination of the edge.
 		* @return Destination of the edge.
 		*/
-		Point* dest();
+		Vertex2d* dest();
 
 		/** Return the origin of the edge.
 		* @return Origin of the edge.
 		*/
-		const Point& org2d() const;
+		const Vertex2d& org2d() const;
 
 		/** Return the destination of the edge.
 		* @return Destination of the edge.
 		*/
-		const Point& dest2d() const;
+		const Vertex2d& dest2d() const;
 
 		/** Sets the endpoints of the edge.
 		* @param org - Argument Point for the origin of the Edge.
 		* @param dest - Argument Point for the destination of the Edge.
 		*/
-		void endPoints(Point* org, Point* dest);
+		void endPoints(Vertex2d* org, Vertex2d* dest);
 
 		/** Returns the QuadEdge of this edge.
 		* @returns QuadEdge of this edge.
@@ -675,20 +759,20 @@ class Line {
 		* @param p - Argument representing one point on the line
 		* @param q - Argument representing another point on the line
 		*/
-		Line(const Point& p, const Point& q);
+		Line(const Vertex2d& p, const Vertex2d& q);
 
 		/** Member function for evaluating a relationship
 		* of a Point to the line.
 		* @param p - Point to compare to the line
 		* @return Non zero number means the point is not on the line
 		*/
-		double eval(const Point& p) const;
+		double eval(const Vertex2d& p) const;
 
 		/** Member function for classifying a point on or off a line
 		* @param p - Point to compare to the line
 		* @return 0 for point on the line, 1 for right, -1 for left
 		*/
-		int classify(const Point& p) const;
+		int classify(const Vertex2d& p) const;
 
 	private:
 		double a, b, c;
@@ -723,32 +807,32 @@ void swap(Edge* e);
 /*************** Geometric Predicates for Delaunay Diagrams *****************/
 // Returns twice the area of the oriented triangle (a, b, c), i.e., the
 // area is positive if the triangle is oriented counterclockwise.
-double triArea(const Point& a, const Point& b, const Point& c);
+double triArea(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c);
 
 // Returns TRUE if the point d is inside the circle defined by the
 // points a, b, c. See Guibas and Stolfi (1985) p.107.
-int inCircle(const Point& a, const Point& b, const Point& c, const Point& d);
-int inCircle2(const Point& a, const Point& b, const Point& c, const Point& d);
+int inCircle(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c, const Vertex2d& d);
+int inCircle2(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c, const Vertex2d& d);
 
 // Returns TRUE if the points a, b, c are in a counterclockwise order
-int ccw(const Point& a, const Point& b, const Point& c);
+int ccw(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c);
 
-int rightOf(const Point& x, Edge* e);
+int rightOf(const Vertex2d& x, Edge* e);
 
-int LeftOf(const Point& x, Edge* e);
+int LeftOf(const Vertex2d& x, Edge* e);
 
-int isConvexQuad(const Point& a, const Point& b, const Point& c, const Point& d);
+int isConvexQuad(const Vertex2d& a, const Vertex2d& b, const Vertex2d& c, const Vertex2d& d);
 
 // A predicate that determines if the point x is on the edge e.
 // The point is considered on if it is in the EPS-neighborhood
 // of the edge.
-int onEdge(const Point& x, Edge* e);
+int onEdge(const Vertex2d& x, Edge* e);
 
 double differenceInPlanes(const Triangle& t1, const Triangle& t2);
 
-double sign(const Point& p1, const Point& p2, const Point& p3);
+double sign(const Vertex2d& p1, const Vertex2d& p2, const Vertex2d& p3);
 
-bool pointInTriangle(const Point& p, const Point& v1, const Point& v2, const Point& v3);
+bool pointInTriangle(const Vertex2d& p, const Vertex2d& v1, const Vertex2d& v2, const Vertex2d& v3);
 
 double samplePlane(const Point& p, const Point& v1, const Point& v2, const Point& v3);
 
@@ -764,7 +848,7 @@ struct MinDistance {
 
 /*Added by SJZ. can delete*/
 #pragma region SJZ Added
-int collinear(const Point& x, Edge* e);
+int collinear(const Vertex2d& x, Edge* e);
 int collinear(const Point& x, Point& b, Point& c);
 bool fuzzyEquals(const Point& x, const Point& e);
 double CFPE(double number);
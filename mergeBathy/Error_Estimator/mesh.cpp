@@ -21,7 +21,14 @@
 using namespace std;
 
 // Returns the entire list of positions
-vector<Point> Mesh::getPositions() const { return positions; }
+vector<Point> Mesh::getPositions() const
+{
+	vector<Point> p;
+	p.reserve(positions.size());
+	for(int i = 0; i < positions.size(); i++)
+		p.push_back(positions.point(i));
+	return p;
+}
 		
 // Returns the entire list of indices
 vector<int> Mesh::getIndices() const { return indices; }
@@ -29,9 +36,9 @@ vector<int> Mesh::getIndices() const { return indices; }
 // calls createIndicesFromPoint for all pings in the triangle
 void Mesh::insertIndices(const Triangle& t)
 {
-	insertIndices(t.v1);
-	insertIndices(t.v2);
-	insertIndices(t.v3);
+	insertIndices(t.vertex(1));
+	insertIndices(t.vertex(2));
+	insertIndices(t.vertex(3));
 }
 
 // Requires that positions for all triangles being inserted already be present
@@ -43,9 +50,10 @@ void Mesh::insertIndices(const Point& p)
 	index = (const int)positions.size() / 2;
 	while(true)
 	{
-		if(positions[index] == p)
+		Point q = positions.point(index);
+		if(q == p)
 			break;
-		else if(positions[index] < p)
+		else if(q < p)
 			index += indexMove;
 		else
 			index -= indexMove;
@@ -58,12 +66,21 @@ void Mesh::insertIndices(const Point& p)
 	indices.push_back(index);
 }
 
+// copies the sorted, unique points into the position columns
+void Mesh::setPositions(vector<Point>& p)
+{
+	positions.clear();
+	positions.reserve((const int)p.size());
+	for(int i = 0; i < (const int)p.size(); i++)
+		positions.add(p[i]);
+}
+
 void Mesh::insertPoints(list<Point>& p)
 {
 	p.sort();
 	p.unique();
-	positions.reserve(p.size());
-	positions.assign(p.begin(), p.end());
+	vector<Point> v(p.begin(), p.end());
+	setPositions(v);
 }
 
 // inserts positions from a pre-sorted list (MUCH FASTER)
@@ -71,9 +88,11 @@ void Mesh::insertPoints(PointList& p)
 {
 	p.sort();
 	p.unique();
-	positions.reserve(p.size());
+	vector<Point> v;
+	v.reserve(p.size());
 	for(int i = 0; i < p.size(); i++)
-		positions.push_back(p[i]);
+		v.push_back(p[i]);
+	setPositions(v);
 }
 		
 // inserts positions from a pre-sorted list (MUCH FASTER)
@@ -81,7 +100,7 @@ void Mesh::insertPoints(vector<Point>& p)
 {
 	sort(p.begin(), p.end());
 	unique(p.begin(), p.end());
-	positions = p;
+	setPositions(p);
 }
 
 // clears the mesh completely
@@ -97,13 +116,7 @@ int Mesh::size() const { return (const int)indices.size() / 3; }
 // Operator for indexing specific triangles using []
 Triangle Mesh::operator[](const int& index)
 {
-	Point p(positions[indices[index*3]]);
-	Point v1(p);
-	p = positions[indices[index*3+1]];
-	Point v2(p);
-	p = positions[indices[index*3+2]];
-	Point v3(p);
-	Triangle t(v1, v2, v3);
+	Triangle t(&positions, indices[index*3], indices[index*3+1], indices[index*3+2]);
 	return t;
 }
 
@@ -114,9 +127,9 @@ void Mesh::write(string fileName) const
 	string fn = fileName + ".positions";
 	outData.open(fn.c_str());
 	int k = 0;
-	for(int i = 0; i < (const int)positions.size(); i++)
+	for(int i = 0; i < positions.size(); i++)
 	{
-			p = positions[i];
+			p = positions.point(i);
 			outData << p.x << " " << p.y << " " << p.z << endl;
 	}
 	outData.close();
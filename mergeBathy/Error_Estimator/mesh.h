@@ -10,8 +10,11 @@
 class Mesh
 {
 	private:	
-		/** List of Positions. */
-		std::vector<Point> positions;		
+		/** List of Positions, sorted and unique. */
+		TinVertices positions;
+
+		/** Stores the sorted, unique Points of p as positions. */
+		void setPositions(std::vector<Point>& p);
 
 		/** List of Indices. */
 		std::vector<int> indices;
@@ -67,6 +70,7 @@ class Mesh
 		
 		/** Overloads the [] operator to return the Triangle of the 
 		* index as long as it is a valid value from 0 - mesh.size().
+		* The Triangle refers to the positions of this Mesh.
 		* @return Returns Triangle of index.
 		*/
 		Triangle operator[](const int& index);
@@ -26,11 +26,11 @@ void SHullDelaunay::clear()
 	//for(int i=0; i < (int)edges.size(); i++)
 	//	delete edges[i];
 	edges.clear();
+	startingEdge = NULL;
+	buildCursor = TinCursor();
 
-	//Clear list of Points on Edges
-	for(int i = 0; i < (int)ptPtrs.size(); i++)
-		delete ptPtrs[i];
-	ptPtrs.clear();
+	//Clear the vertices the Edges pointed to
+	verts.clear();
 	
 	if(pL != NULL) // SJZ
 	{
@@ -39,13 +39,80 @@ void SHullDelaunay::clear()
 	}
 }
 
+TinBuildMode SHullDelaunay::defaultBuildMode = SWEEP_GLOBAL_FLIP;
+
 void SHullDelaunay::insert(PointList& pl)
 {
-	Point a1, b2, c3;
 //	pL = &pl;
 	//SHullDelaunay gets its own copy. This is necessary for multi-threading.
 	//If not, every thread will delete the same referenced bathyGrid pointlist, an error.
 	pL = new PointList(pl);
+	offsetX = pL->getOffsetX();
+	offsetY = pL->getOffsetY();
+	totalFlips = 0;
+	buildCursor = TinCursor();
+
+	//Every point plus the 3 outer points. Edges hold pointers into verts
+	//so it must never reallocate while building.
+	verts.clear();
+	verts.reserve(pL->size() + 3);
+
+	triangulate();
+
+	//The vertices now hold everything the queries need
+	delete pL;
+	pL = NULL;
+}
+
+//Builds the triangulation of pL according to buildMode.
+void SHullDelaunay::triangulate()
+{
+	Point a1, b2, c3;
+
+	// 3 outer edge points, these can be skipped in many cases, but help
+	// in the case of sampling whenever some samples can lie outside the hull of the
+	// structure. This will  prevent infinite loops in searching, or bad data samples
+	// along the hull of the structure. Samples within triangles containing these points
+	// should be ignored.
+	Point oe1(0.0, 9999999.0, 0.0);
+	Point oe2(9999999.0, -9999999.0, 0.0);
+	Point oe3(-9999999.0, -9999999.0, 0.0);
+	oe1.hU = 0.0;
+	oe1.vU = 0.0;
+	oe2.hU = 0.0;
+	oe2.vU = 0.0;
+	oe3.hU = 0.0;
+	oe3.vU = 0.0;
+
+	vector<Edge*> flipStack;
+	int i;
+
+	//Insert into the outer triangle in BRIO order if every point fits inside it.
+	//Otherwise fall back to the radial sweep.
+	bool enclosed = (buildMode == BRIO_LOCAL_FLIP && pL->size() > 0);
+	for(i = 0; enclosed && i < pL->size(); i++)
+	{
+		Point p = (*pL)[i];
+		enclosed = ccw(oe3, oe2, p) && ccw(oe2, oe1, p) && ccw(oe1, oe3, p);
+	}
+	if(enclosed)
+	{
+		vector<int> order;
+		brioOrder(order);
+
+		//Walk from the previously inserted point regardless of the query setting
+		bool fromHint = useLocateHint;
+		useLocateHint = true;
+		makeTriangle(oe3, oe2, oe1);
+		for(i = 0; i < (int)order.size(); i++)
+		{
+			insertInterior((*pL)[order[i]], flipStack);
+			legalize(flipStack);
+		}
+		useLocateHint = fromHint;
+		buildCursor = TinCursor();
+		return;
+	}
 
 	//Select Seed - a1
 	//This can be any point, I just pick one in the middle of the list
@@ -67,7 +134,6 @@ void SHullDelaunay::insert(PointList& pl)
 	//Smallest Circle - c3
 	double radius = 0.0;
 	double currentMin = 99999999999.0;
-	int i;
 	for( i = 2; i < pL->size(); i++)
 	{
 		radius = radiusOfCircumCircle(a1, b2, (*pL)[i]);
@@ -79,85 +145,39 @@ void SHullDelaunay::insert(PointList& pl)
 	}
 
 	//init Triangle
-	Point *da, *db, *dc;
-	da = new Point(a1), db = new Point(b2), dc = new Point(c3);
-	ptPtrs.push_back(da);
-	ptPtrs.push_back(db);
-	ptPtrs.push_back(dc);
-
-	Edge* ea = makeEdge(); // Make first edge
-	ea->endPoints(da, db); // Set endpoints of first edge to a and b
-
-	Edge* eb = makeEdge(); // Make second Edge
-	splice(ea->sym(), eb); // Connect first to second edge
-	eb->endPoints(db, dc); // Set endpoints of second edge to b and c
-
-	Edge* ec = makeEdge(); // Make third Edge
-	splice(eb->sym(), ec); // Connect second and third edge
-	ec->endPoints(dc, da);
-	splice(ec->sym(), ea);
-
-	startingEdge = ea;
-
-	// Ensure that my starting hulledge is facing counter-clockwise
-	if(rightOf(*dc, ea))
-		hullEdge = ea->sym();
-	else
-		hullEdge = ea;
-
-	// Add starting edges to edge list
-	edges.push_back(ea);
-	edges.push_back(eb);
-	edges.push_back(ec);
+	makeTriangle(a1, b2, c3);
 
 	//Sort based on distance from center of circumscribed circle formed by a1, b2, and c3
 	Point cp = centerOfCircumCircle(a1, b2, c3);
 	pL->sort(cp);
 
 	//pL->assignID(); //TIN debug
-	// Insert all points building radially from Hull
-	for(int i = 3; i < pL->size(); i++)
-		insert((*pL)[i]);
-
-	// Insert 3 outer edge points, this can be skipped in many cases, but helps
-	// in the case of sampling whenever some samples can lie outside the hull of the
-	// structure. This will  prevent infinite loops in searching, or bad data samples
-	// along the hull of the structure. Samples within triangles containing these points
-	// should be ignored.
-	Point oe1(0.0, 9999999.0, 0.0);
-	Point oe2(9999999.0, -9999999.0, 0.0);
-	Point oe3(-9999999.0, -9999999.0, 0.0);
-	oe1.hU = 0.0;
-	oe1.vU = 0.0;
-	oe2.hU = 0.0;
-	oe2.vU = 0.0;
-	oe3.hU = 0.0;
-	oe3.vU = 0.0;
-	//oe1.e  = 0.0;
-	//oe2.e  = 0.0;
-	//oe3.e  = 0.0;
-	//oe1.nei  = 0.0;
-	//oe2.nei  = 0.0;
-	//oe3.nei  = 0.0;
-	//oe1.rei  = 0.0;
-	//oe2.rei  = 0.0;
-	//oe3.rei  = 0.0;
-	//oe1.z0  = 0.0;
-	//oe2.z0  = 0.0;
-	//oe3.z0  = 0.0;
-	//oe1.e0  = 0.0;
-	//oe2.e0  = 0.0;
-	//oe3.e0  = 0.0;
-	//oe1.zK  = 0.0;
-	//oe2.zK  = 0.0;
-	//oe3.zK  = 0.0;
-	//oe1.eK  = 0.0;
-	//oe2.eK  = 0.0;
-	//oe3.eK  = 0.0;
-
-	insert(oe1);
-	insert(oe2);
-	insert(oe3);
+	// Insert all points building radially from Hull.
+	// Unless the original method was asked for, the edges each point makes
+	// visible are legalized straight away so no global flipping pass is needed.
+	if(buildMode == SWEEP_GLOBAL_FLIP)
+	{
+		for(i = 3; i < pL->size(); i++)
+			insert((*pL)[i]);
+		insert(oe1);
+		insert(oe2);
+		insert(oe3);
+	}
+	else
+	{
+		for(i = 3; i < pL->size(); i++)
+		{
+			insert((*pL)[i], &flipStack);
+			legalize(flipStack);
+		}
+		insert(oe1, &flipStack);
+		legalize(flipStack);
+		insert(oe2, &flipStack);
+		legalize(flipStack);
+		insert(oe3, &flipStack);
+		legalize(flipStack);
+		return;
+	}
 
 	// Perform edge flipping on all edges until no flips occur.
 	//list< Edge * >::iterator it; // SJZ
@@ -205,10 +225,46 @@ void SHullDelaunay::insert(PointList& pl)
 		numFlips = 0;
 		for(it = edges.begin(); it != edges.end(); it++)
 			numFlips += checkEdge(*it);
+		totalFlips += numFlips;
 	}while(numFlips!=0);
 }
 
-void SHullDelaunay::insert(const Point& p)
+//Make the first triangle of the triangulation from three counter-clockwise or clockwise points.
+void SHullDelaunay::makeTriangle(const Point& a, const Point& b, const Point& c)
+{
+	Vertex2d *da, *db, *dc;
+	da = verts.add(a), db = verts.add(b), dc = verts.add(c);
+
+	Edge* ea = makeEdge(); // Make first edge
+	ea->endPoints(da, db); // Set endpoints of first edge to a and b
+
+	Edge* eb = makeEdge(); // Make second Edge
+	splice(ea->sym(), eb); // Connect first to second edge
+	eb->endPoints(db, dc); // Set endpoints of second edge to b and c
+
+	Edge* ec = makeEdge(); // Make third Edge
+	splice(eb->sym(), ec); // Connect second and third edge
+	ec->endPoints(dc, da);
+	splice(ec->sym(), ea);
+
+	startingEdge = ea;
+	buildCursor = TinCursor();
+
+	// Ensure that my starting hulledge is facing counter-clockwise
+	if(rightOf(*dc, ea))
+		hullEdge = ea->sym();
+	else
+		hullEdge = ea;
+
+	// Add starting edges to edge list
+	edges.push_back(ea);
+	edges.push_back(eb);
+	edges.push_back(ec);
+}
+
+//Add a point outside the current hull. When flipStack is given, the hull edges the
+//point can see become interior and are pushed on it to be legalized.
+void SHullDelaunay::insert(const Point& p, vector<Edge*> *flipStack)
 {
 	Edge* temp = hullEdge;
 	// Find first edge in counter-clockwise motion that sees the point.
@@ -228,8 +284,7 @@ void SHullDelaunay::insert(const Point& p)
 	Edge* base = makeEdge();
 	edges.push_back(base);
 
-	Point* pPtr = new Point(p);
-	ptPtrs.push_back(pPtr);
+	Vertex2d* pPtr = verts.add(p);
 	
 	base->endPoints(hullEdge->org(), pPtr);//new Point(p)); //SJZ 12/12/14
 	splice(temp, base);
@@ -240,14 +295,162 @@ void SHullDelaunay::insert(const Point& p)
 	{
 		base = connect(base, hullEdge->sym());
 		edges.push_back(base);
+		if(flipStack != NULL)
+			(*flipStack).push_back(hullEdge);
 		base = base->sym();
 		hullEdge = hullEdge->sym()->oNext()->oNext();
 	}
 }
 
-vector<Point> SHullDelaunay::determinePingLocationInTriangle(PointList& pl, const double& sH, const double& alpha, const double& deltaMin, GradientGrid& grads, vector<Triangle>& triangles, string depthInterpMethod, string uncertInterpMethod, string extrapMethod)
+//Add a point inside the current triangulation by splitting the triangle containing it.
+//The edges of that triangle are pushed on flipStack to be legalized.
+void SHullDelaunay::insertInterior(const Point& p, vector<Edge*>& flipStack)
+{
+	//A. Find the triangle. Duplicates of existing vertices are skipped.
+	Edge* e = locate(p, buildCursor);
+	Edge* t[3] = { e, e->lNext(), e->lNext()->lNext() };
+	if(t[0]->org2d().eq2d(p) || t[1]->org2d().eq2d(p) || t[2]->org2d().eq2d(p))
+		return;
+
+	//B. Points exactly on an edge leave a flat triangle that is removed by flipping that edge below
+	Edge* onEdge = NULL;
+	for(int j = 0; j < 3 && onEdge == NULL; j++)
+		if(triArea(t[j]->org2d(), t[j]->dest2d(), p) == 0)
+			onEdge = t[j];
+
+	//C. Connect the point to the three corners
+	Vertex2d* pPtr = verts.add(p);
+
+	Edge* first = makeEdge();
+	edges.push_back(first);
+	first->endPoints(e->org(), pPtr);
+	splice(first, e);
+	Edge* base = first;
+	do
+	{
+		base = connect(e, base->sym());
+		edges.push_back(base);
+		e = base->oPrev();
+	}while(e->lNext() != first);
+	buildCursor.hint = first;
+
+	if(onEdge != NULL && onEdge->sym()->lNext()->lNext()->lNext() == onEdge->sym())
+	{
+		flipStack.push_back(onEdge->sym()->lNext());
+		flipStack.push_back(onEdge->sym()->lPrev());
+		swap(onEdge);
+		totalFlips++;
+	}
+	for(int j = 0; j < 3; j++)
+		flipStack.push_back(t[j]);
+}
+
+//Lawson flipping. An edge is flipped when the apex of the triangle on its left lies
+//inside the circumcircle of the triangle on its right, and the four outer edges of the
+//flipped quadrilateral are pushed to be checked in turn. Hull edges are never flipped.
+void SHullDelaunay::legalize(vector<Edge*>& flipStack)
+{
+	Edge *e, *l, *r;
+	//Guards against cycling on nearly cocircular points
+	long flipLimit = (long)edges.size() + 100;
+	long flips = 0;
+
+	while(!flipStack.empty())
+	{
+		e = flipStack.back();
+		flipStack.pop_back();
+
+		//Both faces have to be triangles on the correct sides of e
+		l = e->lNext();
+		r = e->sym()->lNext();
+		if(l->lNext()->lNext() != e || r->lNext()->lNext() != e->sym())
+			continue;
+		if(!LeftOf(l->dest2d(), e) || !rightOf(r->dest2d(), e))
+			continue;
+		if(inCircle(e->org2d(), r->dest2d(), e->dest2d(), l->dest2d()) != 1)
+			continue;
+
+		flipStack.push_back(l);
+		flipStack.push_back(l->lNext());
+		flipStack.push_back(r);
+		flipStack.push_back(r->lNext());
+		swap(e);
+		totalFlips++;
+		if(++flips > flipLimit)
+		{
+			flipStack.clear();
+			break;
+		}
+	}
+}
+
+//Biased randomized insertion order: every point is put in the last round with probability 1/2,
+//the one before it with probability 1/4 and so on, and each round is visited in Hilbert curve order
+//so consecutive insertions are close together and the locate walk from the previous point is short.
+void SHullDelaunay::brioOrder(vector<int>& order)
+{
+	int n = pL->size();
+	const unsigned int side = 65536;
+
+	//A. Extent of the data
+	double xmin = (*pL)[0].x, xmax = xmin, ymin = (*pL)[0].y, ymax = ymin;
+	for(int i = 1; i < n; i++)
+	{
+		Point p = (*pL)[i];
+		xmin = min(xmin, p.x); xmax = max(xmax, p.x);
+		ymin = min(ymin, p.y); ymax = max(ymax, p.y);
+	}
+	double scale = (side - 1) / max(max(xmax - xmin, ymax - ymin), 1e-12);
+
+	//B. Round and Hilbert index of each point. A fixed seed keeps the triangulation repeatable.
+	vector< pair<unsigned long long, int> > keys(n);
+	unsigned int seed = 12345;
+	for(int i = 0; i < n; i++)
+	{
+		Point p = (*pL)[i];
+		unsigned int x = (unsigned int)((p.x - xmin) * scale);
+		unsigned int y = (unsigned int)((p.y - ymin) * scale);
+		unsigned long long d = 0;
+		for(unsigned int s = side / 2; s > 0; s /= 2)
+		{
+			unsigned int rx = (x & s) > 0;
+			unsigned int ry = (y & s) > 0;
+			d += (unsigned long long)s * s * ((3 * rx) ^ ry);
+			if(ry == 0)
+			{
+				if(rx == 1)
+				{
+					x = side - 1 - x;
+					y = side - 1 - y;
+				}
+				unsigned int tmp = x; x = y; y = tmp;
+			}
+		}
+
+		seed = seed * 1103515245 + 12345;
+		unsigned int bits = seed >> 8;
+		unsigned long long round = 24;
+		while(round > 0 && (bits & 1))
+		{
+			round--;
+			bits >>= 1;
+		}
+		keys[i] = make_pair((round << 32) | d, i);
+	}
+
+	//C. Sort by round, then by position along the curve
+	sort(keys.begin(), keys.end());
+	order.resize(n);
+	for(int i = 0; i < n; i++)
+		order[i] = keys[i].second;
+}
+
+vector<Point> SHullDelaunay::determinePingLocationInTriangle(PointList& pl, const double& sH, const double& alpha, const double& deltaMin, GradientGrid& grads, vector<Triangle>& triangles, string depthInterpMethod, string uncertInterpMethod, string extrapMethod, TinCursor *cursor)
 {
 	vector<Point> pos = vector<Point>(pl.size());
+	//Walk state of this call.  Threads sharing the triangulation each bring their own.
+	TinCursor callCursor;
+	TinCursor& walk = (cursor != NULL) ? *cursor : callCursor;
 
 	Point* recomputedPoint;
 	Triangle tri;
@@ -275,13 +478,13 @@ vector<Point> SHullDelaunay::determinePingLocationInTriangle(PointList& pl, cons
 			if(depthInterpMethod == "NN"){
 				//Nearest Neighbor Interpolation
 				//Find 3 nearest neighbors
-				tri = locateNearestNeighbor(pl[i], extrapMethod);
+				tri = locateNearestNeighbor(pl[i], extrapMethod, walk);
 			}
 			else{
 				//BILINEAR Interpolation
 				//Find encompassing tri and replace
 				//invalid points with nearest neighbors
-				tri = locateNearestNeighborTri(pl[i], extrapMethod);
+				tri = locateNearestNeighborTri(pl[i], extrapMethod, walk);
 			}
 
 			triangles.push_back(tri);
@@ -356,13 +559,13 @@ vector<Point> SHullDelaunay::determinePingLocationInTriangle(PointList& pl, cons
 			if(depthInterpMethod == "NN"){
 				//Nearest Neighbor Interpolation
 				//Find 3 nearest neighbors of all points.
-				tri = locateNearestNeighbor(pl[i], extrapMethod);
+				tri = locateNearestNeighbor(pl[i], extrapMethod, walk);
 			}
 			else{
 				//3 DT NN with Bilinear for Depth and with IDW for Uncertainty
 				//Find encompassing triangle and replace
 				//invalid points with nearest neighbors
-				tri = locateNearestNeighborTri(pl[i], extrapMethod);
+				tri = locateNearestNeighborTri(pl[i], extrapMethod, walk);
 			}
 			triangles.push_back(tri);
 		}
@@ -387,6 +590,7 @@ vector<Point> SHullDelaunay::determinePingLocationInTriangle(PointList& pl, cons
 Point* SHullDelaunay::computeDepth(const Point& p, const Triangle& t, const double& sH, const double& alpha, const double& deltaMin, string interpMethod)
 {
 	Point *computedPing = new Point();
+	Point v1 = t.vertex(1), v2 = t.vertex(2), v3 = t.vertex(3);
 
 	double z, e = 0;
 	double nei = 0;
@@ -419,47 +623,47 @@ Point* SHullDelaunay::computeDepth(const Point& p, const Triangle& t, const doub
 	int p1Flag=0;
 	int p2Flag=0;
 	int p3Flag=0;
-	if((t.v1==oe1 || t.v1==oe2) || t.v1==oe3)
+	if((v1==oe1 || v1==oe2) || v1==oe3)
 		p1Flag=1;
-	if((t.v2==oe1 || t.v2==oe2) || t.v2==oe3)
+	if((v2==oe1 || v2==oe2) || v2==oe3)
 		p2Flag=1;
-	if((t.v3==oe1 || t.v3==oe2) || t.v3==oe3)
+	if((v3==oe1 || v3==oe2) || v3==oe3)
 		p3Flag=1;
 
 	//See if p is at an vertex.
 	//If we are then its an exact interpolation.
-	if(p.x == t.v1.x && p.y == t.v1.y)
+	if(p.x == v1.x && p.y == v1.y)
 	{
-		z = t.v1.z;
+		z = v1.z;
 		//Raster output uses only bilinear so these are only here for that
-		nei = t.v1.nei;
-		rei = t.v1.rei;
-		z0	= t.v1.z0;
-		e0	= t.v1.e0;
-		zK	= t.v1.zK;
-		eK	= t.v1.eK;
+		nei = v1.nei;
+		rei = v1.rei;
+		z0	= v1.z0;
+		e0	= v1.e0;
+		zK	= v1.zK;
+		eK	= v1.eK;
 	}
-	else if(p.x == t.v2.x && p.y == t.v2.y) 
+	else if(p.x == v2.x && p.y == v2.y) 
 	{
-		z = t.v2.z;
+		z = v2.z;
 		//Raster output uses only bilinear so these are only here for that
-		nei = t.v2.nei;
-		rei = t.v2.rei;
-		z0	= t.v2.z0;
-		e0	= t.v2.e0;
-		zK	= t.v2.zK;
-		eK	= t.v2.eK;
+		nei = v2.nei;
+		rei = v2.rei;
+		z0	= v2.z0;
+		e0	= v2.e0;
+		zK	= v2.zK;
+		eK	= v2.eK;
 	}
-	else if(p.x == t.v3.x && p.y == t.v3.y)
+	else if(p.x == v3.x && p.y == v3.y)
 	{
-		z = t.v3.z;
+		z = v3.z;
 		//Raster output uses only bilinear so these are only here for that
-		nei = t.v3.nei;
-		rei = t.v3.rei;
-		z0	= t.v3.z0;
-		e0	= t.v3.e0;
-		zK	= t.v3.zK;
-		eK	= t.v3.eK;
+		nei = v3.nei;
+		rei = v3.rei;
+		z0	= v3.z0;
+		e0	= v3.e0;
+		zK	= v3.zK;
+		eK	= v3.eK;
 	}
 	//Nearest Neighbor interpolation for depth z
 	//Find the Nearest Neighbor of the 3 NN
@@ -469,24 +673,24 @@ Point* SHullDelaunay::computeDepth(const Point& p, const Triangle& t, const doub
 			z	= (double)NaN;
 		else
 		{
-			double distv1 = sqrt(t.v1.distance2d(p));
-			double distv2 = sqrt(t.v2.distance2d(p));
-			double distv3 = sqrt(t.v3.distance2d(p));
+			double distv1 = sqrt(v1.distance2d(p));
+			double distv2 = sqrt(v2.distance2d(p));
+			double distv3 = sqrt(v3.distance2d(p));
 
 			if(distv1 <= distv2 && distv1 <= distv3)
 			{
 				nn = 1;
-				z = t.v1.z;
+				z = v1.z;
 			}
 			else if(distv2 <= distv3)
 			{
 				nn = 2;
-				z = t.v2.z;
+				z = v2.z;
 			}
 			else
 			{
 				nn = 3;
-				z = t.v3.z;
+				z = v3.z;
 			}
 		}
 	}
@@ -508,48 +712,48 @@ Point* SHullDelaunay::computeDepth(const Point& p, const Triangle& t, const doub
 		}
 		else
 		{ //bilinear interpolation
-			double x1 = t.v1.x;
-			double x2 = t.v2.x;
-			double x3 = t.v3.x;
+			double x1 = v1.x;
+			double x2 = v2.x;
+			double x3 = v3.x;
 		
-			double y1 = t.v1.y;
-			double y2 = t.v2.y;
-			double y3 = t.v3.y;
+			double y1 = v1.y;
+			double y2 = v2.y;
+			double y3 = v3.y;
 		
 			//depths
-			double w1 = t.v1.z;
-			double w2 = t.v2.z;
-			double w3 = t.v3.z;
+			double w1 = v1.z;
+			double w2 = v2.z;
+			double w3 = v3.z;
 		
 			//error
-			double w1_e = t.v1.u;
-			double w2_e = t.v2.u;
-			double w3_e = t.v3.u;
+			double w1_e = v1.u;
+			double w2_e = v2.u;
+			double w3_e = v3.u;
 		
-			//double w1_e = t.v1.e;
-			//double w2_e = t.v2.e;
-			//double w3_e = t.v3.e;
-
-			double w1_nei = t.v1.nei;
-			double w2_nei = t.v2.nei;
-			double w3_nei = t.v3.nei;
-			double w1_rei = t.v1.rei;
-			double w2_rei = t.v2.rei;
-			double w3_rei = t.v3.rei;
+			//double w1_e = v1.e;
+			//double w2_e = v2.e;
+			//double w3_e = v3.e;
+
+			double w1_nei = v1.nei;
+			double w2_nei = v2.nei;
+			double w3_nei = v3.nei;
+			double w1_rei = v1.rei;
+			double w2_rei = v2.rei;
+			double w3_rei = v3.rei;
 		
-			double w1_z0 = t.v1.z0;
-			double w2_z0 = t.v2.z0;
-			double w3_z0 = t.v3.z0;
-			double w1_e0 = t.v1.e0;
-			double w2_e0 = t.v2.e0;
-			double w3_e0 = t.v3.e0;
-
-			double w1_zK = t.v1.zK;
-			double w2_zK = t.v2.zK;
-			double w3_zK = t.v3.zK;
-			double w1_eK = t.v1.eK;
-			double w2_eK = t.v2.eK;
-			double w3_eK = t.v3.eK;
+			double w1_z0 = v1.z0;
+			double w2_z0 = v2.z0;
+			double w3_z0 = v3.z0;
+			double w1_e0 = v1.e0;
+			double w2_e0 = v2.e0;
+			double w3_e0 = v3.e0;
+
+			double w1_zK = v1.zK;
+			double w2_zK = v2.zK;
+			double w3_zK = v3.zK;
+			double w1_eK = v1.eK;
+			double w2_eK = v2.eK;
+			double w3_eK = v3.eK;
 
 			//Query point
 			double x = p.x;
@@ -605,54 +809,55 @@ Point* SHullDelaunay::computeNearestNeighborWeights(const Point& p, const Triang
 {
 	Point *computedPing = new Point();
 	double sigma=0,sigma2=0,sigma3=0,sigma4=0,sigma5=0;
+	Point v1 = t.vertex(1), v2 = t.vertex(2), v3 = t.vertex(3);
 
-	//if(p == t.v1)
-	//	sigma = t.v1.e;	
-	//else if(p == t.v2)
-	//	sigma = t.v2.e;	
-	//else if(p == t.v3)
-	//	sigma = t.v3.e;	
+	//if(p == v1)
+	//	sigma = v1.e;	
+	//else if(p == v2)
+	//	sigma = v2.e;	
+	//else if(p == v3)
+	//	sigma = v3.e;	
 
-	double minNodeSpacing = min(t.v1.distance2d(t.v2),t.v2.distance2d(t.v3));
-	minNodeSpacing = min(minNodeSpacing, t.v3.distance2d(t.v1));
+	double minNodeSpacing = min(v1.distance2d(v2),v2.distance2d(v3));
+	minNodeSpacing = min(minNodeSpacing, v3.distance2d(v1));
 
-	double distv1 = sqrt(t.v1.distance2d(p));
-	double distv2 = sqrt(t.v2.distance2d(p));
-	double distv3 = sqrt(t.v3.distance2d(p));
+	double distv1 = sqrt(v1.distance2d(p));
+	double distv2 = sqrt(v2.distance2d(p));
+	double distv3 = sqrt(v3.distance2d(p));
 	double slopeP = tan((PI/180.0)*slope);
 
 	//These numbers match equations in a MATLAB function Paul' developed.
 	//1.Regular inverse weighted distance
-	double weightN1_C1 = pow(t.v1.vU,2) * (1.00 + pow( (distv1 + sH*t.v1.hU) / deltaMin, alpha) );
-	double weightN2_C1 = pow(t.v2.vU,2) * (1.00 + pow( (distv2 + sH*t.v2.hU) / deltaMin, alpha) );
-	double weightN3_C1 = pow(t.v3.vU,2) * (1.00 + pow( (distv3 + sH*t.v3.hU) / deltaMin, alpha) );
+	double weightN1_C1 = pow(v1.vU,2) * (1.00 + pow( (distv1 + sH*v1.hU) / deltaMin, alpha) );
+	double weightN2_C1 = pow(v2.vU,2) * (1.00 + pow( (distv2 + sH*v2.hU) / deltaMin, alpha) );
+	double weightN3_C1 = pow(v3.vU,2) * (1.00 + pow( (distv3 + sH*v3.hU) / deltaMin, alpha) );
 
 	//3.Regular inverse weighted distance
-	double weightN1_C3 = pow(t.v1.vU,2) + pow(slopeP*sH*t.v1.hU,alpha);
-	double weightN2_C3 = pow(t.v2.vU,2) + pow(slopeP*sH*t.v2.hU,alpha);
-	double weightN3_C3 = pow(t.v3.vU,2) + pow(slopeP*sH*t.v3.hU,alpha);
+	double weightN1_C3 = pow(v1.vU,2) + pow(slopeP*sH*v1.hU,alpha);
+	double weightN2_C3 = pow(v2.vU,2) + pow(slopeP*sH*v2.hU,alpha);
+	double weightN3_C3 = pow(v3.vU,2) + pow(slopeP*sH*v3.hU,alpha);
 
 	//2.Regular inverse weighted distance
- 	double weightN1_C2 = pow(t.v1.vU,2) * (1.00 + pow( (distv1 + slopeP*sH*t.v1.hU) / deltaMin, alpha) );
-	double weightN2_C2 = pow(t.v2.vU,2) * (1.00 + pow( (distv2 + slopeP*sH*t.v2.hU) / deltaMin, alpha) );
-	double weightN3_C2 = pow(t.v3.vU,2) * (1.00 + pow( (distv3 + slopeP*sH*t.v3.hU) / deltaMin, alpha) );
+ 	double weightN1_C2 = pow(v1.vU,2) * (1.00 + pow( (distv1 + slopeP*sH*v1.hU) / deltaMin, alpha) );
+	double weightN2_C2 = pow(v2.vU,2) * (1.00 + pow( (distv2 + slopeP*sH*v2.hU) / deltaMin, alpha) );
+	double weightN3_C2 = pow(v3.vU,2) * (1.00 + pow( (distv3 + slopeP*sH*v3.hU) / deltaMin, alpha) );
 
 	//4.Regular inverse weighted distance
-	double weightN1_C4 = weightN1_C1 + pow(slopeP*sH*t.v1.hU, alpha);
-	double weightN2_C4 = weightN2_C1 + pow(slopeP*sH*t.v2.hU, alpha);
-	double weightN3_C4 = weightN3_C1 + pow(slopeP*sH*t.v3.hU, alpha);
+	double weightN1_C4 = weightN1_C1 + pow(slopeP*sH*v1.hU, alpha);
+	double weightN2_C4 = weightN2_C1 + pow(slopeP*sH*v2.hU, alpha);
+	double weightN3_C4 = weightN3_C1 + pow(slopeP*sH*v3.hU, alpha);
 
 	//5.Regular inverse weighted distance if iDW then needs to move down and sqr
-	double weightN1_C5 = weightN1_C2 + pow(slopeP*sH*t.v1.hU, alpha);
-	double weightN2_C5 = weightN2_C2 + pow(slopeP*sH*t.v2.hU, alpha);
-	double weightN3_C5 = weightN3_C2 + pow(slopeP*sH*t.v3.hU, alpha);
+	double weightN1_C5 = weightN1_C2 + pow(slopeP*sH*v1.hU, alpha);
+	double weightN2_C5 = weightN2_C2 + pow(slopeP*sH*v2.hU, alpha);
+	double weightN3_C5 = weightN3_C2 + pow(slopeP*sH*v3.hU, alpha);
 
 	int nn = 0;
 	////Find NN
 	////Comment out for IDW. 
 	////To test the function comment in distv1 ifelses and comment out the other.
 	////if(distv1<=distv2 && distv1<=distv3) 
-	//if(p == t.v1)
+	//if(p == v1)
 	//{
 	//	nn = 1;
 	//	sigma= sqrt(weightN1_C1);
@@ -662,7 +867,7 @@ Point* SHullDelaunay::computeNearestNeighborWeights(const Point& p, const Triang
 	//	sigma5= sqrt(weightN1_C5);
 	//}
 	////else if(distv2<=distv3)
-	//else if(p == t.v2)
+	//else if(p == v2)
 	//{
 	//	nn = 2;
 	//	sigma= sqrt(weightN2_C1);
@@ -672,7 +877,7 @@ Point* SHullDelaunay::computeNearestNeighborWeights(const Point& p, const Triang
 	//	sigma5= sqrt(weightN2_C5);
 	//}
 	////else
-	//else if(p == t.v3)
+	//else if(p == v3)
 	//{
 	//	nn = 3;
 	//	sigma= sqrt(weightN3_C1);
@@ -681,7 +886,7 @@ Point* SHullDelaunay::computeNearestNeighborWeights(const Point& p, const Triang
 	//	sigma4= sqrt(weightN3_C4);
 	//	sigma5= sqrt(weightN3_C5);
 	//}//Comment out for IDW
-	////if((p != t.v1 && p != t.v2) && p !=  t.v3)
+	////if((p != v1 && p != v2) && p !=  v3)
 	//else
 	{
 		//Added to handle division by 0.  
@@ -763,14 +968,15 @@ Point* SHullDelaunay::computeNearestNeighborWeights(const Point& p, const Triang
 
 // Finds the 3 points closest to my query point p regardless
 // if they are a vertex of the encompassing triangle.
-Triangle SHullDelaunay::locateNearestNeighbor(const Point& p, string extrapMethod)
+Triangle SHullDelaunay::locateNearestNeighbor(const Point& p, string extrapMethod, TinCursor& cursor)
 {
 	if(extrapMethod == "none")//Raster
 	{
 		//Find which triangle p is in first to see if it lies 
 		//outside the convex hull.  If it does we return 
 		//since we don't want to extrapolate.
-		Triangle t = locateNearestNeighborTri(p, extrapMethod);
+		Triangle t = locateNearestNeighborTri(p, extrapMethod, cursor);
+		Point v1 = t.vertex(1), v2 = t.vertex(2), v3 = t.vertex(3);
 				
 		// Invalid Outside Boundary Points
 		Point oe1(0.0, 9999999.0, 0.0);
@@ -783,11 +989,11 @@ Triangle SHullDelaunay::locateNearestNeighbor(const Point& p, string extrapMetho
 		int p1Flag=0;
 		int p2Flag=0;
 		int p3Flag=0;
-		if((t.v1==oe1 || t.v1==oe2) || t.v1==oe3)
+		if((v1==oe1 || v1==oe2) || v1==oe3)
 			p1Flag=1;
-		if((t.v2==oe1 || t.v2==oe2) || t.v2==oe3)
+		if((v2==oe1 || v2==oe2) || v2==oe3)
 			p2Flag=1;
-		if((t.v3==oe1 || t.v3==oe2) || t.v3==oe3)
+		if((v3==oe1 || v3==oe2) || v3==oe3)
 			p3Flag=1;
 
 		//Return if we are outside the hull
@@ -796,7 +1002,7 @@ Triangle SHullDelaunay::locateNearestNeighbor(const Point& p, string extrapMetho
 	}
 
 	//Find 3 nearest neighbors of all points
-	vector<Edge*> e = locate3NN(p);
+	vector<Edge*> e = locate3NN(p, cursor);
 	Triangle t;
 
 	if(e[0]->id == -1)
@@ -806,11 +1012,11 @@ Triangle SHullDelaunay::locateNearestNeighbor(const Point& p, string extrapMetho
 	}
 
 	Point p1, p2, p3;
-	p1 = e[0]->org2d();
-	p2 = e[0]->dest2d();
-	p3 = e[1]->dest2d();
+	p1 = vertexOf(e[0]->org2d());
+	p2 = vertexOf(e[0]->dest2d());
+	p3 = vertexOf(e[1]->dest2d());
 
-	t = Triangle(p1, p2, p3);
+	t = Triangle(&verts, (int)p1.id, (int)p2.id, (int)p3.id);
 	return t;
 }
 
@@ -823,12 +1029,12 @@ Triangle SHullDelaunay::locateNearestNeighbor(const Point& p, string extrapMetho
 // Point oe1(0.0, 9999999.0, 0.0);
 // Point oe2(9999999.0, -9999999.0, 0.0);
 // Point oe3(-9999999.0, -9999999.0, 0.0);
-Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMethod)
+Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMethod, TinCursor& cursor)
 {
 	int PRINT_WARNINGS = 0; //degenerate cases?
 	int printDebugFlag = 0;
 	//Find triangle containing p
-	Edge* e = locate(p);
+	Edge* e = locate(p, cursor);
 	Triangle t;
 
 	if(e->id == -1)
@@ -838,16 +1044,16 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 	}
 
 	Point p1, p2, p3;
-	p1 = e->org2d();
-	p2 = e->dest2d();
-	p3 = e->oNext()->dest2d();
+	p1 = vertexOf(e->org2d());
+	p2 = vertexOf(e->dest2d());
+	p3 = vertexOf(e->oNext()->dest2d());
 
 	//We don't need to replace invalid points
 	//because we don't want to extrapolate.
 	//Since the point lies outside the convex hull
 	if(extrapMethod == "none") //Raster
 	{
-		t = Triangle(p1, p2, p3);
+		t = Triangle(&verts, (int)p1.id, (int)p2.id, (int)p3.id);
 		return t;
 	}
 
@@ -880,10 +1086,10 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 		Edge* e2 = e->sym()->oPrev();		//get edge containing valid pt p2 and p3
 
 		//I. Replace invalid point with query point's nearest neighbor if it is not already one of the valid points
-		vector<Edge*> en = locate3NN(p);
-		Point p1n = en[0]->org2d();
-		Point p2n = en[0]->dest2d();
-		Point p3n = en[1]->dest2d();
+		vector<Edge*> en = locate3NN(p, cursor);
+		Point p1n = vertexOf(en[0]->org2d());
+		Point p2n = vertexOf(en[0]->dest2d());
+		Point p3n = vertexOf(en[1]->dest2d());
 		vector<Point> nntemp;
 		nntemp.push_back(p1n);
 		nntemp.push_back(p2n);
@@ -988,10 +1194,10 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 		Edge* e2 = e->sym()->oPrev();		//get edge containing valid pt p2 and p3
 
 		//I. Replace invalid point with query point's nearest neighbor if it is not already one of the valid points
-		vector<Edge*> en = locate3NN(p);
-		Point p1n = en[0]->org2d();
-		Point p2n = en[0]->dest2d();
-		Point p3n = en[1]->dest2d();
+		vector<Edge*> en = locate3NN(p, cursor);
+		Point p1n = vertexOf(en[0]->org2d());
+		Point p2n = vertexOf(en[0]->dest2d());
+		Point p3n = vertexOf(en[1]->dest2d());
 		vector<Point> nntemp;
 		nntemp.push_back(p1n);
 		nntemp.push_back(p2n);
@@ -1096,10 +1302,10 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 		Edge* e2 = e->sym()->oPrev();		//get edge containing valid pt p2 and p3
 
 		//I. Replace invalid point with query point's nearest neighbor if it is not already one of the valid points
-		vector<Edge*> en = locate3NN(p);
-		Point p1n = en[0]->org2d();
-		Point p2n = en[0]->dest2d();
-		Point p3n = en[1]->dest2d();
+		vector<Edge*> en = locate3NN(p, cursor);
+		Point p1n = vertexOf(en[0]->org2d());
+		Point p2n = vertexOf(en[0]->dest2d());
+		Point p3n = vertexOf(en[1]->dest2d());
 		vector<Point> nntemp;
 		nntemp.push_back(p1n);
 		nntemp.push_back(p2n);
@@ -1204,10 +1410,10 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 		Edge* e2 = e->sym()->oPrev();		//get edge containing valid pt p2 and p3
 
 		//I. Replace invalid point with query point's nearest neighbor if it is not already one of the valid points
-		vector<Edge*> en = locate3NN(p);
-		Point p1n = en[0]->org2d();
-		Point p2n = en[0]->dest2d();
-		Point p3n = en[1]->dest2d();
+		vector<Edge*> en = locate3NN(p, cursor);
+		Point p1n = vertexOf(en[0]->org2d());
+		Point p2n = vertexOf(en[0]->dest2d());
+		Point p3n = vertexOf(en[1]->dest2d());
 		vector<Point> nntemp;
 		nntemp.push_back(p1n);
 		nntemp.push_back(p2n);
@@ -1289,10 +1495,10 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 		Edge* e2 = e->sym()->oPrev();		//get edge containing valid pt p2 and p3
 
 		//I. Replace invalid point with query point's nearest neighbor if it is not already one of the valid points
-		vector<Edge*> en = locate3NN(p);
-		Point p1n = en[0]->org2d();
-		Point p2n = en[0]->dest2d();
-		Point p3n = en[1]->dest2d();
+		vector<Edge*> en = locate3NN(p, cursor);
+		Point p1n = vertexOf(en[0]->org2d());
+		Point p2n = vertexOf(en[0]->dest2d());
+		Point p3n = vertexOf(en[1]->dest2d());
 		vector<Point> nntemp;
 		nntemp.push_back(p1n);
 		nntemp.push_back(p2n);
@@ -1374,10 +1580,10 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 		Edge* e2 = e->sym()->oPrev();		//get edge containing valid pt p2 and p3
 
 		//I. Replace invalid point with query point's nearest neighbor if it is not already one of the valid points
-		vector<Edge*> en = locate3NN(p);
-		Point p1n = en[0]->org2d();
-		Point p2n = en[0]->dest2d();
-		Point p3n = en[1]->dest2d();
+		vector<Edge*> en = locate3NN(p, cursor);
+		Point p1n = vertexOf(en[0]->org2d());
+		Point p2n = vertexOf(en[0]->dest2d());
+		Point p3n = vertexOf(en[1]->dest2d());
 		vector<Point> nntemp;
 		nntemp.push_back(p1n);
 		nntemp.push_back(p2n);
@@ -1468,7 +1674,7 @@ Triangle SHullDelaunay::locateNearestNeighborTri(const Point& p, string extrapMe
 	}
 	#pragma endregion None Invalid
 
-	t = Triangle(p1, p2, p3);
+	t = Triangle(&verts, (int)p1.id, (int)p2.id, (int)p3.id);
 	return t;
 }
 
@@ -1498,9 +1704,9 @@ Edge* SHullDelaunay::nearestDestnTri2P (Edge* e, const Point& p, Point& pn)
 			distance3 = p.distance2d(uOld->dNext()->org2d());	//get next ccw edge around dest
 
 			if(distance2 < distance3)
-				pn = uOld->dPrev()->org2d();
+				pn = vertexOf(uOld->dPrev()->org2d());
 			else
-				pn = uOld->dNext()->org2d();
+				pn = vertexOf(uOld->dNext()->org2d());
 			return uOld;		//we've checked all our edges on the pivot
 		}
 		if(distance < distanceOld)
@@ -1553,24 +1759,34 @@ int SHullDelaunay::checkEdge( Edge* e)
 
 bool SHullDelaunay::pointOnSurface(const Point& p)
 {
-	Edge* temp = hullEdge;
-	while(!rightOf(p, hullEdge))
+	//Walk a copy so lookups leave hullEdge alone.
+	Edge* e = hullEdge;
+	while(!rightOf(p, e))
 	{
-		hullEdge = hullEdge->sym()->oNext();
-		if(temp == hullEdge) return true;
+		e = e->sym()->oNext();
+		if(e == hullEdge) return true;
 	}
 	return false;
 }
 
+//Edge to start a point location walk from. Consecutive queries are
+//usually neighbors, so the last located edge is only a few triangles away.
+Edge* SHullDelaunay::walkStart(const TinCursor& cursor)
+{
+	if (useLocateHint && cursor.hint != NULL)
+		return cursor.hint;
+	return startingEdge;
+}
+
 //Original Locate to find containing triangle
-Edge* SHullDelaunay::locate(const Point& p)
+Edge* SHullDelaunay::locate(const Point& p, TinCursor& cursor)
 {
-	Edge* e = startingEdge;
+	Edge* e = walkStart(cursor);
 	int i = 0;
 	while (TRUE)
 	{
 		if (e->org2d().eq2d(p) || e->dest2d().eq2d(p))
-			return e;
+			break;
 		else if (rightOf(p, e))
 			e = e->sym();
 		else if (!rightOf(p, e->oNext()))
@@ -1578,29 +1794,34 @@ Edge* SHullDelaunay::locate(const Point& p)
 		else if (!rightOf(p, e->dPrev()))
 			e = e->dPrev();
 		else
-			return e;
+			break;
 
 		// This is bad, but I need to solve some floating point errors before I can get rid of it.
 		if(i++ > 2000000)
-			return e;
+			break;
 	}
+	cursor.walkSteps += i;
+	cursor.hint = e;
+	return e;
 }
 
 //This function is used by locateNearestNeighbor
 //Start by finding the containing triangle
 //because it the quickest path  to get to the nearest neighbors
-vector<Edge*> SHullDelaunay::locate3NN(const Point& p)
+vector<Edge*> SHullDelaunay::locate3NN(const Point& p, TinCursor& cursor)
 {
 	Edge* e3=NULL;
 	vector< Edge * >::iterator ite;
-	Edge* e = startingEdge;
+	Edge* e = walkStart(cursor);
 	Edge* u=NULL;
-	Edge* oNextLoop=startingEdge;
+	Edge* oNextLoop=e;
 	double distance=0;
 	double i = 0;
 
 	while (TRUE)
 	{
+		cursor.walkSteps++;
+		cursor.hint = e;
 		if (e->org2d().eq2d(p) || e->dest2d().eq2d(p))
 		{
 			//If p is a vertex on our starting edge
@@ -1762,7 +1983,11 @@ vector<Edge*> SHullDelaunay::findNearest3(const Point& p, Edge* e, Edge* e3, dou
 Mesh* SHullDelaunay::getMesh()
 {
 	Mesh *m = new Mesh();//where is this getting deleted?
-	m->insertPoints(*pL);
+	vector<Point> pts;
+	pts.reserve(verts.size());
+	for(int i = 0; i < verts.size(); i++)
+		pts.push_back(verts.point(i));
+	m->insertPoints(pts);
 
 	Triangle t;
 	Point p1, p2, p3;
@@ -1775,20 +2000,20 @@ Mesh* SHullDelaunay::getMesh()
 	{
 		if(!rightOf((*ite)->oNext()->dest2d(), (*ite)))
 		{
-			p1 = (*ite)->org2d();
-			p2 = (*ite)->dest2d();
-			p3 = (*ite)->oNext()->dest2d();
-			t.set(p1, p2, p3);
+			p1 = vertexOf((*ite)->org2d());
+			p2 = vertexOf((*ite)->dest2d());
+			p3 = vertexOf((*ite)->oNext()->dest2d());
+			t.set(&verts, (int)p1.id, (int)p2.id, (int)p3.id);
 			//t.set(p1, p3, p2);
 			tri.push_back(t);
 		}
 
 		if(rightOf((*ite)->oPrev()->dest2d(), (*ite)))
 		{
-			p1 = (*ite)->org2d();
-			p2 = (*ite)->oPrev()->dest2d();
-			p3 = (*ite)->dest2d();
-			t.set(p1, p2, p3);
+			p1 = vertexOf((*ite)->org2d());
+			p2 = vertexOf((*ite)->oPrev()->dest2d());
+			p3 = vertexOf((*ite)->dest2d());
+			t.set(&verts, (int)p1.id, (int)p2.id, (int)p3.id);
 			//t.set(p1, p3, p2);
 			tri.push_back(t);
 		}
@@ -1806,20 +2031,21 @@ Mesh* SHullDelaunay::getMesh()
 double SHullDelaunay::sample(const Point& p)
 {
 	Edge* e;
+	TinCursor cursor;
 	if(pointOnSurface(p))
-		e = locate(p);
+		e = locate(p, cursor);
 	else
 		return 0;
 
 	if ((e->org2d()).eq2d(p))
-		return (e->org2d()).z;
+		return verts.z[verts.idOf(e->org())];
 	if ((e->dest2d().eq2d(p))) // point is already in
-		return (e->dest2d()).z;
+		return verts.z[verts.idOf(e->dest())];
 
 	Point p1, p2, p3;
-	p1 = e->org2d();
-	p2 = e->dest2d();
-	p3 = e->oNext()->dest2d();
+	p1 = vertexOf(e->org2d());
+	p2 = vertexOf(e->dest2d());
+	p3 = vertexOf(e->oNext()->dest2d());
 
 	return samplePlane(p, p1, p2, p3);
 }
@@ -8,26 +8,59 @@
 #include <string>
 #include <cstring> //UNIX
 
+/** How SHullDelaunay::insert(PointList&) builds the triangulation.
+* SWEEP_GLOBAL_FLIP - Radial sweep, then flip every edge until no flips occur (original method, default).
+* SWEEP_LOCAL_FLIP - Radial sweep, legalizing the edges around each inserted point with a flip stack.
+* BRIO_LOCAL_FLIP - Insert into an enclosing triangle in biased randomized Hilbert curve order, legalizing with a flip stack.
+*/
+enum TinBuildMode{ SWEEP_GLOBAL_FLIP, SWEEP_LOCAL_FLIP, BRIO_LOCAL_FLIP };
+
+/** Where the point location walks of one caller start.  It is kept by the caller, not the
+* triangulation, so threads locating points in the same SHullDelaunay do not share it.
+* hint - Last located edge, where the next walk starts when locating from the hint.  NULL walks from startingEdge.
+* walkSteps - Edges crossed by the walks made with this cursor.
+*/
+struct TinCursor
+{
+	Edge *hint;
+	long walkSteps;
+	TinCursor() { hint = NULL; walkSteps = 0; }
+};
+
 class SHullDelaunay
 {
 	private:
 		Edge *startingEdge;
 		Edge *hullEdge;
+		bool useLocateHint;	//walks start from the cursor's hint; only changed before point location starts
+		TinCursor buildCursor;	//walk state of insertInterior while building
+		TinBuildMode buildMode;
+		long totalFlips;	//edges flipped while building the triangulation
+		static TinBuildMode defaultBuildMode;
 		//std::list < Edge * > edges;
 		vector < Edge * > edges; // SJZ
 
-		vector <Point*> ptPtrs;//keep up with allocated new pts for deletion later
+		TinVertices verts;	//vertex positions and values, indexed by vertex id; edges point into verts.xy
 		
-		PointList *pL;
+		PointList *pL;		//sorted copy of the input, only held while building
+		double offsetX;
+		double offsetY;
 		
-		void insert( const Point& p);
+		void triangulate();
+		Point vertexOf(const Vertex2d& v) const { return verts.point(verts.idOf(&v)); }
+		void makeTriangle( const Point& a, const Point& b, const Point& c);
+		void insert( const Point& p, vector<Edge*> *flipStack = NULL);
+		void insertInterior( const Point& p, vector<Edge*>& flipStack);
+		void legalize( vector<Edge*>& flipStack);
+		void brioOrder( vector<int>& order);
 		int checkEdge( Edge* e );
 		bool pointOnSurface(const Point& p);
 		
-		Triangle locateNearestNeighbor(const Point& p, string extrapMethod);
-		Triangle locateNearestNeighborTri(const Point& p, string extrapMethod);
-		Edge *locate(const Point& p);
-		vector< Edge* > locate3NN(const Point& p);
+		Triangle locateNearestNeighbor(const Point& p, string extrapMethod, TinCursor& cursor);
+		Triangle locateNearestNeighborTri(const Point& p, string extrapMethod, TinCursor& cursor);
+		Edge *walkStart(const TinCursor& cursor);
+		Edge *locate(const Point& p, TinCursor& cursor);
+		vector< Edge* > locate3NN(const Point& p, TinCursor& cursor);
 		vector< Edge* > findNearest3(const Point& p, Edge* e, Edge* e3, double distance, Edge* oNextLoop, Edge* u);
 		Edge* nearestDest (Edge* e);
 		Edge* nearestDestnTri2P (Edge* e, const Point& p, Point& pn);
@@ -39,7 +72,7 @@ class SHullDelaunay
 		
 	public:
 
-		SHullDelaunay() { pL=NULL; }
+		SHullDelaunay() { pL=NULL; offsetX=0; offsetY=0; startingEdge=NULL; useLocateHint=true; buildMode=defaultBuildMode; totalFlips=0; }
 		~SHullDelaunay() { clear(); }
 
 		void insert(PointList& pl);
@@ -47,11 +80,40 @@ class SHullDelaunay
 		double sample(const Point& p);
 		Mesh* getMesh();
 
-		vector<Point> determinePingLocationInTriangle(PointList& pl, const double& sH, const double& alpha, const double& deltaMin, GradientGrid& grads, vector<Triangle>& triangles, string depthInterpMethod, string uncertInterpMethod, string extrapMethod);
+		/** Locates every point of pl and computes its depth and uncertainty.
+		* @param cursor - Walk state to start from and update (Returned).  NULL walks with a cursor of this call only.
+		*/
+		vector<Point> determinePingLocationInTriangle(PointList& pl, const double& sH, const double& alpha, const double& deltaMin, GradientGrid& grads, vector<Triangle>& triangles, string depthInterpMethod, string uncertInterpMethod, string extrapMethod, TinCursor *cursor = NULL);
 		//void gradientGrid(const vector<double>& xIn, const vector<double>& yIn, const vector<double>& zIn, vector<Gradient*>& gradients);
 	
-		double getOffsetX() const { return pL->getOffsetX(); }
-		double getOffsetY() const { return pL->getOffsetY(); }
+		/** Selects where point location walks start.  Query points passed to
+		* determinePingLocationInTriangle are usually in raster order, so walking from
+		* the previously located edge crosses only a few triangles per query instead of
+		* walking in from startingEdge every time.  The located edge is kept in the caller's TinCursor.
+		* Set before any thread locates points.
+		* @param fromHint - true to walk from the last located edge (default), false to always walk from startingEdge.
+		*/
+		void setLocateFromHint(bool fromHint) { useLocateHint = fromHint; }
+
+		/** Selects how the next call to insert(PointList&) builds the triangulation.
+		* @param mode - SWEEP_GLOBAL_FLIP, SWEEP_LOCAL_FLIP or BRIO_LOCAL_FLIP.
+		*/
+		void setBuildMode(TinBuildMode mode) { buildMode = mode; }
+
+		/** Selects the build mode given to every SHullDelaunay constructed afterwards.
+		* Set once at start up, before any threads are created.
+		* @param mode - SWEEP_GLOBAL_FLIP, SWEEP_LOCAL_FLIP or BRIO_LOCAL_FLIP.
+		*/
+		static void setDefaultBuildMode(TinBuildMode mode) { defaultBuildMode = mode; }
+
+		/** Returns the number of edges flipped by the last insert(PointList&). */
+		long getNumFlips() const { return totalFlips; }
+
+		/** Returns the bytes held by the vertices of the triangulation. */
+		size_t getVertexMemory() const { return verts.memory(); }
+
+		double getOffsetX() const { return offsetX; }
+		double getOffsetY() const { return offsetY; }
 
 		void clear();
 };
@@ -28,6 +28,8 @@ extern NV_INT32 surf_init (NV_F64_XYMBR mbr,
 
 extern NV_INT32 surf_load (NV_F64_COORD3 xyz);
 
+extern void surf_set_threads (NV_INT32 threads);
+
 extern  NV_INT32 surf_proc (NV_BOOL surface);
 
 extern NV_INT32 surf_rtrv (NV_FLOAT64 **z_array, 
@@ -56,7 +58,7 @@ extern NV_INT32 surf_cleanup ();
 *		This is essentially a re-coded version of surf_tst.c from the original GMT Surface library that plays nice with mergeBathy
 ************************************************************************************/
 
-int processSurface(double *xData, double *yData, double *zData, int inputDataSize, double x0, double y0, double z0, double x1, double y1, double z1, double spacingX, double spacingY, double tension, double **xPostSurface, double **yPostSurface, double **zPostSurface, int *postSurfaceSize)
+int processSurface(double *xData, double *yData, double *zData, int inputDataSize, double x0, double y0, double z0, double x1, double y1, double z1, double spacingX, double spacingY, double tension, int numThreads, double **xPostSurface, double **yPostSurface, double **zPostSurface, int *postSurfaceSize)
 {
 	NV_INT32 rc = 0; /* return code */
 	long i, j, k, l;
@@ -183,6 +185,7 @@ int processSurface(double *xData, double *yData, double *zData, int inputDataSiz
 	}
 
 	//printf("About to call surf_proc with surface flag set to %d\n", surface_flg);fflush(stdout);
+	surf_set_threads(numThreads);
     rc = surf_proc(surface_flg);	
 	//printf("Rc after surf_proc is %d\n", rc);fflush(stdout);
 	if(rc)
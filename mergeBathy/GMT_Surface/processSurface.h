@@ -29,13 +29,14 @@ extern "C" {
 * @param spacingX - Computational grid spacing in the X direction.
 * @param spacingY - Computational grid spacing in the Y direction.
 * @param tension - Computational grid tension factor.
+* @param numThreads - Number of threads for the surface relaxation.  0 or 1 runs the serial sweep.
 * @param xPostSurface - 1 dimensional double array of interpolated X coordinates. (Returned).
 * @param yPostSurface - 1 dimensional double array of interpolated Y coordinates. (Returned).
 * @param zPostSurface - 1 dimensional double array of interpolated depth values. (Returned).
 * @param postSurfaceSize - Size of the xPostSurface, yPostSurface, and zPostSurface vectors.
 * @return Success or failure vaule.
 */
-int processSurface(double *xData, double *yData, double *zData, int inputDataSize, double x0, double y0, double z0, double x1, double y1, double z1, double spacingX, double spacingY, double tension, double **xPostSurface, double **yPostSurface, double **zPostSurface, int *postSurfaceSize);
+int processSurface(double *xData, double *yData, double *zData, int inputDataSize, double x0, double y0, double z0, double x1, double y1, double z1, double spacingX, double spacingY, double tension, int numThreads, double **xPostSurface, double **yPostSurface, double **zPostSurface, int *postSurfaceSize);
 
 #ifdef __cplusplus
 }
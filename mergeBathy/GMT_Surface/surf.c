@@ -65,6 +65,7 @@ static NV_INT32      surf_errno = 0;
 static NV_F64_COORD3 coord3;
 static NV_INT32      out_of_bounds = 0;
 static NV_INT32      process_state = 0;
+static NV_INT32      num_threads = 0;
 
 /*
 
@@ -453,6 +454,23 @@ NV_INT32 surf_load_NV_F32_COORD3 (NV_F32_COORD3 xyz)
 	return (surf_load (coord3));
 }
 
+/*
+
+  Function:         surf_set_threads  -  Set the number of threads used by the surface relaxation.  The
+                                         setting holds for every later call to surf_proc.
+
+  Arguments:        threads           -  Number of threads.  0 or 1 runs the original serial sweep; more
+                                         than 1 runs the multicolour parallel sweep.
+
+  Returns:          N/A
+
+*/
+
+void surf_set_threads (NV_INT32 threads)
+{
+	num_threads = threads;
+}
+
 /*
 
   Function:         surf_proc         -  Compute the "blockmean" values and run the surface process.  You may
@@ -673,7 +691,7 @@ NV_INT32 surf_proc (NV_BOOL surface)
 		return (surf_err);
 	}
 
-	rc = create_surface_from_array(x_clean, y_clean, z_clean, num_pts, x_grid, y_grid, x_orig, y_orig, x_max, y_max, tension, &rows, &cols);
+	rc = create_surface_from_array(x_clean, y_clean, z_clean, num_pts, x_grid, y_grid, x_orig, y_orig, x_max, y_max, tension, &rows, &cols, num_threads);
 	if(rc < 0)
 	{
 		surf_err = -15;
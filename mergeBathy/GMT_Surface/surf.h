@@ -43,6 +43,8 @@ extern "C" {
   NV_INT32 surf_load_NV_F32_COORD2_z (NV_F32_COORD2 xy, NV_FLOAT32 z);
   NV_INT32 surf_load_NV_F32_COORD3 (NV_F32_COORD3 xyz);
 
+  void surf_set_threads (NV_INT32 threads);
+
   NV_INT32 surf_proc (NV_BOOL surface);
 
   NV_INT32 surf_rtrv (NV_FLOAT64 **z_array, NV_INT32 **cnt_array, NV_INT32 *final_rows, NV_INT32 *final_cols);
@@ -73,7 +75,8 @@ extern "C" {
                             NV_FLOAT64 y_max,
                             NV_FLOAT64 tension,
 			    NV_INT32 *nrows,
-			    NV_INT32 *ncols);					
+			    NV_INT32 *ncols,
+			    NV_INT32 num_threads);					
 
 #ifdef  __cplusplus
 }
@@ -87,6 +87,11 @@
 
 #include "gmt.h"
 #include "surf.h"
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 
 
 struct SURFACE_CTRL {
@@ -135,6 +140,8 @@ struct SURFACE_CTRL {
 };
 
 #define SURFACE_OUTSIDE LONG_MAX	/* Index number indicating data is outside usable area */
+#define SURFACE_N_COLOURS 3		/* Column colours of the parallel sweep; the stencil reaches two columns */
+#define SURFACE_PARALLEL_MIN_NODES 65536	/* Smallest grid (nodes at the current spacing) swept in parallel */
 
 struct SURFACE_DATA {	/* Data point and index to node it currently constrains  */
 	float x;
@@ -204,6 +211,7 @@ struct SURFACE_INFO {	/* Control structure for surface setup and execution */
 	double small;			/* Let data point coincide with node if distance < C->small */
 	double coeff[2][12];		/* Coefficients for 12 nearby points, constrained and unconstrained  */
 	double relax_old, relax_new;	/* Coefficients for relaxation factor to speed up convergence */
+	int num_threads;		/* Threads for the multicolour sweep; 0 or 1 runs the serial sweep */
 	struct SURFACE_DATA  *data;
 	struct SURFACE_BRIGGS *briggs;
 	struct GRD_HEADER h;
@@ -244,7 +252,8 @@ int  create_surface_from_array(NV_FLOAT64 *x,
                             NV_FLOAT64 y_max,
                             NV_FLOAT64 tension,
                             NV_INT32 * rows,
-                            NV_INT32 * cols);
+                            NV_INT32 * cols,
+                            NV_INT32 num_threads);
 
 /************************************************************************************************
 *
@@ -265,6 +274,8 @@ int  create_surface_from_array(NV_FLOAT64 *x,
 *		y - Array of y coordinate values.
 *		z - Array of z coordinate values.
 *		num_pts - The number of x,y,z coordinate values.
+*		num_threads - Threads for the relaxation.  0 or 1 runs the original serial
+*				sweep; more runs the multicolour sweep of iterate in parallel.
 *	Return Values:
 *		0 - Success
 *		1 - Error
@@ -289,7 +300,8 @@ NV_INT32  create_surface_from_array(NV_FLOAT64 *x,
                             NV_FLOAT64 y_max,
                             NV_FLOAT64 tension,
                             NV_INT32 * rows,
-                            NV_INT32 * cols)
+                            NV_INT32 * cols,
+                            NV_INT32 num_threads)
 {
 	#define DEBUG 0	
 
@@ -414,6 +426,7 @@ NV_INT32  create_surface_from_array(NV_FLOAT64 *x,
 	memset ((void *)&C, 0, sizeof (struct SURFACE_INFO));
 	memset ((void *)&GMT_Surface_Global, 0, sizeof (struct SURFACE_GLOBAL));
 	C.n_alloc = GMT_CHUNK;
+	C.num_threads = num_threads;
 	C.z_scale = C.r_z_scale = 1.0;
 	C.mode_type[0] = 'I';
 	C.mode_type[1] = 'D';	/* D means include data points when iterating */
@@ -1443,17 +1456,11 @@ void write_output (struct SURFACE_INFO *C, char *grdfile, NV_FLOAT64 *z)
 	if (C->set_high) GMT_free ((void *)C->upper);
 }
 
-int iterate (struct SURFACE_INFO *C, int mode)
+/* Fill in the auxiliary boundary values of the current grid before a sweep.  */
+void set_boundaries (struct SURFACE_INFO *C)
 {
-
-	GMT_LONG	i, j, k, ij, kase, briggs_index, ij_v2;
+	GMT_LONG	i, j, ij, kase;
 	GMT_LONG	x_case, y_case, x_w_case, x_e_case, y_s_case, y_n_case;
-	GMT_LONG	iteration_count = 0;
-	char *iu;
-
-	double	current_limit = C->converge_limit / C->grid;
-	double	change, max_change = 0.0, busum, sum_ij;
-	double	b0, b1, b2, b3, b4, b5;
 	float *u;
 
 	double	x_0_const = 4.0 * (1.0 - C->boundary_tension) / (2.0 - C->boundary_tension);
@@ -1462,215 +1469,389 @@ int iterate (struct SURFACE_INFO *C, int mode)
 	double	y_0_const = 4 * C->l_epsilon * (1.0 - C->boundary_tension) / y_denom;
 	double	y_1_const = (C->boundary_tension - 2 * C->l_epsilon * (1.0 - C->boundary_tension) ) / y_denom;
 
-	sprintf(C->format,"%s: %%4ld\t%%c\t%%8ld\t%s\t%s\t%%10ld\n", GMT_program, gmtdefs.d_format, gmtdefs.d_format);
-
 	u = C->u;
-	iu = C->iu;
-	do {
-		briggs_index = 0;	/* Reset the constraint table stack pointer  */
 
-		max_change = -1.0;
+	/* Fill in auxiliary boundary values (in new way) */
 
-		/* Fill in auxiliary boundary values (in new way) */
+	/* First set d2[]/dn2 = 0 along edges:  */
+	/* New experiment : (1-T)d2[]/dn2 + Td[]/dn = 0  */
 
-		/* First set d2[]/dn2 = 0 along edges:  */
-		/* New experiment : (1-T)d2[]/dn2 + Td[]/dn = 0  */
+	for (i = 0; i < C->nx; i += C->grid) {
+		/* set d2[]/dy2 = 0 on south side:  */
+		ij = C->ij_sw_corner + i * C->my;
+		/* u[ij - 1] = 2 * u[ij] - u[ij + grid];  */
+		u[ij - 1] = (float)(y_0_const * u[ij] + y_1_const * u[ij + C->grid]);
+		/* set d2[]/dy2 = 0 on north side:  */
+		ij = C->ij_nw_corner + i * C->my;
+		/* u[ij + 1] = 2 * u[ij] - u[ij - grid];  */
+		u[ij + 1] = (float)(y_0_const * u[ij] + y_1_const * u[ij - C->grid]);
 
-		for (i = 0; i < C->nx; i += C->grid) {
-			/* set d2[]/dy2 = 0 on south side:  */
-			ij = C->ij_sw_corner + i * C->my;
-			/* u[ij - 1] = 2 * u[ij] - u[ij + grid];  */
-			u[ij - 1] = (float)(y_0_const * u[ij] + y_1_const * u[ij + C->grid]);
-			/* set d2[]/dy2 = 0 on north side:  */
-			ij = C->ij_nw_corner + i * C->my;
-			/* u[ij + 1] = 2 * u[ij] - u[ij - grid];  */
-			u[ij + 1] = (float)(y_0_const * u[ij] + y_1_const * u[ij - C->grid]);
+	}
 
-		}
+	for (j = 0; j < C->ny; j += C->grid) {
+		/* set d2[]/dx2 = 0 on west side:  */
+		ij = C->ij_sw_corner + j;
+		/* u[ij - my] = 2 * u[ij] - u[ij + grid_east];  */
+		u[ij - C->my] = (float)(x_1_const * u[ij + C->grid_east] + x_0_const * u[ij]);
+		/* set d2[]/dx2 = 0 on east side:  */
+		ij = C->ij_se_corner + j;
+		/* u[ij + my] = 2 * u[ij] - u[ij - grid_east];  */
+		u[ij + C->my] = (float)(x_1_const * u[ij - C->grid_east] + x_0_const * u[ij]);
+	}
 
-		for (j = 0; j < C->ny; j += C->grid) {
-			/* set d2[]/dx2 = 0 on west side:  */
-			ij = C->ij_sw_corner + j;
-			/* u[ij - my] = 2 * u[ij] - u[ij + grid_east];  */
-			u[ij - C->my] = (float)(x_1_const * u[ij + C->grid_east] + x_0_const * u[ij]);
-			/* set d2[]/dx2 = 0 on east side:  */
-			ij = C->ij_se_corner + j;
-			/* u[ij + my] = 2 * u[ij] - u[ij - grid_east];  */
-			u[ij + C->my] = (float)(x_1_const * u[ij - C->grid_east] + x_0_const * u[ij]);
-		}
+	/* Now set d2[]/dxdy = 0 at each corner:  */
 
-		/* Now set d2[]/dxdy = 0 at each corner:  */
+	ij = C->ij_sw_corner;
+	u[ij - C->my - 1] = u[ij + C->grid_east - 1] + u[ij - C->my + C->grid] - u[ij + C->grid_east + C->grid];
 
-		ij = C->ij_sw_corner;
-		u[ij - C->my - 1] = u[ij + C->grid_east - 1] + u[ij - C->my + C->grid] - u[ij + C->grid_east + C->grid];
+	ij = C->ij_nw_corner;
+	u[ij - C->my + 1] = u[ij + C->grid_east + 1] + u[ij - C->my - C->grid] - u[ij + C->grid_east - C->grid];
 
-		ij = C->ij_nw_corner;
-		u[ij - C->my + 1] = u[ij + C->grid_east + 1] + u[ij - C->my - C->grid] - u[ij + C->grid_east - C->grid];
+	ij = C->ij_se_corner;
+	u[ij + C->my - 1] = u[ij - C->grid_east - 1] + u[ij + C->my + C->grid] - u[ij - C->grid_east + C->grid];
 
-		ij = C->ij_se_corner;
-		u[ij + C->my - 1] = u[ij - C->grid_east - 1] + u[ij + C->my + C->grid] - u[ij - C->grid_east + C->grid];
+	ij = C->ij_ne_corner;
+	u[ij + C->my + 1] = u[ij - C->grid_east + 1] + u[ij + C->my - C->grid] - u[ij - C->grid_east - C->grid];
 
-		ij = C->ij_ne_corner;
-		u[ij + C->my + 1] = u[ij - C->grid_east + 1] + u[ij + C->my - C->grid] - u[ij - C->grid_east - C->grid];
+	/* Now set (1-T)dC/dn + Tdu/dn = 0 at each edge :  */
+	/* New experiment:  only dC/dn = 0  */
 
-		/* Now set (1-T)dC/dn + Tdu/dn = 0 at each edge :  */
-		/* New experiment:  only dC/dn = 0  */
+	x_w_case = 0;
+	x_e_case = C->block_nx - 1;
+	for (i = 0; i < C->nx; i += C->grid, x_w_case++, x_e_case--) {
 
-		x_w_case = 0;
-		x_e_case = C->block_nx - 1;
-		for (i = 0; i < C->nx; i += C->grid, x_w_case++, x_e_case--) {
+		if(x_w_case < 2)
+			x_case = x_w_case;
+		else if(x_e_case < 2)
+			x_case = 4 - x_e_case;
+		else
+			x_case = 2;
 
-			if(x_w_case < 2)
-				x_case = x_w_case;
-			else if(x_e_case < 2)
-				x_case = 4 - x_e_case;
-			else
-				x_case = 2;
-
-			/* South side :  */
-			kase = x_case * 5;
-			ij = C->ij_sw_corner + i * C->my;
-			u[ij + C->offset[kase][11]] = 
-				(float)(u[ij + C->offset[kase][0]] + C->eps_m2*(u[ij + C->offset[kase][1]] + u[ij + C->offset[kase][3]]
-					- u[ij + C->offset[kase][8]] - u[ij + C->offset[kase][10]])
-					+ C->two_plus_em2 * (u[ij + C->offset[kase][9]] - u[ij + C->offset[kase][2]]) );
-				/*  + tense * C->eps_m2 * (u[ij + C->offset[kase][2]] - u[ij + C->offset[kase][9]]) / (1.0 - tense);  */
-			/* North side :  */
-			kase = x_case * 5 + 4;
-			ij = C->ij_nw_corner + i * C->my;
-			u[ij + C->offset[kase][0]] = 
-				-(float)(-u[ij + C->offset[kase][11]] + C->eps_m2 * (u[ij + C->offset[kase][1]] + u[ij + C->offset[kase][3]]
-					- u[ij + C->offset[kase][8]] - u[ij + C->offset[kase][10]])
-					+ C->two_plus_em2 * (u[ij + C->offset[kase][9]] - u[ij + C->offset[kase][2]]) );
-				/*  - tense * C->eps_m2 * (u[ij + C->offset[kase][2]] - u[ij + C->offset[kase][9]]) / (1.0 - tense);  */
+		/* South side :  */
+		kase = x_case * 5;
+		ij = C->ij_sw_corner + i * C->my;
+		u[ij + C->offset[kase][11]] = 
+			(float)(u[ij + C->offset[kase][0]] + C->eps_m2*(u[ij + C->offset[kase][1]] + u[ij + C->offset[kase][3]]
+				- u[ij + C->offset[kase][8]] - u[ij + C->offset[kase][10]])
+				+ C->two_plus_em2 * (u[ij + C->offset[kase][9]] - u[ij + C->offset[kase][2]]) );
+			/*  + tense * C->eps_m2 * (u[ij + C->offset[kase][2]] - u[ij + C->offset[kase][9]]) / (1.0 - tense);  */
+		/* North side :  */
+		kase = x_case * 5 + 4;
+		ij = C->ij_nw_corner + i * C->my;
+		u[ij + C->offset[kase][0]] = 
+			-(float)(-u[ij + C->offset[kase][11]] + C->eps_m2 * (u[ij + C->offset[kase][1]] + u[ij + C->offset[kase][3]]
+				- u[ij + C->offset[kase][8]] - u[ij + C->offset[kase][10]])
+				+ C->two_plus_em2 * (u[ij + C->offset[kase][9]] - u[ij + C->offset[kase][2]]) );
+			/*  - tense * C->eps_m2 * (u[ij + C->offset[kase][2]] - u[ij + C->offset[kase][9]]) / (1.0 - tense);  */
+	}
+
+	y_s_case = 0;
+	y_n_case = C->block_ny - 1;
+	for (j = 0; j < C->ny; j += C->grid, y_s_case++, y_n_case--) {
+
+		if(y_s_case < 2)
+			y_case = y_s_case;
+		else if(y_n_case < 2)
+			y_case = 4 - y_n_case;
+		else
+			y_case = 2;
+
+		/* West side :  */
+		kase = y_case;
+		ij = C->ij_sw_corner + j;
+		u[ij+C->offset[kase][4]] = 
+			u[ij + C->offset[kase][7]] + (float)(C->eps_p2 * (u[ij + C->offset[kase][3]] + u[ij + C->offset[kase][10]]
+			-u[ij + C->offset[kase][1]] - u[ij + C->offset[kase][8]])
+			+ C->two_plus_ep2 * (u[ij + C->offset[kase][5]] - u[ij + C->offset[kase][6]]));
+			/*  + tense * (u[ij + C->offset[kase][6]] - u[ij + C->offset[kase][5]]) / (1.0 - tense);  */
+		/* East side :  */
+		kase = 20 + y_case;
+		ij = C->ij_se_corner + j;
+		u[ij + C->offset[kase][7]] = 
+			- (float)(-u[ij + C->offset[kase][4]] + C->eps_p2 * (u[ij + C->offset[kase][3]] + u[ij + C->offset[kase][10]]
+			- u[ij + C->offset[kase][1]] - u[ij + C->offset[kase][8]])
+			+ C->two_plus_ep2 * (u[ij + C->offset[kase][5]] - u[ij + C->offset[kase][6]]) );
+			/*  - tense * (u[ij + C->offset[kase][6]] - u[ij + C->offset[kase][5]]) / (1.0 - tense);  */
+	}
+}
+
+/* Relax the node at ij, case kase, column i and row j of the current grid and return the
+ * size of the change.  briggs holds the coefficients of a constrained node; it is not used
+ * for an unconstrained one.  */
+double relax_node (struct SURFACE_INFO *C, GMT_LONG ij, GMT_LONG kase, GMT_LONG i, GMT_LONG j, struct SURFACE_BRIGGS *briggs)
+{
+	GMT_LONG	k, ij_v2;
+	double	change, busum, sum_ij = 0.0;
+	double	b0, b1, b2, b3, b4, b5;
+	float *u = C->u;
+	char *iu = C->iu;
+
+	if (iu[ij] == 0) {		/* Point is unconstrained  */
+		for (k = 0; k < 12; k++) {
+			sum_ij += (u[ij + C->offset[kase][k]] * C->coeff[0][k]);
+		}
+	}
+	else {				/* Point is constrained  */
+
+		b0 = briggs->b[0];
+		b1 = briggs->b[1];
+		b2 = briggs->b[2];
+		b3 = briggs->b[3];
+		b4 = briggs->b[4];
+		b5 = briggs->b[5];
+		if (iu[ij] < 3) {
+			if (iu[ij] == 1) {	/* Point is in quadrant 1  */
+				busum = b0 * u[ij + C->offset[kase][10]]
+					+ b1 * u[ij + C->offset[kase][9]]
+					+ b2 * u[ij + C->offset[kase][5]]
+					+ b3 * u[ij + C->offset[kase][1]];
+			}
+			else {			/* Point is in quadrant 2  */
+				busum = b0 * u[ij + C->offset[kase][8]]
+					+ b1 * u[ij + C->offset[kase][9]]
+					+ b2 * u[ij + C->offset[kase][6]]
+					+ b3 * u[ij + C->offset[kase][3]];
+			}
+		}
+		else {
+			if (iu[ij] == 3) {	/* Point is in quadrant 3  */
+				busum = b0 * u[ij + C->offset[kase][1]]
+					+ b1 * u[ij + C->offset[kase][2]]
+					+ b2 * u[ij + C->offset[kase][6]]
+					+ b3 * u[ij + C->offset[kase][10]];
+			}
+			else {		/* Point is in quadrant 4  */
+				busum = b0 * u[ij + C->offset[kase][3]]
+					+ b1 * u[ij + C->offset[kase][2]]
+					+ b2 * u[ij + C->offset[kase][5]]
+					+ b3 * u[ij + C->offset[kase][8]];
+			}
 		}
+		for (k = 0; k < 12; k++) {
+			sum_ij += (u[ij + C->offset[kase][k]] * C->coeff[1][k]);
+		}
+		sum_ij = (sum_ij + C->a0_const_2 * (busum + b5))
+			/ (C->a0_const_1 + C->a0_const_2 * b4);
+	}
 
-		y_s_case = 0;
-		y_n_case = C->block_ny - 1;
-		for (j = 0; j < C->ny; j += C->grid, y_s_case++, y_n_case--) {
+	/* New relaxation here  */
+	sum_ij = u[ij] * C->relax_old + sum_ij * C->relax_new;
 
-			if(y_s_case < 2)
-				y_case = y_s_case;
+	if (C->constrained) {	/* Must check limits.  Note lower/upper is v2 format and need ij_v2! */
+		ij_v2 = (C->ny - j - 1) * C->nx + i;
+		if (C->set_low && !GMT_is_fnan (C->lower[ij_v2]) && sum_ij < C->lower[ij_v2])
+			sum_ij = C->lower[ij_v2];
+		else if (C->set_high && !GMT_is_fnan (C->upper[ij_v2]) && sum_ij > C->upper[ij_v2])
+			sum_ij = C->upper[ij_v2];
+	}
+
+	change = fabs(sum_ij - u[ij]);
+	u[ij] = (float)sum_ij;
+	return (change);
+}
+
+/* Parallel sweep.  The 12 point stencil reaches two nodes along each axis, so a red-black
+ * ordering still couples nodes of one colour.  Columns three apart never share a stencil:
+ * colouring each column by its index mod 3 lets all columns of one colour be relaxed at the
+ * same time, each from south to north as in the serial sweep.  Each of the three colour
+ * passes splits its columns among the threads, and the result does not depend on their number.  */
+
+struct SURFACE_SWEEP {	/* One thread's share of a colour pass */
+	struct SURFACE_INFO *C;
+	GMT_LONG *briggs_start;		/* Constraint table index of the first node of each column */
+	GMT_LONG colour;		/* Colour of the pass */
+	GMT_LONG first, stride;		/* This thread takes every stride-th column of the colour from first */
+	double max_change;		/* Largest change of the share (Returned) */
+};
+
+/* Constraint table index of the first node of each column.  The serial sweep pops the table
+ * in column order; a colour pass starts each column from here instead.  */
+void set_briggs_start (struct SURFACE_INFO *C, GMT_LONG *briggs_start)
+{
+	GMT_LONG	column, row, ij, briggs_index = 0;
+
+	for (column = 0; column < C->block_nx; column++) {
+		briggs_start[column] = briggs_index;
+		ij = C->ij_sw_corner + column * C->grid * C->my;
+		for (row = 0; row < C->block_ny; row++, ij += C->grid) {
+			if (C->iu[ij] != 0 && C->iu[ij] != 5) briggs_index++;
+		}
+	}
+}
+
+#ifdef WIN32
+DWORD WINAPI sweep_colour (LPVOID arg)
+#else
+void *sweep_colour (void *arg)
+#endif
+{
+	struct SURFACE_SWEEP *S = (struct SURFACE_SWEEP *)arg;
+	struct SURFACE_INFO *C = S->C;
+	GMT_LONG	column, row, ij, kase, briggs_index;
+	GMT_LONG	x_case, y_case, x_e_case, y_n_case;
+	double	change;
+	char *iu = C->iu;
+
+	S->max_change = -1.0;
+	for (column = S->colour + SURFACE_N_COLOURS * S->first; column < C->block_nx; column += SURFACE_N_COLOURS * S->stride) {
+
+		x_e_case = C->block_nx - 1 - column;
+		if(column < 2)
+			x_case = column;
+		else if(x_e_case < 2)
+			x_case = 4 - x_e_case;
+		else
+			x_case = 2;
+
+		ij = C->ij_sw_corner + column * C->grid * C->my;
+		briggs_index = S->briggs_start[column];
+
+		for (row = 0; row < C->block_ny; row++, ij += C->grid) {
+
+			if (iu[ij] == 5) continue;	/* Point is fixed  */
+
+			y_n_case = C->block_ny - 1 - row;
+			if(row < 2)
+				y_case = row;
 			else if(y_n_case < 2)
 				y_case = 4 - y_n_case;
 			else
 				y_case = 2;
 
-			/* West side :  */
-			kase = y_case;
-			ij = C->ij_sw_corner + j;
-			u[ij+C->offset[kase][4]] = 
-				u[ij + C->offset[kase][7]] + (float)(C->eps_p2 * (u[ij + C->offset[kase][3]] + u[ij + C->offset[kase][10]]
-				-u[ij + C->offset[kase][1]] - u[ij + C->offset[kase][8]])
-				+ C->two_plus_ep2 * (u[ij + C->offset[kase][5]] - u[ij + C->offset[kase][6]]));
-				/*  + tense * (u[ij + C->offset[kase][6]] - u[ij + C->offset[kase][5]]) / (1.0 - tense);  */
-			/* East side :  */
-			kase = 20 + y_case;
-			ij = C->ij_se_corner + j;
-			u[ij + C->offset[kase][7]] = 
-				- (float)(-u[ij + C->offset[kase][4]] + C->eps_p2 * (u[ij + C->offset[kase][3]] + u[ij + C->offset[kase][10]]
-				- u[ij + C->offset[kase][1]] - u[ij + C->offset[kase][8]])
-				+ C->two_plus_ep2 * (u[ij + C->offset[kase][5]] - u[ij + C->offset[kase][6]]) );
-				/*  - tense * (u[ij + C->offset[kase][6]] - u[ij + C->offset[kase][5]]) / (1.0 - tense);  */
+			kase = x_case * 5 + y_case;
+			change = relax_node (C, ij, kase, column * C->grid, row * C->grid, (iu[ij] == 0) ? NULL : &C->briggs[briggs_index++]);
+			if (change > S->max_change) S->max_change = change;
+		}
+	}
+	return (0);
+}
+
+/* Relax every free node once in three colour passes and return the largest change.  */
+double sweep_parallel (struct SURFACE_INFO *C, GMT_LONG *briggs_start, struct SURFACE_SWEEP *S, int n_threads)
+{
+	GMT_LONG	colour;
+	int	t;
+	double	max_change = -1.0;
+#ifdef WIN32
+	HANDLE	*threads = (HANDLE *) GMT_memory (VNULL, (size_t)n_threads, sizeof(HANDLE), GMT_program);
+#else
+	pthread_t	*threads = (pthread_t *) GMT_memory (VNULL, (size_t)n_threads, sizeof(pthread_t), GMT_program);
+#endif
+	int	*started = (int *) GMT_memory (VNULL, (size_t)n_threads, sizeof(int), GMT_program);
+
+	for (colour = 0; colour < SURFACE_N_COLOURS; colour++) {
+		for (t = 0; t < n_threads; t++) {
+			S[t].C = C;
+			S[t].briggs_start = briggs_start;
+			S[t].colour = colour;
+			S[t].first = t;
+			S[t].stride = n_threads;
+		}
+		/* The calling thread takes the first share.  A share whose thread cannot be
+		   started is swept here after the others are joined.  */
+		for (t = 1; t < n_threads; t++) {
+#ifdef WIN32
+			threads[t] = CreateThread (NULL, 0, sweep_colour, &S[t], 0, NULL);
+			started[t] = (threads[t] != NULL);
+#else
+			started[t] = (pthread_create (&threads[t], NULL, sweep_colour, &S[t]) == 0);
+#endif
 		}
+		sweep_colour (&S[0]);
+		for (t = 1; t < n_threads; t++) {
+			if (started[t]) {
+#ifdef WIN32
+				WaitForSingleObject (threads[t], INFINITE);
+				CloseHandle (threads[t]);
+#else
+				pthread_join (threads[t], NULL);
+#endif
+			}
+			else
+				sweep_colour (&S[t]);
+		}
+		for (t = 0; t < n_threads; t++) {
+			if (S[t].max_change > max_change) max_change = S[t].max_change;
+		}
+	}
 
+	GMT_free ((void *)threads);
+	GMT_free ((void *)started);
+	return (max_change);
+}
 
+int iterate (struct SURFACE_INFO *C, int mode)
+{
 
-		/* That's it for the boundary points.  Now loop over all data  */
+	GMT_LONG	i, j, ij, kase, briggs_index;
+	GMT_LONG	x_case, y_case, x_w_case, x_e_case, y_s_case, y_n_case;
+	GMT_LONG	iteration_count = 0;
+	GMT_LONG	*briggs_start = NULL;
+	struct SURFACE_SWEEP *sweep = NULL;
+	int	n_threads = 1;
+	char *iu;
 
-		x_w_case = 0;
-		x_e_case = C->block_nx - 1;
-		for (i = 0; i < C->nx; i += C->grid, x_w_case++, x_e_case--) {
+	double	current_limit = C->converge_limit / C->grid;
+	double	change, max_change = 0.0;
 
-			if(x_w_case < 2)
-				x_case = x_w_case;
-			else if(x_e_case < 2)
-				x_case = 4 - x_e_case;
-			else
-				x_case = 2;
+	sprintf(C->format,"%s: %%4ld\t%%c\t%%8ld\t%s\t%s\t%%10ld\n", GMT_program, gmtdefs.d_format, gmtdefs.d_format);
 
-			y_s_case = 0;
-			y_n_case = C->block_ny - 1;
+	/* Coarse grids are too small to repay starting the threads; they keep the serial sweep.  */
+	if (C->num_threads > 1 && C->block_nx * C->block_ny >= SURFACE_PARALLEL_MIN_NODES) {
+		/* Every thread needs a column of each colour.  */
+		n_threads = C->num_threads;
+		if (n_threads > C->block_nx / SURFACE_N_COLOURS) n_threads = (int)(C->block_nx / SURFACE_N_COLOURS);
+	}
+	if (n_threads > 1) {
+		briggs_start = (GMT_LONG *) GMT_memory (VNULL, (size_t)C->block_nx, sizeof(GMT_LONG), GMT_program);
+		sweep = (struct SURFACE_SWEEP *) GMT_memory (VNULL, (size_t)n_threads, sizeof(struct SURFACE_SWEEP), GMT_program);
+		set_briggs_start (C, briggs_start);
+	}
+
+	iu = C->iu;
+	do {
+		briggs_index = 0;	/* Reset the constraint table stack pointer  */
 
-			ij = C->ij_sw_corner + i * C->my;
+		max_change = -1.0;
 
-			for (j = 0; j < C->ny; j += C->grid, ij += C->grid, y_s_case++, y_n_case--) {
+		set_boundaries (C);
 
-				if (iu[ij] == 5) continue;	/* Point is fixed  */
+		/* That's it for the boundary points.  Now loop over all data  */
 
-				if(y_s_case < 2)
-					y_case = y_s_case;
-				else if(y_n_case < 2)
-					y_case = 4 - y_n_case;
+		if (n_threads > 1)
+			max_change = sweep_parallel (C, briggs_start, sweep, n_threads);
+		else {
+			x_w_case = 0;
+			x_e_case = C->block_nx - 1;
+			for (i = 0; i < C->nx; i += C->grid, x_w_case++, x_e_case--) {
+
+				if(x_w_case < 2)
+					x_case = x_w_case;
+				else if(x_e_case < 2)
+					x_case = 4 - x_e_case;
 				else
-					y_case = 2;
+					x_case = 2;
 
-				kase = x_case * 5 + y_case;
-				sum_ij = 0.0;
+				y_s_case = 0;
+				y_n_case = C->block_ny - 1;
 
-				if (iu[ij] == 0) {		/* Point is unconstrained  */
-					for (k = 0; k < 12; k++) {
-						sum_ij += (u[ij + C->offset[kase][k]] * C->coeff[0][k]);
-					}
-				}
-				else {				/* Point is constrained  */
-
-					b0 = C->briggs[briggs_index].b[0];
-					b1 = C->briggs[briggs_index].b[1];
-					b2 = C->briggs[briggs_index].b[2];
-					b3 = C->briggs[briggs_index].b[3];
-					b4 = C->briggs[briggs_index].b[4];
-					b5 = C->briggs[briggs_index].b[5];
-					briggs_index++;
-					if (iu[ij] < 3) {
-						if (iu[ij] == 1) {	/* Point is in quadrant 1  */
-							busum = b0 * u[ij + C->offset[kase][10]]
-								+ b1 * u[ij + C->offset[kase][9]]
-								+ b2 * u[ij + C->offset[kase][5]]
-								+ b3 * u[ij + C->offset[kase][1]];
-						}
-						else {			/* Point is in quadrant 2  */
-							busum = b0 * u[ij + C->offset[kase][8]]
-								+ b1 * u[ij + C->offset[kase][9]]
-								+ b2 * u[ij + C->offset[kase][6]]
-								+ b3 * u[ij + C->offset[kase][3]];
-						}
-					}
-					else {
-						if (iu[ij] == 3) {	/* Point is in quadrant 3  */
-							busum = b0 * u[ij + C->offset[kase][1]]
-								+ b1 * u[ij + C->offset[kase][2]]
-								+ b2 * u[ij + C->offset[kase][6]]
-								+ b3 * u[ij + C->offset[kase][10]];
-						}
-						else {		/* Point is in quadrant 4  */
-							busum = b0 * u[ij + C->offset[kase][3]]
-								+ b1 * u[ij + C->offset[kase][2]]
-								+ b2 * u[ij + C->offset[kase][5]]
-								+ b3 * u[ij + C->offset[kase][8]];
-						}
-					}
-					for (k = 0; k < 12; k++) {
-						sum_ij += (u[ij + C->offset[kase][k]] * C->coeff[1][k]);
-					}
-					sum_ij = (sum_ij + C->a0_const_2 * (busum + b5))
-						/ (C->a0_const_1 + C->a0_const_2 * b4);
-				}
+				ij = C->ij_sw_corner + i * C->my;
 
-				/* New relaxation here  */
-				sum_ij = u[ij] * C->relax_old + sum_ij * C->relax_new;
+				for (j = 0; j < C->ny; j += C->grid, ij += C->grid, y_s_case++, y_n_case--) {
 
-				if (C->constrained) {	/* Must check limits.  Note lower/upper is v2 format and need ij_v2! */
-					ij_v2 = (C->ny - j - 1) * C->nx + i;
-					if (C->set_low && !GMT_is_fnan (C->lower[ij_v2]) && sum_ij < C->lower[ij_v2])
-						sum_ij = C->lower[ij_v2];
-					else if (C->set_high && !GMT_is_fnan (C->upper[ij_v2]) && sum_ij > C->upper[ij_v2])
-						sum_ij = C->upper[ij_v2];
-				}
+					if (iu[ij] == 5) continue;	/* Point is fixed  */
 
-				change = fabs(sum_ij - u[ij]);
-				u[ij] = (float)sum_ij;
-				if (change > max_change) max_change = change;
+					if(y_s_case < 2)
+						y_case = y_s_case;
+					else if(y_n_case < 2)
+						y_case = 4 - y_n_case;
+					else
+						y_case = 2;
+
+					kase = x_case * 5 + y_case;
+					change = relax_node (C, ij, kase, i, j, (iu[ij] == 0) ? NULL : &C->briggs[briggs_index++]);
+					if (change > max_change) max_change = change;
+				}
 			}
 		}
 		iteration_count++;
@@ -1684,6 +1865,10 @@ int iterate (struct SURFACE_INFO *C, int mode)
 	if (gmtdefs.verbose && !C->long_verbose) fprintf (stderr, C->format,
 		C->grid, C->mode_type[mode], iteration_count, max_change, current_limit, C->total_iterations);
 
+	if (n_threads > 1) {
+		GMT_free ((void *)briggs_start);
+		GMT_free ((void *)sweep);
+	}
 	return (iteration_count);
 }
 
@@ -176,8 +176,16 @@
 #define GSF_S_INT_MIN   (-2147483648.0)
 #define GSF_S_INT_MAX    (2147483647.0)
 
+/* mergeBathy: the record stream buffer is per thread so files can be read concurrently.
+ * Each open handle already keeps its own file table entry and decode arrays. */
+#if defined(_MSC_VER)
+#define GSF_THREAD_LOCAL __declspec(thread)
+#else
+#define GSF_THREAD_LOCAL __thread
+#endif
+
 /* Static Global data for this module */
-static unsigned char streamBuff[GSF_MAX_RECORD_SIZE];
+static GSF_THREAD_LOCAL unsigned char streamBuff[GSF_MAX_RECORD_SIZE];
 static int      numOpenFiles;
 static GSF_FILE_TABLE gsfFileTable[GSF_MAX_OPEN_FILES];
 
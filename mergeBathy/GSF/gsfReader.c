@@ -49,6 +49,8 @@
 	#include "../WarningStates.h"	//Disable all Warnings!!!
 #endif
 
+#include <string.h>
+#include <stdlib.h>
 #include "gsfReader.h"
 
 /******************************************************************************/
@@ -83,15 +85,27 @@ int read_rec(int gsfHandle, gsfRecords *gsfRec, gsfDataID *id)
 
 } /* read_rec */
 
+/******************************************************************************/
+static void locate_beam(double pingLat, double pingLon, double heading,
+			double alongTrack, double acrossTrack, double *lat, double *lon)
+/* step from the ping position along track, then across track */
+{
+	*lat = pingLat;
+	*lon = pingLon;
+	if (fabs(alongTrack) > 0.0)
+		newgp( pingLat, pingLon, heading, alongTrack, lat, lon );
+	if (fabs(acrossTrack) > 0.0)
+		newgp( *lat, *lon, heading + 90.0, acrossTrack, lat, lon );
+
+} /* locate_beam */
+
 /******************************************************************************/
 void place_beam2(int prime_meridian, int beamon,
                         double *lonmin, double *latmin, double *depth,
 			double *h, double *v, gsfRecords gsfRec, gsfDataID id)
 {
 	static ELLIPSOID ellip=WE;
-	short stat=1;
         double lat, lon, az2;
-	int special;
 
 	if ( (gsfRec.mb_ping.ping_flags & GSF_IGNORE_PING)
 		|| (gsfRec.mb_ping.beam_flags[beamon] & GSF_IGNORE_BEAM) )
@@ -100,41 +114,16 @@ void place_beam2(int prime_meridian, int beamon,
 	}
 	else
 	{
-
-		special = 0;
-		if ( gsfRec.mb_ping.along_track[beamon]  == 0.0
-			&& gsfRec.mb_ping.across_track[beamon] == 0.0)
-		{
-			/* very special case - probably single beam */
-			lat = gsfRec.mb_ping.latitude;
-			lon = gsfRec.mb_ping.longitude;
-			special = 1;
-		}
-
-		if (fabs(gsfRec.mb_ping.along_track[beamon]) > 0.0)
-			newgp( gsfRec.mb_ping.latitude,
-					gsfRec.mb_ping.longitude,
-					gsfRec.mb_ping.heading,
-					gsfRec.mb_ping.along_track[beamon],
-					&lat, &lon );
-		stat = 0;
-		if (stat == 0 && fabs(gsfRec.mb_ping.across_track[beamon])>0.0)
-			newgp( lat, lon, gsfRec.mb_ping.heading + 90.0,
-					gsfRec.mb_ping.across_track[beamon],
-					&lat, &lon );
-		stat = 0;
-
-		if (stat == 0 || special) /* it worked or special */
-		{
-			*lonmin = 60.0*lon;	/* convert to min */
-			if (prime_meridian) *lonmin += 21600.0;/* +360 deg min*/
-			*latmin = 60.0*lat;	/* convert to min */
-			*depth = gsfRec.mb_ping.depth[beamon];
-		}
-		else
-		{
-			*depth = NONSENSE;
-		}
+		/* the beam is located by stepping from the ping position along
+		   and across track, so a single beam at (0, 0) is the ping itself */
+		locate_beam(gsfRec.mb_ping.latitude, gsfRec.mb_ping.longitude,
+				gsfRec.mb_ping.heading, gsfRec.mb_ping.along_track[beamon],
+				gsfRec.mb_ping.across_track[beamon], &lat, &lon);
+
+		*lonmin = 60.0*lon;	/* convert to min */
+		if (prime_meridian) *lonmin += 21600.0;/* +360 deg min*/
+		*latmin = 60.0*lat;	/* convert to min */
+		*depth = gsfRec.mb_ping.depth[beamon];
 	}
 
 } /* place_beam2 */
@@ -208,6 +197,136 @@ void close_gsffile(int *handle)
 	gsfClose((*handle));
 }
 
+/******************************************************************************/
+void init_ping_block(GSF_PING_BLOCK *block)
+{
+	memset(block, 0, sizeof(GSF_PING_BLOCK));
+
+} /* init_ping_block */
+
+/******************************************************************************/
+void free_ping_block(GSF_PING_BLOCK *block)
+{
+	free(block->latitude);
+	free(block->longitude);
+	free(block->heading);
+	free(block->firstBeam);
+	free(block->depth);
+	free(block->acrossTrack);
+	free(block->alongTrack);
+	free(block->beamFlags);
+	init_ping_block(block);
+
+} /* free_ping_block */
+
+/******************************************************************************/
+static int grow_ping_block(GSF_PING_BLOCK *block, int numPings, int numBeams)
+/* make room for numPings pings and numBeams beams; 0 if out of memory */
+{
+	if (numPings + 1 > block->pingCapacity)
+	{
+		int n = (numPings + 1 > 2 * block->pingCapacity) ? numPings + 1 : 2 * block->pingCapacity;
+		double *latitude = (double *) realloc(block->latitude, n * sizeof(double));
+		double *longitude = (double *) realloc(block->longitude, n * sizeof(double));
+		double *heading = (double *) realloc(block->heading, n * sizeof(double));
+		int *firstBeam = (int *) realloc(block->firstBeam, n * sizeof(int));
+		if (latitude) block->latitude = latitude;
+		if (longitude) block->longitude = longitude;
+		if (heading) block->heading = heading;
+		if (firstBeam) block->firstBeam = firstBeam;
+		if (!latitude || !longitude || !heading || !firstBeam)
+			return 0;
+		block->pingCapacity = n;
+	}
+	if (numBeams > block->beamCapacity)
+	{
+		int n = (numBeams > 2 * block->beamCapacity) ? numBeams : 2 * block->beamCapacity;
+		double *depth = (double *) realloc(block->depth, n * sizeof(double));
+		double *acrossTrack = (double *) realloc(block->acrossTrack, n * sizeof(double));
+		double *alongTrack = (double *) realloc(block->alongTrack, n * sizeof(double));
+		unsigned char *beamFlags = (unsigned char *) realloc(block->beamFlags, n);
+		if (depth) block->depth = depth;
+		if (acrossTrack) block->acrossTrack = acrossTrack;
+		if (alongTrack) block->alongTrack = alongTrack;
+		if (beamFlags) block->beamFlags = beamFlags;
+		if (!depth || !acrossTrack || !alongTrack || !beamFlags)
+			return 0;
+		block->beamCapacity = n;
+	}
+	return 1;
+
+} /* grow_ping_block */
+
+/******************************************************************************/
+int read_ping_block(int gsfHandle, gsfRecords *gsfRec, GSF_PING_BLOCK *block, int maxPings)
+{
+	gsfDataID id;
+	gsfSwathBathyPing *ping;
+	int b, k, n, ignorePing;
+
+	block->numPings = 0;
+	block->numBeams = 0;
+	if (!grow_ping_block(block, 0, 0))
+		return 0;
+	block->firstBeam[0] = 0;
+
+	while (block->numPings < maxPings && read_rec(gsfHandle, gsfRec, &id))
+	{
+		ping = &gsfRec->mb_ping;
+		n = (ping->number_beams > 0) ? ping->number_beams : 0;
+		if (!grow_ping_block(block, block->numPings + 1, block->numBeams + n))
+			break;
+
+		block->latitude[block->numPings] = ping->latitude;
+		block->longitude[block->numPings] = ping->longitude;
+		block->heading[block->numPings] = ping->heading;
+
+		/* a ping without depths has nothing to locate */
+		ignorePing = (ping->ping_flags & GSF_IGNORE_PING) || ping->depth == NULL;
+		for (b = 0, k = block->numBeams; b < n; b++, k++)
+		{
+			block->depth[k] = ping->depth ? ping->depth[b] : 0.0;
+			block->acrossTrack[k] = ping->across_track ? ping->across_track[b] : 0.0;
+			block->alongTrack[k] = ping->along_track ? ping->along_track[b] : 0.0;
+			block->beamFlags[k] = ping->beam_flags ? ping->beam_flags[b] : 0;
+			if (ignorePing)
+				block->beamFlags[k] |= GSF_IGNORE_BEAM;
+		}
+		block->numBeams += n;
+		block->numPings++;
+		block->firstBeam[block->numPings] = block->numBeams;
+	}
+	return block->numPings;
+
+} /* read_ping_block */
+
+/******************************************************************************/
+void place_ping_block(const GSF_PING_BLOCK *block, int firstPing, int lastPing, int prime_meridian,
+			double *lonmin, double *latmin, double *depth)
+{
+	double lat, lon;
+	int p, k;
+
+	for (p = firstPing; p < lastPing; p++)
+	{
+		for (k = block->firstBeam[p]; k < block->firstBeam[p+1]; k++)
+		{
+			if (block->beamFlags[k] & GSF_IGNORE_BEAM)
+			{
+				lonmin[k] = latmin[k] = depth[k] = NONSENSE;
+				continue;
+			}
+			locate_beam(block->latitude[p], block->longitude[p], block->heading[p],
+					block->alongTrack[k], block->acrossTrack[k], &lat, &lon);
+			lonmin[k] = 60.0*lon;	/* convert to min */
+			if (prime_meridian) lonmin[k] += 21600.0;/* +360 deg min*/
+			latmin[k] = 60.0*lat;	/* convert to min */
+			depth[k] = block->depth[k];
+		}
+	}
+
+} /* place_ping_block */
+
 //Restore warning state -SJZ
 #if _DISABLE_3RDPARTY_WARNINGS
 	#pragma warning ( pop )
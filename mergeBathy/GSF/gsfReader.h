@@ -35,5 +35,44 @@ int gsfReader(double *lonmin, double *latmin, double *depth, double *h, double *
 //Close a gsf file
 void close_gsffile(int *handle);
 
+/* Navigation and beams of consecutive swath bathymetry pings, stored by column.
+   The beams of ping p are firstBeam[p] .. firstBeam[p+1]-1 of the beam columns.
+   Beams marked ignored, or in a ping marked ignored, have GSF_IGNORE_BEAM set in beamFlags. */
+typedef struct
+{
+	int numPings;
+	int numBeams;
+	int pingCapacity;
+	int beamCapacity;
+
+	/* per ping */
+	double *latitude;		/* degrees */
+	double *longitude;		/* degrees */
+	double *heading;		/* degrees */
+	int *firstBeam;			/* numPings+1 entries */
+
+	/* per beam */
+	double *depth;
+	double *acrossTrack;
+	double *alongTrack;
+	unsigned char *beamFlags;
+} GSF_PING_BLOCK;
+
+//Start a ping block with no storage
+void init_ping_block(GSF_PING_BLOCK *block);
+
+//Release the storage of a ping block
+void free_ping_block(GSF_PING_BLOCK *block);
+
+//Read up to maxPings swath bathymetry pings into a block, growing its storage as
+//needed.  Returns the number of pings read; 0 at the end of the file or on error.
+int read_ping_block(int gsfHandle, gsfRecords *gsfRec, GSF_PING_BLOCK *block, int maxPings);
+
+//Locate the beams of pings firstPing .. lastPing-1 of a block as place_beam2 would.
+//Outputs are indexed like the beam columns.  Ignored beams are set to NONSENSE.
+//Pings may be located by several threads at once as long as their ranges do not overlap.
+void place_ping_block(const GSF_PING_BLOCK *block, int firstPing, int lastPing, int prime_meridian,
+			double *lonmin, double *latmin, double *depth);
+
 #endif
 
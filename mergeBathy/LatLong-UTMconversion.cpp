@@ -13,6 +13,13 @@
 #include <cstdlib>
 #include "constants.h"
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
 
 /*Reference ellipsoids derived from Peter H. Dana's website-
 http://www.utexas.edu/depts/grg/gcraft/notes/datum/elist.html
@@ -24,44 +31,46 @@ Source
 Defense Mapping Agency. 1987b. DMA Technical Report: Supplement to Department of Defense World Geodetic System
 1984 Technical Report. Part I and II. Washington, DC: Defense Mapping Agency
 */
-
-void LLtoUTM(int ReferenceEllipsoid, const double Lat, const double Long, double &UTMNorthing, double &UTMEasting, char* UTMZone, const double meanLong)
+//The table is built once rather than on every conversion.
+static const Ellipsoid ellipsoidTable[] =
+{//  id, Ellipsoid name, Equatorial Radius, square of eccentricity
+Ellipsoid( -1, "Placeholder", 0, 0),//placeholder only, To allow array indices to match id numbers
+Ellipsoid( 1, "Airy", 6377563, 0.00667054),
+Ellipsoid( 2, "Australian National", 6378160, 0.006694542),
+Ellipsoid( 3, "Bessel 1841", 6377397, 0.006674372),
+Ellipsoid( 4, "Bessel 1841 (Nambia) ", 6377484, 0.006674372),
+Ellipsoid( 5, "Clarke 1866", 6378206, 0.006768658),
+Ellipsoid( 6, "Clarke 1880", 6378249, 0.006803511),
+Ellipsoid( 7, "Everest", 6377276, 0.006637847),
+Ellipsoid( 8, "Fischer 1960 (Mercury) ", 6378166, 0.006693422),
+Ellipsoid( 9, "Fischer 1968", 6378150, 0.006693422),
+Ellipsoid( 10, "GRS 1967", 6378160, 0.006694605),
+Ellipsoid( 11, "GRS 1980", 6378137, 0.00669438),
+Ellipsoid( 12, "Helmert 1906", 6378200, 0.006693422),
+Ellipsoid( 13, "Hough", 6378270, 0.00672267),
+Ellipsoid( 14, "International", 6378388, 0.00672267),
+Ellipsoid( 15, "Krassovsky", 6378245, 0.006693422),
+Ellipsoid( 16, "Modified Airy", 6377340, 0.00667054),
+Ellipsoid( 17, "Modified Everest", 6377304, 0.006637847),
+Ellipsoid( 18, "Modified Fischer 1960", 6378155, 0.006693422),
+Ellipsoid( 19, "South American 1969", 6378160, 0.006694542),
+Ellipsoid( 20, "WGS 60", 6378165, 0.006693422),
+Ellipsoid( 21, "WGS 66", 6378145, 0.006694542),
+Ellipsoid( 22, "WGS-72", 6378135, 0.006694318),
+Ellipsoid( 23, "WGS-84", 6378137, 0.00669437999014)
+};
+
+
+void LLtoUTM(int ReferenceEllipsoid, const double Lat, const double Long, double &UTMNorthing, double &UTMEasting, char* UTMZone)
 {
 	//converts lat/long to UTM coords.  Equations from USGS Bulletin 1532
 	//East Longitudes are positive, West longitudes are negative.
 	//North latitudes are positive, South latitudes are negative
 	//Lat and Long are in decimal degrees
 	//Written by Chuck Gantz- chuck.gantz@globalstar.com
-	Ellipsoid ellipsoid[] =
-	{//  id, Ellipsoid name, Equatorial Radius, square of eccentricity
-	Ellipsoid( -1, "Placeholder", 0, 0),//placeholder only, To allow array indices to match id numbers
-	Ellipsoid( 1, "Airy", 6377563, 0.00667054),
-	Ellipsoid( 2, "Australian National", 6378160, 0.006694542),
-	Ellipsoid( 3, "Bessel 1841", 6377397, 0.006674372),
-	Ellipsoid( 4, "Bessel 1841 (Nambia) ", 6377484, 0.006674372),
-	Ellipsoid( 5, "Clarke 1866", 6378206, 0.006768658),
-	Ellipsoid( 6, "Clarke 1880", 6378249, 0.006803511),
-	Ellipsoid( 7, "Everest", 6377276, 0.006637847),
-	Ellipsoid( 8, "Fischer 1960 (Mercury) ", 6378166, 0.006693422),
-	Ellipsoid( 9, "Fischer 1968", 6378150, 0.006693422),
-	Ellipsoid( 10, "GRS 1967", 6378160, 0.006694605),
-	Ellipsoid( 11, "GRS 1980", 6378137, 0.00669438),
-	Ellipsoid( 12, "Helmert 1906", 6378200, 0.006693422),
-	Ellipsoid( 13, "Hough", 6378270, 0.00672267),
-	Ellipsoid( 14, "International", 6378388, 0.00672267),
-	Ellipsoid( 15, "Krassovsky", 6378245, 0.006693422),
-	Ellipsoid( 16, "Modified Airy", 6377340, 0.00667054),
-	Ellipsoid( 17, "Modified Everest", 6377304, 0.006637847),
-	Ellipsoid( 18, "Modified Fischer 1960", 6378155, 0.006693422),
-	Ellipsoid( 19, "South American 1969", 6378160, 0.006694542),
-	Ellipsoid( 20, "WGS 60", 6378165, 0.006693422),
-	Ellipsoid( 21, "WGS 66", 6378145, 0.006694542),
-	Ellipsoid( 22, "WGS-72", 6378135, 0.006694318),
-	Ellipsoid( 23, "WGS-84", 6378137, 0.00669437999014)
-	};
-
-	double a = ellipsoid[ReferenceEllipsoid].EquatorialRadius;
-	double eccSquared = ellipsoid[ReferenceEllipsoid].eccentricitySquared;
+
+	double a = ellipsoidTable[ReferenceEllipsoid].EquatorialRadius;
+	double eccSquared = ellipsoidTable[ReferenceEllipsoid].eccentricitySquared;
 	double k0 = 0.9996;
 
 	double LongOrigin;
@@ -81,11 +90,11 @@ void LLtoUTM(int ReferenceEllipsoid, const double Lat, const double Long, double
 	int		tempLoop	= 0;
 	char zChar;
 	//Find UTM Zone
-	if(*UTMZone!=NULL) // SJZ
+	if(*UTMZone!='\0') // SJZ
 	{
 		char ZoneNum[4];
 		int end=strlen(UTMZone)-1;
-		strncpy(ZoneNum,UTMZone,end);
+		memcpy(ZoneNum,UTMZone,end);
 		ZoneNum[end] = '\0';
 		ZoneNumber=(int)strtol(ZoneNum,(char **)NULL, 10);
 		zChar=(UTMZone)[end];
@@ -207,57 +216,24 @@ void UTMtoLL(int ReferenceEllipsoid, const double UTMNorthing, const double UTME
 	//North latitudes are positive, South latitudes are negative
 	//Lat and Long are in decimal degrees.
 	//Written by Chuck Gantz- chuck.gantz@globalstar.com
-	Ellipsoid ellipsoid[] =
-	{//  id, Ellipsoid name, Equatorial Radius, square of eccentricity
-	Ellipsoid( -1, "Placeholder", 0, 0),//placeholder only, To allow array indices to match id numbers
-	Ellipsoid( 1, "Airy", 6377563, 0.00667054),
-	Ellipsoid( 2, "Australian National", 6378160, 0.006694542),
-	Ellipsoid( 3, "Bessel 1841", 6377397, 0.006674372),
-	Ellipsoid( 4, "Bessel 1841 (Nambia) ", 6377484, 0.006674372),
-	Ellipsoid( 5, "Clarke 1866", 6378206, 0.006768658),
-	Ellipsoid( 6, "Clarke 1880", 6378249, 0.006803511),
-	Ellipsoid( 7, "Everest", 6377276, 0.006637847),
-	Ellipsoid( 8, "Fischer 1960 (Mercury) ", 6378166, 0.006693422),
-	Ellipsoid( 9, "Fischer 1968", 6378150, 0.006693422),
-	Ellipsoid( 10, "GRS 1967", 6378160, 0.006694605),
-	Ellipsoid( 11, "GRS 1980", 6378137, 0.00669438),
-	Ellipsoid( 12, "Helmert 1906", 6378200, 0.006693422),
-	Ellipsoid( 13, "Hough", 6378270, 0.00672267),
-	Ellipsoid( 14, "International", 6378388, 0.00672267),
-	Ellipsoid( 15, "Krassovsky", 6378245, 0.006693422),
-	Ellipsoid( 16, "Modified Airy", 6377340, 0.00667054),
-	Ellipsoid( 17, "Modified Everest", 6377304, 0.006637847),
-	Ellipsoid( 18, "Modified Fischer 1960", 6378155, 0.006693422),
-	Ellipsoid( 19, "South American 1969", 6378160, 0.006694542),
-	Ellipsoid( 20, "WGS 60", 6378165, 0.006693422),
-	Ellipsoid( 21, "WGS 66", 6378145, 0.006694542),
-	Ellipsoid( 22, "WGS-72", 6378135, 0.006694318),
-	Ellipsoid( 23, "WGS-84", 6378137, 0.00669437999014)
-	};
 	double k0 = 0.9996;
-	double a = ellipsoid[ReferenceEllipsoid].EquatorialRadius;
-	double eccSquared = ellipsoid[ReferenceEllipsoid].eccentricitySquared;
+	double a = ellipsoidTable[ReferenceEllipsoid].EquatorialRadius;
+	double eccSquared = ellipsoidTable[ReferenceEllipsoid].eccentricitySquared;
 	double eccPrimeSquared;
 	double e1 = (1.00-sqrt(1.00-eccSquared))/(1.00+sqrt(1.00-eccSquared));
 	double N1, T1, C1, R1, D, M;
 	double LongOrigin;
-	double mu, phi1, phi1Rad;
+	double mu, phi1Rad;
 	double x, y;
 	int ZoneNumber;
 	char* ZoneLetter;
-	int NorthernHemisphere; //1 for northern hemisphere, 0 for southern
 
 	x = UTMEasting - 500000.00; //remove 500,000 meter offset for longitude
 	y = UTMNorthing;
 
 	ZoneNumber = strtoul(UTMZone, &ZoneLetter, 10);
-	if((*ZoneLetter - 'N') >= 0)
-		NorthernHemisphere = 1;//point is in northern hemisphere
-	else
-	{
-		NorthernHemisphere = 0;//point is in southern hemisphere
-		y -= 10000000.0;//remove 10,000,000 meter offset used for southern hemisphere
-	}
+	if((*ZoneLetter - 'N') < 0)
+		y -= 10000000.0;//point is in southern hemisphere, remove 10,000,000 meter offset
 
 	LongOrigin = (ZoneNumber - 1)*6.00 - 180.00 + 3.00;  //+3 puts origin in middle of zone
 
@@ -269,7 +245,6 @@ void UTMtoLL(int ReferenceEllipsoid, const double UTMNorthing, const double UTME
 	phi1Rad = mu	+ (3.00*e1/2.00-27.00*e1*e1*e1/32.00)*std::sin(2.00*mu)
 				+ (21.00*e1*e1/16.00-55.00*e1*e1*e1*e1/32.00)*std::sin(4.00*mu)
 				+(151.00*e1*e1*e1/96.00)*std::sin(6.00*mu);
-	phi1 = phi1Rad*rad2deg;
 
 	N1 = a/sqrt(1.00-eccSquared*std::sin(phi1Rad)*std::sin(phi1Rad));
 	T1 = std::tan(phi1Rad)*std::tan(phi1Rad);
@@ -286,6 +261,221 @@ void UTMtoLL(int ReferenceEllipsoid, const double UTMNorthing, const double UTME
 	Long = LongOrigin + Long * rad2deg;
 }
 
+//************************************************************************************
+// Batch conversions.  The same equations as LLtoUTM and UTMtoLL with the ellipsoid and
+// zone terms computed once per zone and each trig function of a point evaluated once.
+// The expressions are kept term for term so the results match the per point routines.
+//************************************************************************************
+UTMProjection::UTMProjection(int ReferenceEllipsoid, const char* UTMZone)
+{
+	char ZoneNum[4];
+	char* ZoneLetter;
+	char zChar;
+	int end = strlen(UTMZone)-1;
+	int ZoneNumber;
+
+	k0 = 0.9996;
+	a = ellipsoidTable[ReferenceEllipsoid].EquatorialRadius;
+	eccSquared = ellipsoidTable[ReferenceEllipsoid].eccentricitySquared;
+	eccPrimeSquared = (eccSquared)/(1.00-eccSquared);
+	e1 = (1.00-sqrt(1.00-eccSquared))/(1.00+sqrt(1.00-eccSquared));
+
+	//The zone is read the way LLtoUTM reads it: the number, then the letter.
+	strncpy(ZoneNum, UTMZone, end);
+	ZoneNum[end] = '\0';
+	ZoneNumber = (int)strtol(ZoneNum, (char **)NULL, 10);
+	zChar = UTMZone[end];
+	LongOriginRad = ((ZoneNumber - 1)*6.00 - 180.00 + 3.00) * deg2rad;
+	southernZone = (zChar != '9' && zChar != 'Z' && zChar <= 'M');
+
+	//and the way UTMtoLL reads it.
+	ZoneNumber = strtoul(UTMZone, &ZoneLetter, 10);
+	inverseLongOrigin = (ZoneNumber - 1)*6.00 - 180.00 + 3.00;
+	inverseSouthernZone = ((*ZoneLetter - 'N') < 0);
+
+	//Meridian arc series
+	M0 = 1.00	- eccSquared/4.00		- 3.00*eccSquared*eccSquared/64.00	- 5.00*eccSquared*eccSquared*eccSquared/256.00;
+	M2 = 3.00*eccSquared/8.00	+ 3.00*eccSquared*eccSquared/32.00	+ 45.00*eccSquared*eccSquared*eccSquared/1024.00;
+	M4 = 15.00*eccSquared*eccSquared/256.00 + 45.00*eccSquared*eccSquared*eccSquared/1024.00;
+	M6 = 35.00*eccSquared*eccSquared*eccSquared/3072.00;
+	E58 = 58.00*eccPrimeSquared;
+	E330 = 330.00*eccPrimeSquared;
+
+	//Footpoint latitude series
+	muDenominator = a*(1.00-eccSquared/4.00-3.00*eccSquared*eccSquared/64.00-5.00*eccSquared*eccSquared*eccSquared/256.00);
+	P2 = 3.00*e1/2.00-27.00*e1*e1*e1/32.00;
+	P4 = 21.00*e1*e1/16.00-55.00*e1*e1*e1*e1/32.00;
+	P6 = 151.00*e1*e1*e1/96.00;
+	R1Numerator = a*(1.00-eccSquared);
+	E9 = 9.00*eccPrimeSquared;
+	E252 = 252.00*eccPrimeSquared;
+	E8 = 8.00*eccPrimeSquared;
+}
+
+void UTMProjection::toUTM(const double *Lat, const double *Long, double *UTMNorthing, double *UTMEasting, int n) const
+{
+	double LatRad, LongRad, sinLat, cosLat, tanLat;
+	double N, T, C, A, M;
+
+	for (int i = 0; i < n; i++)
+	{
+		LatRad = Lat[i]*deg2rad;
+		LongRad = Long[i]*deg2rad;
+		sinLat = std::sin(LatRad);
+		cosLat = std::cos(LatRad);
+		tanLat = std::tan(LatRad);
+
+		N = a/sqrt(1.00-eccSquared*sinLat*sinLat);
+		T = tanLat*tanLat;
+		C = eccPrimeSquared*cosLat*cosLat;
+		A = cosLat*(LongRad-LongOriginRad);
+		M = a*(M0*LatRad - M2*std::sin(2.00*LatRad) + M4*std::sin(4.00*LatRad) - M6*std::sin(6.00*LatRad));
+
+		UTMEasting[i] = (double)(k0*N*(A+(1.00-T+C)*A*A*A/6.00
+						+ (5.00-18.00*T+T*T+72.00*C-E58)*A*A*A*A*A/120.00)
+						+ 500000.00); // 500000 False Easting at Origin
+		UTMNorthing[i] = (double)(k0*(M+N*tanLat*(A*A/2.00+(5.00-T+9.00*C+4.00*C*C)*A*A*A*A/24.00
+					 + (61.00-58.00*T+T*T+600.00*C-E330)*A*A*A*A*A*A/720.00)));
+		if (southernZone)
+			UTMNorthing[i] += 10000000.0; // False Northing at Origin
+	}
+}
+
+void UTMProjection::toLL(const double *UTMNorthing, const double *UTMEasting, double *Lat, double *Long, int n) const
+{
+	double x, y, mu, phi1Rad, sinPhi, cosPhi, tanPhi;
+	double N1, T1, C1, R1, D;
+
+	for (int i = 0; i < n; i++)
+	{
+		x = UTMEasting[i] - 500000.00; //remove 500,000 meter offset for longitude
+		y = UTMNorthing[i];
+		if (inverseSouthernZone)
+			y -= 10000000.0; //remove 10,000,000 meter offset used for southern hemisphere
+
+		mu = (y / k0)/muDenominator;
+		phi1Rad = mu + P2*std::sin(2.00*mu) + P4*std::sin(4.00*mu) + P6*std::sin(6.00*mu);
+		sinPhi = std::sin(phi1Rad);
+		cosPhi = std::cos(phi1Rad);
+		tanPhi = std::tan(phi1Rad);
+
+		N1 = a/sqrt(1.00-eccSquared*sinPhi*sinPhi);
+		T1 = tanPhi*tanPhi;
+		C1 = eccPrimeSquared*cosPhi*cosPhi;
+		R1 = R1Numerator/pow(1.00-eccSquared*sinPhi*sinPhi, 1.50);
+		D = x/(N1*k0);
+
+		Lat[i] = (phi1Rad - (N1*tanPhi/R1)*(D*D/2-(5.00+3.00*T1+10.00*C1-4.00*C1*C1-E9)*D*D*D*D/24.00
+						+(61.00+90.00*T1+298.00*C1+45.00*T1*T1-E252-3.00*C1*C1)*D*D*D*D*D*D/720.00)) * rad2deg;
+		Long[i] = inverseLongOrigin + ((D-(1+2*T1+C1)*D*D*D/6.00+(5.00-2.00*C1+28.00*T1-3.00*C1*C1+E8+24.00*T1*T1)
+						*D*D*D*D*D/120.00)/cosPhi) * rad2deg;
+	}
+}
+
+//A contiguous block of points converted by one thread.
+typedef struct
+{
+	const UTMProjection *projection;
+	const double *in1;
+	const double *in2;
+	double *out1;
+	double *out2;
+	int n;
+	bool inverse;
+} UTM_BLOCK;
+
+static void convertBlock(UTM_BLOCK *block)
+{
+	if ((*block).inverse)
+		(*(*block).projection).toLL((*block).in1, (*block).in2, (*block).out1, (*block).out2, (*block).n);
+	else
+		(*(*block).projection).toUTM((*block).in1, (*block).in2, (*block).out1, (*block).out2, (*block).n);
+}
+
+#ifdef WIN32
+static DWORD WINAPI convertBlockThread(LPVOID lpParam)
+#else
+static void *convertBlockThread(void *lpParam)
+#endif
+{
+	convertBlock((UTM_BLOCK *)lpParam);
+	return 0;
+}
+
+//Splits the points into one block per thread.  Small batches are not worth a thread.
+static void convertBlocks(const UTMProjection &projection, const double *in1, const double *in2, double *out1, double *out2, int n, bool inverse, int numThreads)
+{
+	const int minPointsPerThread = 65536;
+	int numBlocks = std::min(std::max(numThreads, 1), std::max(n / minPointsPerThread, 1));
+	int begin, end;
+	std::vector<UTM_BLOCK> blocks(numBlocks);
+	std::vector<bool> started(numBlocks, false);
+#ifdef WIN32
+	std::vector<HANDLE> threads(numBlocks);
+#else
+	std::vector<pthread_t> threads(numBlocks);
+#endif
+
+	for (int t = 0; t < numBlocks; t++)
+	{
+		begin = (int)(((long long)n * t) / numBlocks);
+		end = (int)(((long long)n * (t + 1)) / numBlocks);
+		blocks[t].projection = &projection;
+		blocks[t].in1 = in1 + begin;
+		blocks[t].in2 = in2 + begin;
+		blocks[t].out1 = out1 + begin;
+		blocks[t].out2 = out2 + begin;
+		blocks[t].n = end - begin;
+		blocks[t].inverse = inverse;
+	}
+	for (int t = 1; t < numBlocks; t++)
+	{
+#ifdef WIN32
+		threads[t] = CreateThread(NULL, 0, convertBlockThread, &blocks[t], 0, NULL);
+		started[t] = (threads[t] != NULL);
+#else
+		started[t] = (pthread_create(&threads[t], NULL, convertBlockThread, &blocks[t]) == 0);
+#endif
+	}
+	convertBlock(&blocks[0]);
+	for (int t = 1; t < numBlocks; t++)
+	{
+		if (started[t])
+		{
+#ifdef WIN32
+			WaitForSingleObject(threads[t], INFINITE);
+			CloseHandle(threads[t]);
+#else
+			pthread_join(threads[t], NULL);
+#endif
+		}
+		else
+			convertBlock(&blocks[t]);
+	}
+}
+
+void LLtoUTM(int ReferenceEllipsoid, const double *Lat, const double *Long, double *UTMNorthing, double *UTMEasting, int n, char* UTMZone, int numThreads)
+{
+	if (n <= 0)
+		return;
+
+	//Fix the zone from the first point, then normalize it as LLtoUTM does.
+	double northing, easting;
+	LLtoUTM(ReferenceEllipsoid, Lat[0], Long[0], northing, easting, UTMZone);
+
+	UTMProjection projection(ReferenceEllipsoid, UTMZone);
+	convertBlocks(projection, Lat, Long, UTMNorthing, UTMEasting, n, false, numThreads);
+}
+
+void UTMtoLL(int ReferenceEllipsoid, const double *UTMNorthing, const double *UTMEasting, double *Lat, double *Long, int n, const char* UTMZone, int numThreads)
+{
+	if (n <= 0)
+		return;
+
+	UTMProjection projection(ReferenceEllipsoid, UTMZone);
+	convertBlocks(projection, UTMNorthing, UTMEasting, Lat, Long, n, true, numThreads);
+}
+
 #if _DISABLE_3RDPARTY_WARNINGS
 	#pragma warning( pop )			//Restore warning state
 #endif
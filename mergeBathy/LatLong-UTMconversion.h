@@ -18,12 +18,23 @@ converts from UTM coordinates to lat lon
 
 //Convert from Lat/Lon coordinates to UTM coordinates
 void LLtoUTM(int ReferenceEllipsoid, const double Lat, const double Long, 
-			 double &UTMNorthing, double &UTMEasting, char* UTMZone, const double meanLong);
+			 double &UTMNorthing, double &UTMEasting, char* UTMZone);
 
 //Convert from UTM coordinates to Lat/Lon coordinates 
 void UTMtoLL(int ReferenceEllipsoid, const double UTMNorthing, const double UTMEasting, const char* UTMZone,
 			  double& Lat,  double& Long );
 
+//Convert arrays of Lat/Lon coordinates to UTM coordinates in one zone.
+//An empty UTMZone is set from the first point.  The outputs may be the input arrays.
+//Large batches are split over numThreads threads.
+void LLtoUTM(int ReferenceEllipsoid, const double *Lat, const double *Long,
+			 double *UTMNorthing, double *UTMEasting, int n, char* UTMZone, int numThreads);
+
+//Convert arrays of UTM coordinates in one zone to Lat/Lon coordinates.
+//The outputs may be the input arrays.  Large batches are split over numThreads threads.
+void UTMtoLL(int ReferenceEllipsoid, const double *UTMNorthing, const double *UTMEasting,
+			  double *Lat, double *Long, int n, const char* UTMZone, int numThreads);
+
 char UTMLetterDesignator(double Lat);
 
 //Define the basic ellipsoid class for use in converting between coordinate systems.
@@ -31,14 +42,14 @@ class Ellipsoid
 {
 public:
 	Ellipsoid(){};
-	Ellipsoid(int Id, char* name, double radius, double ecc)
+	Ellipsoid(int Id, const char* name, double radius, double ecc)
 	{
 		id = Id; ellipsoidName = name; 
 		EquatorialRadius = radius; eccentricitySquared = ecc;
 	}
 
 	int id;
-	char* ellipsoidName;
+	const char* ellipsoidName;
 	double EquatorialRadius; 
 	double eccentricitySquared;  
 
@@ -46,4 +57,46 @@ public:
 
 
 
+/**
+* A UTM zone on a reference ellipsoid with the ellipsoid and zone constants of the
+* conversion computed once, so that blocks of points can be converted in a tight loop.
+*/
+class UTMProjection
+{
+public:
+	/**
+	* A constructor for UTMProjection.
+	* @param ReferenceEllipsoid - Index of the reference ellipsoid.
+	* @param UTMZone - The zone, e.g. "16R".
+	*/
+	UTMProjection(int ReferenceEllipsoid, const char* UTMZone);
+
+	/**
+	* Converts Lat/Lon coordinates to UTM coordinates in the zone.
+	* @param Lat - Latitudes in decimal degrees.
+	* @param Long - Longitudes in decimal degrees.
+	* @param UTMNorthing - UTM Northings. (Returned).
+	* @param UTMEasting - UTM Eastings. (Returned).
+	* @param n - Number of points.
+	*/
+	void toUTM(const double *Lat, const double *Long, double *UTMNorthing, double *UTMEasting, int n) const;
+
+	/**
+	* Converts UTM coordinates in the zone to Lat/Lon coordinates.
+	* @param UTMNorthing - UTM Northings.
+	* @param UTMEasting - UTM Eastings.
+	* @param Lat - Latitudes in decimal degrees. (Returned).
+	* @param Long - Longitudes in decimal degrees. (Returned).
+	* @param n - Number of points.
+	*/
+	void toLL(const double *UTMNorthing, const double *UTMEasting, double *Lat, double *Long, int n) const;
+
+private:
+	double k0, a, eccSquared, eccPrimeSquared, e1;
+	double LongOriginRad, inverseLongOrigin;
+	bool southernZone, inverseSouthernZone;
+	double M0, M2, M4, M6, E58, E330;
+	double muDenominator, P2, P4, P6, R1Numerator, E9, E252, E8;
+};
+
 //#endif
@@ -1,5 +1,6 @@
 #include "MB_Threads.h"
 #include "scalecInterp.h"
+#include <algorithm>
 
 // SJZ Added 1/22/15
 //#include <tchar.h>
@@ -25,19 +26,12 @@ void *threadInterp6( void *lpParam );
 void *threadInterpKrig( void *lpParam );
 void *threadInterpTile( void *lpParam );
 void *threadInterpTileKrig( void *lpParam );
-void *SuspendThread();
-void *ResumeThread();
-timespec time_ns = {0, 50*1000*1000};
-pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t  cond = PTHREAD_COND_INITIALIZER;
-int play = 0;
 #endif
 
 //************************************************************************************
-// I. Set up local variables that can be used for tracking
+// I. Each thread is handed its number and the thread count in an MB_THREAD_ARG, so
+//	several mbThreads may run at once without sharing any state.
 //************************************************************************************
-map<int,int> locationThreadMap;
-int numTotalThreads;
 
 //************************************************************************************
 // II. Constructor for mbThreads
@@ -61,9 +55,13 @@ void mbThreads::makeMBThread(SCALEC_TILE_DATA_POINTER stdp)
 {
 	pDataArray = vector<SCALEC_TILE_DATA>(numTotalThreads);
 	pDataArray2 = vector<SCALEC_DATA>();
+	threadArgs = vector<MB_THREAD_ARG>(numTotalThreads);
 	for (int i = 0; i < numTotalThreads; i++)
 	{
 		pDataArray[i] = *stdp;
+		threadArgs[i].data = &pDataArray[i];
+		threadArgs[i].threadNum = i;
+		threadArgs[i].numThreads = numTotalThreads;
 	}
 }
 
@@ -74,9 +72,13 @@ void mbThreads::makeMBThread(SCALEC_DATA_POINTER sdp)
 {
 	pDataArray = vector<SCALEC_TILE_DATA>();
 	pDataArray2 = vector<SCALEC_DATA>(numTotalThreads);
+	threadArgs = vector<MB_THREAD_ARG>(numTotalThreads);
 	for (int i = 0; i < numTotalThreads; i++)
 	{
 		pDataArray2[i] = *sdp;
+		threadArgs[i].data = &pDataArray2[i];
+		threadArgs[i].threadNum = i;
+		threadArgs[i].numThreads = numTotalThreads;
 	}
 }
 
@@ -94,10 +96,9 @@ void mbThreads::initMBThread_Tile(int runType)
 				NULL,					// default security attributes
 				0,						// use default stack size
 				threadInterpTile,	    // thread function name
-				&pDataArray[i],			// argument to thread function
+				&threadArgs[i],			// argument to thread function
 				CREATE_SUSPENDED,		// use default creation flags
 				&dwThreadIdArray[i]);	// returns the thread identifier
-			locationThreadMap[dwThreadIdArray[i]] = i;
 			ResumeThread(hThreadArray[i]);
 
 			// Check the return value for success.
@@ -117,10 +118,9 @@ void mbThreads::initMBThread_Tile(int runType)
 				NULL,				   // default security attributes
 				0,					   // use default stack size
 				threadInterpTileKrig,  // thread function name
-				&pDataArray[i],		   // argument to thread function
+				&threadArgs[i],		   // argument to thread function
 				CREATE_SUSPENDED,	   // use default creation flags
 				&dwThreadIdArray[i]);  // returns the thread identifier
-			locationThreadMap[dwThreadIdArray[i]] = i;
 			ResumeThread(hThreadArray[i]);
 
 			// Check the return value for success.
@@ -138,19 +138,13 @@ void mbThreads::initMBThread_Tile(int runType)
 	{
 		for (int i = 0; i < numTotalThreads; i++)
 		{
-			SuspendThread();
 			//fprintf(stderr,"i %d\n",i);
 			//cout<<"i "<<i<<endl;
 
-			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterpTile, (void *) &pDataArray[i]);
-			locationThreadMap[hThreadArray[i]] = i;
+			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterpTile, (void *) &threadArgs[i]);
 			
 			//fprintf(stderr,"ID %d\n",hThreadArray[i]);
 			//cout<<"ID "<<pthread_self()<<endl;
-			ResumeThread();
-			// Sleep to allow thread to run before suspending again.  This
-			// is not necessary but added to see suspension and resume.
-			nanosleep(&time_ns, NULL); 
 
 			if(dwThreadIdArray[i])
 			{
@@ -162,11 +156,7 @@ void mbThreads::initMBThread_Tile(int runType)
 	{
 		for (int i = 0; i < numTotalThreads; i++)
 		{
-			SuspendThread();
-			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterpTileKrig, (void *) &pDataArray[i]);
-			locationThreadMap[hThreadArray[i]] = i;
-			ResumeThread();
-			nanosleep(&time_ns, NULL); 
+			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterpTileKrig, (void *) &threadArgs[i]);
 			if(dwThreadIdArray[i])
 			{
 				fprintf(stderr,"Error - pthread_create() return code: %d\n %s",dwThreadIdArray[i], strerror(dwThreadIdArray[i]));
@@ -191,10 +181,9 @@ void mbThreads::initMBThread(int runType)
 				NULL,				    // default security attributes
 				0,					    // use default stack size
 				threadInterp,			// thread function name
-				&pDataArray2[i],		// argument to thread function
+				&threadArgs[i],		// argument to thread function
 				CREATE_SUSPENDED,	    // use default creation flags
 				&dwThreadIdArray[i]);   // returns the thread identifier
-			locationThreadMap[dwThreadIdArray[i]] = i;
 			ResumeThread(hThreadArray[i]);
 
 			// Check the return value for success.
@@ -217,10 +206,9 @@ void mbThreads::initMBThread(int runType)
 				NULL,				   // default security attributes
 				0,					   // use default stack size
 				threadInterpKrig,	   // thread function name
-				&pDataArray2[i],	   // argument to thread function
+				&threadArgs[i],	   // argument to thread function
 				CREATE_SUSPENDED,	   // use default creation flags
 				&dwThreadIdArray[i]);  // returns the thread identifier
-			locationThreadMap[dwThreadIdArray[i]] = i;
 			ResumeThread(hThreadArray[i]);
 
 			// Check the return value for success.
@@ -238,11 +226,7 @@ void mbThreads::initMBThread(int runType)
 	{
 		for (int i = 0; i < numTotalThreads; i++)
 		{
-			SuspendThread();
-			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterp, (void *) &pDataArray2[i]);
-			locationThreadMap[hThreadArray[i]] = i;
-			ResumeThread();
-			nanosleep(&time_ns, NULL); 
+			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterp, (void *) &threadArgs[i]);
 			if(dwThreadIdArray[i])
 			{
 				fprintf(stderr,"Error - pthread_create() return code: %d\n %s",dwThreadIdArray[i], strerror(dwThreadIdArray[i]));
@@ -253,11 +237,7 @@ void mbThreads::initMBThread(int runType)
 	{
 		for (int i = 0; i < numTotalThreads; i++)
 		{
-			SuspendThread();
-			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterpKrig, (void *) &pDataArray2[i]);
-			locationThreadMap[hThreadArray[i]] = i;
-			ResumeThread();
-			nanosleep(&time_ns, NULL); 
+			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterpKrig, (void *) &threadArgs[i]);
 			if(dwThreadIdArray[i])
 			{
 				fprintf(stderr,"Error - pthread_create() return code: %d\n %s",dwThreadIdArray[i], strerror(dwThreadIdArray[i]));
@@ -280,10 +260,9 @@ void mbThreads::initMBThread2(int runType)
 				NULL,				    // default security attributes
 				0,					    // use default stack size
 				threadInterp2,			// thread function name
-				&pDataArray2[i],		// argument to thread function
+				&threadArgs[i],		// argument to thread function
 				CREATE_SUSPENDED,	    // use default creation flags
 				&dwThreadIdArray[i]);   // returns the thread identifier
-			locationThreadMap[dwThreadIdArray[i]] = i;
 			ResumeThread(hThreadArray[i]);
 
 			// Check the return value for success.
@@ -301,11 +280,7 @@ void mbThreads::initMBThread2(int runType)
 	{
 		for (int i = 0; i < numTotalThreads; i++)
 		{
-			SuspendThread();
-			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterp2, (void *) &pDataArray2[i]);
-			locationThreadMap[hThreadArray[i]] = i;
-			ResumeThread();
-			nanosleep(&time_ns, NULL); 
+			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterp2, (void *) &threadArgs[i]);
 			if(dwThreadIdArray[i])
 			{
 				fprintf(stderr,"Error - pthread_create() return code: %d\n %s",dwThreadIdArray[i], strerror(dwThreadIdArray[i]));
@@ -326,10 +301,9 @@ void mbThreads::initMBThread6(int runType)
 				NULL,				    // default security attributes
 				0,					    // use default stack size
 				threadInterp6,			// thread function name
-				&pDataArray2[i],		// argument to thread function
+				&threadArgs[i],		// argument to thread function
 				CREATE_SUSPENDED,	    // use default creation flags
 				&dwThreadIdArray[i]);   // returns the thread identifier
-			locationThreadMap[dwThreadIdArray[i]] = i;
 			ResumeThread(hThreadArray[i]);
 
 			// Check the return value for success.
@@ -347,11 +321,7 @@ void mbThreads::initMBThread6(int runType)
 	{
 		for (int i = 0; i < numTotalThreads; i++)
 		{
-			SuspendThread();
-			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterp6, (void *) &pDataArray2[i]);
-			locationThreadMap[hThreadArray[i]] = i;
-			ResumeThread();
-			nanosleep(&time_ns, NULL); 
+			dwThreadIdArray[i] = pthread_create( &hThreadArray[i], NULL, threadInterp6, (void *) &threadArgs[i]);
 			if(dwThreadIdArray[i])
 			{
 				fprintf(stderr,"Error - pthread_create() return code: %d\n %s",dwThreadIdArray[i], strerror(dwThreadIdArray[i]));
@@ -396,7 +366,7 @@ void mbThreads::terminateMBThread()
 	hThreadArray.clear();
 	pDataArray.clear();
 	pDataArray2.clear();
-	locationThreadMap.clear();
+	threadArgs.clear();
 }
 
 #ifdef WIN32
@@ -406,42 +376,45 @@ void mbThreads::terminateMBThread()
 //************************************************************************************
 DWORD WINAPI threadInterp(LPVOID lpParam)
 {
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
 	SCALEC_DATA_POINTER pda;
 
 	// Cast the parameter to the correct data type.
 	// The pointer is known to be valid because
 	// it was checked for NULL before the thread was created.
 
-	pda = (SCALEC_DATA_POINTER)lpParam;
-	int flag = scalecInterp_Process(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	int flag = scalecInterp_Process(pda, (*arg).threadNum, (*arg).numThreads);
 
 	return 0;
 }
 DWORD WINAPI threadInterp2(LPVOID lpParam)
 {
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
 	SCALEC_DATA_POINTER pda;
 
 	// Cast the parameter to the correct data type.
 	// The pointer is known to be valid because
 	// it was checked for NULL before the thread was created.
 
-	pda = (SCALEC_DATA_POINTER)lpParam;
-	//int flag = scalecInterp_Process2A(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);//handles w and w/o kriging
-	int flag = scalecInterp_Process4A(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);//handles w and w/o kriging
-//	int flag = scalecInterp_Process2(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);//part 2 w/o kriging
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	//int flag = scalecInterp_Process2A(pda, (*arg).threadNum, (*arg).numThreads);//handles w and w/o kriging
+	int flag = scalecInterp_Process4A(pda, (*arg).threadNum, (*arg).numThreads);//handles w and w/o kriging
+//	int flag = scalecInterp_Process2(pda, (*arg).threadNum, (*arg).numThreads);//part 2 w/o kriging
 
 	return 0;
 }
 DWORD WINAPI threadInterp6(LPVOID lpParam)
 {
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
 	SCALEC_DATA_POINTER pda;
 
 	// Cast the parameter to the correct data type.
 	// The pointer is known to be valid because
 	// it was checked for NULL before the thread was created.
 
-	pda = (SCALEC_DATA_POINTER)lpParam;
-	int flag = scalecInterp_Process6A(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);//handles w and w/o kriging
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	int flag = scalecInterp_Process6A(pda, (*arg).threadNum, (*arg).numThreads);//handles w and w/o kriging
 
 	return 0;
 }
@@ -450,14 +423,15 @@ DWORD WINAPI threadInterp6(LPVOID lpParam)
 //************************************************************************************
 DWORD WINAPI threadInterpKrig(LPVOID lpParam)
 {
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
 	SCALEC_DATA_POINTER pda;
 
 	// Cast the parameter to the correct data type.
 	// The pointer is known to be valid because
 	// it was checked for NULL before the thread was created.
 
-	pda = (SCALEC_DATA_POINTER)lpParam;
-	int flag = scalecInterp_ProcessKrig(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	int flag = scalecInterp_ProcessKrig(pda, (*arg).threadNum, (*arg).numThreads);
 
 	return 0;
 }
@@ -467,15 +441,16 @@ DWORD WINAPI threadInterpKrig(LPVOID lpParam)
 //************************************************************************************
 DWORD WINAPI threadInterpTile(LPVOID lpParam)
 {
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
 	SCALEC_TILE_DATA_POINTER pda;
 
 	// Cast the parameter to the correct data type.
 	// The pointer is known to be valid because
 	// it was checked for NULL before the thread was created.
 	
-	pda = (SCALEC_TILE_DATA_POINTER)lpParam;
-	int flag = scalecInterpTile_ProcessA(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);
-//	int flag = scalecInterpTile_Process(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);
+	pda = (SCALEC_TILE_DATA_POINTER)(*arg).data;
+	int flag = scalecInterpTile_ProcessA(pda, (*arg).threadNum, (*arg).numThreads);
+//	int flag = scalecInterpTile_Process(pda, (*arg).threadNum, (*arg).numThreads);
 
 	return 0;
 }
@@ -485,6 +460,7 @@ DWORD WINAPI threadInterpTile(LPVOID lpParam)
 //************************************************************************************
 DWORD WINAPI threadInterpTileKrig(LPVOID lpParam)
 {
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
 	SCALEC_TILE_DATA_POINTER pda;
 
 	// Cast the parameter to the correct data type.
@@ -492,8 +468,8 @@ DWORD WINAPI threadInterpTileKrig(LPVOID lpParam)
 	// it was checked for NULL before the thread was created.
 
 	//Calling original function from mergeBathy v3.6 instead of the _Serial version for consistency.
-	pda = (SCALEC_TILE_DATA_POINTER)lpParam;
-	int flag = scalecInterpTile_ProcessKrig(pda, locationThreadMap[(int)GetCurrentThreadId()], numTotalThreads);
+	pda = (SCALEC_TILE_DATA_POINTER)(*arg).data;
+	int flag = scalecInterpTile_ProcessKrig(pda, (*arg).threadNum, (*arg).numThreads);
 
 	return 0;
 }
@@ -502,157 +478,235 @@ DWORD WINAPI threadInterpTileKrig(LPVOID lpParam)
 
 void *threadInterp(void *lpParam)
 {
-	for(;;) 
-	{
-		pthread_mutex_lock(&lock);
-		while(!play) { /* We're paused */
-			pthread_cond_wait(&cond, &lock); /* Wait for play signal */
-		}
-		pthread_mutex_unlock(&lock);
-		/* Continue */
-
-		SCALEC_DATA_POINTER pda;
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
+	SCALEC_DATA_POINTER pda;
 
-		// Cast the parameter to the correct data type.
-		// The pointer is known to be valid because
-		// it was checked for NULL before the thread was created.
+	// Cast the parameter to the correct data type.
+	// The pointer is known to be valid because
+	// it was checked for NULL before the thread was created.
 
-		pda = (SCALEC_DATA_POINTER)lpParam;
-		int flag = scalecInterp_Process(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	int flag = scalecInterp_Process(pda, (*arg).threadNum, (*arg).numThreads);
 
-		return 0;
-	}
+	return 0;
 }
 
 void *threadInterp2(void *lpParam)
 {
-	for(;;) 
-	{
-		pthread_mutex_lock(&lock);
-		while(!play) { /* We're paused */
-			pthread_cond_wait(&cond, &lock); /* Wait for play signal */
-		}
-		pthread_mutex_unlock(&lock);
-		/* Continue */
-
-		SCALEC_DATA_POINTER pda;
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
+	SCALEC_DATA_POINTER pda;
 
-		// Cast the parameter to the correct data type.
-		// The pointer is known to be valid because
-		// it was checked for NULL before the thread was created.
+	// Cast the parameter to the correct data type.
+	// The pointer is known to be valid because
+	// it was checked for NULL before the thread was created.
 
-		pda = (SCALEC_DATA_POINTER)lpParam;
-		int flag = scalecInterp_Process4A(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);//handles w and w/o kriging
-//		int flag = scalecInterp_Process2A(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);//handles w and w/o kriging
-//		int flag = scalecInterp_Process2(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	int flag = scalecInterp_Process4A(pda, (*arg).threadNum, (*arg).numThreads);//handles w and w/o kriging
 
-		return 0;
-	}
+	return 0;
 }
+
 void *threadInterp6(void *lpParam)
 {
-	for(;;) 
-	{
-		pthread_mutex_lock(&lock);
-		while(!play) { /* We're paused */
-			pthread_cond_wait(&cond, &lock); /* Wait for play signal */
-		}
-		pthread_mutex_unlock(&lock);
-		/* Continue */
-
-		SCALEC_DATA_POINTER pda;
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
+	SCALEC_DATA_POINTER pda;
 
-		// Cast the parameter to the correct data type.
-		// The pointer is known to be valid because
-		// it was checked for NULL before the thread was created.
+	// Cast the parameter to the correct data type.
+	// The pointer is known to be valid because
+	// it was checked for NULL before the thread was created.
 
-		pda = (SCALEC_DATA_POINTER)lpParam;
-		int flag = scalecInterp_Process6A(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);//handles w and w/o kriging
-//		int flag = scalecInterp_Process2A(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);//handles w and w/o kriging
-//		int flag = scalecInterp_Process2(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	int flag = scalecInterp_Process6A(pda, (*arg).threadNum, (*arg).numThreads);//handles w and w/o kriging
 
-		return 0;
-	}
+	return 0;
 }
+
 void *threadInterpKrig(void *lpParam)
 {
-	for(;;) 
-	{
-		pthread_mutex_lock(&lock);
-		while(!play) { /* We're paused */
-			pthread_cond_wait(&cond, &lock); /* Wait for play signal */
-		}
-		pthread_mutex_unlock(&lock);
-		/* Continue */
-
-		SCALEC_DATA_POINTER pda;
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
+	SCALEC_DATA_POINTER pda;
 
-		// Cast the parameter to the correct data type.
-		// The pointer is known to be valid because
-		// it was checked for NULL before the thread was created.
+	// Cast the parameter to the correct data type.
+	// The pointer is known to be valid because
+	// it was checked for NULL before the thread was created.
 
-		pda = (SCALEC_DATA_POINTER)lpParam;
-		int flag = scalecInterp_ProcessKrig(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);
+	pda = (SCALEC_DATA_POINTER)(*arg).data;
+	int flag = scalecInterp_ProcessKrig(pda, (*arg).threadNum, (*arg).numThreads);
 
-		return 0;
-	}
+	return 0;
 }
 
 void *threadInterpTile(void *lpParam)
 {
-	for(;;) 
-	{
-		pthread_mutex_lock(&lock);
-		while(!play) { /* We're paused */
-			pthread_cond_wait(&cond, &lock); /* Wait for play signal */
-		}
-		pthread_mutex_unlock(&lock);
-		/* Continue */
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
+	SCALEC_TILE_DATA_POINTER pda;
 
-		//cout<<"thread#"<<locationThreadMap[(unsigned int)pthread_self()]<<endl;
-		//cout<<"threadID"<<(unsigned int)pthread_self()<<endl;
-		//fprintf(stderr,"thread# %d\n",locationThreadMap[(unsigned int)pthread_self()]);
-		//fprintf(stderr,"threadID %d\n",pthread_self());
+	// Cast the parameter to the correct data type.
+	// The pointer is known to be valid because
+	// it was checked for NULL before the thread was created.
 
-		SCALEC_TILE_DATA_POINTER pda;
+	pda = (SCALEC_TILE_DATA_POINTER)(*arg).data;
+	int flag = scalecInterpTile_ProcessA(pda, (*arg).threadNum, (*arg).numThreads);
 
-		// Cast the parameter to the correct data type.
-		// The pointer is known to be valid because
-		// it was checked for NULL before the thread was created.
+	return 0;
+}
 
-		pda = (SCALEC_TILE_DATA_POINTER)lpParam;
-	//	int flag = scalecInterpTile_Process(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);
-		int flag = scalecInterpTile_ProcessA(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);
+void *threadInterpTileKrig(void *lpParam)
+{
+	MB_THREAD_ARG *arg = (MB_THREAD_ARG *)lpParam;
+	SCALEC_TILE_DATA_POINTER pda;
 
-		return 0;
-	}
+	// Cast the parameter to the correct data type.
+	// The pointer is known to be valid because
+	// it was checked for NULL before the thread was created.
+
+	pda = (SCALEC_TILE_DATA_POINTER)(*arg).data;
+	int flag = scalecInterpTile_ProcessKrig(pda, (*arg).threadNum, (*arg).numThreads);
+
+	return 0;
 }
 
-void *threadInterpTileKrig(void *lpParam)
+#endif
+
+//************************************************************************************
+// XI. Work-stealing task queue shared by the interpolation threads
+//************************************************************************************
+mbTaskQueue::mbTaskQueue(int numThreads)
 {
-	for(;;) 
-	{
-		pthread_mutex_lock(&lock);
-		while(!play) { /* We're paused */
-			pthread_cond_wait(&cond, &lock); /* Wait for play signal */
-		}
-		pthread_mutex_unlock(&lock);
-		/* Continue */
+	numQueues = (numThreads > 0) ? numThreads : 1;
+	queues = vector< deque<MB_TASK> >(numQueues);
+	stealCounts = vector<int>(numQueues, 0);
+#ifdef WIN32
+	queueLocks = new CRITICAL_SECTION[numQueues];
+	for (int i = 0; i < numQueues; i++)
+		InitializeCriticalSection(&queueLocks[i]);
+#else
+	queueLocks = new pthread_mutex_t[numQueues];
+	for (int i = 0; i < numQueues; i++)
+		pthread_mutex_init(&queueLocks[i], NULL);
+#endif
+}
 
-		SCALEC_TILE_DATA_POINTER pda;
+mbTaskQueue::~mbTaskQueue()
+{
+#ifdef WIN32
+	for (int i = 0; i < numQueues; i++)
+		DeleteCriticalSection(&queueLocks[i]);
+#else
+	for (int i = 0; i < numQueues; i++)
+		pthread_mutex_destroy(&queueLocks[i]);
+#endif
+	delete [] queueLocks;
+}
 
-		// Cast the parameter to the correct data type.
-		// The pointer is known to be valid because
-		// it was checked for NULL before the thread was created.
+void mbTaskQueue::addTask(const MB_TASK &task)
+{
+	pending.push_back(task);
+}
 
-		pda = (SCALEC_TILE_DATA_POINTER)lpParam;
-		int flag = scalecInterpTile_ProcessKrig(pda, locationThreadMap[(unsigned int)pthread_self()], numTotalThreads);
+void mbTaskQueue::addBlocks(int numItems)
+{
+	MB_TASK task;
+	int blockSize = numItems / (32 * numQueues);
+	if (blockSize < 1)
+		blockSize = 1;
+	task.outerLoop = 0;
+	task.innerLoop = 0;
+	for (int i = 0; i < numItems; i += blockSize)
+	{
+		task.begin = i;
+		task.end = (i + blockSize < numItems) ? i + blockSize : numItems;
+		task.cost = (double)(task.end - task.begin);
+		pending.push_back(task);
+	}
+}
+
+bool compareTaskCost(const MB_TASK &a, const MB_TASK &b)
+{
+	return a.cost > b.cost;
+}
 
-		return 0;
+void mbTaskQueue::schedule()
+{
+	//Most expensive first, dealt round-robin so every thread starts with a
+	//comparable share. stable_sort keeps equal-cost tasks in the order added.
+	stable_sort(pending.begin(), pending.end(), compareTaskCost);
+	for (int i = 0; i < numQueues; i++)
+	{
+		queues[i].clear();
+		stealCounts[i] = 0;
 	}
+	for (int i = 0; i < (const int)pending.size(); i++)
+		queues[i % numQueues].push_back(pending[i]);
+	pending.clear();
 }
 
+bool mbTaskQueue::nextTask(int threadNum, MB_TASK *task)
+{
+	bool found = false;
+	threadNum = threadNum % numQueues;
+
+	//A. Take the most expensive task left on our own deque
+#ifdef WIN32
+	EnterCriticalSection(&queueLocks[threadNum]);
+#else
+	pthread_mutex_lock(&queueLocks[threadNum]);
 #endif
+	if (!queues[threadNum].empty())
+	{
+		*task = queues[threadNum].front();
+		queues[threadNum].pop_front();
+		found = true;
+	}
+#ifdef WIN32
+	LeaveCriticalSection(&queueLocks[threadNum]);
+#else
+	pthread_mutex_unlock(&queueLocks[threadNum]);
+#endif
+	if (found)
+		return true;
+
+	//B. Otherwise steal the cheapest task from the next thread that has work.
+	//	No tasks are added once the threads start, so one empty pass means we are done.
+	for (int k = 1; k < numQueues && !found; k++)
+	{
+		int victim = (threadNum + k) % numQueues;
+#ifdef WIN32
+		EnterCriticalSection(&queueLocks[victim]);
+#else
+		pthread_mutex_lock(&queueLocks[victim]);
+#endif
+		if (!queues[victim].empty())
+		{
+			*task = queues[victim].back();
+			queues[victim].pop_back();
+			found = true;
+		}
+#ifdef WIN32
+		LeaveCriticalSection(&queueLocks[victim]);
+#else
+		pthread_mutex_unlock(&queueLocks[victim]);
+#endif
+	}
+	if (found)
+		stealCounts[threadNum]++;
+	return found;
+}
+
+void mbTaskQueue::clear()
+{
+	pending.clear();
+	for (int i = 0; i < numQueues; i++)
+		queues[i].clear();
+}
+
+int mbTaskQueue::steals() const
+{
+	int total = 0;
+	for (int i = 0; i < numQueues; i++)
+		total += stealCounts[i];
+	return total;
+}
 
 //SJZ added to catch CreateThread Errors. 1/22/15
 #ifdef WIN32
@@ -697,18 +751,4 @@ void ErrorHandler(LPTSTR lpszFunction)
 	LocalFree(lpMsgBuf);
 	LocalFree(lpDisplayBuf);
 }
-#else
-void *SuspendThread()
-{
-	pthread_mutex_lock(&lock);
-	play = 0;
-	pthread_mutex_unlock(&lock);
-}
-void *ResumeThread()
-{
-	pthread_mutex_lock(&lock);
-	play = 1;
-	pthread_cond_signal(&cond);
-	pthread_mutex_unlock(&lock);
-}
 #endif
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <map>
 #include <vector>
+#include <deque>
 #include "outFileStructs.h"
 
 #ifdef WIN32 
@@ -18,8 +19,163 @@
 #include <pthread.h>
 #endif
 
+/**
+* A unit of work handed out by mbTaskQueue.
+* Tiled runs use outerLoop and innerLoop to name the (x, y) tile.  Irregular runs use
+* begin and end to name a block of consecutive interpolation locations.
+*/
+typedef struct
+{
+	/**
+	* outerLoop - Index of the x tile column.
+	*/
+	int outerLoop;
+
+	/**
+	* innerLoop - Index of the y tile row.
+	*/
+	int innerLoop;
+
+	/**
+	* begin - First location in the block.
+	*/
+	int begin;
+
+	/**
+	* end - One past the last location in the block.
+	*/
+	int end;
+
+	/**
+	* cost - Estimated processing cost.  Used only to order the tasks.
+	*/
+	double cost;
+} MB_TASK;
+
+/**
+* The argument each mbThreads thread is started with.
+*/
+typedef struct
+{
+	/**
+	* data - The thread's copy of the SCALEC_TILE_DATA or SCALEC_DATA.
+	*/
+	void *data;
+
+	/**
+	* threadNum - Number of the thread, 0 to numThreads-1.
+	*/
+	int threadNum;
+
+	/**
+	* numThreads - Number of threads started together.
+	*/
+	int numThreads;
+} MB_THREAD_ARG;
+
+/**
+* A work-stealing task queue shared by the interpolation threads.
+* Tasks are sorted by decreasing estimated cost and dealt round-robin onto one deque per
+* thread.  A thread takes its most expensive remaining task from the front of its own deque
+* and, once that is empty, steals the cheapest task from the back of another thread's deque,
+* so a thread that drew sparse tiles keeps working until every tile is done.
+*/
+class mbTaskQueue
+{
+
+public:
+
+	/**
+	* A constructor for mbTaskQueue.
+	* @param numThreads - Number of threads that will pull tasks from the queue.
+	*/
+	mbTaskQueue(int numThreads);
+
+	/**
+	* A destructor for mbTaskQueue.
+	*/
+	~mbTaskQueue();
+
+	/**
+	* Adds a task.  Tasks are not handed out until schedule is called.
+	* @param task - The task to add.
+	*/
+	void addTask(const MB_TASK &task);
+
+	/**
+	* Adds tasks covering locations 0 to numItems-1 in blocks of consecutive locations, each with a cost equal to its length.
+	* The blocks are sized so each thread is dealt about 32 of them, which leaves enough work to steal near the end.
+	* @param numItems - Number of locations to cover.
+	*/
+	void addBlocks(int numItems);
+
+	/**
+	* Orders the added tasks by decreasing cost and deals them onto the thread deques.  Must be called before the threads start.
+	*/
+	void schedule();
+
+	/**
+	* Gets the next task for a thread, stealing from another thread when its own deque is empty.
+	* @param threadNum - The calling thread number, 0 to numThreads-1.
+	* @param task - The task to process. (Returned).
+	* @return True if a task was returned, false when all tasks have been handed out.
+	*/
+	bool nextTask(int threadNum, MB_TASK *task);
+
+	/**
+	* Discards any remaining tasks so the queue can be refilled.
+	*/
+	void clear();
+
+	/**
+	* @return The number of tasks taken from another thread's deque since the last schedule.
+	*/
+	int steals() const;
+
+private:
+
+	/**
+	* Copying would duplicate the locks.
+	*/
+	mbTaskQueue(const mbTaskQueue &);
+	mbTaskQueue &operator=(const mbTaskQueue &);
+
+	/**
+	* Number of threads pulling from the queue.
+	*/
+	int numQueues;
+
+	/**
+	* Tasks added but not yet scheduled.
+	*/
+	std::vector<MB_TASK> pending;
+
+	/**
+	* One deque of tasks per thread.
+	*/
+	std::vector< std::deque<MB_TASK> > queues;
+
+	/**
+	* Count of stolen tasks per thread.  Each thread only updates its own entry.
+	*/
+	std::vector<int> stealCounts;
+
+#ifdef WIN32
+	/**
+	* One lock per deque. (Windows).
+	*/
+	CRITICAL_SECTION *queueLocks;
+#else
+	/**
+	* One lock per deque. (Linux).
+	*/
+	pthread_mutex_t *queueLocks;
+#endif
+};
+
 /**
 * A multi-threading class used in mergeBathy.
+* Each instance keeps its own threads and arguments, so several may run at once.
 */
 class mbThreads
 {
@@ -85,6 +241,16 @@ private:
 	*/
 	std::vector<SCALEC_DATA> pDataArray2;
 
+	/**
+	* Number of threads started by initMBThread*.
+	*/
+	int numTotalThreads;
+
+	/**
+	* Arguments of the threads, pointing into pDataArray or pDataArray2.
+	*/
+	std::vector<MB_THREAD_ARG> threadArgs;
+
 #ifdef WIN32
 	/**
 	* Data structure containing the thread IDs. (Windows).
@@ -46,6 +46,10 @@
  *     cay = k = amount of spline eqn (between 0 and inf.) 
  *     nrng...grid points more than nrng grid spaces from the nearest 
  *            data point are set to undefined. 
+ *     nthreads = number of threads for the over-relaxation.  Grids of
+ *            ZGRID_PARALLEL_MIN_NODES nodes or more are relaxed in the
+ *            colour order for any nthreads, so the result does not depend
+ *            on it; smaller grids run the original serial sweep.
  *
  * Author:	Unknown, but "jdt", "ian crain",  and "dr t murty"
  *              obviously contributed.
@@ -150,6 +154,12 @@
 	#include "../WarningStates.h"	//Disable all Warnings!!!
 #endif
 
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 /* MBIO include files */
 #include "mb_define.h"
 #include "mb_zgrid.h"
@@ -161,6 +171,360 @@
 
 #define ITERMAX 1000
 #define ITERTRANSITION 300
+#define ZGRID_N_COLOURS 3		/* row colours of the parallel sweep; the stencil reaches two rows */
+#define ZGRID_PARALLEL_MIN_NODES 65536	/* smallest grid swept in colour order */
+
+/*----------------------------------------------------------------------- */
+/*
+ * Relax grid node (i,j) once with the laplace-spline equation and return
+ * 1, or return 0 if the node is undefined or holds data.  z is indexed
+ * as in mb_zgrid (z[i + j * z_dim1], both subscripts from 1).  The change
+ * before over-relaxation is returned in dz.
+ */
+static int zgrid_relax_node(float *z, int z_dim1, int nx, int ny, int i, int j,
+		float cay, float big, float relax, float *dz)
+{
+    float z00, wgt, zsum;
+    float zim, zimm, zip, zipp, zjm, zjmm, zjp, zjpp;
+    int im, jm;
+
+    z00 = z[i + j * z_dim1];
+    if (z00 - big >= (float)0. || z00 < (float)0.)
+	return 0;
+    wgt = (float)0.;
+    zsum = (float)0.;
+
+    im = 0;
+    if (i - 1 > 0) {
+	zim = (float)fabs((double)z[i - 1 + j * z_dim1]);
+	if (zim - big < (float)0.) {
+	    im = 1;
+	    wgt += (float)1.;
+	    zsum += zim;
+	    if (i - 2 > 0) {
+		zimm = (float)fabs((double)z[i - 2 + j * z_dim1]);
+		if (zimm - big < (float)0.) {
+		    wgt += cay;
+		    zsum -= cay * (zimm - zim * (float)2.);
+		}
+	    }
+	}
+    }
+    if (nx - i > 0) {
+	zip = (float)fabs((double)z[i + 1 + j * z_dim1]);
+	if (zip - big < (float)0.) {
+	    wgt += (float)1.;
+	    zsum += zip;
+	    if (im > 0) {
+		wgt += cay * (float)4.;
+		zsum += cay * (float)2. * (zim + zip);
+	    }
+	    if (nx - 1 - i > 0) {
+		zipp = (float)fabs((double)z[i + 2 + j * z_dim1]);
+		if (zipp - big < (float)0.) {
+		    wgt += cay;
+		    zsum -= cay * (zipp - zip * (float)2.);
+		}
+	    }
+	}
+    }
+
+    jm = 0;
+    if (j - 1 > 0) {
+	zjm = (float)fabs((double)z[i + (j - 1) * z_dim1]);
+	if (zjm - big < (float)0.) {
+	    jm = 1;
+	    wgt += (float)1.;
+	    zsum += zjm;
+	    if (j - 2 > 0) {
+		zjmm = (float)fabs((double)z[i + (j - 2) * z_dim1]);
+		if (zjmm - big < (float)0.) {
+		    wgt += cay;
+		    zsum -= cay * (zjmm - zjm * (float)2.);
+		}
+	    }
+	}
+    }
+    if (ny - j > 0) {
+	zjp = (float)fabs((double)z[i + (j + 1) * z_dim1]);
+	if (zjp - big < (float)0.) {
+	    wgt += (float)1.;
+	    zsum += zjp;
+	    if (jm > 0) {
+		wgt += cay * (float)4.;
+		zsum += cay * (float)2. * (zjm + zjp);
+	    }
+	    if (ny - 1 - j > 0) {
+		zjpp = (float)fabs((double)z[i + (j + 2) * z_dim1]);
+		if (zjpp - big < (float)0.) {
+		    wgt += cay;
+		    zsum -= cay * (zjpp - zjp * (float)2.);
+		}
+	    }
+	}
+    }
+
+    *dz = zsum / wgt - z00;
+    z[i + j * z_dim1] = z00 + *dz * relax;
+    return 1;
+}
+
+/*----------------------------------------------------------------------- */
+/*
+ * Parallel relaxation.  The stencil reaches two nodes along each axis and
+ * none on the diagonals, so rows three apart never share a stencil.  Each
+ * sweep relaxes the rows in three colour passes (row mod 3), every row in
+ * order of increasing i along the contiguous x direction, and splits the
+ * rows of a pass among the threads.  The change statistics are kept per
+ * row and summed in row order, so the result does not depend on the
+ * number of threads.  Grids this large take the colour order on a single
+ * thread too.
+ *
+ * The data points are sorted into bins, one per grid node holding data,
+ * with the points of a bin in increasing input order as in the knxt
+ * lists.  The per point positions and heights are stored as separate
+ * arrays so the shift of the data points needs neither the lists nor
+ * the repeated position arithmetic.
+ */
+typedef struct {
+    int nbin;			/* number of grid nodes holding data */
+    int *node_i, *node_j;	/* grid node of each bin */
+    int *start;			/* first point of each bin; start[nbin] ends the last */
+    float *x, *y;		/* offset of each point from its node in grid units */
+    float *zpxy;		/* height of each point plus zbase */
+    float *zpij;		/* shifted height of each point */
+} ZGRID_BINS;
+
+#define ZGRID_SWEEP 0		/* relax the rows of a colour */
+#define ZGRID_SHIFT 1		/* compute the shifted heights of the points of each bin */
+#define ZGRID_PLACE 2		/* set each bin node to the average shifted height */
+
+typedef struct {
+    int task;
+    int first, stride;		/* this share takes every stride-th row or bin from first */
+    int colour;
+    float *z;
+    int z_dim1, nx, ny;
+    float cay, big, relax;
+    float derzm, dx, dy;
+    float *row_dzrms, *row_dzmax;	/* change statistics of each row */
+    int *row_npg;
+    ZGRID_BINS *bins;
+} ZGRID_SHARE;
+
+/*
+ * Sort the data points into bins by walking the knxt lists as set up by
+ * mb_zgrid.  Returns 0 if the memory cannot be allocated.
+ */
+static int zgrid_make_bins(ZGRID_BINS *bins, float *xyz, int n, int *knxt,
+		float x1, float y1, float dx, float dy, float zbase)
+{
+    int k, kk, npt, i, j;
+    float x, y;
+
+    bins->nbin = 0;
+    bins->node_i = (int *) malloc(n * sizeof(int));
+    bins->node_j = (int *) malloc(n * sizeof(int));
+    bins->start = (int *) malloc((n + 1) * sizeof(int));
+    bins->x = (float *) malloc(n * sizeof(float));
+    bins->y = (float *) malloc(n * sizeof(float));
+    bins->zpxy = (float *) malloc(n * sizeof(float));
+    bins->zpij = (float *) malloc(n * sizeof(float));
+    if (bins->node_i == NULL || bins->node_j == NULL || bins->start == NULL || bins->x == NULL
+		|| bins->y == NULL || bins->zpxy == NULL || bins->zpij == NULL)
+	return 0;
+
+    /* xyz is indexed as in mb_zgrid (xyz[k * 3 + 1..3], k from 1) */
+    npt = 0;
+    for (k = 1; k <= n; ++k) {
+	if (knxt[k - 1] >= 0)
+	    continue;
+	bins->node_i[bins->nbin] = (xyz[k * 3 + 1] - x1) / dx + (float)1.5;
+	bins->node_j[bins->nbin] = (xyz[k * 3 + 2] - y1) / dy + (float)1.5;
+	bins->start[bins->nbin] = npt;
+	kk = k;
+	while (kk > 0 && kk <= n) {
+	    x = (xyz[kk * 3 + 1] - x1) / dx;
+	    i = x + (float)1.5;
+	    bins->x[npt] = x + (float)1. - i;
+	    y = (xyz[kk * 3 + 2] - y1) / dy;
+	    j = y + (float)1.5;
+	    bins->y[npt] = y + (float)1. - j;
+	    bins->zpxy[npt] = xyz[kk * 3 + 3] + zbase;
+	    ++npt;
+	    knxt[kk - 1] = -knxt[kk - 1];
+	    kk = knxt[kk - 1];
+	}
+	++bins->nbin;
+    }
+    bins->start[bins->nbin] = npt;
+    return 1;
+}
+
+static void zgrid_free_bins(ZGRID_BINS *bins)
+{
+    free(bins->node_i);
+    free(bins->node_j);
+    free(bins->start);
+    free(bins->x);
+    free(bins->y);
+    free(bins->zpxy);
+    free(bins->zpij);
+}
+
+/*
+ * Shifted height of each point of bin b: the data height moved by the
+ * misfit of a quadratic through the node and its four neighbours.
+ */
+static void zgrid_shift_bin(ZGRID_SHARE *s, int b)
+{
+    float *z = s->z;
+    int z_dim1 = s->z_dim1;
+    ZGRID_BINS *bins = s->bins;
+    int i = bins->node_i[b], j = bins->node_j[b];
+    int p;
+    float x, y, z00, zw, ze, zs, zn, a, bb, c, d, zxy, delz, delzm;
+
+    z00 = (float)fabs((double)z[i + j * z_dim1]);
+    zw = (float)1e35;
+    if (i - 1 > 0)
+	zw = (float)fabs((double)z[i - 1 + j * z_dim1]);
+    ze = (float)1e35;
+    if (i - s->nx < 0)
+	ze = (float)fabs((double)z[i + 1 + j * z_dim1]);
+    if (ze - s->big >= (float)0.) {
+	if (zw - s->big >= (float)0.) {
+	    ze = z00;
+	    zw = z00;
+	}
+	else
+	    ze = z00 * (float)2. - zw;
+    }
+    else if (zw - s->big >= (float)0.)
+	zw = z00 * (float)2. - ze;
+
+    zs = (float)1e35;
+    if (j - 1 > 0)
+	zs = (float)fabs((double)z[i + (j - 1) * z_dim1]);
+    zn = (float)1e35;
+    if (j - s->ny < 0)
+	zn = (float)fabs((double)z[i + (j + 1) * z_dim1]);
+    if (zn - s->big >= (float)0.) {
+	if (zs - s->big >= (float)0.) {
+	    zn = z00;
+	    zs = z00;
+	}
+	else
+	    zn = z00 * (float)2. - zs;
+    }
+    else if (zs - s->big >= (float)0.)
+	zs = z00 * (float)2. - zn;
+
+    a = (ze - zw) * (float).5;
+    bb = (zn - zs) * (float).5;
+    c = (ze + zw) * (float).5 - z00;
+    d = (zn + zs) * (float).5 - z00;
+    for (p = bins->start[b]; p < bins->start[b + 1]; ++p) {
+	x = bins->x[p];
+	y = bins->y[p];
+	zxy = z00 + a * x + bb * y + c * x * x + d * y * y;
+	delz = z00 - zxy;
+	delzm = s->derzm * ((float)fabs((double)x) * s->dx + (float)fabs((double)y) * s->dy) * (float).8;
+	if (delz - delzm > (float)0.)
+	    delz = delzm;
+	if (delz + delzm < (float)0.)
+	    delz = -(double)delzm;
+	bins->zpij[p] = bins->zpxy[p] + delz;
+    }
+}
+
+#ifdef WIN32
+static DWORD WINAPI zgrid_work(LPVOID arg)
+#else
+static void *zgrid_work(void *arg)
+#endif
+{
+    ZGRID_SHARE *s = (ZGRID_SHARE *) arg;
+    ZGRID_BINS *bins = s->bins;
+    int i, j, b, p, npt;
+    float dz, zsum;
+
+    if (s->task == ZGRID_SWEEP) {
+	for (j = s->colour + 1 + ZGRID_N_COLOURS * s->first; j <= s->ny; j += ZGRID_N_COLOURS * s->stride) {
+	    s->row_dzrms[j - 1] = (float)0.;
+	    s->row_dzmax[j - 1] = (float)0.;
+	    s->row_npg[j - 1] = 0;
+	    for (i = 1; i <= s->nx; ++i) {
+		if (zgrid_relax_node(s->z, s->z_dim1, s->nx, s->ny, i, j, s->cay, s->big, s->relax, &dz)) {
+		    ++s->row_npg[j - 1];
+		    s->row_dzrms[j - 1] += dz * dz;
+		    s->row_dzmax[j - 1] = MAX((float)fabs((double)dz), s->row_dzmax[j - 1]);
+		}
+	    }
+	}
+    }
+    else if (s->task == ZGRID_SHIFT) {
+	for (b = s->first; b < bins->nbin; b += s->stride)
+	    zgrid_shift_bin(s, b);
+    }
+    else {
+	for (b = s->first; b < bins->nbin; b += s->stride) {
+	    npt = 0;
+	    zsum = (float)0.;
+	    for (p = bins->start[b]; p < bins->start[b + 1]; ++p) {
+		++npt;
+		zsum += bins->zpij[p];
+	    }
+	    s->z[bins->node_i[b] + bins->node_j[b] * s->z_dim1] = -(double)zsum / npt;
+	}
+    }
+    return 0;
+}
+
+/*
+ * Run one task over nthreads shares; the calling thread takes the first.
+ * A share whose thread cannot be started is run after the others finish.
+ */
+static void zgrid_run(ZGRID_SHARE *shares, int nthreads, int task, int colour)
+{
+    int t;
+#ifdef WIN32
+    HANDLE *threads = (HANDLE *) malloc(nthreads * sizeof(HANDLE));
+#else
+    pthread_t *threads = (pthread_t *) malloc(nthreads * sizeof(pthread_t));
+#endif
+    int *started = (int *) calloc(nthreads, sizeof(int));
+
+    for (t = 0; t < nthreads; ++t) {
+	shares[t].task = task;
+	shares[t].colour = colour;
+    }
+    for (t = 1; t < nthreads; ++t) {
+	if (threads == NULL || started == NULL)
+	    break;
+#ifdef WIN32
+	threads[t] = CreateThread(NULL, 0, zgrid_work, &shares[t], 0, NULL);
+	started[t] = (threads[t] != NULL);
+#else
+	started[t] = (pthread_create(&threads[t], NULL, zgrid_work, &shares[t]) == 0);
+#endif
+    }
+    zgrid_work(&shares[0]);
+    for (t = 1; t < nthreads; ++t) {
+	if (started != NULL && started[t]) {
+#ifdef WIN32
+	    WaitForSingleObject(threads[t], INFINITE);
+	    CloseHandle(threads[t]);
+#else
+	    pthread_join(threads[t], NULL);
+#endif
+	}
+	else
+	    zgrid_work(&shares[t]);
+    }
+    free(threads);
+    free(started);
+}
 
 /*----------------------------------------------------------------------- */
 /*
@@ -174,7 +538,7 @@ make the code difficult to follow.  Again, GOTO's are typically BAD!!!!
 int mb_zgrid(float *z, int *nx, int *ny, 
 		float *x1, float *y1, float *dx, float *dy, float *xyz, 
 		int *n, float *zpij, int *knxt, int *imnew, 
-		float *cay, int *nrng)
+		float *cay, int *nrng, int *nthreads)
 {
     /* System generated locals */
     int z_dim1, z_offset, i__1, i__2, i__3;
@@ -183,22 +547,27 @@ int mb_zgrid(float *z, int *nx, int *ny,
     /* Local variables */
     float delz;
     int iter, nnew;
-    float zijn, zmin, zimm, zmax, zjmm, zipp, zjpp;
+    float zijn, zmin, zmax;
     float root, zsum, zpxy, a, b, c, d;
     int i, j, k;
     float x, y, zbase, relax, delzm;
     float derzm;
     int jmnew;
     float dzmax, dzrms;
-    int kk, im, jm;
+    int kk;
     float dzrms8, z00, dz, ze, hrange, zn, zs, zw, zrange, 
             dzmaxf, convtest, convtestlast=MIN_INT,// 7/7/15 initialize before use SJZ
 	    relaxn, rootgs, dzrmsp, big, abz;
     int npg;
     int nmax;
-    float eps, zim, zjm;
+    float eps;
     int npt;
-    float wgt, zip, zjp, tpy, zxy;
+    float tpy, zxy;
+    int nthr, t, coloured;
+    float *row_dzrms = NULL, *row_dzmax = NULL;
+    int *row_npg = NULL;
+    ZGRID_SHARE *shares = NULL;
+    ZGRID_BINS bins = {0, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
 
     /* Parameter adjustments */
     z_dim1 = *nx;
@@ -471,6 +840,53 @@ L202:
 /*     using the laplace-spline equation  (carres method is used) */
 /* ********************************************************************** 
 */
+/*     sort the data points into bins for the parallel relaxation */
+/* ********************************************************************** 
+*/
+
+    nthr = (nthreads == NULL) ? 1 : *nthreads;
+    if (nthr > *ny / ZGRID_N_COLOURS)
+	nthr = *ny / ZGRID_N_COLOURS;
+    if (nthr < 1)
+	nthr = 1;
+    /* large grids take the colour order even on one thread so the
+       result does not depend on the thread count */
+    coloured = ((double) *nx * *ny >= ZGRID_PARALLEL_MIN_NODES);
+    if (!coloured)
+	nthr = 1;
+    if (coloured) {
+	row_dzrms = (float *) malloc(*ny * sizeof(float));
+	row_dzmax = (float *) malloc(*ny * sizeof(float));
+	row_npg = (int *) malloc(*ny * sizeof(int));
+	shares = (ZGRID_SHARE *) malloc(nthr * sizeof(ZGRID_SHARE));
+	if (row_dzrms == NULL || row_dzmax == NULL || row_npg == NULL || shares == NULL
+		|| !zgrid_make_bins(&bins, xyz, *n, knxt, *x1, *y1, *dx, *dy, zbase)) {
+	    fprintf(stderr,"Zgrid could not allocate the parallel work arrays; relaxing serially\n");
+	    zgrid_free_bins(&bins);
+	    coloured = 0;
+	    nthr = 1;
+	}
+	else {
+	    for (t = 0; t < nthr; ++t) {
+		shares[t].first = t;
+		shares[t].stride = nthr;
+		shares[t].z = &z[0];
+		shares[t].z_dim1 = z_dim1;
+		shares[t].nx = *nx;
+		shares[t].ny = *ny;
+		shares[t].cay = *cay;
+		shares[t].big = big;
+		shares[t].derzm = derzm;
+		shares[t].dx = *dx;
+		shares[t].dy = *dy;
+		shares[t].row_dzrms = row_dzrms;
+		shares[t].row_dzmax = row_dzmax;
+		shares[t].row_npg = row_npg;
+		shares[t].bins = &bins;
+	    }
+	}
+    }
+
 fprintf(stderr,"Zgrid starting iterations\n");
     dzrmsp = zrange;
     relax = (float)1.;
@@ -478,181 +894,28 @@ fprintf(stderr,"Zgrid starting iterations\n");
 	dzrms = (float)0.;
 	dzmax = (float)0.;
 	npg = 0;
-	i__2 = *nx;
-	for (i = 1; i <= i__2; ++i) {
+	if (coloured) {
+	    for (t = 0; t < nthr; ++t)
+		shares[t].relax = relax;
+	    for (k = 0; k < ZGRID_N_COLOURS; ++k)
+		zgrid_run(shares, nthr, ZGRID_SWEEP, k);
 	    i__1 = *ny;
 	    for (j = 1; j <= i__1; ++j) {
-		z00 = z[i + j * z_dim1];
-		if (z00 - big >= (float)0.) {
-		    goto L2000;
-		} else {
-		    goto L205;
-		}
-L205:
-		if (z00 >= (float)0.) {
-		    goto L208;
-		} else {
-		    goto L2000;
-		}
-L208:
-		wgt = (float)0.;
-		zsum = (float)0.;
-
-		im = 0;
-		if (i - 1 <= 0) {
-		    goto L570;
-		} else {
-		    goto L510;
-		}
-L510:
-		zim = (r__1 = z[i - 1 + j * z_dim1], (float)fabs((double)r__1));
-		if (zim - big >= (float)0.) {
-		    goto L570;
-		} else {
-		    goto L530;
-		}
-L530:
-		im = 1;
-		wgt += (float)1.;
-		zsum += zim;
-		if (i - 2 <= 0) {
-		    goto L570;
-		} else {
-		    goto L540;
-		}
-L540:
-		zimm = (r__1 = z[i - 2 + j * z_dim1], (float)fabs((double)r__1));
-		if (zimm - big >= (float)0.) {
-		    goto L570;
-		} else {
-		    goto L560;
-		}
-L560:
-		wgt += *cay;
-		zsum -= *cay * (zimm - zim * (float)2.);
-L570:
-		if (*nx - i <= 0) {
-		    goto L700;
-		} else {
-		    goto L580;
-		}
-L580:
-		zip = (r__1 = z[i + 1 + j * z_dim1], (float)fabs((double)r__1));
-		if (zip - big >= (float)0.) {
-		    goto L700;
-		} else {
-		    goto L600;
-		}
-L600:
-		wgt += (float)1.;
-		zsum += zip;
-		if (im <= 0) {
-		    goto L620;
-		} else {
-		    goto L610;
-		}
-L610:
-		wgt += *cay * (float)4.;
-		zsum += *cay * (float)2. * (zim + zip);
-L620:
-		if (*nx - 1 - i <= 0) {
-		    goto L700;
-		} else {
-		    goto L630;
-		}
-L630:
-		zipp = (r__1 = z[i + 2 + j * z_dim1], (float)fabs((double)r__1));
-		if (zipp - big >= (float)0.) {
-		    goto L700;
-		} else {
-		    goto L650;
-		}
-L650:
-		wgt += *cay;
-		zsum -= *cay * (zipp - zip * (float)2.);
-L700:
-
-		jm = 0;
-		if (j - 1 <= 0) {
-		    goto L1570;
-		} else {
-		    goto L1510;
-		}
-L1510:
-		zjm = (r__1 = z[i + (j - 1) * z_dim1], (float)fabs((double)r__1));
-		if (zjm - big >= (float)0.) {
-		    goto L1570;
-		} else {
-		    goto L1530;
-		}
-L1530:
-		jm = 1;
-		wgt += (float)1.;
-		zsum += zjm;
-		if (j - 2 <= 0) {
-		    goto L1570;
-		} else {
-		    goto L1540;
-		}
-L1540:
-		zjmm = (r__1 = z[i + (j - 2) * z_dim1], (float)fabs((double)r__1));
-		if (zjmm - big >= (float)0.) {
-		    goto L1570;
-		} else {
-		    goto L1560;
-		}
-L1560:
-		wgt += *cay;
-		zsum -= *cay * (zjmm - zjm * (float)2.);
-L1570:
-		if (*ny - j <= 0) {
-		    goto L1700;
-		} else {
-		    goto L1580;
-		}
-L1580:
-		zjp = (r__1 = z[i + (j + 1) * z_dim1], (float)fabs((double)r__1));
-		if (zjp - big >= (float)0.) {
-		    goto L1700;
-		} else {
-		    goto L1600;
-		}
-L1600:
-		wgt += (float)1.;
-		zsum += zjp;
-		if (jm <= 0) {
-		    goto L1620;
-		} else {
-		    goto L1610;
-		}
-L1610:
-		wgt += *cay * (float)4.;
-		zsum += *cay * (float)2. * (zjm + zjp);
-L1620:
-		if (*ny - 1 - j <= 0) {
-		    goto L1700;
-		} else {
-		    goto L1630;
-		}
-L1630:
-		zjpp = (r__1 = z[i + (j + 2) * z_dim1], (float)fabs((double)r__1));
-		if (zjpp - big >= (float)0.) {
-		    goto L1700;
-		} else {
-		    goto L1650;
+		npg += row_npg[j - 1];
+		dzrms += row_dzrms[j - 1];
+		dzmax = MAX(row_dzmax[j - 1], dzmax);
+	    }
+	} else {
+	    i__2 = *nx;
+	    for (i = 1; i <= i__2; ++i) {
+		i__1 = *ny;
+		for (j = 1; j <= i__1; ++j) {
+		    if (zgrid_relax_node(&z[0], z_dim1, *nx, *ny, i, j, *cay, big, relax, &dz)) {
+			++npg;
+			dzrms += dz * dz;
+			dzmax = MAX((float)fabs((double)dz), dzmax);
+		    }
 		}
-L1650:
-		wgt += *cay;
-		zsum -= *cay * (zjpp - zjp * (float)2.);
-L1700:
-
-		dz = zsum / wgt - z00;
-		++npg;
-		dzrms += dz * dz;
-		dzmax = MAX((float)fabs((double)dz), dzmax);
-		z[i + j * z_dim1] = z00 + dz * relax;
-L2000:
-		;
 	    }
 	}
 
@@ -665,6 +928,10 @@ as */
 
 	if (iter - iter / 10 * 10 != 0) {
 	    goto L3600;
+	} else if (coloured) {
+	    zgrid_run(shares, nthr, ZGRID_SHIFT, 0);
+	    zgrid_run(shares, nthr, ZGRID_PLACE, 0);
+	    goto L3600;
 	} else {
 	    goto L3020;
 	}
@@ -914,6 +1181,12 @@ L4000:
 	;
     }
 L4010:
+    if (coloured)
+	zgrid_free_bins(&bins);
+    free(row_dzrms);
+    free(row_dzmax);
+    free(row_npg);
+    free(shares);
 
 /*     remove zbase from array z and return. */
 /* ********************************************************************** 
@@ -15,7 +15,7 @@ extern "C" {
 int mb_zgrid(float *z, int *nx, int *ny, 
 		float *x1, float *y1, float *dx, float *dy, float *xyz, 
 		int *n, float *zpij, int *knxt, int *imnew, 
-		float *cay, int *nrng);
+		float *cay, int *nrng, int *nthreads);
 
 
 #ifdef __cplusplus
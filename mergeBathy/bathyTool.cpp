@@ -5,7 +5,7 @@
 //************************************************************************************
 // SUBROUTINE I: Function call for running standard BathyTool
 //************************************************************************************
-int bathyTool(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, vector<double> *xSingleVector, vector<double> *ySingleVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName, map<string, int> additionalOptions, double subDataMulitplier, bool dispIntermResults, bool useDscale, const double neitol, OUTPUT_DATA *xyzOut)
+int bathyTool(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, vector<double> *xSingleVector, vector<double> *ySingleVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName, map<string, int> additionalOptions, double subDataMulitplier, bool dispIntermResults, bool useDscale, const double neitol, OUTPUT_DATA *xyzOut, vector< vector<double> > *subsampledInput)
 {
 	//************************************************************************************
 	//0. Declare and initialize local variables and objects for use with bathyTool.
@@ -23,9 +23,12 @@ int bathyTool(vector<double> *inputDataX, vector<double> *inputDataY, vector<dou
 	vector< vector <double> > subsampledData = vector< vector<double> >(7);
 
 	//************************************************************************************
-	//I. Subsample the data for use in interpolating .
+	//I. Subsample the data for use in interpolating, unless it was subsampled as it was read.
 	//************************************************************************************
-	returnValue = subsampleData(inputDataX, inputDataY, inputDataZ, inputDataE, inputDataHErr, inputDataVErr, subSpacingX, subSpacingY, x0, y0, meanXSingle, meanYSingle, dispIntermResults, &subsampledData);
+	if (subsampledInput != NULL)
+		subsampledData.swap(*subsampledInput);
+	else
+		returnValue = subsampleData(inputDataX, inputDataY, inputDataZ, inputDataE, inputDataHErr, inputDataVErr, subSpacingX, subSpacingY, x0, y0, meanXSingle, meanYSingle, dispIntermResults, &subsampledData, additionalOptions["-multiThread"]);
 	if (returnValue != 0)
 	{
 		return returnValue;
@@ -57,7 +60,7 @@ int bathyTool(vector<double> *inputDataX, vector<double> *inputDataY, vector<dou
 //************************************************************************************
 // SUBROUTINE II: Function call for running Pre-Interpolated BathyTool
 //************************************************************************************
-int bathyToolPreDefined(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, vector<double> *xInterpVector, vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, const double neitol, OUTPUT_DATA *xyzOut)
+int bathyToolPreDefined(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, vector<double> *xInterpVector, vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, const double neitol, OUTPUT_DATA *xyzOut, vector< vector<double> > *subsampledInput)
 {
 	//************************************************************************************
 	//0. Declare and initialize local variables and objects for use with bathyTool.
@@ -66,9 +69,12 @@ int bathyToolPreDefined(vector<double> *inputDataX, vector<double> *inputDataY,
 	vector< vector <double> > subsampledData = vector< vector<double> >(7);
 
 	//************************************************************************************
-	//I. Subsample the data for use in interpolating .
+	//I. Subsample the data for use in interpolating, unless it was subsampled as it was read.
 	//************************************************************************************
-	returnValue = subsampleData(inputDataX, inputDataY, inputDataZ, inputDataE, inputDataHErr, inputDataVErr, gridSpacingX/Dscale, gridSpacingY/Dscale, x0, y0, meanXSingle, meanYSingle, true, &subsampledData);
+	if (subsampledInput != NULL)
+		subsampledData.swap(*subsampledInput);
+	else
+		returnValue = subsampleData(inputDataX, inputDataY, inputDataZ, inputDataE, inputDataHErr, inputDataVErr, gridSpacingX/Dscale, gridSpacingY/Dscale, x0, y0, meanXSingle, meanYSingle, true, &subsampledData, additionalOptions["-multiThread"]);
 	if (returnValue != 0)
 	{
 		return returnValue;
@@ -34,10 +34,11 @@
 * @param useDscale - Set to true for normal use, for compute offset set to false.
 * @param neitol - Normalized Error Tolerance Value.
 * @param xyzOut - OUTPUT_DATA that contains the interpolated depth, error, normalized error, and residual error. (Returned).
+* @param subsampledInput - Data already subsampled as it was read, used in place of subsampling the input data points, which may then be empty.  It is emptied.  NULL to subsample the input data points.
 * @return Success or failure value.
 */
 
-int bathyTool(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, vector<double> *xSingleVector, vector<double> *ySingleVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, double subDataMulitplier, bool dispIntermResults, bool useDscale, const double neitol, OUTPUT_DATA *xyzOut);
+int bathyTool(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, vector<double> *xSingleVector, vector<double> *ySingleVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, double subDataMulitplier, bool dispIntermResults, bool useDscale, const double neitol, OUTPUT_DATA *xyzOut, vector< vector<double> > *subsampledInput = NULL);
 
 /**
 * Bathy tool that is used to call subsampleData and scalecInterp.  It is a scale-controlled interpolation of bathymetric (or other scalar) data.  It is only used for known plotting to specific data points defined by the user.
@@ -57,7 +58,8 @@ int bathyTool(vector<double> *inputDataX, vector<double> *inputDataY, vector<dou
 * @param additionalOptions - A map of additional options that are required.
 * @param neitol - Normalized Error Tolerance Value.
 * @param xyzOut - OUTPUT_DATA that contains the interpolated depth, error, normalized error, and residual error. (Returned).
+* @param subsampledInput - Data already subsampled as it was read, used in place of subsampling the input data points, which may then be empty.  It is emptied.  NULL to subsample the input data points.
 * @return Success or failure value.
 */
-int bathyToolPreDefined(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, vector<double> *xInterpVector, vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, const double neitol, OUTPUT_DATA *xyzOut);
+int bathyToolPreDefined(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, vector<double> *xInterpVector, vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double &x0, double &y0, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, const double neitol, OUTPUT_DATA *xyzOut, vector< vector<double> > *subsampledInput = NULL);
 
@@ -0,0 +1,408 @@
+#include "binaryBathyFile.h"
+#include "fileReader.h"
+#include "supportedFileTypes.h"
+#include "constants.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifndef _MSC_VER
+//UNIX
+#define strtok_s strtok_r
+#define sscanf_s sscanf
+#endif
+
+/**
+* A read-only memory map of a whole file.
+*/
+typedef struct
+{
+	const char *data;
+	size_t size;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+} MAPPED_FILE;
+
+//************************************************************************************
+// SUBROUTINE I: Map a file into memory read only.
+//************************************************************************************
+static int mapFile(const string &fileName, MAPPED_FILE *map)
+{
+	(*map).data = NULL;
+	(*map).size = 0;
+#ifdef _WIN32
+	LARGE_INTEGER size;
+	(*map).mapping = NULL;
+	(*map).file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if ((*map).file == INVALID_HANDLE_VALUE || !GetFileSizeEx((*map).file, &size))
+		return IN_FILE_ERROR;
+	(*map).size = (size_t)size.QuadPart;
+	if ((*map).size == 0)
+		return SUCCESS;
+	(*map).mapping = CreateFileMappingA((*map).file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if ((*map).mapping == NULL)
+		return IN_FILE_ERROR;
+	(*map).data = (const char*)MapViewOfFile((*map).mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	struct stat st;
+	(*map).fd = open(fileName.c_str(), O_RDONLY);
+	if ((*map).fd < 0 || fstat((*map).fd, &st) != 0)
+		return IN_FILE_ERROR;
+	(*map).size = (size_t)st.st_size;
+	if ((*map).size == 0)
+		return SUCCESS;
+	void *p = mmap(NULL, (*map).size, PROT_READ, MAP_PRIVATE, (*map).fd, 0);
+	if (p == MAP_FAILED)
+		return IN_FILE_ERROR;
+	//The columns are read front to back once
+	madvise(p, (*map).size, MADV_SEQUENTIAL);
+	(*map).data = (const char*)p;
+#endif
+	return ((*map).data == NULL) ? IN_FILE_ERROR : SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE II: Release a memory map.
+//************************************************************************************
+static void unmapFile(MAPPED_FILE *map)
+{
+#ifdef _WIN32
+	if ((*map).data != NULL)
+		UnmapViewOfFile((*map).data);
+	if ((*map).mapping != NULL)
+		CloseHandle((*map).mapping);
+	if ((*map).file != INVALID_HANDLE_VALUE)
+		CloseHandle((*map).file);
+#else
+	if ((*map).data != NULL)
+		munmap((void*)(*map).data, (*map).size);
+	if ((*map).fd >= 0)
+		close((*map).fd);
+#endif
+	(*map).data = NULL;
+	(*map).size = 0;
+}
+
+//************************************************************************************
+// SUBROUTINE III: Copy records first to first+n-1 of one column out of the map into a vector.
+//************************************************************************************
+static void copyColumn(const MBB_HEADER &header, const char *column, int col, size_t first, size_t n, vector<double> *out)
+{
+	if (header.encoding == MBB_FLOAT64)
+	{
+		const double *v = (const double*)column + first;
+		(*out).assign(v, v + n);
+	}
+	else
+	{
+		const int32_t *v = (const int32_t*)column + first;
+		double scale = header.scale[col];
+		double offset = header.offset[col];
+		(*out).resize(n);
+		for (size_t i = 0; i < n; i++)
+			(*out)[i] = offset + scale * v[i];
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE III.A: Map a .mbb file and check its header.
+//************************************************************************************
+static int openMBB(const string &fileName, MAPPED_FILE *map, MBB_HEADER *header)
+{
+	if (mapFile(fileName, map) != SUCCESS || (*map).size < sizeof(MBB_HEADER))
+	{
+		unmapFile(map);
+		cerr << "Unable to open input file: " << fileName << endl;
+		return IN_FILE_ERROR;
+	}
+	memcpy(header, (*map).data, sizeof(MBB_HEADER));
+	size_t width = ((*header).encoding == MBB_FLOAT64) ? sizeof(double) : sizeof(int32_t);
+	if (memcmp((*header).magic, MBB_MAGIC, sizeof(MBB_MAGIC)) != 0 || (*header).version > MBB_VERSION ||
+		((*header).encoding != MBB_FLOAT64 && (*header).encoding != MBB_SCALED_INT32) || (*header).numRecords < 0 ||
+		(*map).size < sizeof(MBB_HEADER) + MBB_NUM_COLUMNS * width * (size_t)(*header).numRecords)
+	{
+		unmapFile(map);
+		cerr << "Not a valid mergeBathy binary file: " << fileName << endl;
+		return IN_FILE_ERROR;
+	}
+	return SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE III.B: Apply the tide correction, cut the bounding box and keep only water.
+//************************************************************************************
+static void applyModifiers(TRUE_DATA *d, BOUNDING_BOX bbox, int nonegdepth, double tideCorrection, bool resum)
+{
+	vector<double>* columns[MBB_NUM_COLUMNS] = { &(*d).lon, &(*d).lat, &(*d).depth, &(*d).error, &(*d).h_Error, &(*d).v_Error };
+	if (tideCorrection != 0)
+	{
+		for (int i = 0; i < (const int)(*d).depth.size(); i++)
+			(*d).depth[i] += tideCorrection;
+	}
+	if (bbox.doBoundingBox || nonegdepth || resum)
+	{
+		int kept = 0;
+		double lon, lat;
+		(*d).longitudeSum = 0.00;
+		(*d).latitudeSum = 0.00;
+		for (int i = 0; i < (const int)(*d).lon.size(); i++)
+		{
+			lon = (*d).lon[i];
+			lat = (*d).lat[i];
+			if (bbox.doBoundingBox && ((lat > bbox.bboxTop) || (lat < bbox.bboxBottom) || (lon > bbox.bboxRight) || (lon < bbox.bboxLeft)))
+				continue;
+			if (nonegdepth && (*d).depth[i] < 0)
+				continue;
+			for (int c = 0; c < MBB_NUM_COLUMNS; c++)
+				(*columns[c])[kept] = (*columns[c])[i];
+			(*d).longitudeSum += (lon+180.00) - int((lon+180.00)/360.00)*360.00-180.00;
+			(*d).latitudeSum  += (lat+180.00) - int((lat+180.00)/360.00)*360.00-180.00;
+			kept++;
+		}
+		for (int c = 0; c < MBB_NUM_COLUMNS; c++)
+			(*columns[c]).resize(kept);
+	}
+
+	//A. Zero out the projected coordinates
+	(*d).x = vector<double>((*d).lon.size(), 0.00);
+	(*d).y = vector<double>((*d).lon.size(), 0.00);
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Function call for reading .mbb Files
+//************************************************************************************
+int readMBB(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int &pos, int nonegdepth)
+{
+	//************************************************************************************
+	// 0. Declare local variables and objects
+	//************************************************************************************
+	int retVal = SUCCESS;
+	double wMultiplier = 0.00;
+	double tideCorrection = 0.00;
+	double maximumDataOffset = INT_MAX;
+	MAPPED_FILE map;
+	MBB_HEADER header;
+
+	//A. Parse out the tide correction and maximum data offset.  The weight is not used.
+	parseFileModifiers(fileName, &wMultiplier, &tideCorrection, &maximumDataOffset);
+
+	//************************************************************************************
+	// I. Map the file and check the header
+	//************************************************************************************
+	retVal = openMBB(fileName, &map, &header);
+	if (retVal != SUCCESS)
+		return retVal;
+	size_t width = (header.encoding == MBB_FLOAT64) ? sizeof(double) : sizeof(int32_t);
+
+	if (!readingConcurrently())
+		printf("Reading Input File: %s ......", fileName.c_str());
+
+	//************************************************************************************
+	// II. Copy the columns
+	//************************************************************************************
+	TRUE_DATA *d = &(*inputData)[pos];
+	vector<double>* columns[MBB_NUM_COLUMNS] = { &(*d).lon, &(*d).lat, &(*d).depth, &(*d).error, &(*d).h_Error, &(*d).v_Error };
+	const char *column = map.data + sizeof(MBB_HEADER);
+	for (int c = 0; c < MBB_NUM_COLUMNS; c++)
+	{
+		copyColumn(header, column, c, 0, (size_t)header.numRecords, columns[c]);
+		column += width * (size_t)header.numRecords;
+	}
+	unmapFile(&map);
+	(*d).longitudeSum = header.longitudeSum;
+	(*d).latitudeSum = header.latitudeSum;
+	(*d).maximumDataOffset = (maximumDataOffset != INT_MAX) ? maximumDataOffset : header.maximumDataOffset;
+
+	//A. Apply the tide correction, cut the bounding box and keep only water.
+	//	The sums are recomputed only when soundings are dropped.
+	applyModifiers(d, bbox, nonegdepth, tideCorrection, false);
+	if (readingConcurrently())
+		printf("Reading Input File: %s ...... %d Records Read Successfully.\n", fileName.c_str(), (int)(*d).lon.size());
+	else
+		printf(" %d Records Read Successfully.\n", (int)(*d).lon.size());
+	if (tideCorrection != 0)
+		cout << "\tUsing Tide Correction: " << tideCorrection << endl;
+	if ((*d).maximumDataOffset != INT_MAX)
+		cout << "\tUsing Maximum Data Offset: " << (*d).maximumDataOffset << endl;
+
+	return retVal;
+}
+
+//************************************************************************************
+// SUBROUTINE IV.A: Function call for reading a block of records of a .mbb File
+//************************************************************************************
+int readMBBBlock(const string &fileName, BOUNDING_BOX bbox, TRUE_DATA *block, int64_t first, int64_t count, int nonegdepth, double tideCorrection, int64_t *numRecords)
+{
+	MAPPED_FILE map;
+	MBB_HEADER header;
+
+	int retVal = openMBB(fileName, &map, &header);
+	if (retVal != SUCCESS)
+		return retVal;
+	size_t width = (header.encoding == MBB_FLOAT64) ? sizeof(double) : sizeof(int32_t);
+	(*numRecords) = header.numRecords;
+	first = max((int64_t)0, min(first, (int64_t)header.numRecords));
+	count = max((int64_t)0, min(count, (int64_t)header.numRecords - first));
+
+	//A. Copy the part of each column in the block.  Only those pages of the map are touched.
+	vector<double>* columns[MBB_NUM_COLUMNS] = { &(*block).lon, &(*block).lat, &(*block).depth, &(*block).error, &(*block).h_Error, &(*block).v_Error };
+	const char *column = map.data + sizeof(MBB_HEADER);
+	for (int c = 0; c < MBB_NUM_COLUMNS; c++)
+	{
+		copyColumn(header, column, c, (size_t)first, (size_t)count, columns[c]);
+		column += width * (size_t)header.numRecords;
+	}
+	unmapFile(&map);
+	(*block).maximumDataOffset = header.maximumDataOffset;
+
+	//B. The stored sums cover the whole file, so the sums of the block are always recomputed
+	applyModifiers(block, bbox, nonegdepth, tideCorrection, true);
+	return SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE V: Function call for writing .mbb Files
+//************************************************************************************
+int writeMBB(const string &fileName, const TRUE_DATA &data, int encoding)
+{
+	MBB_HEADER header;
+	const vector<double>* columns[MBB_NUM_COLUMNS] = { &data.lon, &data.lat, &data.depth, &data.error, &data.h_Error, &data.v_Error };
+	size_t n = data.lon.size();
+
+	//A. Fill the header
+	memset(&header, 0, sizeof(MBB_HEADER));
+	memcpy(header.magic, MBB_MAGIC, sizeof(MBB_MAGIC));
+	header.version = MBB_VERSION;
+	header.encoding = encoding;
+	header.numRecords = (int64_t)n;
+	header.maximumDataOffset = data.maximumDataOffset;
+	header.longitudeSum = data.longitudeSum;
+	header.latitudeSum = data.latitudeSum;
+	for (int c = 0; c < MBB_NUM_COLUMNS; c++)
+	{
+		if ((*columns[c]).size() != n)
+		{
+			cerr << "Unable to write " << fileName << ": columns differ in length!" << endl;
+			return OUT_FILE_ERROR;
+		}
+		header.scale[c] = 1.0;
+		header.offset[c] = 0.0;
+		if (encoding == MBB_SCALED_INT32 && n > 0)
+		{
+			//Map the range of the column onto [-2^31+1, 2^31-1]
+			double vmin = (*columns[c])[0], vmax = vmin;
+			for (size_t i = 1; i < n; i++)
+			{
+				vmin = min(vmin, (*columns[c])[i]);
+				vmax = max(vmax, (*columns[c])[i]);
+			}
+			header.offset[c] = (vmin + vmax) / 2.0;
+			if (vmax > vmin)
+				header.scale[c] = (vmax - vmin) / (2.0 * 2147483646.0);
+		}
+	}
+
+	//B. Write the header and the columns
+	ofstream outFile;
+	outFile.open(fileName.c_str(), ios::out | ios::binary);
+	if (!outFile.is_open())
+	{
+		cerr << "Unable to open output file: " << fileName << endl;
+		return OUT_FILE_ERROR;
+	}
+	outFile.write((const char*)&header, sizeof(MBB_HEADER));
+	for (int c = 0; c < MBB_NUM_COLUMNS; c++)
+	{
+		if (encoding == MBB_FLOAT64)
+		{
+			if (n > 0)
+				outFile.write((const char*)&(*columns[c])[0], n * sizeof(double));
+		}
+		else
+		{
+			vector<int32_t> q = vector<int32_t>(n);
+			for (size_t i = 0; i < n; i++)
+				q[i] = (int32_t)floor(((*columns[c])[i] - header.offset[c]) / header.scale[c] + 0.5);
+			if (n > 0)
+				outFile.write((const char*)&q[0], n * sizeof(int32_t));
+		}
+	}
+	outFile.close();
+	if (outFile.fail())
+	{
+		cerr << "Unable to write output file: " << fileName << endl;
+		return OUT_FILE_ERROR;
+	}
+	return SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE VI: Convert every data set of an input file list to .mbb Files.
+//************************************************************************************
+int writeMBBInputs(string &listFileName, vector<TRUE_DATA> *inputData, int encoding)
+{
+	vector<string> inputFiles;
+	string mbbName, entry;
+	char *next_token;
+	int retVal = readFileList(listFileName, &inputFiles);
+	if (retVal != SUCCESS)
+		return retVal;
+	if (inputFiles.size() != (*inputData).size())
+	{
+		cerr << "Input file list changed while reading: " << listFileName << endl;
+		return LIST_FILE_ERROR;
+	}
+
+	string listOut = listFileName + binaryBathy + ".txt";
+	ofstream outList;
+	outList.open(listOut.c_str(), ios::out);
+	if (!outList.is_open())
+	{
+		cerr << "Unable to open output file: " << listOut << endl;
+		return OUT_FILE_ERROR;
+	}
+
+	for (int i = 0; i < (const int)inputFiles.size(); i++)
+	{
+		//A. An input that is already a .mbb is listed as it was, decorations and all.
+		//Writing it would overwrite the source with the data read from it.
+		entry = inputFiles[i];
+		next_token = NULL;
+		mbbName = (char*)strtok_s((char*)inputFiles[i].c_str(), "&^#\t\n", &next_token);
+		if (mbbName.find(binaryBathy) != string::npos)
+		{
+			outList << entry << endl;
+			cout << "Kept Binary Input File: " << mbbName << endl;
+			continue;
+		}
+
+		//B. Drop the weight, tide and offset decorations, they are applied already
+		mbbName += binaryBathy;
+		retVal = writeMBB(mbbName, (*inputData)[i], encoding);
+		if (retVal != SUCCESS)
+			break;
+		outList << mbbName << endl;
+		cout << "Wrote Binary Input File: " << mbbName << endl;
+	}
+	outList.close();
+	if (retVal == SUCCESS)
+		cout << "Binary Input File List: " << listOut << endl << endl;
+	return retVal;
+}
@@ -0,0 +1,139 @@
+/**
+* @file			binaryBathyFile.h
+* @brief		Columnar binary sounding format (.mbb) read through a memory map, and the converter that writes it.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* A .mbb file holds the TRUE_DATA of one input file exactly as the text or GSF
+* reader left it, so later runs copy whole columns instead of parsing records.
+* Layout (native little-endian byte order):
+*	MBB_HEADER (144 bytes)
+*	longitude column
+*	latitude column
+*	depth column
+*	error column
+*	horizontal error column
+*	vertical error column
+* Each column holds numRecords values, either float64 or int32 scaled as
+* value = offset[column] + scale[column] * stored.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "inFileStructs.h"
+
+using namespace std;
+
+/**
+* Magic number at the start of every .mbb file.
+*/
+const char MBB_MAGIC[8] = { 'M', 'B', 'B', 'A', 'T', 'H', 'Y', '\0' };
+
+/**
+* Version of the .mbb layout written by this build.
+*/
+const int32_t MBB_VERSION = 1;
+
+/**
+* Column encodings.
+* MBB_FLOAT64 - Values are stored as 8 byte doubles.
+* MBB_SCALED_INT32 - Values are stored as 4 byte integers scaled over the range of the column, about 1e-9 of the range in resolution.
+*/
+enum MBB_ENCODING{ MBB_FLOAT64, MBB_SCALED_INT32 };
+
+/**
+* Number of columns in a .mbb file.
+*/
+const int MBB_NUM_COLUMNS = 6;
+
+/**
+* Fixed size header of a .mbb file.
+*/
+typedef struct
+{
+	/**
+	* MBB_MAGIC.
+	*/
+	char magic[8];
+
+	/**
+	* MBB_VERSION of the writer.
+	*/
+	int32_t version;
+
+	/**
+	* MBB_ENCODING of the columns.
+	*/
+	int32_t encoding;
+
+	/**
+	* Number of soundings in each column.
+	*/
+	int64_t numRecords;
+
+	/**
+	* TRUE_DATA maximumDataOffset of the input file.
+	*/
+	double maximumDataOffset;
+
+	/**
+	* TRUE_DATA longitudeSum and latitudeSum of the input file.
+	*/
+	double longitudeSum;
+	double latitudeSum;
+
+	/**
+	* Per column scale and offset used by MBB_SCALED_INT32.  Scale is 1 and offset 0 for MBB_FLOAT64.
+	*/
+	double scale[MBB_NUM_COLUMNS];
+	double offset[MBB_NUM_COLUMNS];
+
+} MBB_HEADER;
+
+/**
+* Read a .mbb file.  The file is memory mapped and each column is copied into TRUE_DATA in one pass, without per-record parsing.
+* The bounding box, -nonegdepth and a tide correction (^) given in the file list still apply, and a maximum data offset (#) given in the file list replaces the stored one.
+* @param fileName - File name of the .mbb file to be read.
+* @param bbox - The bounding extents of the input data if it is to be cut.
+* @param inputData - Vector TRUE_DATA that contains the values read from each file.  Only the index specified by pos is modified.  (Returned).
+* @param pos - Integer representing the location of inputData where the data from the input file should be stored.
+* @return Success or failure boolean.
+*/
+int readMBB(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int &pos, int nonegdepth);
+
+/**
+* Read a block of consecutive records of a .mbb file, so that a file larger than memory can be read a part at a time.  Only the pages of the map holding the block are read.
+* The sums of the block are computed over the records kept.
+* @param fileName - File name of the .mbb file to be read, without the list modifiers.
+* @param bbox - The bounding extents of the input data if it is to be cut.
+* @param block - The records kept from the block. (Returned).
+* @param first - Index of the first record of the block.
+* @param count - Number of records in the block.  A block past the end of the file is cut short.
+* @param tideCorrection - Tide correction added to each depth.
+* @param numRecords - Number of records in the whole file. (Returned).
+* @return Success or failure boolean.
+*/
+int readMBBBlock(const string &fileName, BOUNDING_BOX bbox, TRUE_DATA *block, int64_t first, int64_t count, int nonegdepth, double tideCorrection, int64_t *numRecords);
+
+/**
+* Write one TRUE_DATA to a .mbb file.
+* @param fileName - File name of the .mbb file to be written.
+* @param data - Data to write.
+* @param encoding - MBB_FLOAT64 or MBB_SCALED_INT32.
+* @return Success or failure boolean.
+*/
+int writeMBB(const string &fileName, const TRUE_DATA &data, int encoding);
+
+/**
+* Write every data set read from an input file list to .mbb files and write a new list file naming them.
+* Each input file is written next to itself as <input file>.mbb and the list as <input_file_list>.mbb.txt.  Passing the new list
+* to mergeBathy reads the same data without parsing any text.  Inputs that are already .mbb files are not rewritten; their
+* list entries are copied unchanged.
+* @param listFileName - File name of the input file list inputData was read from.
+* @param inputData - Data read from the list by readFile.
+* @param encoding - MBB_FLOAT64 or MBB_SCALED_INT32.
+* @return Success or failure boolean.
+*/
+int writeMBBInputs(string &listFileName, vector<TRUE_DATA> *inputData, int encoding);
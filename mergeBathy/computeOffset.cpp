@@ -1,6 +1,167 @@
 #include <exception>
 #include "computeOffset.h"
 #include "bathyTool.h"
+#include "MB_Threads.h"
+//************************************************************************************
+// SUBROUTINE I: Gridding the data sets.  Each data set is gridded by bathyTool into its
+// own block of the dense zData and wData, so the data sets can be gridded concurrently.
+//************************************************************************************
+/**
+* The arguments shared by the threads gridding the data sets.
+*/
+typedef struct
+{
+	vector<TRUE_DATA> *localInputData;
+	dgrid *xMeshGrid;
+	dgrid *yMeshGrid;
+	vector<double> *xt;
+	vector<double> *yt;
+	double gridSpacingX;
+	double gridSpacingY;
+	double meanXt;
+	double meanYt;
+	string kernel;
+	map<string, int> addOpts;
+	int numCells;
+	double *zData;
+	double *wData;
+	mbTaskQueue *queue;
+	int threadNum;
+} OFFSET_GRID_DATA;
+
+/**
+* Grids one data set and writes its depths and weights to its block of zData and wData.
+* @param gd - The shared arguments.  zData and wData are (Returned).
+* @param i - The data set to grid.  Its local copy is cleared.
+*/
+static void gridDataSet(OFFSET_GRID_DATA *gd, int i)
+{
+	TRUE_DATA &data = (*(*gd).localInputData)[i];
+	OUTPUT_DATA xyzOut;
+	double val;
+	double *zBlock = (*gd).zData + (size_t)i*(*gd).numCells;
+	double *wBlock = (*gd).wData + (size_t)i*(*gd).numCells;
+
+	double minCurXLoc = data.x[0];
+	double minCurYLoc = data.y[0];
+	//A. Get the min
+	for (int j = 0; j < (const int)data.x.size(); j++)
+	{
+		if(data.x[j] < minCurXLoc)
+			minCurXLoc = data.x[j];
+		if(data.y[j] < minCurYLoc)
+			minCurYLoc = data.y[j];
+	}
+	dgrid xMeshTemp = dgrid(*(*gd).xMeshGrid);
+	dgrid yMeshTemp = dgrid(*(*gd).yMeshGrid);
+	vector<double> xtTemp = vector<double>(*(*gd).xt);
+	vector<double> ytTemp = vector<double>(*(*gd).yt);
+
+	//B. Call bathyTool
+	bathyTool(&data.x, &data.y, &data.depth, &data.error, &data.h_Error, &data.v_Error, &xMeshTemp, &yMeshTemp, &xtTemp, &ytTemp, (*gd).gridSpacingX, (*gd).gridSpacingY, minCurXLoc, minCurYLoc, (*gd).meanXt, (*gd).meanYt, (*gd).kernel, (*gd).addOpts, 0.5, false, false, NEITOL_COMPUTE_OFFSET, &xyzOut);
+
+	//Added 8/7/14 sqrt results to get errors
+	for (int j = 0; j < (const int)xyzOut.nEi.size(); j++)
+	{
+		val = 1.00 - sqrt(xyzOut.nEi[j]);
+		if (val > eps || val < -eps)
+		{
+			if(xyzOut.depth[j] > eps || xyzOut.depth[j] < -eps)
+				zBlock[j] = xyzOut.depth[j];
+			wBlock[j] = val;
+		}
+	}
+
+	//C. Clear the local copy
+	data.x.clear();
+	data.y.clear();
+	data.depth.clear();
+	data.error.clear();
+	data.h_Error.clear();
+	data.v_Error.clear();
+}
+
+#ifdef WIN32
+static DWORD WINAPI gridDataSetsThread(LPVOID lpParam)
+#else
+static void *gridDataSetsThread(void *lpParam)
+#endif
+{
+	OFFSET_GRID_DATA *gd = (OFFSET_GRID_DATA *)lpParam;
+	MB_TASK task;
+
+	while ((*(*gd).queue).nextTask((*gd).threadNum, &task))
+		gridDataSet(gd, task.begin);
+	return 0;
+}
+
+/**
+* Grids every data set on numThreads threads.  The data sets are handed out largest first through
+* a mbTaskQueue, each on its share of the -multiThread threads.
+* @param gd - The shared arguments.  zData and wData are (Returned).
+* @param numThreads - Number of data sets gridded at once.
+*/
+static void gridDataSets(OFFSET_GRID_DATA *gd, int numThreads)
+{
+	int inDataSize = (const int)(*(*gd).localInputData).size();
+	mbTaskQueue queue(numThreads);
+	MB_TASK task;
+	vector<OFFSET_GRID_DATA> threadData(numThreads, *gd);
+	vector<bool> started(numThreads, false);
+#ifdef WIN32
+	vector<HANDLE> threads(numThreads);
+#else
+	vector<pthread_t> threads(numThreads);
+#endif
+
+	task.outerLoop = 0;
+	task.innerLoop = 0;
+	for (int i = 0; i < inDataSize; i++)
+	{
+		task.begin = i;
+		task.end = i + 1;
+		task.cost = (double)(*(*gd).localInputData)[i].x.size();
+		queue.addTask(task);
+	}
+	queue.schedule();
+
+	//The data sets gridded at once split the -multiThread threads.  A data set left with one thread is gridded serially.
+	int setThreads = (*gd).addOpts["-multiThread"] / numThreads;
+	for (int t = 0; t < numThreads; t++)
+	{
+		threadData[t].addOpts["-multiThread"] = (setThreads > 1) ? setThreads : 0;
+		threadData[t].queue = &queue;
+		threadData[t].threadNum = t;
+	}
+
+	//The calling thread takes the first share.  A share whose thread cannot be started is
+	//gridded here after the others are joined.
+	for (int t = 1; t < numThreads; t++)
+	{
+#ifdef WIN32
+		threads[t] = CreateThread(NULL, 0, gridDataSetsThread, &threadData[t], 0, NULL);
+		started[t] = (threads[t] != NULL);
+#else
+		started[t] = (pthread_create(&threads[t], NULL, gridDataSetsThread, &threadData[t]) == 0);
+#endif
+	}
+	gridDataSetsThread(&threadData[0]);
+	for (int t = 1; t < numThreads; t++)
+	{
+		if (started[t])
+		{
+#ifdef WIN32
+			WaitForSingleObject(threads[t], INFINITE);
+			CloseHandle(threads[t]);
+#else
+			pthread_join(threads[t], NULL);
+#endif
+		}
+		else
+			gridDataSetsThread(&threadData[t]);
+	}
+}
+
 /*computeOffset - Requires more than 1 data set in order to find the offsets between them. Constructs a grid x,y and computes the grid values for each data set by calling bathyTool.  BathyTool executes the heart of mergeBathy computations for generating a bathymetric surface. The n resulting gridded data sets from the n input data sets are compared to find the differences in their estimations. The computed offsets are removed from the input data before returning to the calling function.  This is a correction to the input data.
 */
 
@@ -109,16 +270,10 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 		cly += 1;
 	}
 
-	OUTPUT_DATA xyzOut;
-	boost::numeric::ublas::mapped_matrix<double> zData (inDataSize, xMeshVector2.size());
-	boost::numeric::ublas::mapped_matrix<double> wData (inDataSize, xMeshVector2.size());
-
-	dgrid xMeshTemp;
-	dgrid yMeshTemp;
-	vector<double> xtTemp;
-	vector<double> ytTemp;
-	double minCurXLoc;
-	double minCurYLoc;
+	int numCells = (const int)xMeshVector2.size();
+	//Each data set's depths and weights fill a block of numCells; zero where it has no estimate.
+	vector<double> zData((size_t)inDataSize*numCells, 0.00);
+	vector<double> wData((size_t)inDataSize*numCells, 0.00);
 
 	//F. Make the local data structure for overlapping data
 	vector<TRUE_DATA> localInputData = vector<TRUE_DATA>(inDataSize);
@@ -148,68 +303,39 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 	//II. Run each input data set through bathy tool to compute the offset at that data set
 	//************************************************************************************
 	#pragma region --Compute Offset, Run bathyTool for each dataset
-	int ii = 0; // SJZ to catch weird behavior
-	for (int i = 0; i < inDataSize; i++)
+	OFFSET_GRID_DATA gridData;
+	gridData.localInputData = &localInputData;
+	gridData.xMeshGrid = &xMeshGrid2;
+	gridData.yMeshGrid = &yMeshGrid2;
+	gridData.xt = &xt;
+	gridData.yt = &yt;
+	gridData.gridSpacingX = gridSpacingX;
+	gridData.gridSpacingY = gridSpacingY;
+	gridData.meanXt = meanXt;
+	gridData.meanYt = meanYt;
+	gridData.kernel = kernel;
+	gridData.addOpts = addOpts;
+	gridData.numCells = numCells;
+	gridData.zData = &zData[0];
+	gridData.wData = &wData[0];
+	gridData.queue = NULL;
+	gridData.threadNum = 0;
+
+	int numThreads = min(addOpts.find("-multiThread")->second, inDataSize);
+	if (numThreads > 1)
 	{
-		ii = i+1;
-		cout << "\tComputing Data Set Number: " << ii << " ...";
-		minCurXLoc = localInputData[i].x[0];
-		minCurYLoc = localInputData[i].y[0];
-		//A. Get the min
-		for (int j = 0; j < (const int)localInputData[i].x.size(); j++)
-		{
-			if(localInputData[i].x[j] < minCurXLoc)
-				minCurXLoc = localInputData[i].x[j];
-			if(localInputData[i].y[j] < minCurYLoc)
-				minCurYLoc = localInputData[i].y[j];
-		}
-		xMeshTemp = dgrid(xMeshGrid2);
-		yMeshTemp = dgrid(yMeshGrid2);
-		xtTemp = vector<double>(xt);
-		ytTemp = vector<double>(yt);
-
-		//B. Call bathyTool
-		bathyTool(&localInputData[i].x,&localInputData[i].y, &localInputData[i].depth, &localInputData[i].error, &localInputData[i].h_Error, &localInputData[i].v_Error, &xMeshTemp, &yMeshTemp, &xtTemp, &ytTemp, gridSpacingX, gridSpacingY, minCurXLoc, minCurYLoc, meanXt, meanYt, kernel, addOpts, 0.5, false, false, NEITOL_COMPUTE_OFFSET, &xyzOut);
-
-		//Added 8/7/14 sqrt results to get errors
-		for (int j = 0; j < (const int)xyzOut.nEi.size(); j++)
-		{
-			val = 1.00 - sqrt(xyzOut.nEi[j]);
-			if (val > eps || val < -eps)
-			{
-				if(xyzOut.depth[j] > eps || xyzOut.depth[j] < -eps)
-					zData(i,j) = xyzOut.depth[j];
-				wData(i,j) = val;
-			}
-		}
-
-		//C. Clear the variables
-		xyzOut.depth.clear();
-		xyzOut.error.clear();
-		xyzOut.nEi.clear();
-		xyzOut.rEi.clear();
-
-		if(abs(addOpts.find("-propUncert")->second)==1)
-		{
-			xyzOut.depth0.clear();
-			xyzOut.error0.clear();
-		}
-		if(abs(addOpts.find("-kalman")->second)==1)
+		cout << "\tComputing " << inDataSize << " Data Sets, " << numThreads << " at a time ...";
+		gridDataSets(&gridData, numThreads);
+		cout << "... Done!" << endl;
+	}
+	else
+	{
+		for (int i = 0; i < inDataSize; i++)
 		{
-			xyzOut.depthK.clear();
-			xyzOut.errorK.clear();
+			cout << "\tComputing Data Set Number: " << i+1 << " ...";
+			gridDataSet(&gridData, i);
+			cout << "... Done!" << endl;
 		}
-		xMeshTemp.clear();
-		yMeshTemp.clear();
-		xtTemp.clear();
-		ytTemp.clear();
-		localInputData[i].x.clear();
-		localInputData[i].y.clear();
-		localInputData[i].depth.clear();
-		localInputData[i].error.clear();
-		localInputData[i].h_Error.clear();
-		localInputData[i].v_Error.clear();
-		cout << "... Done!" << endl;
 	}
 
 	localInputData.clear();
@@ -221,43 +347,55 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 	// These are observed differences between data sets.
 	//************************************************************************************
 	#pragma region Offsetting Calculations
-
-	int NR = (int)floor(xtSize * ytSize * (pow(inDataSize, 2.00)) / 2.00);
 	vector<int> idVector;
-
+	vector<int> overlap;
 	int curLoc = 0;
 	double sumW = 0.00;
+	double sumD = 0.00;
+	double wPair, dPair, rPair;
+	int k, kprime;
 
-	//Create empty sparse matrices big enough to hold ...
-	//all pairs
-	boost::numeric::ublas::mapped_matrix<double> dzDData(1, NR, 0);
-	//the correlation matrix
-	boost::numeric::ublas::mapped_matrix<double> dzRData(inDataSize, NR, 0);
-	//the joint weight, sqrt(wt(k)*wt(k'))
-	boost::numeric::ublas::mapped_matrix<double> dzWData(1, NR, 0);
+	//Normal equations of the weighted pair differences, built without forming [R] and D.
+	//Each pair adds (w+eps)^2 to the diagonals of its data sets and takes it from their cross terms.
+	vector<double> rtR((size_t)inDataSize*inDataSize, 0.00);
+	vector<double> rtD(inDataSize, 0.00);
 
 	//A. Form the matrix equation: DZ(k,k') = [Delta(k) - Delta(k')]dz(k)=>D = [R]*dz
-	//Here are observed differences between data sets
-	if(!idVector.empty())
-		idVector.clear();
-
-	//loop through all offset pairs in order to find the points that contribute to the offset.
-	for (int i = 0; i < inDataSize; i++){//k
-		for (int j = i + 1; j < inDataSize; j++){//kprime
-			//get overlap
-			for (int k = 0; k < (const int)wData.size2(); k++){//id
-				//these are points that contribute to offset
-				if(((wData(i,k) > eps || wData(i,k) < -eps) && (wData(j,k) > eps || wData(j,k) < -eps ))){
-					dzDData(0, curLoc) = zData(i,k)-zData(j,k);
-					dzRData(i, curLoc) = 1.0000;
-					dzRData(j, curLoc) = -1.00 * dzRData(i,curLoc);
-					dzWData(0, curLoc) = sqrt(wData(i,k)*wData(j,k));
-					curLoc = curLoc + 1;
-				}
+	//One pass over the cells; every pair of data sets with weights in a cell contributes to the offset.
+	overlap.reserve(inDataSize);
+	for (int id = 0; id < numCells; id++)
+	{
+		overlap.clear();
+		for (int i = 0; i < inDataSize; i++)
+		{
+			if (wData[(size_t)i*numCells + id] > eps || wData[(size_t)i*numCells + id] < -eps)
+				overlap.push_back(i);
+		}
+		for (int i = 0; i < (const int)overlap.size(); i++)
+		{
+			k = overlap[i];
+			for (int j = i + 1; j < (const int)overlap.size(); j++)
+			{
+				kprime = overlap[j];
+				//convert to weighted space (priestly p.315)
+				wPair = sqrt(wData[(size_t)k*numCells + id]*wData[(size_t)kprime*numCells + id]);
+				dPair = (zData[(size_t)k*numCells + id] - zData[(size_t)kprime*numCells + id])*wPair;
+				rPair = wPair + eps;
+
+				rtR[k*inDataSize + k] += rPair*rPair;
+				rtR[kprime*inDataSize + kprime] += rPair*rPair;
+				rtR[k*inDataSize + kprime] -= rPair*rPair;
+				rtR[kprime*inDataSize + k] -= rPair*rPair;
+				rtD[k] += dPair*rPair;
+				rtD[kprime] -= dPair*rPair;
+				sumD += dPair*dPair;
+				sumW += wPair;
+				curLoc = curLoc + 1;
 			}
 		}
-		printf("Finished weighting %d of %d sets\n", i, inDataSize);
 	}
+	zData.clear();
+	wData.clear();
 
 	//PAE - 12/31/2009. If there is no overlap, which is possible, leave the subroutine.
 	//MATLAB and CPP versions may not agree!!!
@@ -266,39 +404,11 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 	if(curLoc == 0)
 		return ;
 
-	//Create empty sparse matrices
-	boost::numeric::ublas::mapped_matrix<double>  dzDData2 (1, curLoc, 0);
-	boost::numeric::ublas::mapped_matrix<double>  dzRData2 (inDataSize, curLoc, 0);
-	boost::numeric::ublas::mapped_matrix<double>  dzWData2 (1, curLoc, 0);
-
-	//convert to weighted space (priestly p.315)
-	sumW = 0;
-	for (int i = 0; i < curLoc; i++)
-	{
-		dzDData2(0,i) = dzDData(0,i)*dzWData(0,i);
-		dzWData2(0,i) = dzWData(0,i);
-		for (int j = 0; j < inDataSize; j++)
-		{
-			dzRData2(j,i) = dzRData(j,i) * (dzWData2(0,i) + (eps));
-		}
-		sumW += dzWData2(0,i);
-	}
-
-	//Save as compressed sparse matrix for efficient computations
-	boost::numeric::ublas::compressed_matrix<double> dzRData2_C (dzRData2);
-	boost::numeric::ublas::compressed_matrix<double> dzDData2_C (dzDData2);
-	boost::numeric::ublas::compressed_matrix<double> dzWData2_C (dzWData2);
-
-	//model-model correlation (mult. by weights here)
-	boost::numeric::ublas::compressed_matrix<double> rtRGrid = prod(dzRData2_C, trans(dzRData2_C))/sumW;
-	//model-data correlation
-	boost::numeric::ublas::compressed_matrix<double> rtDGrid = prod(dzDData2_C, trans(dzRData2_C))/sumW;
-
 	//B. Get the values that are not zero
 	//It is possible that there is no overlap for some data sets, remove
-	for (int i = 0; i < (const int)rtRGrid.size2(); i++)
+	for (int i = 0; i < inDataSize; i++)
 	{
-		if (rtRGrid(i,i) > 0+eps)
+		if (rtR[i*inDataSize + i]/sumW > 0+eps)
 			idVector.push_back(i);
 	}
 
@@ -309,40 +419,33 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 	}
 
 	int newFileSize = (const int)idVector.size();
-	boost::numeric::ublas::mapped_matrix<double> temp  (rtRGrid);
-	boost::numeric::ublas::mapped_matrix<double> temp2 (rtDGrid);
-
-	rtRGrid.clear();
-	rtDGrid.clear();
-	//rtRGrid.resize (idVector.size() + 1, idVector.size() + 1); // produced !preserve error in UNIX // SJZ 12/10/14
-	//rtDGrid.resize (1, idVector.size() + 1);
-	rtRGrid = boost::numeric::ublas::compressed_matrix<double>(idVector.size() + 1, idVector.size() + 1);
-	rtDGrid = boost::numeric::ublas::compressed_matrix<double>(1, idVector.size() + 1);
+	//model-model correlation and model-data correlation (mult. by weights here)
+	boost::numeric::ublas::matrix<double> rtRGrid(newFileSize + 1, newFileSize + 1);
+	vector<double> rtDGrid(newFileSize + 1, 0.00);
 
 	//C. Do some matrix setting based on the values that were found in the idVector
 	//Augment with Lagrange Mult., B
 	int B = 0; // sum of offsets equals this
-	for (int i = 0; i < (const int)idVector.size(); i++)
+	for (int i = 0; i < newFileSize; i++)
 	{
-		for (int j = 0; j < (const int)idVector.size(); j++)
-		{
-			rtRGrid(i,j) = temp(idVector[i], idVector[j]);
-			if( i == idVector.size()-1)
-				rtRGrid(i+1,j) = 1; //append row of ones
-		}
-		rtRGrid(i,idVector.size()) = 1; //append column of ones
-		rtDGrid(0,i) = temp2(0, idVector[i]); //Keep id datasets
+		for (int j = 0; j < newFileSize; j++)
+			rtRGrid(i,j) = rtR[idVector[i]*inDataSize + idVector[j]]/sumW;
+		rtRGrid(i,newFileSize) = 1; //append column of ones
+		rtRGrid(newFileSize,i) = 1; //append row of ones
+		rtDGrid[i] = rtD[idVector[i]]/sumW; //Keep id datasets
 	}
-	rtRGrid.erase_element(rtRGrid.size1()-1, rtRGrid.size2()-1);//= 0;
-	rtDGrid(0,idVector.size()) = B; // append B
+	rtRGrid(newFileSize,newFileSize) = 0;
+	rtDGrid[newFileSize] = B; // append B
 
 	int count = 0;
-	boost::numeric::ublas::compressed_matrix<double> rtRInv;
-	boost::numeric::ublas::compressed_matrix<double> dzSolution;
-	boost::numeric::ublas::compressed_matrix<double> rtRTemp;
+	bool solved = false;
+	boost::numeric::ublas::matrix<double> rtRInv(newFileSize + 1, newFileSize + 1);
+	boost::numeric::ublas::matrix<double> rtRTemp;
+	vector<double> dzSolution(newFileSize + 1, 0.00);
+	rtRInv.clear();
 
 	//D. Invert the matrix
-	while((dzSolution.nnz() == 0) && (count <= 10))
+	while(!solved && (count <= 10))
 	{
 		double p = 0;
 		if (count > 0)
@@ -354,14 +457,18 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 			for (int j = 0; j < newFileSize; j++)
 				rtRTemp(i,j) = rtRTemp(i,j) + p;
 
-		rtRInv = boost::numeric::ublas::compressed_matrix<double> (rtRTemp.size1(), rtRTemp.size2());		
-		//rtRInv.resize(rtRTemp.size1(), rtRTemp.size2()); // produced !preserve error in UNIX // SJZ 12/10/14
-		InvertMatrix(rtRTemp, rtRInv);
-
-		dzSolution = prod(rtRInv, trans(rtDGrid));
+		if (InvertMatrix(rtRTemp, rtRInv))
+		{
+			for (int i = 0; i <= newFileSize; i++)
+			{
+				dzSolution[i] = 0;
+				for (int j = 0; j <= newFileSize; j++)
+					dzSolution[i] += rtRInv(i,j)*rtDGrid[j];
+				if (dzSolution[i] != 0)
+					solved = true;
+			}
+		}
 		count += 1;
-
-		rtRInv.clear();
 	}
 
 	vector<int>::iterator it = idVector.begin();
@@ -369,19 +476,20 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 	double meanOffset = 0;
 	for (int i = 0; i < newFileSize; i++)
 	{
-		if(abs(dzSolution(i,0)) > eps)
+		if(abs(dzSolution[i]) > eps)
 		{
-			cOffset[*it] = dzSolution(i,0);
+			cOffset[*it] = dzSolution[i];
 			meanOffset += cOffset[*it];
 		}
 		it++;
 	}
 	meanOffset /= (double)cOffset.size();
 
-	boost::numeric::ublas::compressed_matrix<double> msz = (prod(dzDData2_C, trans(dzDData2_C))/sumW);
-	boost::numeric::ublas::compressed_matrix<double> msrTemp = prod(trans(dzSolution), rtRGrid);
-	boost::numeric::ublas::compressed_matrix<double> msrTemp2 = prod(msrTemp, dzSolution);
-	boost::numeric::ublas::compressed_matrix<double> msr = msz - msrTemp2;
+	double msz = sumD/sumW;
+	double msr = msz;
+	for (int i = 0; i <= newFileSize; i++)
+		for (int j = 0; j <= newFileSize; j++)
+			msr -= dzSolution[i]*rtRGrid(i,j)*dzSolution[j];
 
 	//F. Compute the offset error
 	double offErrTmp;
@@ -391,11 +499,11 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 	for (int i = 0; i < newFileSize; i++){
 		//default error
 		while(m<*it){
-			cOffsetError[m] = cOffsetError[m]+ sqrt(msz(0,0));
+			cOffsetError[m] = cOffsetError[m]+ sqrt(msz);
 			meanOffsetError += cOffsetError[m];
 			m++;
 		}
-		offErrTmp = (rtRInv(i,i)*msr(0,0));
+		offErrTmp = (rtRInv(i,i)*msr);
 		if ((sumW-2)>0){
 			offErrTmp = offErrTmp/(sumW-2.00);
 			if (offErrTmp >= 0)
@@ -472,7 +580,7 @@ void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1
 /* Matrix inversion routine.
 Uses lu_factorize and lu_substitute in uBLAS to invert a matrix */
  template<class T>
-bool InvertMatrix (const boost::numeric::ublas::compressed_matrix<T>& input, boost::numeric::ublas::compressed_matrix<T>& inverse) {
+bool InvertMatrix (const boost::numeric::ublas::matrix<T>& input, boost::numeric::ublas::matrix<T>& inverse) {
 	using namespace boost::numeric::ublas;
 	typedef permutation_matrix<std::size_t> pmatrix;
 	// create a working copy of the input
@@ -14,7 +14,6 @@
 #endif
 
 //Third-Party Includes
-#include <boost/numeric/ublas/matrix_sparse.hpp>
 #include <boost/numeric/ublas/io.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
@@ -54,7 +53,7 @@
 void computeOffset(vector<TRUE_DATA> *inputData, double x0, double y0, double x1, double y1, vector<double> *xInterpVector, vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, vector<double> *zDataIn, vector<double> *eDataIn, vector<double> *hEDataIn, vector<double> *vEDataIn, string &kernel,  map<string, int> addOpts);
 
 template<class T>
-bool InvertMatrix (const boost::numeric::ublas::compressed_matrix<T>& input, boost::numeric::ublas::compressed_matrix<T>& inverse);
+bool InvertMatrix (const boost::numeric::ublas::matrix<T>& input, boost::numeric::ublas::matrix<T>& inverse);
 template <typename size_type, typename A> // SJZ
 int determinant(const boost::numeric::ublas::permutation_matrix<size_type,A>& pm);
 
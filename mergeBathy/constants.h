@@ -37,7 +37,7 @@ const double RCOND_TOL = 1e-6;  //Reciprocal condition test threshold
 /**
 * Version Number.
 */
-const static char *OBF_VERSION_NUMBER = "BUILD 5.0.2: July 23, 2015";
+const static char * const OBF_VERSION_NUMBER = "BUILD 5.0.2: July 23, 2015";
 
 /**
 * PI.
@@ -83,6 +83,35 @@ const double eps = 2.220446049250313e-016;
 */
 const int KRIGED_SIZE_THRESHOLD = 64;
 
+/**
+* Sets the maximum amount of interpolation points whose kriging systems are solved together in one call.
+*/
+const int KRIGING_BATCH_SIZE = 256;
+
+/**
+* Sets the number of lattice cells per smoothing scale the data are binned onto by -fftSmoothing.
+*/
+const int FFT_SMOOTHING_CELLS_PER_SCALE = 8;
+
+/**
+* Sets the largest padded lattice -fftSmoothing convolves.  Larger tiles are interpolated node by node.
+*/
+const double FFT_SMOOTHING_MAX_CELLS = 16777216;
+
+/**
+* Sets how many (point, node) pairs of the tile sweep each lattice cell must replace for -fftSmoothing to convolve
+* a tile.  Sparser tiles are swept.  Measured on boxcar tiles, a lattice cell costs about 1.8 microseconds across the
+* convolutions and a pair about 12 nanoseconds; the convolution broke even between 150 and 330 pairs per cell, so
+* it is only taken above that range.
+*/
+const double FFT_SMOOTHING_PAIRS_PER_CELL = 384;
+
+/**
+* Sets the smallest sum of window weights, relative to the sum of the tile's weights, that -fftSmoothing trusts.
+* Nodes with less go through the exact computation.
+*/
+const double FFT_SMOOTHING_MIN_WEIGHT = 1e-9;
+
 /**
 * Input argument error. -1.
 */
@@ -103,6 +103,7 @@ bool externalInterpolators::run_MB_ZGrid(vector<double> *x, vector<double> *y, v
 	int mb_nx; //interpolated area x size
 	int mb_ny; //interpolated area y size
 	int mb_nrng = 1000; //mbzg.nrng;
+	int mb_nthreads = additionalOptions.find("-multiThread")->second;
 
 	//2.  Working arrays
 	float *mb_zpij = NULL;
@@ -181,7 +182,7 @@ bool externalInterpolators::run_MB_ZGrid(vector<double> *x, vector<double> *y, v
 	//************************************************************************************
 	mb_zgrid(mb_z, &mb_nx, &mb_ny, &mb_x1, &mb_y1,
 			 &mb_dx, &mb_dy, mb_xyz, &mb_n, mb_zpij,
-			 mb_knxt, mb_imnew, &mb_cay, &mb_nrng);
+			 mb_knxt, mb_imnew, &mb_cay, &mb_nrng, &mb_nthreads);
 
 	dgrid zGrid_temp = dgrid(mb_ny, mb_nx);
 
@@ -350,7 +351,7 @@ bool externalInterpolators::run_MB_ZGrid(vector<double> *x, vector<double> *y, v
 //************************************************************************************
 // SUBROUTINE III: Function call for running GMT Surface
 //************************************************************************************
-bool externalInterpolators::run_Surface(vector<double> *x, vector<double> *y, vector<double> *z, vector<double> *e, vector<double> *h, vector<double> *v, map<string, int> additionalOptions, double spacingX, double spacingY, double tension, string z_OutputFileName, double scaleFactor, double alpha, int usage, Bathy_Grid* bathyGrid)
+bool externalInterpolators::run_Surface(vector<double> *x, vector<double> *y, vector<double> *z, vector<double> *e, vector<double> *h, vector<double> *v, map<string, int> additionalOptions, double spacingX, double spacingY, double tension, string z_OutputFileName, double scaleFactor, double alpha, int usage, int numThreads, Bathy_Grid* bathyGrid)
 {
 	//************************************************************************************
 	// 0. Declare local variables and objects
@@ -429,7 +430,7 @@ bool externalInterpolators::run_Surface(vector<double> *x, vector<double> *y, ve
 	//There was a loop to perform Monte Carlo Simulations here (see older versions) but this didn't make sense so it was removed. SJZ
 	x0=y0=15800;
 	x1=y1=16200;
-	returnValue = processSurface(xConverted, yConverted, zConverted, (int)(*x).size(), x0, y0, z0, x1, y1, z1, spacingX, spacingY, tension, &xPostSurface, &yPostSurface, &zPostSurface, &postSurfaceSize);
+	returnValue = processSurface(xConverted, yConverted, zConverted, (int)(*x).size(), x0, y0, z0, x1, y1, z1, spacingX, spacingY, tension, numThreads, &xPostSurface, &yPostSurface, &zPostSurface, &postSurfaceSize);
 
 	stopTime = clock();
 	compTime = stopTime-startTime;
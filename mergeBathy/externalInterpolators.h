@@ -82,9 +82,10 @@ public:
 	* @param scaleFactor - The multiplier value for a Confidence Interval to be used in error calculation. A value of 1.96 is typically used for a 95% Confidence Interval.
 	* @param alpha - This is the alpha value for error computation. Typically 2.0.
 	* @param usage - Sets how MB_ZGrid output will be used. A value of 0 will perform the MB_ZGrid interpolation and write the results to the specified output file.  A value of 1 will perform the MB_ZGrid interpolation, write the results to the specified output file, and use the computed X,Y, and Z values as input for mergeBathy.  If used as input then the data will take the place of the data read from the input files.  This allows for a pre-smoothing effect before mergeBathy is run.
+	* @param numThreads - Number of threads for the GMT_Surface relaxation.  0 or 1 runs the serial sweep.
 	* @return Success or failure value.
 	*/
-	bool run_Surface(vector<double> *x, vector<double> *y, vector<double> *z, vector<double> *e, vector<double> *hError, vector<double> *v, map<string, int> additionalOptions, double spacingX, double spacingY, double tension, string z_OutputFileName, double scaleFactor, double alpha, int usage, Bathy_Grid* bathyGrid);
+	bool run_Surface(vector<double> *x, vector<double> *y, vector<double> *z, vector<double> *e, vector<double> *hError, vector<double> *v, map<string, int> additionalOptions, double spacingX, double spacingY, double tension, string z_OutputFileName, double scaleFactor, double alpha, int usage, int numThreads, Bathy_Grid* bathyGrid);
 
 	/**
 	* Run the ALG Spline routine.
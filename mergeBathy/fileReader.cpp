@@ -4,8 +4,18 @@
 #include <cstring>	//UNIX
 #include <cmath>
 #include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
 #include "standardOperations.h"
 #include "constants.h" //UNIX for INT_MIN
+#include "binaryBathyFile.h"
+#include "textRecordReader.h"
+#include "inputFileIndex.h"
+#include "MB_Threads.h"
+#ifndef WIN32
+#include <semaphore.h>
+#include <sys/time.h>
+#endif
 
 #ifdef _MSC_VER
 //Disable warnings since this is a Third-party file. -SJZ
@@ -21,24 +31,161 @@
 #define _countof(a) (sizeof(a)/sizeof(*(a)))
 #endif
 
+//************************************************************************************
+// 0. Declare local data and functions used to read the input files concurrently
+//************************************************************************************
+/**
+* Arguments passed to each thread reading input files.  A thread only writes the inputData, status and seconds entries of the files it takes from the queue.
+*/
+typedef struct
+{
+	vector<string> *inputFiles;
+	vector<TRUE_DATA> *inputData;
+	BOUNDING_BOX bbox;
+	int noerr;
+	int nonegdepth;
+	int unScaledAvgInputs;
+	int numThreads;
+	mbTaskQueue *tasks;
+	vector<int> *status;
+	vector<double> *seconds;
+	int threadNum;
+} READ_FILES_DATA;
+
+/**
+* Arguments passed to each thread locating the beams of a block of GSF pings.  A thread only writes the beams of the pings it takes from the queue.
+*/
+typedef struct
+{
+	const GSF_PING_BLOCK *block;
+	mbTaskQueue *tasks;
+	double *lonmin;
+	double *latmin;
+	double *depth;
+	int threadNum;
+} PLACE_PINGS_DATA;
+
+//Number of GSF pings decoded before their beams are located
+#define GSF_PINGS_PER_BLOCK 2048
+
+//The GSF library keeps one table of open files for the whole process and holds no more than
+//GSF_MAX_OPEN_FILES at a time.  While files are read concurrently the table is only changed
+//under gsfTableLock and gsfOpenSlots makes a thread wait for a free entry.
+static bool concurrentRead = false;
+
+//Set by readFile when the text input files are read through their .mbi sidecar spatial indexes
+static bool indexInputFiles = false;
+#ifdef WIN32
+static CRITICAL_SECTION gsfTableLock;
+static HANDLE gsfOpenSlots;
+#else
+static pthread_mutex_t gsfTableLock = PTHREAD_MUTEX_INITIALIZER;
+static sem_t gsfOpenSlots;
+#endif
+
+static int readInputFile(vector<string> *inputFiles, int i, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads);
+static int readFilesConcurrently(vector<string> *inputFiles, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, vector<double> *bytes, vector<int> *status, vector<double> *seconds);
+static double inputFileBytes(const string &inputFile);
+static double wallClock();
+static void placePingBlock(const GSF_PING_BLOCK *block, int numThreads, double *lonmin, double *latmin, double *depth);
+static bool openInputIndex(const string &fileName, BOUNDING_BOX bbox, textRecordReader *inFile, inputFileIndex *index);
+static void saveInputIndex(const string &fileName, inputFileIndex *index);
+
 //************************************************************************************
 // SUBROUTINE I: Function call for reading input files. The starting point for file reader.
 //************************************************************************************
-int readFile(string &fileName, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs)
+int readFile(string &fileName, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, int indexInputs)
 {
 	int retVal = SUCCESS;
 
 	//************************************************************************************
 	// 0. Declare local variables and objects
 	//************************************************************************************
-	ifstream inListFile;
-	string inputFile;
-	char inputFileChar[512];
 	vector<string> inputFiles;
+	vector<int> status;
+	vector<double> bytes, seconds;
+	double start;
 
 	//************************************************************************************
-	// I. Try to open the input file
+	// I. Read the input file list
 	//************************************************************************************
+	retVal = readFileList(fileName, &inputFiles);
+	if (retVal != SUCCESS)
+		return retVal;
+	indexInputFiles = (indexInputs != 0);
+	cout << "Number of Input Files to Read: " << inputFiles.size() << endl;
+	(*inputData) = vector<TRUE_DATA>(inputFiles.size());
+	status = vector<int>(inputFiles.size(), SUCCESS);
+	seconds = vector<double>(inputFiles.size(), 0.00);
+	bytes = vector<double>(inputFiles.size(), 0.00);
+	for (int i = 0; i < (const int)inputFiles.size(); i++)
+		bytes[i] = inputFileBytes(inputFiles[i]);
+
+	//************************************************************************************
+	// II. Read each file into its own TRUE_DATA
+	//************************************************************************************
+	//The files are independent.  Each reader fills only (*inputData)[i], including the
+	//longitudeSum and latitudeSum of that file, so the data come out in list order however
+	//the reads are scheduled and the sums are combined across files by the caller.
+	if (numThreads > 1 && inputFiles.size() > 1)
+	{
+		//A. Concurrent.  Every file is read and the first failure in list order is returned.
+		readFilesConcurrently(&inputFiles, inputData, bbox, noerr, nonegdepth, unScaledAvgInputs, numThreads, &bytes, &status, &seconds);
+		for (int i = 0; i < (const int)inputFiles.size(); i++)
+		{
+			if (status[i] != SUCCESS)
+			{
+				retVal = status[i];
+				break;
+			}
+		}
+	}
+	else
+	{
+		//B. Serial.  Stop at the first failure.
+		for (int i = 0; i < (const int)inputFiles.size(); i++)
+		{
+			start = wallClock();
+			retVal = status[i] = readInputFile(&inputFiles, i, bbox, inputData, noerr, nonegdepth, unScaledAvgInputs, numThreads);
+			seconds[i] = wallClock() - start;
+			if (retVal != SUCCESS)
+				break;
+		}
+	}
+
+	//************************************************************************************
+	// III. Report the read throughput of each file in list order
+	//************************************************************************************
+	if (retVal == SUCCESS)
+	{
+		double totalBytes = 0, totalSeconds = 0;
+		int totalRecords = 0;
+		printf("\n%10s %10s %10s %10s  %s\n", "Records", "MB", "Seconds", "MB/s", "Input File");
+		for (int i = 0; i < (const int)inputFiles.size(); i++)
+		{
+			printf("%10d %10.2f %10.3f %10.2f  %s\n", (int)(*inputData)[i].lon.size(), bytes[i] / 1048576.0, seconds[i],
+				(seconds[i] > 0) ? bytes[i] / 1048576.0 / seconds[i] : 0.00, inputFiles[i].c_str());
+			totalRecords += (int)(*inputData)[i].lon.size();
+			totalBytes += bytes[i];
+			totalSeconds += seconds[i];
+		}
+		printf("%10d %10.2f %10.3f %10s  %s\n", totalRecords, totalBytes / 1048576.0, totalSeconds, "", "Total (sum of per file read times)");
+	}
+
+	printf("Done Reading Input Files\n\n");
+	inputFiles.clear();
+	return retVal;
+}
+
+//************************************************************************************
+// SUBROUTINE I.A: Function call for reading the names in an input file list.
+//************************************************************************************
+int readFileList(string &fileName, vector<string> *inputFiles)
+{
+	ifstream inListFile;
+	string inputFile;
+	char inputFileChar[512];
+
 	inListFile.open(fileName.c_str(), ifstream::in);
 	if (!inListFile.is_open())
 	{
@@ -46,6 +193,7 @@ int readFile(string &fileName, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox,
 		cerr << fileName.c_str() << endl;
 		return LIST_FILE_ERROR;
 	}
+	(*inputFiles).clear();
 	while(!inListFile.eof())
 	{
 		//Read in each input file to be used
@@ -59,17 +207,21 @@ int readFile(string &fileName, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox,
 				inputFile.erase(found);
 			inputFile.erase(inputFile.find_last_not_of(" \r\t")+1);
 			if(!inputFile.empty())
-				inputFiles.push_back(inputFile);
+				(*inputFiles).push_back(inputFile);
 		}
 	}
 	inListFile.clear();
 	inListFile.close();
-	cout << "Number of Input Files to Read: " << inputFiles.size() << endl;
-	(*inputData) = vector<TRUE_DATA>(inputFiles.size());
+	return SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE I.B: Check the supported file types header file and read one input file accordingly.
+//************************************************************************************
+static int readInputFile(vector<string> *inputFiles, int i, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads)
+{
+	string &inputFile = (*inputFiles)[i];
 
-	//************************************************************************************
-	// II. Check the supported file types header file and process accordingly
-	//************************************************************************************
 	//If the same value is read-in for all e, h, or v, error we assume this value is an average
 	//and scale it as a function of each sounding's depth for a new value.  The may be disabled
 	//for testing purposes with the -useUnScaledAvgInputs flag.
@@ -78,52 +230,376 @@ int readFile(string &fileName, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox,
 	//Specifically, SR = 1500 m/s/30,000 hz = 0.05 m.
 	//Here we are using 0.01 as a default which corresponds to a sampling frequency of 150,000 hz
 	//We need to check the average frequency for sonar.
-	int retval =!SUCCESS;
-	for (int i = 0; i < (const int)inputFiles.size(); i++)
+
+	//0. mergeBathy binary, checked first since converted files keep their original extension before .mbb
+	if (inputFile.find(binaryBathy) != string::npos)
+		return readMBB(inputFile, bbox, inputData, i, nonegdepth);
+	//A. No Error
+	else if ((inputFile.find(no_error_DAT) != string::npos) || (inputFile.find(no_error_TXT) != string::npos))
+		return readXYZ(inputFile, bbox, inputData, i, noerr, nonegdepth);
+	//B. Error
+	else if ((inputFile.find(error_DAT) != string::npos) || (inputFile.find(error_TXT) != string::npos))
+		return readXYZE(inputFile, bbox, inputData, i, noerr, nonegdepth, unScaledAvgInputs);
+	//C. HV Error
+	else if ((inputFile.find(hv_error_DAT) != string::npos) || (inputFile.find(hv_error_TXT) != string::npos))
+		return readXYZHV(inputFile, bbox, inputData, i, noerr, nonegdepth, unScaledAvgInputs);
+	//D. GSF
+	else if ((inputFile.find(GSF) != string::npos) || (inputFile.find(GSF2) != string::npos))
+		return readGSF(inputFile, bbox, inputData, i, noerr, nonegdepth, unScaledAvgInputs, numThreads);
+	//E. ARC_ASCII_RASTER
+	else if ((inputFile.find(raster) != string::npos) || (inputFile.find(raster2) != string::npos))
+		return readARC_ASCII_RASTER(inputFile, bbox, inputData, i, noerr, nonegdepth);
+
+	cerr << "Unable to open input file list!" << endl;
+	cerr << "File type not supported (no identifiable extension found)!" << endl;
+	cerr << inputFile.c_str() << endl;
+	return LIST_FILE_EXT_ERROR;
+}
+
+//************************************************************************************
+// SUBROUTINE I.C: Thread function that reads input files from the queue until it is empty.
+//************************************************************************************
+#ifdef WIN32
+static DWORD WINAPI threadReadFiles(LPVOID lpParam)
+#else
+static void *threadReadFiles(void *lpParam)
+#endif
+{
+	READ_FILES_DATA *rfd = (READ_FILES_DATA*)lpParam;
+	MB_TASK task;
+	double start;
+
+	while ((*rfd->tasks).nextTask(rfd->threadNum, &task))
 	{
-		//A. No Error
-		if ((inputFiles[i].find(no_error_DAT) != string::npos) || (inputFiles[i].find(no_error_TXT) != string::npos))
-		{
-			retVal = readXYZ(inputFiles[i], bbox, inputData, i, noerr, nonegdepth);
-			if (retVal != SUCCESS)
-				break;
-		}//B. Error
-		else if ((inputFiles[i].find(error_DAT) != string::npos) || (inputFiles[i].find(error_TXT) != string::npos))
+		start = wallClock();
+		(*rfd->status)[task.begin] = readInputFile(rfd->inputFiles, task.begin, rfd->bbox, rfd->inputData, rfd->noerr, rfd->nonegdepth, rfd->unScaledAvgInputs, rfd->numThreads);
+		(*rfd->seconds)[task.begin] = wallClock() - start;
+	}
+	return 0;
+}
+
+//************************************************************************************
+// SUBROUTINE I.D: Read the input files with a pool of threads.
+//************************************************************************************
+static int readFilesConcurrently(vector<string> *inputFiles, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, vector<double> *bytes, vector<int> *status, vector<double> *seconds)
+{
+	int numFiles = (const int)(*inputFiles).size();
+	int numWorkers = min(numThreads, numFiles);
+
+	//A. Queue one task per file, largest first, so a long file does not start last
+	mbTaskQueue tasks(numWorkers);
+	MB_TASK task;
+	for (int i = 0; i < numFiles; i++)
+	{
+		task.outerLoop = 0;
+		task.innerLoop = 0;
+		task.begin = i;
+		task.end = i + 1;
+		task.cost = (*bytes)[i];
+		tasks.addTask(task);
+	}
+	tasks.schedule();
+
+	vector<READ_FILES_DATA> rfd = vector<READ_FILES_DATA>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		rfd[t].inputFiles = inputFiles;
+		rfd[t].inputData = inputData;
+		rfd[t].bbox = bbox;
+		rfd[t].noerr = noerr;
+		rfd[t].nonegdepth = nonegdepth;
+		rfd[t].unScaledAvgInputs = unScaledAvgInputs;
+		rfd[t].numThreads = max(1, numThreads / numWorkers);	//Threads left over for locating GSF beams
+		rfd[t].tasks = &tasks;
+		rfd[t].status = status;
+		rfd[t].seconds = seconds;
+		rfd[t].threadNum = t;
+	}
+	cout << "Reading Input Files with " << numWorkers << " Threads" << endl;
+
+	//B. Start the threads and wait for every file to be read
+#ifdef WIN32
+	InitializeCriticalSection(&gsfTableLock);
+	gsfOpenSlots = CreateSemaphore(NULL, GSF_MAX_OPEN_FILES, GSF_MAX_OPEN_FILES, NULL);
+	concurrentRead = true;
+
+	vector<HANDLE> hThreadArray = vector<HANDLE>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		hThreadArray[t] = CreateThread(NULL, 0, threadReadFiles, &rfd[t], 0, NULL);
+		if (hThreadArray[t] == NULL)
 		{
-			retVal = readXYZE(inputFiles[i], bbox, inputData, i, noerr, nonegdepth, unScaledAvgInputs);
-			if (retVal != SUCCESS)
-				break;
-		}//C. HV Error
-		else if ((inputFiles[i].find(hv_error_DAT) != string::npos) || (inputFiles[i].find(hv_error_TXT) != string::npos))
+			cerr << "Unable to create a file reading thread!" << endl;
+			ExitProcess(3);
+		}
+	}
+	WaitForMultipleObjects(numWorkers, &hThreadArray[0], TRUE, INFINITE);
+	for (int t = 0; t < numWorkers; t++)
+		CloseHandle(hThreadArray[t]);
+
+	concurrentRead = false;
+	CloseHandle(gsfOpenSlots);
+	DeleteCriticalSection(&gsfTableLock);
+#else
+	sem_init(&gsfOpenSlots, 0, GSF_MAX_OPEN_FILES);
+	concurrentRead = true;
+
+	vector<pthread_t> hThreadArray = vector<pthread_t>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		int rc = pthread_create(&hThreadArray[t], NULL, threadReadFiles, (void *) &rfd[t]);
+		if (rc)
 		{
-			retVal = readXYZHV(inputFiles[i], bbox, inputData, i, noerr, nonegdepth, unScaledAvgInputs);
-			if (retVal != SUCCESS)
-				break;
-		}//D. GSF
-		else if ((inputFiles[i].find(GSF) != string::npos) || (inputFiles[i].find(GSF2) != string::npos))
+			fprintf(stderr, "Error - pthread_create() return code: %d\n %s", rc, strerror(rc));
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (int t = 0; t < numWorkers; t++)
+		pthread_join(hThreadArray[t], NULL);
+
+	concurrentRead = false;
+	sem_destroy(&gsfOpenSlots);
+#endif
+	return SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE I.E: Open and close GSF files through the shared GSF file table, and report whether files are being read concurrently.
+//************************************************************************************
+static int openGSF(char *fName)
+{
+	int gsfHandle;
+	if (!concurrentRead)
+		return open_gsffile(fName);
+
+#ifdef WIN32
+	WaitForSingleObject(gsfOpenSlots, INFINITE);
+	EnterCriticalSection(&gsfTableLock);
+	gsfHandle = open_gsffile(fName);
+	LeaveCriticalSection(&gsfTableLock);
+	if (gsfHandle == -1)
+		ReleaseSemaphore(gsfOpenSlots, 1, NULL);
+#else
+	while (sem_wait(&gsfOpenSlots) != 0 && errno == EINTR);
+	pthread_mutex_lock(&gsfTableLock);
+	gsfHandle = open_gsffile(fName);
+	pthread_mutex_unlock(&gsfTableLock);
+	if (gsfHandle == -1)
+		sem_post(&gsfOpenSlots);
+#endif
+	return gsfHandle;
+}
+
+static void closeGSF(int *gsfHandle)
+{
+	if (!concurrentRead)
+	{
+		close_gsffile(gsfHandle);
+		return;
+	}
+
+#ifdef WIN32
+	EnterCriticalSection(&gsfTableLock);
+	close_gsffile(gsfHandle);
+	LeaveCriticalSection(&gsfTableLock);
+	ReleaseSemaphore(gsfOpenSlots, 1, NULL);
+#else
+	pthread_mutex_lock(&gsfTableLock);
+	close_gsffile(gsfHandle);
+	pthread_mutex_unlock(&gsfTableLock);
+	sem_post(&gsfOpenSlots);
+#endif
+}
+
+bool readingConcurrently()
+{
+	return concurrentRead;
+}
+
+//************************************************************************************
+// SUBROUTINE I.F: Size of an input file named in the file list, without its decorations.
+//************************************************************************************
+static double inputFileBytes(const string &inputFile)
+{
+	string name = inputFile;
+	size_t found = name.find_first_of("&^#");
+	if (found != string::npos)
+		name.erase(found);
+	name.erase(name.find_last_not_of(" \t") + 1);
+
+	struct stat fileStat;
+	if (stat(name.c_str(), &fileStat) != 0)
+		return 0.00;
+	return (double)fileStat.st_size;
+}
+
+//************************************************************************************
+// SUBROUTINE I.G: Wall clock time in seconds.  clock() sums the time of all threads on UNIX.
+//************************************************************************************
+static double wallClock()
+{
+#ifdef WIN32
+	LARGE_INTEGER count, frequency;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&frequency);
+	return (double)count.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + 1e-6 * (double)tv.tv_usec;
+#endif
+}
+
+//************************************************************************************
+// SUBROUTINE I.H: Split the weight, tide correction and maximum data offset from an input file name.
+//************************************************************************************
+void parseFileModifiers(string &fileName, double *wMultiplier, double *tideCorrection, double *maximumDataOffset)
+{
+	const char modifiers[3] = { '&', '^', '#' };
+	const char *text;
+	double value;
+
+	for (int m = 0; m < 3; m++)
+	{
+		size_t found = fileName.find(modifiers[m]);
+		if (found == string::npos)
+			continue;
+		text = fileName.c_str() + found;
+		while (*text == modifiers[m] || *text == ' ' || *text == '\t')
+			text++;
+		if (sscanf_s(text, "%lf", &value) <= 0)
+			continue;
+		if (m == 0)
+			*wMultiplier = 1 / value;
+		else if (m == 1)
+			*tideCorrection = value;
+		else
+			*maximumDataOffset = value;
+	}
+	fileName.erase(min(fileName.find_first_of("&^#\t\n"), fileName.length()));
+}
+
+//************************************************************************************
+// SUBROUTINE I.I: Thread function that locates the beams of GSF pings from the queue until it is empty.
+//************************************************************************************
+#ifdef WIN32
+static DWORD WINAPI threadPlacePings(LPVOID lpParam)
+#else
+static void *threadPlacePings(void *lpParam)
+#endif
+{
+	PLACE_PINGS_DATA *ppd = (PLACE_PINGS_DATA*)lpParam;
+	MB_TASK task;
+
+	while ((*ppd->tasks).nextTask(ppd->threadNum, &task))
+		place_ping_block(ppd->block, task.begin, task.end, 0, ppd->lonmin, ppd->latmin, ppd->depth);
+	return 0;
+}
+
+//************************************************************************************
+// SUBROUTINE I.J: Locate the beams of a block of GSF pings, dividing the pings among threads.
+//************************************************************************************
+static void placePingBlock(const GSF_PING_BLOCK *block, int numThreads, double *lonmin, double *latmin, double *depth)
+{
+	int numWorkers = min(numThreads, (*block).numPings);
+	if (numWorkers <= 1)
+	{
+		place_ping_block(block, 0, (*block).numPings, 0, lonmin, latmin, depth);
+		return;
+	}
+
+	//A. Each task is a run of consecutive pings, so every beam is written by one thread
+	mbTaskQueue tasks(numWorkers);
+	tasks.addBlocks((*block).numPings);
+	tasks.schedule();
+
+	vector<PLACE_PINGS_DATA> ppd = vector<PLACE_PINGS_DATA>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		ppd[t].block = block;
+		ppd[t].tasks = &tasks;
+		ppd[t].lonmin = lonmin;
+		ppd[t].latmin = latmin;
+		ppd[t].depth = depth;
+		ppd[t].threadNum = t;
+	}
+
+	//B. Start the threads and wait for every ping to be located
+#ifdef WIN32
+	vector<HANDLE> hThreadArray = vector<HANDLE>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		hThreadArray[t] = CreateThread(NULL, 0, threadPlacePings, &ppd[t], 0, NULL);
+		if (hThreadArray[t] == NULL)
 		{
-			retVal = readGSF(inputFiles[i], bbox, inputData, i, noerr, nonegdepth, unScaledAvgInputs);
-			if (retVal != SUCCESS)
-				break;
-		}//E. ARC_ASCII_RASTER
-		else if ((inputFiles[i].find(raster) != string::npos) || (inputFiles[i].find(raster2) != string::npos))
+			cerr << "Unable to create a GSF beam locating thread!" << endl;
+			ExitProcess(3);
+		}
+	}
+	WaitForMultipleObjects(numWorkers, &hThreadArray[0], TRUE, INFINITE);
+	for (int t = 0; t < numWorkers; t++)
+		CloseHandle(hThreadArray[t]);
+#else
+	vector<pthread_t> hThreadArray = vector<pthread_t>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		int rc = pthread_create(&hThreadArray[t], NULL, threadPlacePings, (void *) &ppd[t]);
+		if (rc)
 		{
-			retVal = readARC_ASCII_RASTER(inputFiles[i], bbox, inputData, i, noerr, nonegdepth);
-			if (retVal != SUCCESS)
-				break;
+			fprintf(stderr, "Error - pthread_create() return code: %d\n %s", rc, strerror(rc));
+			exit(EXIT_FAILURE);
 		}
-		else 
+	}
+	for (int t = 0; t < numWorkers; t++)
+		pthread_join(hThreadArray[t], NULL);
+#endif
+}
+
+//************************************************************************************
+// SUBROUTINE I.K: Prepare to read a text input file through its sidecar spatial index.
+//************************************************************************************
+static bool openInputIndex(const string &fileName, BOUNDING_BOX bbox, textRecordReader *inFile, inputFileIndex *index)
+{
+	if (!indexInputFiles)
+		return false;
+
+	//A. A current index limits the read to the byte ranges that can hold records inside the bounding box
+	if ((*index).load(fileName))
+	{
+		if (bbox.doBoundingBox)
 		{
-			retval = LIST_FILE_EXT_ERROR;
-			cerr << "Unable to open input file list!" << endl;
-			cerr << "File type not supported (no identifiable extension found)!" << endl;
-			cerr << fileName.c_str() << endl;
-			break; //error opening files
+			vector< pair<int64_t, int64_t> > byteRanges;
+			(*index).rangesInside(bbox, &byteRanges);
+			(*inFile).setRanges(byteRanges);
 		}
+		return false;
 	}
-	
-	printf("Done Reading Input Files\n\n");
-	inputFiles.clear();
+
+	//B. Otherwise the whole file is read and indexed on the way
+	return true;
+}
+
+//************************************************************************************
+// SUBROUTINE I.L: Write the index built while reading a whole text input file.
+//************************************************************************************
+static void saveInputIndex(const string &fileName, inputFileIndex *index)
+{
+	if ((*index).save(fileName) != SUCCESS)
+		cerr << "Unable to write spatial index: " << inputFileIndexName(fileName) << endl;
+}
+
+//************************************************************************************
+// SUBROUTINE I.M: Read one input file named in the file list on its own.
+//************************************************************************************
+int readListedFile(const string &inputFile, BOUNDING_BOX bbox, TRUE_DATA *data, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, int indexInputs)
+{
+	//The readers strip the modifiers from the name they are given, so they get a copy
+	vector<string> inputFiles = vector<string>(1, inputFile);
+	vector<TRUE_DATA> inputData = vector<TRUE_DATA>(1);
+	indexInputFiles = (indexInputs != 0);
+
+	int retVal = readInputFile(&inputFiles, 0, bbox, &inputData, noerr, nonegdepth, unScaledAvgInputs, numThreads);
+	std::swap(*data, inputData[0]);
 	return retVal;
 }
 
@@ -231,7 +707,7 @@ int readLocationsFile(string &fileName, FORCED_LOCATIONS *inputData, int usagePr
 //************************************************************************************
 // SUBROUTINE III: Function call for reading GSF Files
 //************************************************************************************
-int readGSF(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int &pos, int noerr, int nonegdepth, int unScaledAvgInputs)
+int readGSF(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int &pos, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads)
 {
 	//************************************************************************************
 	// 0. Declare local variables and objects
@@ -239,53 +715,31 @@ int readGSF(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, i
 	int retVal = SUCCESS;
 
 	int gsfHandle = -1;
-	char *fName = (char*)"";
+	char fName[1024];
 
-	double lon, lat, depth, hError, vError, error, wMultiplier;
+	double lon, lat, depth, hError, vError, error, wMultiplier = 0.00;
 	double tideCorrection = 0.00;
 	double maximumDataOffset = INT_MAX;
-	int i = 0;
-	int beamon = -2;
-	int stat;
 	double z_avg;
 	double z_max = MIN_INT, z_min = MAX_INT;
 
 	gsfRecords gsfRec;
-	gsfDataID id;
+	GSF_PING_BLOCK block;
+	vector<double> lonmin, latmin, beamDepth;
 
-	string fileNameTemp;
-	char *next_token;
 	(*inputData)[pos].longitudeSum = 0.00;
 	(*inputData)[pos].latitudeSum  = 0.00;
 
-	//A. Parse out the user weighting
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "&\t\n", &next_token);
-	char* wM = strtok_s(NULL, "& \t\n", &next_token);
-	wMultiplier = ((wM==NULL)||(sscanf_s(wM, "%lf", &wMultiplier) <= 0))? 0.00:(1/wMultiplier);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "^\t\n", &next_token);
-	wM = strtok_s(NULL, "^ \t\n", &next_token);
-	tideCorrection = ((wM==NULL)||(sscanf_s(wM, "%lf", &tideCorrection) <= 0))? 0.00:(tideCorrection);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "#\t\n", &next_token);
-	wM = strtok_s(NULL, "# \t\n", &next_token);
-	maximumDataOffset = ((wM==NULL)||(sscanf_s(wM, "%lf", &maximumDataOffset) <= 0))? INT_MAX:(maximumDataOffset);
-
-	next_token = NULL;
-	fileName = (char*)strtok_s((char*)fileName.c_str(), "&^#\t\n", &next_token);
+	//A. Parse out the user weighting, tide correction and maximum data offset
+	parseFileModifiers(fileName, &wMultiplier, &tideCorrection, &maximumDataOffset);
 
 	//************************************************************************************
 	// I. Try to open the input file
 	//************************************************************************************
-	strcpy(fName,fileName.c_str());
+	strncpy(fName, fileName.c_str(), _countof(fName) - 1);
+	fName[_countof(fName) - 1] = '\0';
 
-	gsfHandle = open_gsffile(fName);
+	gsfHandle = openGSF(fName);
 	if(gsfHandle == -1)
 	{
 		cerr << "Unable to open input file: " << fileName << endl;
@@ -295,36 +749,59 @@ int readGSF(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, i
 	//************************************************************************************
 	// II. Read the file data
 	//************************************************************************************
-	printf("Reading Input File: %s ......", fileName.c_str());
-	while (!gsfReader(&lon, &lat, &depth, &hError, &vError,	0, gsfHandle, &beamon, &stat, &gsfRec, &id))
+	//The pings are decoded a block at a time, since the GSF library decodes each ping
+	//against the scale factors of the pings before it, and the beams of the block are
+	//then located by several threads.  The beams are kept in file order.
+	//The GSF beam errors are not used, so hError and vError stay 0 for every beam.
+	if (!readingConcurrently())
+		printf("Reading Input File: %s ......", fileName.c_str());
+	memset(&gsfRec, 0, sizeof(gsfRec));
+	init_ping_block(&block);
+	hError = vError = 0.00;
+	while (read_ping_block(gsfHandle, &gsfRec, &block, GSF_PINGS_PER_BLOCK) > 0)
 	{
-		if ((lon == NONSENSE) && (lat == NONSENSE) && (depth == NONSENSE))
-			continue;
-		//Cut the bounding box
-		if (bbox.doBoundingBox)
+		if ((const int)lonmin.size() < block.numBeams)
 		{
-			if ( (lat > bbox.bboxTop) || (lat < bbox.bboxBottom) || (lon > bbox.bboxRight) || (lon < bbox.bboxLeft))
-				continue;
+			lonmin.resize(block.numBeams);
+			latmin.resize(block.numBeams);
+			beamDepth.resize(block.numBeams);
 		}
-		depth += tideCorrection;
-		//Keep only water
-		if (!nonegdepth || depth >= 0)
-		{
-			(*inputData)[pos].lon.push_back(lon/60.00);
-			(*inputData)[pos].lat.push_back(lat/60.00);
-			(*inputData)[pos].depth.push_back(depth);
-			(*inputData)[pos].h_Error.push_back(abs(hError));
-			(*inputData)[pos].v_Error.push_back(abs(vError));
-			if(z_max < depth)
-				z_max = depth;
-			else if(z_min > depth)
-				z_min = depth;
+		placePingBlock(&block, numThreads, &lonmin[0], &latmin[0], &beamDepth[0]);
 
-			//A. Compute the longitude sum for use later when converting to UTM
-			(*inputData)[pos].longitudeSum += (lon+180.00) - int((lon+180.00)/360.00)*360.00-180.00;
-			(*inputData)[pos].latitudeSum  += (lat+180.00) - int((lat+180.00)/360.00)*360.00-180.00;
+		for (int k = 0; k < block.numBeams; k++)
+		{
+			lon = lonmin[k];
+			lat = latmin[k];
+			depth = beamDepth[k];
+			if ((lon == NONSENSE) && (lat == NONSENSE) && (depth == NONSENSE))
+				continue;
+			//Cut the bounding box
+			if (bbox.doBoundingBox)
+			{
+				if ( (lat > bbox.bboxTop) || (lat < bbox.bboxBottom) || (lon > bbox.bboxRight) || (lon < bbox.bboxLeft))
+					continue;
+			}
+			depth += tideCorrection;
+			//Keep only water
+			if (!nonegdepth || depth >= 0)
+			{
+				(*inputData)[pos].lon.push_back(lon/60.00);
+				(*inputData)[pos].lat.push_back(lat/60.00);
+				(*inputData)[pos].depth.push_back(depth);
+				(*inputData)[pos].h_Error.push_back(abs(hError));
+				(*inputData)[pos].v_Error.push_back(abs(vError));
+				if(z_max < depth)
+					z_max = depth;
+				else if(z_min > depth)
+					z_min = depth;
+
+				//A. Compute the longitude sum for use later when converting to UTM
+				(*inputData)[pos].longitudeSum += (lon+180.00) - int((lon+180.00)/360.00)*360.00-180.00;
+				(*inputData)[pos].latitudeSum  += (lat+180.00) - int((lat+180.00)/360.00)*360.00-180.00;
+			}
 		}
 	}
+	free_ping_block(&block);
 	hError = standardDeviation(&(*inputData)[pos].h_Error, False);
 	vError = standardDeviation(&(*inputData)[pos].v_Error, False);
 	z_avg = (z_max-z_min)/2;
@@ -390,8 +867,11 @@ int readGSF(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, i
 	(*inputData)[pos].y = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].maximumDataOffset = maximumDataOffset;
 
-	close_gsffile(&gsfHandle);
-	printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
+	closeGSF(&gsfHandle);
+	if (readingConcurrently())
+		printf("Reading Input File: %s ...... %d Records Read Successfully.\n", fileName.c_str(), (int)(*inputData)[pos].lon.size());
+	else
+		printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
 	if (wMultiplier != 0)
 		cout << "\tUsing Multiplier: " << wMultiplier << endl;
 	if (tideCorrection != 0)
@@ -411,104 +891,60 @@ int readXYZ(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, i
 	// 0. Declare local variables and objects
 	//************************************************************************************
 	int retVal = SUCCESS;
-	double lon, lat, depth, wMultiplier, error, hvError;
+	double lon, lat, depth, wMultiplier = 0.00, error, hvError;
 	double tideCorrection = 0.00;
 	double maximumDataOffset = INT_MAX;
-	char inputFileChar[128];
-	char delim[] = " \t";
-	string fileNameTemp;
-	ifstream inFile;
-	char *next_token;
-	char header[128];
+	textRecordReader inFile;
+	double values[3];
+	int numValues;
 
-	//A. Parse out the user weighting
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "&\t\n", &next_token);
-	char* wM = strtok_s(NULL, "& \t\n", &next_token);
-	wMultiplier = ((wM==NULL)||(sscanf_s(wM, "%lf", &wMultiplier) <= 0))? 0.00:(1/wMultiplier);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "^\t\n", &next_token);
-	wM = strtok_s(NULL, "^ \t\n", &next_token);
-	tideCorrection = ((wM==NULL)||(sscanf_s(wM, "%lf", &tideCorrection) <= 0))? 0.00:(tideCorrection);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "#\t\n", &next_token);
-	wM = strtok_s(NULL, "# \t\n", &next_token);
-	maximumDataOffset = ((wM==NULL)||(sscanf_s(wM, "%lf", &maximumDataOffset) <= 0))? INT_MAX:(maximumDataOffset);
+	//A. Parse out the user weighting, tide correction and maximum data offset
+	parseFileModifiers(fileName, &wMultiplier, &tideCorrection, &maximumDataOffset);
 
 	//Check if format is at the end of the filename and remove it
-	string typeTemp = (fileNameTemp.find(no_error_DAT) != string::npos) ? no_error_DAT: no_error_TXT;
-	size_t found = fileNameTemp.find(typeTemp);
-	size_t foundFmt = fileNameTemp.substr(found).find_first_not_of(typeTemp);
+	string typeTemp = (fileName.find(no_error_DAT) != string::npos) ? no_error_DAT: no_error_TXT;
+	size_t found = fileName.find(typeTemp);
+	size_t foundFmt = fileName.substr(found).find_first_not_of(typeTemp);
 	if(foundFmt!=string::npos)
-	{
-		fileNameTemp.erase(found + typeTemp.length(), fileNameTemp.length());
-		fileName = fileNameTemp;
-	}
-	next_token = NULL;
-	fileName = (char*)strtok_s((char*)fileName.c_str(), "&^#\t\n", &next_token);
+		fileName.erase(found + typeTemp.length(), fileName.length());
 
 	//************************************************************************************
 	// I. Try to open the input file
 	//************************************************************************************
-	inFile.open(fileName.c_str(), ios::in);
-	if (!inFile.is_open())
+	if (!inFile.open(fileName))
 	{
 		cerr << "Unable to open input file: " << fileName << endl;
 		return IN_FILE_ERROR;
 	}
+	inputFileIndex index;
+	bool buildIndex = openInputIndex(fileName, bbox, &inFile, &index);
 
 	(*inputData)[pos].longitudeSum = 0.00;
 	(*inputData)[pos].latitudeSum  = 0.00;
 
-	printf("Reading Input File: %s ......", fileName.c_str());
+	if (!readingConcurrently())
+		printf("Reading Input File: %s ......", fileName.c_str());
 	
-	//Check for header
-	if ((inFile.gcount() > 3) && !inFile.eof())
-	{
-		next_token = NULL;
-		if(! (sscanf_s(strtok_s(inputFileChar, delim, &next_token), "%s", &header, _countof(header) ) <= 0))
-			inFile.getline(inputFileChar, 128);
-	}
-
 	//************************************************************************************
 	// II. Read the file data
 	//************************************************************************************
-	inFile.getline(inputFileChar, 128);
-	while (inFile.gcount() > 3)
+	while ((numValues = inFile.nextRecord(values, 3)) >= 0)
 	{
-		next_token = NULL;
-		if (sscanf_s(strtok_s(inputFileChar, delim, &next_token), "%lf", &lon) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &lat) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &depth) <= 0)
+		if (numValues < 3)
 		{
 			retVal = IN_FILE_ERROR;
 			break;
 		}
+		lon = values[0];
+		lat = values[1];
+		depth = values[2];
+		if (buildIndex)
+			index.addRecord(inFile.recordOffset(), inFile.recordEndOffset(), lon, lat);
 		//Cut the bounding box
 		if (bbox.doBoundingBox)
 		{
 			if ( (lat > bbox.bboxTop) || (lat < bbox.bboxBottom) || (lon > bbox.bboxRight) || (lon < bbox.bboxLeft))
-			{
-				if(inFile.eof())
-					break;
-				inFile.getline(inputFileChar, 128);
 				continue;
-			}
 		}
 		depth += tideCorrection;
 		//Keep only water
@@ -533,16 +969,18 @@ int readXYZ(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, i
 			(*inputData)[pos].longitudeSum += (lon+180.00) - int((lon+180.00)/360.00)*360.00-180.00;
 			(*inputData)[pos].latitudeSum  += (lat+180.00) - int((lat+180.00)/360.00)*360.00-180.00;
 		}
-		if(inFile.eof())
-			break;
-		inFile.getline(inputFileChar, 128);
 	}
 	
 	//D. Zero out errors so we don't crash later since none were provided
 	(*inputData)[pos].x = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].y = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].maximumDataOffset = maximumDataOffset;
-	printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
+	if (buildIndex && retVal == SUCCESS)
+		saveInputIndex(fileName, &index);
+	if (readingConcurrently())
+		printf("Reading Input File: %s ...... %d Records Read Successfully.\n", fileName.c_str(), (int)(*inputData)[pos].lon.size());
+	else
+		printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
 	if (wMultiplier != 0)
 		cout << "\tUsing Multiplier: " << wMultiplier << endl;
 	if (tideCorrection != 0)
@@ -550,7 +988,6 @@ int readXYZ(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, i
 	if (maximumDataOffset != INT_MAX)
 		cout << "\tUsing Maximum Data Offset: " << maximumDataOffset << endl;
 
-	inFile.clear();
 	inFile.close();
 	//vector<double>::iterator minIt= min_element((*inputData)[pos].lon.begin(),(*inputData)[pos].lon.end());
 	//vector<double>::iterator maxIt= max_element((*inputData)[pos].lon.begin(),(*inputData)[pos].lon.end());
@@ -579,102 +1016,55 @@ int readXYZE(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 	// 0. Declare local variables and objects
 	//************************************************************************************
 	int retVal = SUCCESS;
-	char inputFileChar[128];
-	char delim[] = " \t";
-	double lon, lat, depth, error, hvError, wMultiplier; double z_avg = 0;
+	double lon, lat, depth, error, hvError, wMultiplier = 1.00; double z_avg = 0;
 	double tideCorrection = 0.00;
 	double maximumDataOffset = INT_MAX;
-	string fileNameTemp;
-	ifstream inFile;
-	char *next_token;
-	char header[128];
+	textRecordReader inFile;
+	double values[4];
+	int numValues;
 	double z_max = MIN_INT, z_min = MAX_INT;
 
-	//A. Parse out the user weighting
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "&\t\n", &next_token);
-	char* wM = strtok_s(NULL, "& \t\n", &next_token);
-	wMultiplier = ((wM==NULL)||(sscanf_s(wM, "%lf", &wMultiplier) <= 0))? 1.00:(1/wMultiplier);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "^\t\n", &next_token);
-	wM = strtok_s(NULL, "^ \t\n", &next_token);
-	tideCorrection = ((wM==NULL)||(sscanf_s(wM, "%lf", &tideCorrection) <= 0))? 0.00:(tideCorrection);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "#\t\n", &next_token);
-	wM = strtok_s(NULL, "# \t\n", &next_token);
-	maximumDataOffset = ((wM==NULL)||(sscanf_s(wM, "%lf", &maximumDataOffset) <= 0))? INT_MAX:(maximumDataOffset);
-
-	next_token = NULL;
-	fileName = (char*)strtok_s((char*)fileName.c_str(), "&^#\t\n", &next_token);
+	//A. Parse out the user weighting, tide correction and maximum data offset
+	parseFileModifiers(fileName, &wMultiplier, &tideCorrection, &maximumDataOffset);
 
 	//************************************************************************************
 	// I. Try to open the input file
 	//************************************************************************************
-	inFile.open(fileName.c_str(), ios::in);
-	if (!inFile.is_open())
+	if (!inFile.open(fileName))
 	{
 		cerr << "Unable to open input file: " << fileName << endl;
 		return IN_FILE_ERROR;
 	}
+	inputFileIndex index;
+	bool buildIndex = openInputIndex(fileName, bbox, &inFile, &index);
 
 	(*inputData)[pos].longitudeSum = 0.00;
 	(*inputData)[pos].latitudeSum  = 0.00;
 
-	printf("Reading Input File: %s ......", fileName.c_str());
+	if (!readingConcurrently())
+		printf("Reading Input File: %s ......", fileName.c_str());
 	
-	//Check for header
-	if ((inFile.gcount() > 3) && !inFile.eof())
-	{
-		next_token = NULL;
-		if(! (sscanf_s(strtok_s(inputFileChar, delim, &next_token), "%s", &header, _countof(header) ) <= 0))
-			inFile.getline(inputFileChar, 128);
-	}
-
 	//************************************************************************************
 	// II. Read the file data
 	//************************************************************************************
-	inFile.getline(inputFileChar, 128);
-	while ((inFile.gcount() > 3))
+	while ((numValues = inFile.nextRecord(values, 4)) >= 0)
 	{
-		next_token = NULL;
-		if (sscanf_s(strtok_s(inputFileChar, delim, &next_token), "%lf", &lon) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &lat) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &depth) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &error) <= 0)
+		if (numValues < 4)
 		{
 			retVal = IN_FILE_ERROR;
 			break;
 		}
+		lon = values[0];
+		lat = values[1];
+		depth = values[2];
+		error = values[3];
+		if (buildIndex)
+			index.addRecord(inFile.recordOffset(), inFile.recordEndOffset(), lon, lat);
 		//Cut the bounding box
 		if (bbox.doBoundingBox)
 		{
 			if ( (lat > bbox.bboxTop) || (lat < bbox.bboxBottom) || (lon > bbox.bboxRight) || (lon < bbox.bboxLeft))
-			{
-				if(inFile.eof())
-					break;
-				inFile.getline(inputFileChar, 128);
 				continue;
-			}
 		}
 		depth += tideCorrection;
 		//Keep only water
@@ -694,9 +1084,6 @@ int readXYZE(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 			(*inputData)[pos].longitudeSum += (lon+180.00) - int((lon+180.00)/360.00)*360.00-180.00;
 			(*inputData)[pos].latitudeSum  += (lat+180.00) - int((lat+180.00)/360.00)*360.00-180.00;
 		}
-		if(inFile.eof())
-			break;
-		inFile.getline(inputFileChar, 128);
 	}
 	error = standardDeviation(&(*inputData)[pos].error, False);
 	z_avg = (z_max - z_min)/2;
@@ -737,7 +1124,12 @@ int readXYZE(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 	(*inputData)[pos].x = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].y = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].maximumDataOffset = maximumDataOffset;
-	printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
+	if (buildIndex && retVal == SUCCESS)
+		saveInputIndex(fileName, &index);
+	if (readingConcurrently())
+		printf("Reading Input File: %s ...... %d Records Read Successfully.\n", fileName.c_str(), (int)(*inputData)[pos].lon.size());
+	else
+		printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
 	if (wMultiplier != 0)
 		cout << "\tUsing Multiplier: " << wMultiplier << endl;
 	if (tideCorrection != 0)
@@ -745,7 +1137,6 @@ int readXYZE(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 	if (maximumDataOffset != INT_MAX)
 		cout << "\tUsing Maximum Data Offset: " << maximumDataOffset << endl;
 
-	inFile.clear();
 	inFile.close();
 
 	return retVal;
@@ -760,109 +1151,57 @@ int readXYZHV(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 	// 0. Declare local variables and objects
 	//************************************************************************************
 	int retVal = SUCCESS;
-	char inputFileChar[128];
-	char delim[] = " \t";
-	double lon, lat, depth, hError, vError, error, wMultiplier;
+	double lon, lat, depth, hError, vError, error, wMultiplier = 0.00;
 	double tideCorrection = 0.00;
 	double maximumDataOffset = INT_MAX;
-	string fileNameTemp;
-	ifstream inFile;
-	char *next_token;
-	char header[128];
+	textRecordReader inFile;
+	double values[5];
+	int numValues;
 	double z_avg;
 	double z_max = MIN_INT, z_min = MAX_INT;
 
-	//A. Parse out the user weighting
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "&\t\n", &next_token);
-	char* wM = strtok_s(NULL, "& \t\n", &next_token);
-	wMultiplier = ((wM==NULL)||(sscanf_s(wM, "%lf", &wMultiplier) <= 0))? 0.00:(1/wMultiplier);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "^\t\n", &next_token);
-	wM = strtok_s(NULL, "^ \t\n", &next_token);
-	tideCorrection = ((wM==NULL)||(sscanf_s(wM, "%lf", &tideCorrection) <= 0))? 0.00:(tideCorrection);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "#\t\n", &next_token);
-	wM = strtok_s(NULL, "# \t\n", &next_token);
-	maximumDataOffset = ((wM==NULL)||(sscanf_s(wM, "%lf", &maximumDataOffset) <= 0))? INT_MAX:(maximumDataOffset);
-
-	next_token = NULL;
-	fileName = (char*)strtok_s((char*)fileName.c_str(), "&^#\t\n", &next_token);
+	//A. Parse out the user weighting, tide correction and maximum data offset
+	parseFileModifiers(fileName, &wMultiplier, &tideCorrection, &maximumDataOffset);
 
 	//************************************************************************************
 	// I. Try to open the input file
 	//************************************************************************************
-	inFile.open(fileName.c_str(), ios::in);
-	if (!inFile.is_open())
+	if (!inFile.open(fileName))
 	{
 		cerr << "Unable to open input file: " << fileName << endl;
 		return IN_FILE_ERROR;
 	}
+	inputFileIndex index;
+	bool buildIndex = openInputIndex(fileName, bbox, &inFile, &index);
 
 	(*inputData)[pos].longitudeSum = 0.00;
 	(*inputData)[pos].latitudeSum  = 0.00;
 
-	printf("Reading Input File: %s ......", fileName.c_str());
-
-	//Check for header
-	if ((inFile.gcount() > 3) && !inFile.eof())
-	{
-		next_token = NULL;
-		if(! (sscanf_s(strtok_s(inputFileChar, delim, &next_token), "%s", &header, _countof(header) ) <= 0))
-			inFile.getline(inputFileChar, 128);
-	}
+	if (!readingConcurrently())
+		printf("Reading Input File: %s ......", fileName.c_str());
 
 	//************************************************************************************
 	// II. Read the file data
 	//************************************************************************************
-	inFile.getline(inputFileChar, 128);
-	while ((inFile.gcount() > 3))
+	while ((numValues = inFile.nextRecord(values, 5)) >= 0)
 	{
-		next_token = NULL;
-		if (sscanf_s(strtok_s(inputFileChar, delim, &next_token), "%lf", &lon) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &lat) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &depth) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &hError) <= 0)
-		{
-			retVal = IN_FILE_ERROR;
-			break;
-		}
-
-		if (sscanf_s(strtok_s(NULL, delim, &next_token), "%lf", &vError) <= 0)
+		if (numValues < 5)
 		{
 			retVal = IN_FILE_ERROR;
 			break;
 		}
+		lon = values[0];
+		lat = values[1];
+		depth = values[2];
+		hError = values[3];
+		vError = values[4];
+		if (buildIndex)
+			index.addRecord(inFile.recordOffset(), inFile.recordEndOffset(), lon, lat);
 		//Cut the bounding box
 		if (bbox.doBoundingBox)
 		{
 			if ( (lat > bbox.bboxTop) || (lat < bbox.bboxBottom) || (lon > bbox.bboxRight) || (lon < bbox.bboxLeft))
-			{
-				if(inFile.eof())
-					break;
-				inFile.getline(inputFileChar, 128);
 				continue;
-			}
 		}
 		depth += tideCorrection;
 		//Keep only water
@@ -883,9 +1222,6 @@ int readXYZHV(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 			(*inputData)[pos].longitudeSum += (lon+180.00) - int((lon+180.00)/360.00)*360.00-180.00;
 			(*inputData)[pos].latitudeSum  += (lat+180.00) - int((lat+180.00)/360.00)*360.00-180.00;
 		}
-		if(inFile.eof()) // SJZ
-			break;
-		inFile.getline(inputFileChar, 128);
 	}
 	hError = standardDeviation(&(*inputData)[pos].h_Error, False);
 	vError = standardDeviation(&(*inputData)[pos].v_Error, False);
@@ -952,7 +1288,12 @@ int readXYZHV(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 	(*inputData)[pos].x = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].y = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].maximumDataOffset = maximumDataOffset;
-	printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
+	if (buildIndex && retVal == SUCCESS)
+		saveInputIndex(fileName, &index);
+	if (readingConcurrently())
+		printf("Reading Input File: %s ...... %d Records Read Successfully.\n", fileName.c_str(), (int)(*inputData)[pos].lon.size());
+	else
+		printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
 	if (wMultiplier != 0)
 		cout << "\tUsing Multiplier: " << wMultiplier << endl;
 	if (tideCorrection != 0)
@@ -960,7 +1301,6 @@ int readXYZHV(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData,
 	if (maximumDataOffset != INT_MAX)
 		cout << "\tUsing Maximum Data Offset: " << maximumDataOffset << endl;
 
-	inFile.clear();
 	inFile.close();
 
 	return retVal;
@@ -977,36 +1317,15 @@ int readARC_ASCII_RASTER(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA>
 	int retVal = SUCCESS;
 	string temp;
 	double noData = -9999; //Is this suppose to be 999999? SJZ
-	double depth, wMultiplier;
+	double depth, wMultiplier = 0.00;
 	double tideCorrection = 0.00;
 	double maximumDataOffset = INT_MAX;
 	int nx, ny, lowerLeftX, lowerLeftY, lx;
-	string fileNameTemp;
 	ifstream inFile;
-	char *next_token;
 	double error,hvError;
 
-	//A. Parse out the user weighting
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "&\t\n", &next_token);
-	char* wM = strtok_s(NULL, "& \t\n", &next_token);
-	wMultiplier = ((wM==NULL)||(sscanf_s(wM, "%lf", &wMultiplier) <= 0))? 0.00:(1/wMultiplier);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "^\t\n", &next_token);
-	wM = strtok_s(NULL, "^ \t\n", &next_token);
-	tideCorrection = ((wM==NULL)||(sscanf_s(wM, "%lf", &tideCorrection) <= 0))? 0.00:(tideCorrection);
-
-	next_token = NULL;
-	fileNameTemp = fileName;
-	fileNameTemp = (char*)strtok_s((char*)fileNameTemp.c_str(), "#\t\n", &next_token);
-	wM = strtok_s(NULL, "# \t\n", &next_token);
-	maximumDataOffset = ((wM==NULL)||(sscanf_s(wM, "%lf", &maximumDataOffset) <= 0))? INT_MAX:(maximumDataOffset);
-
-	next_token = NULL;
-	fileName = (char*)strtok_s((char*)fileName.c_str(), "&^#\t\n", &next_token);
+	//A. Parse out the user weighting, tide correction and maximum data offset
+	parseFileModifiers(fileName, &wMultiplier, &tideCorrection, &maximumDataOffset);
 
 	//************************************************************************************
 	// I. Try to open the input file
@@ -1021,7 +1340,8 @@ int readARC_ASCII_RASTER(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA>
 	(*inputData)[pos].longitudeSum = 0.00;
 	(*inputData)[pos].latitudeSum  = 0.00;
 
-	printf("Reading Input File: %s ......", fileName.c_str());
+	if (!readingConcurrently())
+		printf("Reading Input File: %s ......", fileName.c_str());
 	//************************************************************************************
 	// II. Read the file data
 	//************************************************************************************
@@ -1088,7 +1408,10 @@ int readARC_ASCII_RASTER(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA>
 	(*inputData)[pos].x = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].y = vector<double>((*inputData)[pos].lon.size(), 0.00);
 	(*inputData)[pos].maximumDataOffset = maximumDataOffset;
-	printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
+	if (readingConcurrently())
+		printf("Reading Input File: %s ...... %d Records Read Successfully.\n", fileName.c_str(), (int)(*inputData)[pos].lon.size());
+	else
+		printf(" %d Records Read Successfully.\n", (int)(*inputData)[pos].lon.size());
 	if (wMultiplier != 0)
 		cout << "\tUsing Multiplier: " << wMultiplier << endl;
 	if (tideCorrection != 0)
@@ -31,9 +31,48 @@ using namespace std;
 * @param fileName - File name of the list file that contains each individual data set.
 * @param inputData - Vector TRUE_DATA that contains the values read from each file.  The length of the vector corresponds to the number of input files.  Each index of the vector corresponds the TRUE_DATA read from a specific input file.  (Returned).
 * @param bbox - The bounding extents of the input data if it is to be cut.
+* @param numThreads - Number of files to read at once.  0 or 1 reads the files one after another and stops at the first failure.  Either way the data are stored in list order and the read throughput of each file is reported.
+* @param indexInputs - Read the XYZ, XYZE and XYZHV files through their .mbi sidecar spatial indexes.  A file without a current index is read whole and its index written; with one, only the parts of the file near the bounding box are read.
 * @return Success or failure boolean.
 */
-int readFile(string &fileName, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs);
+int readFile(string &fileName, vector<TRUE_DATA> *inputData, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, int indexInputs);
+
+/**
+* While readFile has several files open at once a reader prints its progress line in one piece after the file is read, so lines from different files do not run together.
+* @return True while readFile is reading files concurrently.
+*/
+bool readingConcurrently();
+
+/**
+* Read the names of the input files from a file list.  Blank lines are skipped, anything following a # is dropped and trailing white space is removed.
+* @param fileName - File name of the list file.
+* @param inputFiles - Names of the input files, including any weight, tide or offset decorations.  (Returned).
+* @return Success or failure boolean.
+*/
+int readFileList(string &fileName, vector<string> *inputFiles);
+
+/**
+* Read one input file named in a file list, as readFile reads each of them.  Used to read the files one at a time so that only one is held in memory.
+* @param inputFile - Name of the input file as listed, including any weight, tide or offset decorations.
+* @param bbox - The bounding extents of the input data if it is to be cut.
+* @param data - TRUE_DATA that contains the values read from the file.  (Returned).
+* @param numThreads - Number of threads used to locate the beams of a GSF file.
+* @param indexInputs - Read an XYZ, XYZE or XYZHV file through its .mbi sidecar spatial index.
+* @return Success or failure boolean.
+*/
+int readListedFile(const string &inputFile, BOUNDING_BOX bbox, TRUE_DATA *data, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, int indexInputs);
+
+/**
+* Split the modifiers that may follow an input file name in the file list and strip them from the name.
+* File Format:
+*	${PATH_TO_FILES}/file_name_1.txt&weight^tideCorrection#maximumDataOffset
+* Each modifier is optional.  Outputs whose modifier is not present are left unchanged, so callers initialize them to their defaults.
+* @param fileName - Input file name as listed.  Returned without the modifiers. (Returned).
+* @param wMultiplier - 1/weight. (Returned).
+* @param tideCorrection - Tide correction added to each depth. (Returned).
+* @param maximumDataOffset - Maximum data offset of the file. (Returned).
+*/
+void parseFileModifiers(string &fileName, double *wMultiplier, double *tideCorrection, double *maximumDataOffset);
 
 /**
 * Read a file containing Longitude and Latitude data columns.  Used to grid data to an irregular grid at the Longitude and Latitude coordinates specified in this file.
@@ -56,9 +95,10 @@ int readLocationsFile(string &fileName, FORCED_LOCATIONS *inputData,int usagePre
 * @param bbox - The bounding extents of the input data if it is to be cut.
 * @param inputData - Vector TRUE_DATA that contains the values read from each file.  Only the index specified by pos is modified.  The TRUE_DATA at inputData[pos] will contain all of data read from the inputFile.  (Returned).
 * @param pos - Integer representing the location of inputData where the data from the input file should be stored.
+* @param numThreads - Number of threads used to locate the beams of each block of pings.  The pings are decoded by the calling thread.
 * @return Success or failure boolean.
 */
-int readGSF(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int &pos, int noerr, int nonegdepth, int unScaledAvgInputs);
+int readGSF(string &fileName, BOUNDING_BOX bbox, vector<TRUE_DATA> *inputData, int &pos, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads);
 
 /**
 * Read a file containing Longitude, Latitude, and Depth data columns. 
@@ -159,6 +159,11 @@ typedef struct
 	*/
 	int usage;
 
+	/**
+	* Number of threads for the GMT_Surface relaxation (0 or 1 runs the serial sweep).
+	*/
+	int numThreads;
+
 } GMT_SURFACE_DATA;
 /**
 * This structure is used to define all values necessary to run ALGSpline.
@@ -0,0 +1,189 @@
+#include "inputFileIndex.h"
+#include "supportedFileTypes.h"
+#include "constants.h"
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _MSC_VER
+#define statFile _stat64
+typedef struct _stat64 FILE_STAT;
+#else
+#define statFile stat
+typedef struct stat FILE_STAT;
+#endif
+
+//************************************************************************************
+// SUBROUTINE I: Constructor.
+//************************************************************************************
+inputFileIndex::inputFileIndex(double cellSize)
+{
+	this->cellSize = (cellSize > 0) ? cellSize : MBI_CELL_SIZE;
+	ordered = true;
+	numRecords = 0;
+	fileBytes = 0;
+}
+
+//************************************************************************************
+// SUBROUTINE II: Add the next record, extending the last run while its extent fits in a cell.
+//************************************************************************************
+void inputFileIndex::addRecord(int64_t begin, int64_t end, double lon, double lat)
+{
+	numRecords++;
+	if (end > fileBytes)
+		fileBytes = end;
+	if (!ordered)
+		return;
+
+	//The readers keep a record whose coordinates are not numbers whatever the bounding box, so its run must always be read
+	double lonLow = (lon == lon) ? lon : -HUGE_VAL, lonHigh = (lon == lon) ? lon : HUGE_VAL;
+	double latLow = (lat == lat) ? lat : -HUGE_VAL, latHigh = (lat == lat) ? lat : HUGE_VAL;
+	if (!runs.empty())
+	{
+		MBI_RUN &run = runs.back();
+		double minLon = min(run.minLon, lonLow), maxLon = max(run.maxLon, lonHigh);
+		double minLat = min(run.minLat, latLow), maxLat = max(run.maxLat, latHigh);
+		if (maxLon - minLon <= cellSize && maxLat - minLat <= cellSize)
+		{
+			//Anything between the two records is blank lines, so the run covers it too
+			run.bytes = end - run.offset;
+			run.count++;
+			run.minLon = minLon;
+			run.maxLon = maxLon;
+			run.minLat = minLat;
+			run.maxLat = maxLat;
+			return;
+		}
+	}
+
+	MBI_RUN run;
+	run.offset = begin;
+	run.bytes = end - begin;
+	run.count = 1;
+	run.reserved = 0;
+	run.minLon = lonLow;
+	run.maxLon = lonHigh;
+	run.minLat = latLow;
+	run.maxLat = latHigh;
+	runs.push_back(run);
+
+	//A file in no spatial order would have about one run per record; stop keeping them
+	if (runs.size() > 4096 && (int64_t)runs.size() * MBI_MIN_AVERAGE_RUN > numRecords)
+	{
+		ordered = false;
+		vector<MBI_RUN>().swap(runs);
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE III: Load and save the sidecar.
+//************************************************************************************
+bool inputFileIndex::load(const string &dataFileName)
+{
+	FILE_STAT dataStat;
+	MBI_HEADER header;
+
+	if (statFile(dataFileName.c_str(), &dataStat) != 0)
+		return false;
+	FILE *fp = fopen(inputFileIndexName(dataFileName).c_str(), "rb");
+	if (fp == NULL)
+		return false;
+
+	//A. The header must match this build and the text file as it is now
+	bool valid = (fread(&header, sizeof(MBI_HEADER), 1, fp) == 1)
+		&& memcmp(header.magic, MBI_MAGIC, sizeof(MBI_MAGIC)) == 0
+		&& header.version == MBI_VERSION
+		&& header.fileBytes == (int64_t)dataStat.st_size
+		&& header.fileModified == (int64_t)dataStat.st_mtime
+		&& header.cellSize > 0
+		&& header.numRuns >= 0;
+
+	//B. Read the runs
+	if (valid)
+	{
+		runs.resize((size_t)header.numRuns);
+		if (header.numRuns > 0)
+			valid = (fread(&runs[0], sizeof(MBI_RUN), runs.size(), fp) == runs.size());
+	}
+	fclose(fp);
+
+	if (!valid)
+	{
+		vector<MBI_RUN>().swap(runs);
+		return false;
+	}
+	cellSize = header.cellSize;
+	ordered = (header.ordered != 0);
+	numRecords = header.numRecords;
+	fileBytes = header.fileBytes;
+	return true;
+}
+
+int inputFileIndex::save(const string &dataFileName)
+{
+	FILE_STAT dataStat;
+	MBI_HEADER header;
+
+	if (statFile(dataFileName.c_str(), &dataStat) != 0)
+		return IN_FILE_ERROR;
+
+	memset(&header, 0, sizeof(MBI_HEADER));
+	memcpy(header.magic, MBI_MAGIC, sizeof(MBI_MAGIC));
+	header.version = MBI_VERSION;
+	header.ordered = ordered ? 1 : 0;
+	header.fileBytes = (int64_t)dataStat.st_size;
+	header.fileModified = (int64_t)dataStat.st_mtime;
+	header.cellSize = cellSize;
+	header.numRecords = numRecords;
+	header.numRuns = (int64_t)runs.size();
+
+	FILE *fp = fopen(inputFileIndexName(dataFileName).c_str(), "wb");
+	if (fp == NULL)
+		return OUT_FILE_ERROR;
+	bool written = (fwrite(&header, sizeof(MBI_HEADER), 1, fp) == 1);
+	if (written && !runs.empty())
+		written = (fwrite(&runs[0], sizeof(MBI_RUN), runs.size(), fp) == runs.size());
+	written = (fclose(fp) == 0) && written;
+	if (!written)
+	{
+		remove(inputFileIndexName(dataFileName).c_str());
+		return OUT_FILE_ERROR;
+	}
+	return SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Byte ranges holding the records inside a bounding box.
+//************************************************************************************
+void inputFileIndex::rangesInside(const BOUNDING_BOX &bbox, vector< pair<int64_t, int64_t> > *byteRanges) const
+{
+	(*byteRanges).clear();
+	if (!ordered)
+	{
+		(*byteRanges).push_back(pair<int64_t, int64_t>(0, fileBytes));
+		return;
+	}
+
+	//A record is kept unless it is outside the box, so a run is needed unless its whole extent is outside
+	for (size_t r = 0; r < runs.size(); r++)
+	{
+		const MBI_RUN &run = runs[r];
+		if (run.minLon > bbox.bboxRight || run.maxLon < bbox.bboxLeft || run.minLat > bbox.bboxTop || run.maxLat < bbox.bboxBottom)
+			continue;
+		if (!(*byteRanges).empty() && run.offset - ((*byteRanges).back().first + (*byteRanges).back().second) <= MBI_MERGE_GAP)
+			(*byteRanges).back().second = run.offset + run.bytes - (*byteRanges).back().first;
+		else
+			(*byteRanges).push_back(pair<int64_t, int64_t>(run.offset, run.bytes));
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE V: Name of the sidecar of a text file.
+//************************************************************************************
+string inputFileIndexName(const string &dataFileName)
+{
+	return dataFileName + spatialIndexSidecar;
+}
@@ -0,0 +1,191 @@
+/**
+* @file			inputFileIndex.h
+* @brief		Sidecar spatial index (.mbi) of the records of a text sounding file, used to read only the part of the file inside a bounding box.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* The index splits the file into runs of consecutive records that fit in a
+* coarse cell, a square no wider than cellSize, and keeps the byte range,
+* record count and extent of each run.  Survey files written along track have
+* long runs, so a small bounding box maps to a few byte ranges of a large file.
+* Layout (native little-endian byte order):
+*	MBI_HEADER (64 bytes)
+*	numRuns MBI_RUN (56 bytes each), in file order
+* The index is written next to the text file as <input file>.mbi the first time
+* the whole file is read, and is ignored once the size or modification time of
+* the text file no longer match the ones it was built from.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "inFileStructs.h"
+
+using namespace std;
+
+/**
+* Magic number at the start of every .mbi file.
+*/
+const char MBI_MAGIC[8] = { 'M', 'B', 'I', 'N', 'D', 'E', 'X', '\0' };
+
+/**
+* Version of the .mbi layout written by this build.
+*/
+const int32_t MBI_VERSION = 1;
+
+/**
+* Largest width and height of the extent of a run in the units of the file, degrees for the text sounding files.
+*/
+const double MBI_CELL_SIZE = 0.01;
+
+/**
+* Runs shorter than this on average mean the file is not in any spatial order.  The index then only
+* records that, and the whole file is read.
+*/
+const int MBI_MIN_AVERAGE_RUN = 16;
+
+/**
+* Selected ranges closer together than this many bytes are read as one, along with the records between them.
+*/
+const int64_t MBI_MERGE_GAP = 65536;
+
+/**
+* Fixed size header of a .mbi file.
+*/
+typedef struct
+{
+	/**
+	* MBI_MAGIC.
+	*/
+	char magic[8];
+
+	/**
+	* MBI_VERSION of the writer.
+	*/
+	int32_t version;
+
+	/**
+	* 1 if the runs are kept, 0 if the file was not in spatial order and must be read whole.
+	*/
+	int32_t ordered;
+
+	/**
+	* Size in bytes and modification time of the text file the index was built from.
+	*/
+	int64_t fileBytes;
+	int64_t fileModified;
+
+	/**
+	* Cell size used to build the index.
+	*/
+	double cellSize;
+
+	/**
+	* Number of records in the text file and of runs in the index.
+	*/
+	int64_t numRecords;
+	int64_t numRuns;
+
+	/**
+	* Unused; keeps the header at 64 bytes.
+	*/
+	int64_t reserved;
+
+} MBI_HEADER;
+
+/**
+* A run of consecutive records whose extent fits in one cell.
+*/
+typedef struct
+{
+	/**
+	* Byte offset of the first record and length in bytes of the run, up to and including the newline of its last record.
+	*/
+	int64_t offset;
+	int64_t bytes;
+
+	/**
+	* Number of records in the run.
+	*/
+	int32_t count;
+
+	/**
+	* Unused; aligns the extent.
+	*/
+	int32_t reserved;
+
+	/**
+	* Extent of the records in the run.  A record with a coordinate that is not a number makes the extent infinite.
+	*/
+	double minLon;
+	double maxLon;
+	double minLat;
+	double maxLat;
+
+} MBI_RUN;
+
+/**
+* The spatial index of one text sounding file.
+* Built one record at a time while the file is read, or loaded from the .mbi sidecar of the file.
+*/
+class inputFileIndex
+{
+
+public:
+
+	/**
+	* A constructor for inputFileIndex.  The index starts empty.
+	* @param cellSize - Largest width and height of the extent of a run.
+	*/
+	inputFileIndex(double cellSize = MBI_CELL_SIZE);
+
+	/**
+	* Adds the next record of the file.  Records must be added in file order.
+	* @param begin - Byte offset of the record.
+	* @param end - Byte offset just past the record and its newline.
+	* @param lon - Longitude (X) of the record.
+	* @param lat - Latitude (Y) of the record.
+	*/
+	void addRecord(int64_t begin, int64_t end, double lon, double lat);
+
+	/**
+	* Loads the sidecar of a text file.
+	* @param dataFileName - File name of the text file, without list modifiers.
+	* @return True if the sidecar exists and was built from the text file as it is now.
+	*/
+	bool load(const string &dataFileName);
+
+	/**
+	* Writes the index to the sidecar of a text file.  Call after every record of the file has been added.
+	* @param dataFileName - File name of the text file, without list modifiers.
+	* @return Success or failure boolean.
+	*/
+	int save(const string &dataFileName);
+
+	/**
+	* Gets the byte ranges of the file that hold every record inside a bounding box.  Some records outside the box may be included.
+	* @param bbox - The bounding extents to read.
+	* @param byteRanges - Byte offset and length of each range, in file order. (Returned).
+	*/
+	void rangesInside(const BOUNDING_BOX &bbox, vector< pair<int64_t, int64_t> > *byteRanges) const;
+
+	/**
+	* @return The number of records the index covers.
+	*/
+	int64_t size() const { return numRecords; }
+
+private:
+
+	double cellSize;
+	bool ordered;
+	int64_t numRecords;
+	int64_t fileBytes;
+	vector<MBI_RUN> runs;
+};
+
+/**
+* @param dataFileName - File name of a text sounding file.
+* @return The file name of its .mbi sidecar.
+*/
+string inputFileIndexName(const string &dataFileName);
@@ -1,5 +1,8 @@
 #include "kriging.h"
 #include "outFileStructs.h"
+#include <map>
+#include <algorithm>
+#include "ALG/alglibmisc.h"
 
 bool krigingDebugValue = false;
 
@@ -11,19 +14,19 @@ int roundKrig(double x){
 	}
 }
 
-void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *invGammaDArray, dgrid *A)
+void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *luGammaDArray, ivector *gammaDPivots, dgrid *A)
+{
+	ordinaryKrigingOfResiduals_Variogram(subX, subY, residualObservations, twoGammaHatVector, distanceVectorBinCenters, aVectorFine, A);
+	ordinaryKrigingOfResiduals_Factor(subX, subY, twoGammaHatVector, distanceVectorBinCenters, aVectorFine, A, luGammaDArray, gammaDPivots);
+}
+
+void ordinaryKrigingOfResiduals_Variogram(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *A)
 {
 	//Declare some variables
 	dgrid twoGammaHat;
 	dgrid twoGammaHatFine;
-
-	dgrid distanceArray((const uint)(*residualObservations).size(),(const uint)(*residualObservations).size(), 0.00);
-	dgrid angleArray(distanceArray);
-	dgrid deltaRSquaredArray(distanceArray);
-
-	dgrid distanceArray2;
-	dgrid angleArray2;
-	dgrid deltaRSquaredArray2;
+	dgrid pairSums;
+	dgrid pairCounts;
 	dgrid indexMax;
 	dgrid workingGrid;
 
@@ -34,24 +37,18 @@ void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double>
 	vector<int> r95Indices;
 	vector<double> twoGammaBar = vector<double>(8,0);
 	vector<double> twoGammaHatPerpendicular;
-	vector<double> bVector;
 
 	double min1, max1, min2, max2;
 	double tileSize, distanceBinSize;
 	double tempSum, tempMax;//, tempMin;
 	double tempTermDFT_Re, tempTermDFT_Im;
 	double standardDeviationRi, meanRi;
-	double angleMultiplier = 180.00 / PI;
 	double alphaAlt = 1.00;
-	double workingDouble1, workingDouble2, cValue, gamma;
-	double gammaComputedX, gammaComputedY;
 	double phi_2;
 	double thetaM;
 
 	int i, j, k;
-	int riSize = (const int)(*residualObservations).size();
 	int indexLoc;
-	int gammaDZeroIndexLoc;
 
 	angleVector[0] = -180.00;
 	angleVector[1] = -135.00;
@@ -108,20 +105,13 @@ void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double>
 		distanceVector.push_back((double)i * distanceBinSize);
 	}
 
-	//Calculate the array information
-	//First get distances, angles and squared difference in residuals. Place
-	//into n-by-n square-matrix arrays.
-	for (i = 0; i < riSize; i++){
-		for (j = 0; j < riSize; j++){
-			distanceArray(i,j) = sqrt( pow((*subX)[i] - (*subX)[j], 2) + pow((*subY)[i] - (*subY)[j], 2) );
-			angleArray(i,j) = angleMultiplier*atan2( (*subY)[i] - (*subY)[j],(*subX)[i] - (*subX)[j] );
-			deltaRSquaredArray(i,j) = pow((*residualObservations)[i] - (*residualObservations)[j], 2);
-		}
-	}
+	//Bin the distances, angles and squared difference in residuals of every
+	//pair of points straight into angle by distance sums, in one pass over the pairs.
+	accumulatePointPairs(subX, subY, residualObservations, NULL, &distanceVector, &angleVector, &pairSums, &pairCounts);
 
 	//Use Methods of Moments Estimator as coded in Appendix A below to get
 	//empirical variogram, two_gamma_hat. Calder's Eqns. (15-17). Also in Cressie, 1993.
-	methodsOfMomentsEstimator(&distanceVector, &angleVector, &distanceArray, &angleArray, &deltaRSquaredArray, &twoGammaHat);
+	methodsOfMomentsEstimatorBinned(&pairSums, &pairCounts, &twoGammaHat);
 
 	//Compute phi_2 and thetaM
 	//Need to fit two_gamma_bar to second Fourier eigen function. Take FFT of two_gamma_bar.
@@ -169,18 +159,9 @@ void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double>
 		distanceVector2.push_back((double)i * (distanceBinSize/2.5));
 	}
 
-	distanceArray2 = dgrid((const uint)r95Indices.size(),(const uint)r95Indices.size());
-	angleArray2 = dgrid((const uint)r95Indices.size(),(const uint)r95Indices.size());
-	deltaRSquaredArray2 = dgrid((const uint)r95Indices.size(),(const uint)r95Indices.size());
-	for (i = 0; i < (const int)r95Indices.size(); i ++){
-		for (j = 0; j < (const int)r95Indices.size(); j++){
-			distanceArray2(i,j) = distanceArray.get(r95Indices.at(i), r95Indices.at(j));
-			angleArray2(i,j) = angleArray.get(r95Indices.at(i), r95Indices.at(j));
-			deltaRSquaredArray2(i,j) = deltaRSquaredArray.get(r95Indices.at(i), r95Indices.at(j));
-		}
-	}
-
-	methodsOfMomentsEstimator(&distanceVector2, &angleVectorPerpendicular, &distanceArray2, &angleArray2, &deltaRSquaredArray2, &twoGammaHatFine);
+	//b. Only the pairs of the residuals within two standard deviations of the mean
+	accumulatePointPairs(subX, subY, residualObservations, &r95Indices, &distanceVector2, &angleVectorPerpendicular, &pairSums, &pairCounts);
+	methodsOfMomentsEstimatorBinned(&pairSums, &pairCounts, &twoGammaHatFine);
 
 	(*twoGammaHatVector) = vector<double> (twoGammaHatFine.cols());
 	twoGammaHatPerpendicular = vector<double> (twoGammaHatFine.cols());
@@ -247,12 +228,36 @@ void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double>
 	(*A) = dgrid(trans(matmult(matmult(rotMtx(-thetaM),workingGrid),rotMtx(thetaM))));
 	workingGrid.clear();
 
-	//Initialize storage vector for Calder's change to distance to account for anisotropy. Calder's Eq. (21)
-	dgrid distancePrimeArray = dgrid(riSize,riSize, 0);
+	//Clean up variable space
+	twoGammaHat.clear();
+	twoGammaHatFine.clear();
+	pairSums.clear();
+	pairCounts.clear();
+
+	indexMax.clear();
+	workingGrid.clear();
+
+	angleVector.clear();
+	angleVectorPerpendicular.clear();
+	distanceVector.clear();
+	distanceVector2.clear();
+	twoGammaBar.clear();
+	r95Indices.clear();
+}
+
+void ordinaryKrigingOfResiduals_Factor(vector<double> *subX, vector<double> *subY, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *A, dgrid *luGammaDArray, ivector *gammaDPivots)
+{
+	double workingDouble1, workingDouble2, cValue, gamma;
+	double gammaComputedX, gammaComputedY;
+	double tempSum, minDistance;
+	double distancePrime;
+
+	int i, j, k;
+	int riSize = (const int)(*subX).size();
+	int indexLoc;
+
 	dgrid gammaDArray = dgrid(riSize+1, riSize+1, 1);
 
-	gammaDZeroIndexLoc = 0;
-	//cout << aVectorFine << endl;
 	for (i = 0; i < riSize; i++)
 	{
 		for (j = 0; j < riSize; j++)
@@ -267,15 +272,15 @@ void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double>
 			tempSum = pow(gammaComputedX,2) + pow(gammaComputedY,2);
 			if (tempSum <=0)
 			{
-				distancePrimeArray(i,j) = 0;
+				distancePrime = 0;
 			}else
 			{
-				distancePrimeArray(i,j) = sqrt(tempSum);
+				distancePrime = sqrt(tempSum);
 			}
 
 			//Compute semivariogram from data point to interpolation point.
-			if (1 >= (distancePrimeArray(i,j) / (*aVectorFine)[2])){
-				cValue = distancePrimeArray(i,j) / (*aVectorFine)[2];
+			if (1 >= (distancePrime / (*aVectorFine)[2])){
+				cValue = distancePrime / (*aVectorFine)[2];
 				gamma =  (*aVectorFine)[0] +  (*aVectorFine)[1] * ( 1.5000 * cValue  - 0.5000 * pow(cValue,3) );
 			}else
 			{
@@ -285,11 +290,11 @@ void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double>
 			//Since fit of modeled variogram may give negative numbers, fallback to emperical variogram if needed.
 			if ((0.5*gamma) <= 0)
 			{
-				min1 = pow(((*distanceVectorBinCenters)[0] - distancePrimeArray(i,j)), 2);
+				minDistance = pow(((*distanceVectorBinCenters)[0] - distancePrime), 2);
 				indexLoc = 0;
 				for (k = 0; k < (const int)(*distanceVectorBinCenters).size(); k++){
-					if (pow(((*distanceVectorBinCenters)[k] - distancePrimeArray(i,j)), 2) < min1){
-						min1 = pow(((*distanceVectorBinCenters)[k] - distancePrimeArray(i,j)), 2);
+					if (pow(((*distanceVectorBinCenters)[k] - distancePrime), 2) < minDistance){
+						minDistance = pow(((*distanceVectorBinCenters)[k] - distancePrime), 2);
 						indexLoc = k;
 					}
 				}
@@ -301,36 +306,118 @@ void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double>
 	// kriging as provided in Davis JC, Statistics and Data Analysis in Geology,
 	// 3rd edition, pp. 420-1, New York: Wiley, 2002.
 	gammaDArray(riSize,riSize) = 0.0;
-	bVector = vector<double>(riSize+1, 1);
 
-	// Get inverse of W for later use
-	(*invGammaDArray) = dgrid(inv(gammaDArray,0, 'U', true, 'N'));
+	// Factor W once for later use; every query is then a pair of triangular
+	// solves rather than a product with an explicit inverse.  USE_LAPACK is not
+	// defined in the builds, so this is the partial-pivot LU of grid.h, which
+	// ignores the symmetry.  Built against LAPACK, symgrid selects dsytrf.
+	LU(gammaDArray, (*luGammaDArray), (*gammaDPivots), symgrid, 'U');
 
-	//Clean up variable space
-	distancePrimeArray.clear();
 	gammaDArray.clear();
+}
 
-	twoGammaHat.clear();
-	twoGammaHatFine.clear();
+void ordinaryKrigingOfResiduals_Local(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *interpX, vector<double> *interpY, int maxNeighbors, vector<double> *outDepthKrig, vector<double> *outErrorKrig)
+{
+	vector<double> twoGammaHatVector;
+	vector<double> distanceVectorBinCenters;
+	vector<double> aVectorFine;
+	dgrid AGrid;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
+
+	vector<double> subX_n, subY_n, ri_n;
+	vector<double> interpX_n, interpY_n;
+	vector<double> zKriged, varZKriged;
+	vector<int> neighbors;
+	map< vector<int>, vector<int> > neighborhoods;
+	map< vector<int>, vector<int> >::iterator it;
+
+	alglib::real_2d_array xy;
+	alglib::integer_1d_array tags;
+	alglib::real_1d_array query;
+	alglib::integer_1d_array found;
+	alglib::kdtree kdt;
 
-	distanceArray.clear();
-	angleArray.clear();
-	deltaRSquaredArray.clear();
-	distanceArray2.clear();
-	angleArray2.clear();
-	deltaRSquaredArray2.clear();
-	indexMax.clear();
-	workingGrid.clear();
-	gammaDArray.clear();
-	distancePrimeArray.clear();
+	int i, j, k;
+	const int n = (const int)(*subX).size();
+	const int numQueries = (const int)(*interpX).size();
+
+	if ((const int)(*outDepthKrig).size() < numQueries)
+		(*outDepthKrig).resize(numQueries, 0.0);
+	if ((const int)(*outErrorKrig).size() < numQueries)
+		(*outErrorKrig).resize(numQueries, 0.0);
+	if (n < 4 || numQueries == 0)
+		return;
+
+	//1. Fit the variogram and anisotropy once over every residual of the tile.
+	ordinaryKrigingOfResiduals_Variogram(subX, subY, residualObservations, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &AGrid);
+
+	//2. Index the residuals in the space stretched by A, where Euclidean distance is the distance the variogram is evaluated at.
+	k = min(maxNeighbors, n);
+	xy.setlength(n, 2);
+	tags.setlength(n);
+	for (i = 0; i < n; i++)
+	{
+		xy(i,0) = (*subX)[i]*AGrid(0,0) + (*subY)[i]*AGrid(1,0);
+		xy(i,1) = (*subX)[i]*AGrid(0,1) + (*subY)[i]*AGrid(1,1);
+		tags[i] = i;
+	}
+	alglib::kdtreebuildtagged(xy, tags, n, 2, 0, 2, kdt);
 
-	angleVector.clear();
-	angleVectorPerpendicular.clear();
-	distanceVector.clear();
-	distanceVector2.clear();
-	twoGammaBar.clear();
-	r95Indices.clear();
-	bVector.clear();
+	//3. Group the interpolation points by the set of their k nearest residuals,
+	//so each distinct set is factored once and solved for all of its points together.
+	query.setlength(2);
+	for (i = 0; i < numQueries; i++)
+	{
+		query[0] = (*interpX)[i]*AGrid(0,0) + (*interpY)[i]*AGrid(1,0);
+		query[1] = (*interpX)[i]*AGrid(0,1) + (*interpY)[i]*AGrid(1,1);
+		alglib::kdtreequeryknn(kdt, query, k, true);
+		alglib::kdtreequeryresultstags(kdt, found);
+
+		neighbors.resize(k);
+		for (j = 0; j < k; j++)
+			neighbors[j] = (int)found[j];
+		sort(neighbors.begin(), neighbors.end());
+		neighborhoods[neighbors].push_back(i);
+	}
+
+	//4. Krige each neighborhood.
+	for (it = neighborhoods.begin(); it != neighborhoods.end(); it++)
+	{
+		subX_n.resize(k);
+		subY_n.resize(k);
+		ri_n.resize(k);
+		for (j = 0; j < k; j++)
+		{
+			subX_n[j] = (*subX)[it->first[j]];
+			subY_n[j] = (*subY)[it->first[j]];
+			ri_n[j] = (*residualObservations)[it->first[j]];
+		}
+		interpX_n.resize(it->second.size());
+		interpY_n.resize(it->second.size());
+		for (j = 0; j < (const int)it->second.size(); j++)
+		{
+			interpX_n[j] = (*interpX)[it->second[j]];
+			interpY_n[j] = (*interpY)[it->second[j]];
+		}
+
+		ordinaryKrigingOfResiduals_Factor(&subX_n, &subY_n, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &AGrid, &luGammaDArray, &gammaDPivots);
+		ordinaryKrigingOfResiduals_PostComputeBatch(&subX_n, &subY_n, &ri_n, &interpX_n, &interpY_n, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKriged, &varZKriged);
+
+		for (j = 0; j < (const int)it->second.size(); j++)
+		{
+			(*outDepthKrig)[it->second[j]] = zKriged[j];
+			(*outErrorKrig)[it->second[j]] = varZKriged[j];
+		}
+	}
+
+	neighborhoods.clear();
+	twoGammaHatVector.clear();
+	distanceVectorBinCenters.clear();
+	aVectorFine.clear();
+	luGammaDArray.clear();
+	gammaDPivots.clear();
+	AGrid.clear();
 }
 
 void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *interpX, vector<double> *interpY, double spacingX, double spacingY, vector<double> *outDepthKrig, vector<double> *outErrorKrig)
@@ -360,7 +447,8 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 	vector<double> twoGammaHatVector;
 	vector<double> distanceVectorBinCenters;
 	vector<double> aVectorFine;
-	dgrid invGammaDArray;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
 	dgrid AGrid;
 
 	vector<double> localSubX = vector<double>((*subX));
@@ -537,7 +625,7 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 
 				if (subX_idx.size() >= 4)
 				{
-					ordinaryKrigingOfResiduals_PreCompute(&subX_idx, &subY_idx, &ri_idx, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+					ordinaryKrigingOfResiduals_PreCompute(&subX_idx, &subY_idx, &ri_idx, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 
 					//3. Krig the data
 					//cout << "PROCESS CALL" << endl;
@@ -549,7 +637,7 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 							zKriged = 0.00;
 							varZKriged = 0.00;
 							//Compute the residual value
-							ordinaryKrigingOfResiduals_PostCompute(&subX_idx, &subY_idx, &ri_idx, &localInterpX[idxInterp[i]], &localInterpY[idxInterp[i]], &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKriged, &varZKriged);
+							ordinaryKrigingOfResiduals_PostCompute(&subX_idx, &subY_idx, &ri_idx, &localInterpX[idxInterp[i]], &localInterpY[idxInterp[i]], &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKriged, &varZKriged);
 
 							(*outDepthKrig)[idxInterp[i]] = zKriged;
 							(*outErrorKrig)[idxInterp[i]] = varZKriged;
@@ -559,7 +647,8 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 					twoGammaHatVector.clear();
 					distanceVectorBinCenters.clear();
 					aVectorFine.clear();
-					invGammaDArray.clear();
+					luGammaDArray.clear();
+					gammaDPivots.clear();
 					AGrid.clear();
 				}
 				subX_idx.clear();
@@ -601,7 +690,8 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 	vector<double> twoGammaHatVector;
 	vector<double> distanceVectorBinCenters;
 	vector<double> aVectorFine;
-	dgrid invGammaDArray;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
 	dgrid AGrid;
 
 	//int tempIn;
@@ -714,7 +804,7 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 					}else
 					{
 						//cout << "PRE-PROCESS CALL" << endl;
-						ordinaryKrigingOfResiduals_PreCompute(&subX_idx, &subY_idx, &ri_idx, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+						ordinaryKrigingOfResiduals_PreCompute(&subX_idx, &subY_idx, &ri_idx, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 
 						//3. Krig the data
 						//cout << "PROCESS CALL" << endl;
@@ -725,7 +815,7 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 								zKriged = 0.00;
 								varZKriged = 0.00;
 								//Compute the residual value
-								ordinaryKrigingOfResiduals_PostCompute(&subX_idx, &subY_idx, &ri_idx, &(*interpX)[i], &(*interpY)[i], &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKriged, &varZKriged);
+								ordinaryKrigingOfResiduals_PostCompute(&subX_idx, &subY_idx, &ri_idx, &(*interpX)[i], &(*interpY)[i], &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKriged, &varZKriged);
 
 								if ((*outDepthKrig)[i] == 0)
 								{
@@ -742,7 +832,8 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 						twoGammaHatVector.clear();
 						distanceVectorBinCenters.clear();
 						aVectorFine.clear();
-						invGammaDArray.clear();
+						luGammaDArray.clear();
+						gammaDPivots.clear();
 						AGrid.clear();
 					}
 				}else
@@ -767,26 +858,22 @@ void ordinaryKrigingOfResiduals_PreComputeTile(vector<double> *subX, vector<doub
 	idx.clear();
 }*/
 
-void ordinaryKrigingOfResiduals_PostCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, double *xGridValue, double *yGridValue, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *invGammaDArray, dgrid *A, double *zKrigValue, double *varZKrigValue)
+//Fill column B of the right hand side with the semivariogram from each data point to the interpolation point (x, y), Davis Eqn. (5.102).
+static void krigingRightHandSide(vector<double> *subX, vector<double> *subY, double x, double y, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *A, double *B)
 {
-	//Set up the variables
-	vector<double> B = vector<double>((*residualObservations).size()+1, 1.0);
-	vector<double> Y = vector<double>((*residualObservations).size()+1, 0.0);
 	double distancePrimeInterp;
 	double xValueTemp, yValueTemp;
 	double gammaComputedX, gammaComputedY;
 	double tempSum;
 	double cValue, gamma, tempGammaMin;
-	double zComputed, varZComputed;
 	int i, j, k;
+	const int n = (const int)(*subX).size();
 
-	//Find ordinary kringing solution for residuals at the interpolated surfaces
-	//Build B Vector, Eqn. (5.102)
-	for (i = 0; i < (const int)(*residualObservations).size(); i++)
+	for (i = 0; i < n; i++)
 	{
 		//Apply Calder's change to distance to account for anisotropy
-		xValueTemp = (*subX)[i]-(*xGridValue);
-		yValueTemp = (*subY)[i]-(*yGridValue);
+		xValueTemp = (*subX)[i]-x;
+		yValueTemp = (*subY)[i]-y;
 
 		gammaComputedX = xValueTemp*(*A)(0,0) + yValueTemp*(*A)(1,0);
 		gammaComputedY = xValueTemp*(*A)(0,1) + yValueTemp*(*A)(1,1);
@@ -828,102 +915,160 @@ void ordinaryKrigingOfResiduals_PostCompute(vector<double> *subX, vector<double>
 			}
 			B[i] = (*twoGammaHatVector)[k];
 		}
-		//Build Y Vector in Davis, Eqn, (5.103).
-		Y[i] = (*residualObservations)[i];
 	}
+	//Lagrange multiplier row.
+	B[n] = 1.0;
+}
+
+void ordinaryKrigingOfResiduals_PostCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, double *xGridValue, double *yGridValue, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *luGammaDArray, ivector *gammaDPivots, dgrid *A, double *zKrigValue, double *varZKrigValue)
+{
+	vector<double> xGridValues = vector<double>(1, (*xGridValue));
+	vector<double> yGridValues = vector<double>(1, (*yGridValue));
+	vector<double> zKrigValues;
+	vector<double> varZKrigValues;
+
+	ordinaryKrigingOfResiduals_PostComputeBatch(subX, subY, residualObservations, &xGridValues, &yGridValues, twoGammaHatVector, distanceVectorBinCenters, aVectorFine, luGammaDArray, gammaDPivots, A, &zKrigValues, &varZKrigValues);
+
+	(*zKrigValue) = zKrigValues[0];
+	(*varZKrigValue) = varZKrigValues[0];
+}
+
+void ordinaryKrigingOfResiduals_PostComputeBatch(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *xGridValues, vector<double> *yGridValues, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *luGammaDArray, ivector *gammaDPivots, dgrid *A, vector<double> *zKrigValues, vector<double> *varZKrigValues)
+{
+	const int n = (const int)(*residualObservations).size() + 1;
+	const int numQueries = (const int)(*xGridValues).size();
+	int first, count;
+	int i, q;
+	double zComputed, varZComputed;
+	dgrid B;
+	dgrid lambda;
+
+	if ((const int)(*zKrigValues).size() < numQueries)
+		(*zKrigValues).resize(numQueries, 0.0);
+	if ((const int)(*varZKrigValues).size() < numQueries)
+		(*varZKrigValues).resize(numQueries, 0.0);
 
-	//Davis's solution for ordinary kriging equations, Eqn (5.105).
-	// Davis's solution for the variance of the interpolated point when semmivariogram is used, Eqn. (5.106).
-	zComputed = 0;
-	varZComputed = 0;
-	tempSum = 0;
-	for (i = 0; i < (const int)B.size(); i++)
+	for (first = 0; first < numQueries; first += KRIGING_BATCH_SIZE)
 	{
-		tempSum = 0;
-		for (j = 0; j < (const int)(*invGammaDArray).cols(); j++)
-		{
-			tempSum = tempSum + (*invGammaDArray)(i,j)*B[j];
-		}
-		//Davis's solution for ordinary kriging equations, Eqn (5.105).
-		zComputed = zComputed + (Y[i]*tempSum);
+		count = min(KRIGING_BATCH_SIZE, numQueries - first);
 
-		// Davis's solution for the variance of the interpolated point when semmivariogram is used, Eqn. (5.106).
-		varZComputed = varZComputed + (B[i]*tempSum);
-	}
+		//Build one column of B for each interpolation point, Eqn. (5.102).
+		B = dgrid(n, count);
+		for (q = 0; q < count; q++)
+			krigingRightHandSide(subX, subY, (*xGridValues)[first+q], (*yGridValues)[first+q], twoGammaHatVector, distanceVectorBinCenters, aVectorFine, A, &B(0, q));
+
+		//Solve W * lambda = B for every column at once with the LU factors of W.
+		LUsolve((*luGammaDArray), B, lambda, (*gammaDPivots), symgrid, 'U');
+
+		for (q = 0; q < count; q++)
+		{
+			zComputed = 0;
+			varZComputed = 0;
+			for (i = 0; i < n - 1; i++)
+			{
+				//Davis's solution for ordinary kriging equations, Eqn (5.105).
+				zComputed = zComputed + ((*residualObservations)[i]*lambda(i,q));
 
-	(*zKrigValue) = zComputed;
-	(*varZKrigValue) = varZComputed;
+				// Davis's solution for the variance of the interpolated point when semmivariogram is used, Eqn. (5.106).
+				varZComputed = varZComputed + (B(i,q)*lambda(i,q));
+			}
+			varZComputed = varZComputed + (B(n-1,q)*lambda(n-1,q));
 
+			(*zKrigValues)[first+q] = zComputed;
+			(*varZKrigValues)[first+q] = varZComputed;
+		}
+	}
 	B.clear();
-	Y.clear();
+	lambda.clear();
 }
 
-void methodsOfMomentsEstimator(vector<double> *distanceVector, vector<double> *angleVector, dgrid *distanceArray, dgrid *angleArray, dgrid *deltaRSquaredArray, dgrid *twoGammaHat)
+//Whether an angle falls in angle bin i.  The first bin wraps around +/-180.
+static bool inAngleBin(vector<double> *angleVector, int i, double angleBinSize, double angle)
 {
-	(*twoGammaHat) = dgrid((const uint)(*angleVector).size(), (const uint)(*distanceVector).size(), 0.00);
+	if (i == 0)
+		return ( ( (*angleVector)[ (*angleVector).size()-1 ] + (angleBinSize / 2.00) ) <= angle ) || ( angle < ( (*angleVector)[0] + (angleBinSize / 2.00) ) );
+	return ( ( (*angleVector)[i] - (angleBinSize / 2.00) ) <= angle ) && ( angle < ( (*angleVector)[i] + (angleBinSize / 2.00) ) );
+}
 
-	int currentTempVecLoc = 0;
-	int currentAngleVecLoc = 0;
+//Add one ordered pair to every angle bin it falls in, in the distance bin [distanceVector[k], distanceVector[k+1]) it falls in.
+static void addPointPair(vector<double> *distanceVector, vector<double> *angleVector, double angleBinSize, double distance, double angle, double deltaRSquared, dgrid *pairSums, dgrid *pairCounts)
+{
+	int lastEdge = (const int)(*distanceVector).size() - 1;
+	if (lastEdge < 1 || !(distance < (*distanceVector)[lastEdge]))
+		return;
+
+	//The edges are multiples of the first bin width; step off any rounding in the division
+	int k = (int)(distance / (*distanceVector)[1]);
+	if (k > lastEdge - 1)
+		k = lastEdge - 1;
+	while (k > 0 && distance < (*distanceVector)[k])
+		k--;
+	while (k < lastEdge - 1 && (*distanceVector)[k+1] <= distance)
+		k++;
+
+	for (int i = 0; i < (const int)(*angleVector).size(); i++){
+		if (inAngleBin(angleVector, i, angleBinSize, angle)){
+			(*pairSums)(i,k) += deltaRSquared;
+			(*pairCounts)(i,k) += 1.00;
+		}
+	}
+}
 
-	vector<double> tempVec;
-	vector<double> filteredDistanceVector;
-	vector<double> filteredDeltaRSquaredVector;
-	vector<int> hatAngle;
+void accumulatePointPairs(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<int> *indices, vector<double> *distanceVector, vector<double> *angleVector, dgrid *pairSums, dgrid *pairCounts)
+{
+	int numDistanceBins = max((const int)(*distanceVector).size() - 1, 1);
+	(*pairSums) = dgrid((const uint)(*angleVector).size(), (const uint)numDistanceBins, 0.00);
+	(*pairCounts) = dgrid((const uint)(*angleVector).size(), (const uint)numDistanceBins, 0.00);
 
 	double angleBinSize = 360.00/((double)(*angleVector).size());
-	double deltaRSquaredArraySum = 0.00;
-	double nDeltaR = 0.00;
 	double angleMultiplier = 180.00 / PI;
-//	double workingDouble;
-	double maxVal;
+	double maxDistance = (*distanceVector)[(*distanceVector).size()-1];
+	double dx, dy, distance, deltaRSquared;
+	int n = (indices == NULL) ? (const int)(*residualObservations).size() : (const int)(*indices).size();
+	int i, j, a, b;
+
+	for (i = 0; i < n; i++){
+		a = (indices == NULL) ? i : (*indices)[i];
+
+		//A point paired with itself is at distance 0 and angle 0
+		addPointPair(distanceVector, angleVector, angleBinSize, 0.00, angleMultiplier*atan2(0.00, 0.00), 0.00, pairSums, pairCounts);
+
+		//Both orders of each pair share a distance and squared difference; their angles differ by 180 degrees
+		for (j = i + 1; j < n; j++){
+			b = (indices == NULL) ? j : (*indices)[j];
+			dx = (*subX)[a] - (*subX)[b];
+			dy = (*subY)[a] - (*subY)[b];
+			distance = sqrt( pow(dx, 2) + pow(dy, 2) );
+			if (!(distance < maxDistance))
+				continue;
+			deltaRSquared = pow((*residualObservations)[a] - (*residualObservations)[b], 2);
+			addPointPair(distanceVector, angleVector, angleBinSize, distance, angleMultiplier*atan2(dy, dx), deltaRSquared, pairSums, pairCounts);
+			addPointPair(distanceVector, angleVector, angleBinSize, distance, angleMultiplier*atan2(-dy, -dx), deltaRSquared, pairSums, pairCounts);
+		}
+	}
+}
 
-	int i,j,k;
+void methodsOfMomentsEstimatorBinned(dgrid *pairSums, dgrid *pairCounts, dgrid *twoGammaHat)
+{
+	(*twoGammaHat) = dgrid((*pairSums).rows(), (*pairSums).cols() + 1, 0.00);
 
-	//Bin distances
-	for (i = 0; i < (const int)(*angleVector).size(); i++){
-		currentAngleVecLoc = 0;
+	vector<int> hatAngle;
 
-		//Find and sum points in the bins
-		if (i == 0){
-			for (j = 0; j < (const int)(*angleArray).cols(); j++){
-				for (k = 0; k < (const int)(*angleArray).rows(); k++){
-					if ( ( ( (*angleVector)[ (*angleVector).size()-1 ] + (angleBinSize / 2.00) ) <= (*angleArray)(k,j) ) || ( (*angleArray)(k,j) < ( (*angleVector)[0] + (angleBinSize / 2.00) ) ) ){
-						filteredDistanceVector.push_back((*distanceArray)(k,j));
-						filteredDeltaRSquaredVector.push_back((*deltaRSquaredArray)(k, j));
+	double deltaRSquaredArraySum = 0.00;
+	double nDeltaR = 0.00;
+	double maxVal;
 
-						currentAngleVecLoc += 1;
-					}
-				}
-			}
-		}else{
-			for (j = 0; j < (const int)(*angleArray).cols(); j++){
-				for (k = 0; k < (const int)(*angleArray).rows(); k++){
-					if ( ( ( (*angleVector)[i] - (angleBinSize / 2.00) ) <= (*angleArray)(k,j) ) && ( (*angleArray)(k,j) < ( (*angleVector)[i] + (angleBinSize / 2.00) ) ) ){
-						filteredDistanceVector.push_back((*distanceArray)(k,j));
-						filteredDeltaRSquaredVector.push_back((*deltaRSquaredArray)(k, j));
-
-						currentAngleVecLoc += 1;
-					}
-				}
-			}
-		}
+	int i,j;
 
+	for (i = 0; i < (const int)(*pairSums).rows(); i++){
 		deltaRSquaredArraySum = 0;
 		nDeltaR = 0;
 
-		//Calculate h_hat for the jj-th angle and the kk-th distance bin
-		tempVec = vector<double>(filteredDistanceVector.size(),0.00);
-		for (j = 0; j < ((const int)(*distanceVector).size() - 1); j++){
-			currentTempVecLoc = 0;
-			for (k = 0; k < (const int)filteredDistanceVector.size(); k++){
-				if ( ((*distanceVector)[j] <= filteredDistanceVector[k]) && (filteredDistanceVector[k] < (*distanceVector)[j+1])){
-					tempVec[currentTempVecLoc] = filteredDeltaRSquaredVector[k];
-					deltaRSquaredArraySum += filteredDeltaRSquaredVector[k];
-					currentTempVecLoc += 1;
-				}
-			}
-			nDeltaR = nDeltaR + currentTempVecLoc;
-			if ( (currentTempVecLoc > 0) && (deltaRSquaredArraySum > 0) ){
+		//Calculate h_hat for the jj-th angle and the kk-th distance bin.  The sums run on over the distance bins.
+		for (j = 0; j < (const int)(*pairSums).cols(); j++){
+			deltaRSquaredArraySum += (*pairSums)(i,j);
+			nDeltaR = nDeltaR + (*pairCounts)(i,j);
+			if ( ((*pairCounts)(i,j) > 0) && (deltaRSquaredArraySum > 0) ){
 				(*twoGammaHat)(i,j+1) = (1.00/nDeltaR)*deltaRSquaredArraySum;
 			}else if (j > 0){
 				(*twoGammaHat)(i,j+1) = (*twoGammaHat)(i,j);
@@ -951,19 +1096,23 @@ void methodsOfMomentsEstimator(vector<double> *distanceVector, vector<double> *a
 				(*twoGammaHat)(i, j) = maxVal;
 			}
 		}
-		filteredDistanceVector.clear();
-		filteredDeltaRSquaredVector.clear();
-		tempVec.clear();
 		hatAngle.clear();
 	}
+}
 
-	//************************************************************************************
-	// 2. Clear all allocated memory from the function
-	//************************************************************************************
-	hatAngle.clear();
-	tempVec.clear();
-	filteredDistanceVector.clear();
-	filteredDeltaRSquaredVector.clear();
+void methodsOfMomentsEstimator(vector<double> *distanceVector, vector<double> *angleVector, dgrid *distanceArray, dgrid *angleArray, dgrid *deltaRSquaredArray, dgrid *twoGammaHat)
+{
+	int numDistanceBins = max((const int)(*distanceVector).size() - 1, 1);
+	double angleBinSize = 360.00/((double)(*angleVector).size());
+	dgrid pairSums((const uint)(*angleVector).size(), (const uint)numDistanceBins, 0.00);
+	dgrid pairCounts((const uint)(*angleVector).size(), (const uint)numDistanceBins, 0.00);
+
+	for (int j = 0; j < (const int)(*angleArray).cols(); j++){
+		for (int k = 0; k < (const int)(*angleArray).rows(); k++){
+			addPointPair(distanceVector, angleVector, angleBinSize, (*distanceArray)(k,j), (*angleArray)(k,j), (*deltaRSquaredArray)(k,j), &pairSums, &pairCounts);
+		}
+	}
+	methodsOfMomentsEstimatorBinned(&pairSums, &pairCounts, twoGammaHat);
 }
 
 dgrid rotMtx(double x)
@@ -18,7 +18,7 @@ using namespace std;
 
 /**
 * This function computes weighting values for use in the _PostCompute function.
-* It also computes the inverse of the gammaDArray.  Inverting the grid has the highest computational and time requirements.
+* It also factors the gammaDArray.  Factoring the grid has the highest computational and time requirements.
 * This function is best for residual observation vectors smaller than 64 elements
 * @param subX - Vector of the subsampled X coordinates to be computed.
 * @param subY - Vector of the subsampled Y coordinates to be computed.
@@ -26,10 +26,52 @@ using namespace std;
 * @param twoGammaHatVector - Vector of the fine-scale variogram in line with theta_m. (Returned).
 * @param distanceVectorBinCenters - The fit of the fine-scale variograms to spherical model. (Returned).
 * @param aVectorFine - The Levenburg-Marquart fits for the spherical model of the semivariance. (Returned).
-* @param invGammaDArray - The inverse of the computed solution for the interpolated residual surface using ordinary kriging as provided in Davis JC, Statistics and Data Analysis in Geology,  3rd edition, pp. 420-1, New York: Wiley, 2002. (Returned).
+* @param luGammaDArray - The LU factorization of the ordinary kriging system for the interpolated residual surface as provided in Davis JC, Statistics and Data Analysis in Geology,  3rd edition, pp. 420-1, New York: Wiley, 2002. (Returned).
+* @param gammaDPivots - The pivots of the factorization in luGammaDArray. (Returned).
+* @param A - The A matrix as per Calder's Eqn. (22), to account for anisotropy. (Returned).
+*/
+void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *luGammaDArray, ivector *gammaDPivots, dgrid *A);
+
+/**
+* The first half of the _PreCompute function: fits the semivariogram and the anisotropy of the residuals.
+* @param subX - Vector of the subsampled X coordinates to be computed.
+* @param subY - Vector of the subsampled Y coordinates to be computed.
+* @param residualObservations - Vector of the residual observed depths at the coordinates specified by subX and subY.
+* @param twoGammaHatVector - Vector of the fine-scale variogram in line with theta_m. (Returned).
+* @param distanceVectorBinCenters - The fit of the fine-scale variograms to spherical model. (Returned).
+* @param aVectorFine - The Levenburg-Marquart fits for the spherical model of the semivariance. (Returned).
 * @param A - The A matrix as per Calder's Eqn. (22), to account for anisotropy. (Returned).
 */
-void ordinaryKrigingOfResiduals_PreCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *invGammaDArray, dgrid *A);
+void ordinaryKrigingOfResiduals_Variogram(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *A);
+
+/**
+* The second half of the _PreCompute function: builds the ordinary kriging system of the given points from a fitted semivariogram and factors it.
+* The points need not be those the semivariogram was fitted to.
+* @param subX - Vector of the X coordinates of the points of the system.
+* @param subY - Vector of the Y coordinates of the points of the system.
+* @param twoGammaHatVector - Vector of the fine-scale variogram in line with theta_m. 
+* @param distanceVectorBinCenters - The fit of the fine-scale variograms to spherical model. 
+* @param aVectorFine - The Levenburg-Marquart fits for the spherical model of the semivariance. 
+* @param A - The A matrix as per Calder's Eqn. (22), to account for anisotropy. 
+* @param luGammaDArray - The LU factorization of the ordinary kriging system. (Returned).
+* @param gammaDPivots - The pivots of the factorization in luGammaDArray. (Returned).
+*/
+void ordinaryKrigingOfResiduals_Factor(vector<double> *subX, vector<double> *subY, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *A, dgrid *luGammaDArray, ivector *gammaDPivots);
+
+/**
+* Moving neighborhood kriging.  The semivariogram is fitted once over all of the residuals, and each interpolation point is
+* then kriged from only its maxNeighbors nearest residuals, found with a kd-tree in the anisotropic distance of Calder's Eqn. (21).
+* Interpolation points with the same set of neighbors share one factored system, so the cost grows with the number of points rather than the cube of the number of residuals.
+* @param subX - Vector of the subsampled X coordinates to be computed.
+* @param subY - Vector of the subsampled Y coordinates to be computed.
+* @param residualObservations - Vector of the residual observed depths at the coordinates specified by subX and subY.
+* @param interpX - Vector of interpolation X coordinates.
+* @param interpY - Vector of interpolation Y coordinates.
+* @param maxNeighbors - Number of residuals in the system of each interpolation point.
+* @param outDepthKrig - Vector of the computed depths for the given data points; lengthened if shorter than interpX. (Returned).
+* @param outErrorKrig - Vector of the computed errors for the given data points; lengthened if shorter than interpX. (Returned).
+*/
+void ordinaryKrigingOfResiduals_Local(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *interpX, vector<double> *interpY, int maxNeighbors, vector<double> *outDepthKrig, vector<double> *outErrorKrig);
 
 /**
 * This function computes weighting values for use in the _PostCompute function.
@@ -65,12 +107,32 @@ It operates on a single gridded data point at a time over a smaller, resampled l
 * @param twoGammaHatVector - Vector of the fine-scale variogram in line with theta_m. 
 * @param distanceVectorBinCenters - The fit of the fine-scale variograms to spherical model. 
 * @param aVectorFine - The Levenburg-Marquart fits for the spherical model of the semivariance. 
-* @param invGammaDArray - The inverse of the computed solution for the interpolated residual surface using ordinary kriging as provided in Davis JC, Statistics and Data Analysis in Geology,  3rd edition, pp. 420-1, New York: Wiley, 2002. 
+* @param luGammaDArray - The factored ordinary kriging system from the _PreCompute function. 
+* @param gammaDPivots - The pivots of the factorization in luGammaDArray. 
 * @param A - The A matrix as per Calder's Eqn. (22), to account for anisotropy. 
 * @param zKrigValue - The comptued depth for the given data point. (Returned).
 * @param varZKrigValue - The comptued error for the given data point. (Returned).
 */
-void ordinaryKrigingOfResiduals_PostCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, double *xGridValue, double *yGridValue, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *invGammaDArray, dgrid *A, double *zKrigValue, double *varZKrigValue);
+void ordinaryKrigingOfResiduals_PostCompute(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, double *xGridValue, double *yGridValue, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *luGammaDArray, ivector *gammaDPivots, dgrid *A, double *zKrigValue, double *varZKrigValue);
+
+/**
+* The _PostCompute function for many gridded data points at once.
+* The right hand sides of up to KRIGING_BATCH_SIZE points are gathered into the columns of one grid and solved against the factored system together.
+* @param subX - Vector of the subsampled X coordinates to be computed.
+* @param subY - Vector of the subsampled Y coordinates to be computed.
+* @param residualObservations - Vector of the residual observed depths at the coordinates specified by subX and subY.
+* @param xGridValues - The interpolated X coordinates of the data to krig.
+* @param yGridValues - The interpolated Y coordinates of the data to krig.
+* @param twoGammaHatVector - Vector of the fine-scale variogram in line with theta_m. 
+* @param distanceVectorBinCenters - The fit of the fine-scale variograms to spherical model. 
+* @param aVectorFine - The Levenburg-Marquart fits for the spherical model of the semivariance. 
+* @param luGammaDArray - The factored ordinary kriging system from the _PreCompute function. 
+* @param gammaDPivots - The pivots of the factorization in luGammaDArray. 
+* @param A - The A matrix as per Calder's Eqn. (22), to account for anisotropy. 
+* @param zKrigValues - The comptued depths for the given data points, in their first xGridValues.size() elements; lengthened if shorter. (Returned).
+* @param varZKrigValues - The comptued errors for the given data points, in their first xGridValues.size() elements; lengthened if shorter. (Returned).
+*/
+void ordinaryKrigingOfResiduals_PostComputeBatch(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<double> *xGridValues, vector<double> *yGridValues, vector<double> *twoGammaHatVector, vector<double> *distanceVectorBinCenters, vector<double> *aVectorFine, dgrid *luGammaDArray, ivector *gammaDPivots, dgrid *A, vector<double> *zKrigValues, vector<double> *varZKrigValues);
 
 /**
 * This function provides a polar 2-D emperical variogram. 
@@ -85,6 +147,29 @@ void ordinaryKrigingOfResiduals_PostCompute(vector<double> *subX, vector<double>
 */
 void methodsOfMomentsEstimator(vector<double> *distanceVector, vector<double> *angleVector, dgrid *distanceArray, dgrid *angleArray, dgrid *deltaRSquaredArray, dgrid *twoGammaHat);
 
+/**
+* Bins the squared differences of the residuals of every ordered pair of points, a point paired with itself included, by angle and distance in one pass over the pairs.
+* Takes the place of the n by n distance, angle and squared difference grids given to methodsOfMomentsEstimator; the memory used is that of the bins.
+* Pairs at or beyond the last distance are skipped before their angle is computed.
+* @param subX - Vector of the X coordinates.
+* @param subY - Vector of the Y coordinates.
+* @param residualObservations - Vector of the residual observed depths at the coordinates specified by subX and subY.
+* @param indices - Indices of the points to pair.  NULL pairs every point.
+* @param distanceVector - Vector of distances to compute over.  Distance bin k holds the distances from distanceVector[k] up to distanceVector[k+1].
+* @param angleVector - Vector of angles to compute over, as in methodsOfMomentsEstimator.
+* @param pairSums - Sum of the squared differences in each angle (row) and distance bin (column). (Returned).
+* @param pairCounts - Number of pairs in each angle (row) and distance bin (column). (Returned).
+*/
+void accumulatePointPairs(vector<double> *subX, vector<double> *subY, vector<double> *residualObservations, vector<int> *indices, vector<double> *distanceVector, vector<double> *angleVector, dgrid *pairSums, dgrid *pairCounts);
+
+/**
+* The polar 2-D emperical variogram of methodsOfMomentsEstimator computed from pairs binned by accumulatePointPairs.
+* @param pairSums - Sum of the squared differences in each angle and distance bin.
+* @param pairCounts - Number of pairs in each angle and distance bin.
+* @param twoGammaHat - The grid of computed gamma values. The grid has a row for each angle and one more column than there are distance bins. (Returned).
+*/
+void methodsOfMomentsEstimatorBinned(dgrid *pairSums, dgrid *pairCounts, dgrid *twoGammaHat);
+
 /**
 * Rotate a matrix follow the rule of: y = PI * x / 180.  The output grid is:
 * @n cos(y)		sin(y)
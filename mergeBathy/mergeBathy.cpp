@@ -37,6 +37,7 @@ int main(char argc, char *argv[])
 	//2. Data structures for external interpolates and irregular grid points
 	MB_ZGRID_DATA mbzData;
 	GMT_SURFACE_DATA GMTSurfaceData;
+	GMTSurfaceData.numThreads = 0;
 	ALG_SPLINE_DATA ALGsplineData;
 	FORCED_LOCATIONS forcedLocPositions;
 	BOUNDING_BOX bbox;
@@ -68,6 +69,13 @@ int main(char argc, char *argv[])
 	additionalOptions["-printMSEwK"] = 0;
 	additionalOptions["-appendFilename"] = 0;
 	additionalOptions["-useUnscaledAvgInputs"] = 0;
+	additionalOptions["-tinBuild"] = SWEEP_GLOBAL_FLIP;
+	additionalOptions["-writeBinaryInputs"] = -1;
+	additionalOptions["-indexInputs"] = 0;
+	additionalOptions["-streaming"] = 0;
+	additionalOptions["-krigingNeighbors"] = 0;
+	additionalOptions["-fftSmoothing"] = 0;
+	additionalOptions["-mcMemoryBudget"] = 0;
 	vector<string> unrecognizedParams;
 	//************************************************************************************
 	//I. Check input arguments and store data. If not then display the usage instructions.
@@ -82,7 +90,7 @@ int main(char argc, char *argv[])
 		cerr << "                   [-llsmooth <smoothing_scale_longitude (X)> <smoothing_scale_latitude (Y)>] [-llgrid]" << endl;
 		cerr << "					[-computeOffset] [-outputRasterFile] [-outputBagFile] [-multiThread <num_threads>]" << endl;
 		cerr << "                   [-ZGrid <grid_spacing_X> <grid_spacing_Y> <Z_Grid_Output_File_Name> <Tension_Factor (Typically 1e10)> <Usage: (1: Do not use as input. 2: Use as input. Negate the value to include error in the computation)> ]" << endl;
-		cerr << "                   [-GMTSurface <grid_spacing_X> <grid_spacing_Y> <GMT_Surface_Output_File_Name> <Tension_Factor (Between 0 and 1)> <scale_factor> <alpha> <Usage: (1: Do not use as input. 2: Use as input. Negate the value to include error in the computation)> ]" << endl;
+		cerr << "                   [-GMTSurface <grid_spacing_X> <grid_spacing_Y> <GMT_Surface_Output_File_Name> <Tension_Factor (Between 0 and 1)> <scale_factor> <alpha> <Usage: (1: Do not use as input. 2: Use as input. Negate the value to include error in the computation)> [num_threads] ]" << endl;
 		cerr << "[-ALGSpline <grid_spacing_X> <grid_spacing_Y> <ALG_Surface_Output_File_Name> ]" << endl;
 		cerr << "					[-preInterpolatedLocations <interpolation_location_file_name> <Usage: (1: Read in Lat,Lon. Negate to read in Lon,Lat.>]" << endl;
 		cerr << "					[-boundingBox <upper_bound> <lower_bound> <right_bound> <left_bound>]" << endl;
@@ -91,6 +99,10 @@ int main(char argc, char *argv[])
 		cerr << "					[-propUncert <Print: (1: Print output file. Negate to disable)>]" << endl;
 		cerr << "					[-kalman <Print: (1: Print output file. Negate to disable)>]" << endl; 
 		cerr << "					[-printMSEwK ] [-appendFilename]" << endl;
+		cerr << "					[-tinBuild <Mode: (0: Radial sweep, global flipping. 1: Radial sweep, local flipping. 2: BRIO order, local flipping)>]" << endl;
+		cerr << "					[-writeBinaryInputs <Encoding: (0: float64. 1: scaled int32)>] [-indexInputs] [-streaming]" << endl;
+		cerr << "					[-krigingNeighbors <max_neighbors (at least 4)>] [-fftSmoothing]" << endl;
+		cerr << "					[-mcMemoryBudget <megabytes for concurrent Monte Carlo runs (0: half of the physical memory)>]" << endl;
 		return ARGS_ERROR;
 	}else
 	{
@@ -209,6 +221,10 @@ int main(char argc, char *argv[])
 					cout << "Improper argument passed to -GMTSurface. Exiting!" << endl;
 					return ARGS_ERROR;
 				}
+
+				//Optional thread count for the surface relaxation
+				if (argLocation+1 < argc && isdigit(argv[argLocation+1][0]))
+					GMTSurfaceData.numThreads = atoi(argv[++argLocation]);
 			}
 
 			//b. ALGSpline Surface will be used
@@ -465,7 +481,74 @@ int main(char argc, char *argv[])
 			else if (strcmp(argv[argLocation], "-appendFilename") == 0)
 				additionalOptions["-appendFilename"] = 1;
 			
-			//bb.Unrecognized parameter
+			//bb. Triangulation build mode
+			else if (strcmp(argv[argLocation], "-tinBuild") == 0)
+			{
+				if (argLocation+1 >= argc || !isdigit(argv[argLocation+1][0])){
+					cout << "Improper argument passed to -tinBuild. Exiting!" << endl;
+					return ARGS_ERROR;
+				}
+				additionalOptions["-tinBuild"] = atoi(argv[++argLocation]);
+				if (additionalOptions.find("-tinBuild")->second > BRIO_LOCAL_FLIP)
+				{
+					cout << "Improper argument passed to -tinBuild. Exiting!" << endl;
+					return ARGS_ERROR;
+				}
+			}
+
+			//cc. Write the input data sets to mergeBathy binary files
+			else if (strcmp(argv[argLocation], "-writeBinaryInputs") == 0)
+			{
+				if (argLocation+1 >= argc || !isdigit(argv[argLocation+1][0])){
+					cout << "Improper argument passed to -writeBinaryInputs. Exiting!" << endl;
+					return ARGS_ERROR;
+				}
+				additionalOptions["-writeBinaryInputs"] = atoi(argv[++argLocation]);
+				if (additionalOptions.find("-writeBinaryInputs")->second > MBB_SCALED_INT32)
+				{
+					cout << "Improper argument passed to -writeBinaryInputs. Exiting!" << endl;
+					return ARGS_ERROR;
+				}
+			}
+
+			//dd. Read the text input files through their sidecar spatial indexes
+			else if (strcmp(argv[argLocation], "-indexInputs") == 0)
+				additionalOptions["-indexInputs"] = 1;
+
+			//ee. Subsample the input files a block at a time instead of reading them into memory
+			else if (strcmp(argv[argLocation], "-streaming") == 0)
+				additionalOptions["-streaming"] = 1;
+
+			//ff. Krige each location from its nearest residuals only
+			else if (strcmp(argv[argLocation], "-krigingNeighbors") == 0)
+			{
+				if (argLocation+1 >= argc || !isdigit(argv[argLocation+1][0])){
+					cout << "Improper argument passed to -krigingNeighbors. Exiting!" << endl;
+					return ARGS_ERROR;
+				}
+				additionalOptions["-krigingNeighbors"] = atoi(argv[++argLocation]);
+				if (additionalOptions.find("-krigingNeighbors")->second < 4)
+				{
+					cout << "Improper argument passed to -krigingNeighbors. Exiting!" << endl;
+					return ARGS_ERROR;
+				}
+			}
+
+			//gg. Convolve boxcar and hann windows over regular tiles by FFT
+			else if (strcmp(argv[argLocation], "-fftSmoothing") == 0)
+				additionalOptions["-fftSmoothing"] = 1;
+
+			//hh. Memory the concurrent Monte Carlo runs may hold
+			else if (strcmp(argv[argLocation], "-mcMemoryBudget") == 0)
+			{
+				if (argLocation+1 >= argc || !isdigit(argv[argLocation+1][0])){
+					cout << "Improper argument passed to -mcMemoryBudget. Exiting!" << endl;
+					return ARGS_ERROR;
+				}
+				additionalOptions["-mcMemoryBudget"] = atoi(argv[++argLocation]);
+			}
+
+			//ii.Unrecognized parameter
 			else 
 				unrecognizedParams.push_back(argv[argLocation]);
 		}
@@ -508,6 +591,8 @@ int main(char argc, char *argv[])
 	if (additionalOptions.find("-kriging")->second == 1)
 	{
 		cout << "Computing using Kriging" << endl;
+		if (additionalOptions.find("-krigingNeighbors")->second != 0)
+			cout << "Kriging from the nearest " << additionalOptions.find("-krigingNeighbors")->second << " residuals of each location" << endl;
 	}
 	if (additionalOptions.find("-ZGrid")->second == 1)
 	{
@@ -516,6 +601,8 @@ int main(char argc, char *argv[])
 	if (additionalOptions.find("-GMTSurface")->second == 1)
 	{
 		cout << "Using GMT Surface in Interpolation" << endl;
+		if (GMTSurfaceData.numThreads > 1)
+			cout << "Using " << GMTSurfaceData.numThreads << " Threads in GMT Surface" << endl;
 	}
 	if (additionalOptions.find("-ALGSpline")->second == 1)
 	{
@@ -553,6 +640,40 @@ int main(char argc, char *argv[])
 	{
 		cout << "Using Nearest Neighbor Interpolation for pre-splining depths." << endl;
 	}
+	if (additionalOptions.find("-fftSmoothing")->second == 1)
+	{
+		cout << "Convolving boxcar and hann windows over regular tiles by FFT where it is cheaper than the exact sweep." << endl;
+	}
+	if (additionalOptions.find("-mcMemoryBudget")->second != 0)
+	{
+		cout << "Concurrent Monte Carlo runs may hold " << additionalOptions.find("-mcMemoryBudget")->second << " MB" << endl;
+	}
+	if (additionalOptions.find("-tinBuild")->second == SWEEP_LOCAL_FLIP)
+	{
+		cout << "Building triangulations with local edge flipping." << endl;
+	}
+	if (additionalOptions.find("-tinBuild")->second == BRIO_LOCAL_FLIP)
+	{
+		cout << "Building triangulations in BRIO insertion order." << endl;
+	}
+	SHullDelaunay::setDefaultBuildMode((TinBuildMode)additionalOptions.find("-tinBuild")->second);
+	if (additionalOptions.find("-streaming")->second == 1)
+	{
+		cout << "Streaming the input files; the soundings are subsampled as they are read." << endl;
+		//Everything else needs every sounding in memory
+		if (additionalOptions.find("-ZGrid")->second == 1 || additionalOptions.find("-GMTSurface")->second == 1 || additionalOptions.find("-ALGSpline")->second == 1
+			|| additionalOptions.find("-computeOffset")->second == 1 || numMCRuns != -1 || additionalOptions.find("-writeBinaryInputs")->second != -1)
+		{
+			cout << "-streaming cannot be used with -ZGrid, -GMTSurface, -ALGSpline, -computeOffset, -writeBinaryInputs or Monte Carlo runs. Exiting!" << endl;
+			return ARGS_ERROR;
+		}
+	}
+	if (additionalOptions.find("-writeBinaryInputs")->second != -1 && (bbox.doBoundingBox || additionalOptions.find("-nonegdepth")->second == 1))
+	{
+		//The .mbb files would hold the cut data and a later run without the filters would read it unknowingly
+		cout << "-writeBinaryInputs cannot be used with -boundingBox or -nonegdepth. Exiting!" << endl;
+		return ARGS_ERROR;
+	}
 	if (abs(additionalOptions.find("-mse")->second) == 1)
 	{
 		cout << "Using MSE (linear) Estimator." << endl;
@@ -634,9 +755,10 @@ int main(char argc, char *argv[])
 	//************************************************************************************
 	//II. Read the files
 	//************************************************************************************
-	//1. Read the input files
+	//1. Read the input files, unless they are streamed
 	start = clock();
-	returnValue = readFile(inputFileList, &inputData, bbox, additionalOptions.find("-noerr")->second, additionalOptions.find("-nonegdepth")->second,additionalOptions.find("-useUnscaledAvgInputs")->second);
+	if (additionalOptions.find("-streaming")->second == 0)
+		returnValue = readFile(inputFileList, &inputData, bbox, additionalOptions.find("-noerr")->second, additionalOptions.find("-nonegdepth")->second,additionalOptions.find("-useUnscaledAvgInputs")->second, additionalOptions.find("-multiThread")->second, additionalOptions.find("-indexInputs")->second);
 
 	if (returnValue != SUCCESS)
 	{
@@ -644,7 +766,18 @@ int main(char argc, char *argv[])
 		return returnValue;
 	}
 
-	//2. Read in the interpolated locations
+	//2. Write the data sets as read to binary files so later runs skip parsing
+	if (additionalOptions.find("-writeBinaryInputs")->second != -1)
+	{
+		returnValue = writeMBBInputs(inputFileList, &inputData, additionalOptions.find("-writeBinaryInputs")->second);
+		if (returnValue != SUCCESS)
+		{
+			cerr << "FAILED TO WRITE BINARY INPUT FILES! ABORTING!!!" << endl;
+			return returnValue;
+		}
+	}
+
+	//3. Read in the interpolated locations
 	if (additionalOptions.find("-preInterpolatedLocations")->second == 1)
 	{
 		returnValue = readLocationsFile(interpolationLocationsFileName, &forcedLocPositions, usagePreInterpLocsLatLon);
@@ -660,7 +793,10 @@ int main(char argc, char *argv[])
 	//************************************************************************************
 	start = clock();
 
-	returnValue = mergeBathy_PreCompute(&inputData, refLon, refLat, rotationAngle, gridSpacingX_Lon, gridSpacingY_Lat, smoothingScaleX, smoothingScaleY, kernelName, outputFileName, additionalOptions, numMCRuns, &mbzData, &GMTSurfaceData, &ALGsplineData, &forcedLocPositions,usagePreInterpLocsLatLon);
+	if (additionalOptions.find("-streaming")->second == 1)
+		returnValue = mergeBathy_PreComputeStreaming(inputFileList, bbox, refLon, refLat, rotationAngle, gridSpacingX_Lon, gridSpacingY_Lat, smoothingScaleX, smoothingScaleY, kernelName, outputFileName, additionalOptions, numMCRuns, &mbzData, &GMTSurfaceData, &ALGsplineData, &forcedLocPositions,usagePreInterpLocsLatLon);
+	else
+		returnValue = mergeBathy_PreCompute(&inputData, refLon, refLat, rotationAngle, gridSpacingX_Lon, gridSpacingY_Lat, smoothingScaleX, smoothingScaleY, kernelName, outputFileName, additionalOptions, numMCRuns, &mbzData, &GMTSurfaceData, &ALGsplineData, &forcedLocPositions,usagePreInterpLocsLatLon);
 
 	if (returnValue != SUCCESS)
 	{
@@ -11,6 +11,7 @@
 #include <map>
 #include "constants.h"
 #include "fileReader.h"
+#include "binaryBathyFile.h"
 #include "mergeBathyOld.h"
 
 /**
@@ -58,6 +59,12 @@
 * [-kalman] - Perform Kalman Estimator.
 *		<Print> - A value of 1 to write results to an output file.  A value of -1 to disable output file printout.
 * [-nnInterp] - Perform Nearest Neighbor interpolation when pre-splining.  Default performs bilinear interpolation.
+* [-tinBuild] - Selects how the Delaunay triangulation used for uncertainty estimation is built.
+*		<Mode> - 0 sweeps the points radially and then flips every edge until no flips occur (original method, default).  1 sweeps the points radially and legalizes the edges around each point as it is inserted.  2 inserts the points in biased randomized Hilbert curve order and legalizes the edges around each point as it is inserted.
+* [-writeBinaryInputs] - After reading, write each input data set to <input file>.mbb and list them in <input_file_list>.mbb.txt.  Passing that list in later runs memory maps the soundings instead of parsing text.  The files hold the data after tide correction and the error defaults have been applied.  Inputs that are already .mbb files are listed as they are.  Cannot be used with -boundingBox or -nonegdepth.
+*		<Encoding> - 0 stores float64 columns.  1 stores int32 columns scaled over the range of each column, halving the file size.
+* [-indexInputs] - Keep a spatial index next to each XYZ, XYZE and XYZHV input file as <input file>.mbi.  The first run reads the whole file and writes the index; later runs with -boundingBox read only the parts of the file near the box.  An index is rebuilt once its input file changes size or modification time.
+* [-streaming] - Subsample the input files as they are read instead of reading them into memory first.  The files are read several times over, .mbb files a block of records at a time and other files one at a time, so only the subsampled cells and one block are held.  Cannot be used with -ZGrid, -GMTSurface, -ALGSpline, -computeOffset, -writeBinaryInputs or Monte Carlo runs.
 * [-printMatlabMatch] - print output file with results formatted to match Matlab's output file.
 */
 
@@ -17,6 +17,13 @@
 #include <cmath>
 #include <functional> //mod
 #include "Error_Estimator/Bathy_Grid.h"
+#include "streamingSubsample.h"
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #ifdef _MSC_VER
 //Disable warnings since this is a Third-party file. -SJZ
@@ -32,6 +39,185 @@
 //}
 
 
+//************************************************************************************
+// SUBROUTINE 0: Locations to interpolate to, for mergeBathy_PreCompute and
+// mergeBathy_PreComputeStreaming.  Computed from the extents of the data on a
+// grid of the grid spacing, or the pre-interpolated locations converted to X and Y.
+//************************************************************************************
+static int computeGridLocations(double x0, double y0, double x1, double y1, double refLat, double refLon, double rotationAngle, double &gridSpacingX, double &gridSpacingY, double &smoothingScaleX, double &smoothingScaleY, map<string, int> &additionalOptions, FORCED_LOCATIONS *forcedLocationPositions, int usagePreInterpLocsLatLon, int USE_UTM, vector<double> &xt, vector<double> &yt, vector<double> &xMeshVector, vector<double> &yMeshVector, dgrid &xMeshGrid, dgrid &yMeshGrid, double &meanXt, double &meanYt)
+{
+	int refEllipsoid = 23;
+	int currentLoc;
+	int xtSize, ytSize;
+	double locationValue;
+	double maxLat, minLat;
+	double longitudeMean, latitudeMean;
+	double UTMNorthingRef = 0, UTMEastingRef = 0, UTMNorthing = 0, UTMEasting = 0;
+	char UTMZone[4]="";
+	char UTMZoneRef[4]="";
+
+	if (additionalOptions.find("-preInterpolatedLocations")->second == 0)//calcgrid
+	{
+		#pragma region --No preInterpolatedLocations provided
+		//Compute grid locations based on smoothing scale; No preInterpolatedLocations provided
+		if (gridSpacingX == 0 && gridSpacingX == 0)
+        {
+			gridSpacingX = 100;
+			gridSpacingY = 100;
+		}
+		if(smoothingScaleX == 0 && smoothingScaleY == 0)
+		{
+			smoothingScaleX = 100;
+			smoothingScaleY = 100;
+		}
+		else if (smoothingScaleX < gridSpacingX || smoothingScaleY < gridSpacingY)
+		{
+			cout << "Grid spacing defaults to 100 making smoothing scales too small.  Make smoothing scales greater than the grid spacing." << endl;
+			return ARGS_ERROR;
+		}
+
+		meanXt = 0.00;
+		meanYt = 0.00;
+
+		//A. Calculate X
+		locationValue = x0 - gridSpacingX;
+		xtSize = 0;
+		while (locationValue <= (const double)(x1 + gridSpacingX)) {
+			xt.push_back(locationValue);
+			meanXt += locationValue;
+			locationValue += gridSpacingX;
+			xtSize += 1;
+		}
+		//Get the mean for later use
+		meanXt = meanXt / (double)xt.size();
+
+		//B. Calculate Y
+		locationValue = y0 - gridSpacingY;
+		ytSize = 0;
+		while (locationValue <= (const double)(y1 + gridSpacingY)) {
+			yt.push_back(locationValue);
+			meanYt += locationValue;
+			locationValue += gridSpacingY;
+			ytSize += 1;
+		}
+		//Get the mean for later use
+		meanYt = meanYt / (double)yt.size();
+
+		int temp = xtSize*ytSize;
+		xMeshVector = vector<double>(temp);
+		yMeshVector = vector<double>(temp);
+		xMeshGrid = dgrid(ytSize, xtSize);
+		yMeshGrid = dgrid(ytSize, xtSize);
+
+		//C. Reform the data to a grid that we can use for calculations
+		int clx = 0;
+		int cly = 0;
+		currentLoc = 0;
+		for (int i = 0; i < ytSize; i++)
+		{
+			currentLoc = i;
+			for (int j = 0; j < xtSize; j++)
+			{
+				xMeshGrid(i,j) = xt[clx] - meanXt;
+				yMeshGrid(i,j) = yt[cly] - meanYt;
+				xMeshVector[currentLoc] = xt[clx];
+				yMeshVector[currentLoc] = yt[cly];
+				currentLoc = currentLoc + ytSize;
+				clx += 1;
+			}
+			clx = 0;
+			cly += 1;
+		}
+		#pragma endregion
+	}
+	else
+	{
+		#pragma region --Dont compute grid, Use pre-interpolated locs
+		//D. Don't compute a grid, instead use the pre-interpolated locations
+		xMeshVector = vector<double>((*forcedLocationPositions).forcedLonCoord.size());
+		yMeshVector = vector<double>((*forcedLocationPositions).forcedLatCoord.size());
+		
+		//E. Convert the pre-interpolated lon-lat locations to meters in x and y
+		minLat = (*forcedLocationPositions).forcedLatCoord[0];
+		maxLat = (*forcedLocationPositions).forcedLatCoord[0];
+		strcpy(UTMZone,"\0"); // SJZ
+		longitudeMean = (*forcedLocationPositions).longitudeSum/(*forcedLocationPositions).forcedLonCoord.size();
+		latitudeMean = (*forcedLocationPositions).latitudeSum/(*forcedLocationPositions).forcedLatCoord.size(); // SJZ
+		LLtoUTM(refEllipsoid, latitudeMean, longitudeMean, UTMNorthing, UTMEasting, UTMZone); // SJZ
+		strcpy(UTMZoneRef,UTMZone); // SJZ
+
+		if(!USE_UTM) // SJZ 
+			LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef);
+
+		//Project all the locations at once; the offset and rotation are applied in place below.
+		double cosRotation = cos(deg2rad*rotationAngle);
+		double sinRotation = sin(deg2rad*rotationAngle);
+		if(abs(usagePreInterpLocsLatLon) == 1 && (*forcedLocationPositions).forcedLonCoord.size() > 0)
+			LLtoUTM(refEllipsoid, &(*forcedLocationPositions).forcedLatCoord[0], &(*forcedLocationPositions).forcedLonCoord[0], &yMeshVector[0], &xMeshVector[0], (int)(*forcedLocationPositions).forcedLonCoord.size(), UTMZone, additionalOptions.find("-multiThread")->second);
+		
+		for(int i = 0; i < (const int)(*forcedLocationPositions).forcedLonCoord.size(); i++)
+		{
+			if ((*forcedLocationPositions).forcedLatCoord[i] > maxLat)
+				maxLat = (*forcedLocationPositions).forcedLatCoord[i];
+
+			if ((*forcedLocationPositions).forcedLatCoord[i] < minLat)
+				minLat = (*forcedLocationPositions).forcedLatCoord[i];
+			if(abs(usagePreInterpLocsLatLon) == 1)
+			{
+				if(!USE_UTM)// SJZ 
+				{
+					UTMEasting = xMeshVector[i] - UTMEastingRef;
+					UTMNorthing = yMeshVector[i] - UTMNorthingRef;
+
+					//i. Factor in the rotation angle to the UTM coordinates
+					xMeshVector[i] = (UTMEasting)*cosRotation - (UTMNorthing)*sinRotation;
+					yMeshVector[i] = (UTMEasting)*sinRotation + (UTMNorthing)*cosRotation;
+				}
+			}
+			else
+			{
+				xMeshVector[i] = (*forcedLocationPositions).forcedLonCoord[i];
+				yMeshVector[i] = (*forcedLocationPositions).forcedLatCoord[i];
+			}
+			strcpy((*forcedLocationPositions).utmzone, UTMZone);
+			if(!USE_UTM)// SJZ 
+				strcpy((*forcedLocationPositions).utmzone, "999");
+
+
+			//Commented out 11/11/14 SJZ 
+			//F. If we have the special case where we have positive and negative latitudes (i.e. we cross the equator or have a weird data set)
+			/*if ((minLat < 0) && (maxLat > 0)){
+				if(refLat >= 0){
+					for(int i = 0; i < (const int)(*forcedLocationPositions).forcedLatCoord.size(); i++){
+						if ((*forcedLocationPositions).forcedLatCoord[i] < 0){
+							yMeshVector[i] = yMeshVector[i] - 10000000.00;
+						}
+					}
+				}else{
+					for(int i = 0; i < (const int)(*forcedLocationPositions).forcedLatCoord.size(); i++){
+						if ((*forcedLocationPositions).forcedLatCoord[i] >= 0){
+							yMeshVector[i] = yMeshVector[i] + 10000000.00;
+						}
+					}
+				}
+			}	*/	
+		}
+		
+		//G. Get the mean data points for later use
+		meanXt = 0.00;
+		meanYt = 0.00;
+		for (int i = 0; i < (const int)xMeshVector.size(); i++)
+		{
+			meanXt = meanXt + xMeshVector[i];
+			meanYt = meanYt + yMeshVector[i];
+		}
+		meanXt = meanXt / (double)xMeshVector.size();
+		meanYt = meanYt / (double)yMeshVector.size();
+		#pragma endregion
+	}
+	return SUCCESS;
+}
+
 //************************************************************************************
 // SUBROUTINE I: Primary MergeBathy function call for
 // preprocessing and grid alignment
@@ -50,8 +236,6 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 	double maxLat, minLat;
 	double UTMNorthingRef = 0, UTMEastingRef = 0, UTMNorthingRefAll = 0, UTMEastingRefAll = 0, UTMNorthing = 0, UTMEasting = 0;
 	double x0, x1, y0, y1, lat0, lat1, lon0, lon1;
-	int xtSize, ytSize;
-	double locationValue;
 	char UTMZone[4]="";//{'\0'};
 	char UTMZoneRef[4]="";
 	char UTMZoneRefAll[4]="";
@@ -172,7 +356,7 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 		// and UTMEastingRef and UTMNorthingRef but it did not match
 		// matlab.
 		//Therefore, it was kept for UTM2LL conversion as UTMZoneRefAll.
-		LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRefAll, UTMEastingRefAll, UTMZoneRefAll, refLon);
+		LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRefAll, UTMEastingRefAll, UTMZoneRefAll);
 
 		//ii. Get individual dataset's longitude mean and reference Lat and Lon
 		//Matlab code calculates UTMZoneRef and UTMZone based on
@@ -180,11 +364,11 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 		//instead of the refLon, and longitudeMean of all datasets.
 		longitudeMean = (*inputData)[0].longitudeSum/(*inputData)[0].lon.size();
 		//Find UTMZoneRef for each dataset using its own longitudeMean.
-		LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef, longitudeMean);
+		LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef);
 
 		//iii. Find UTMZone for first dataset from first point.
 		//Convert the fist point to UTM. Get the UTM for the first data point in the dataset using the dataset's mean longitude.
-		LLtoUTM(refEllipsoid, (*inputData)[0].lat[0], (*inputData)[0].lon[0], UTMNorthing, UTMEasting, UTMZone, longitudeMean);
+		LLtoUTM(refEllipsoid, (*inputData)[0].lat[0], (*inputData)[0].lon[0], UTMNorthing, UTMEasting, UTMZone);
 		UTMEasting -= UTMEastingRef;
 		UTMNorthing -= UTMNorthingRef;
 
@@ -200,6 +384,9 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 		maxLat = lat0;
 		minLat = lat0;
 		int INIT_TEMPS = 1;
+		int numThreads = additionalOptions.find("-multiThread")->second;
+		double cosRotation = cos(deg2rad*rotationAngle);
+		double sinRotation = sin(deg2rad*rotationAngle);
 	
 		//C. Compute each pair of UTM coordinates based
 		//on the location of the reference coordinate 
@@ -213,7 +400,7 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 			strcpy(UTMZone,"\0"); // SJZ
 			latitudeMean = (*inputData)[count].latitudeSum/(*inputData)[count].lat.size(); // SJZ
 			//Find the utmzone from the the dataset's mean latitude and mean longitude.
-			LLtoUTM(refEllipsoid, latitudeMean, longitudeMean, UTMNorthing, UTMEasting, UTMZone, longitudeMean); // SJZ
+			LLtoUTM(refEllipsoid, latitudeMean, longitudeMean, UTMNorthing, UTMEasting, UTMZone); // SJZ
 			strcpy((*inputData)[count].utmzone, UTMZone); //utmzone for the majority of the dataset. // SJZ
 
 			if(UTMZone==NULL)
@@ -225,9 +412,13 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 			{
 				//strcpy(UTMZoneRef,UTMZone); // SJZ
 				//Calculate dataset's UTMNorthingRef and UTMEastingRef 
-				LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef, longitudeMean);
+				LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef);
 			}
 
+			//Project the whole dataset into its zone at once; the offset and rotation are applied in place below.
+			if((*inputData)[count].lon.size() > 0)
+				LLtoUTM(refEllipsoid, &(*inputData)[count].lat[0], &(*inputData)[count].lon[0], &y[currentLoc], &x[currentLoc], (int)(*inputData)[count].lon.size(), UTMZone, numThreads);
+
 			for(int i = 0; i < (const int)(*inputData)[count].lon.size(); i++)
 			{
 				//Find max and min latitude (isn't this the same as lat1 and lat0? SJZ)
@@ -236,20 +427,14 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 				else if ((*inputData)[count].lat[i] < minLat)
 					minLat = (*inputData)[count].lat[i];
 				
-				LLtoUTM(refEllipsoid, (*inputData)[count].lat[i], (*inputData)[count].lon[i], UTMNorthing, UTMEasting, UTMZone, longitudeMean);
 				if(!USE_UTM) // SJZ
 				{
-					UTMEasting -= UTMEastingRef;
-					UTMNorthing -= UTMNorthingRef;
+					UTMEasting = x[currentLoc] - UTMEastingRef;
+					UTMNorthing = y[currentLoc] - UTMNorthingRef;
 
 					//i. Factor in the rotation angle to the UTM coordinates
-					x[currentLoc] = (UTMEasting)*cos(deg2rad*rotationAngle) - (UTMNorthing)*sin(deg2rad*rotationAngle);
-					y[currentLoc] = (UTMEasting)*sin(deg2rad*rotationAngle) + (UTMNorthing)*cos(deg2rad*rotationAngle);
-				}
-				else
-				{// SJZ
-					x[currentLoc] = (UTMEasting);
-					y[currentLoc] = (UTMNorthing);
+					x[currentLoc] = (UTMEasting)*cosRotation - (UTMNorthing)*sinRotation;
+					y[currentLoc] = (UTMEasting)*sinRotation + (UTMNorthing)*cosRotation;
 				}
 				//ii. Determine minimum and maximum extents of the grid for calculation later
 				//if(INIT_TEMPS)
@@ -402,7 +587,7 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 		}
 
 		if(!USE_UTM)//F. Do this for safety that way we don't end up using the Reference zone info when it has no data.
-			LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef, refLon);
+			LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef);
 		#pragma endregion
 	}
 
@@ -418,7 +603,7 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 	{
 		
 		//strcpy(UTMZoneRefAll,'\0'); // SJZ
-		//LLtoUTM(refEllipsoid, latitudeMeanAll, longitudeMeanAll, UTMNorthingRefAll, UTMEastingRefAll, UTMZoneRefAll, longitudeMeanAll);
+		//LLtoUTM(refEllipsoid, latitudeMeanAll, longitudeMeanAll, UTMNorthingRefAll, UTMEastingRefAll, UTMZoneRefAll);
 
 		// Set scene center lat/lon for use with UTM gridding
 		// Not necessary if local coordinate system specified)
@@ -498,11 +683,10 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 					cout << "reprojecting UTM coordinates into majority zone." << endl;
 					strcpy((*inputData)[count].utmzone, zoneTemp);
 
+					if((*inputData)[count].lon.size() > 0)
+						LLtoUTM(refEllipsoid, &(*inputData)[count].lat[0], &(*inputData)[count].lon[0], &y[currentLoc], &x[currentLoc], (int)(*inputData)[count].lon.size(), zoneTemp, additionalOptions.find("-multiThread")->second);
 					for(int i = 0; i < (const int)(*inputData)[count].lon.size(); i++)
 					{			
-						LLtoUTM(refEllipsoid, (*inputData)[count].lat[i], (*inputData)[count].lon[i], UTMNorthing, UTMEasting, zoneTemp, longitudeMean);
-						x[currentLoc] = (UTMEasting);
-						y[currentLoc] = (UTMNorthing);
 						(*inputData)[count].x[i] = x[currentLoc];
 						(*inputData)[count].y[i] = y[currentLoc];
 						
@@ -573,176 +757,287 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 	//************************************************************************************
 	// II. If we are computing our own locations based on a smoothing scale then do those calculations here
 	//************************************************************************************
-	if (additionalOptions.find("-preInterpolatedLocations")->second == 0)//calcgrid
+	returnValue = computeGridLocations(x0, y0, x1, y1, refLat, refLon, rotationAngle, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, additionalOptions, forcedLocationPositions, usagePreInterpLocsLatLon, USE_UTM, xt, yt, xMeshVector, yMeshVector, xMeshGrid, yMeshGrid, meanXt, meanYt);
+	if (returnValue != SUCCESS)
+		return returnValue;
+
+	//************************************************************************************
+	// III. Compute Offset
+	//************************************************************************************
+	if (additionalOptions.find("-computeOffset")->second == 1)
 	{
-		#pragma region --No preInterpolatedLocations provided
-		//Compute grid locations based on smoothing scale; No preInterpolatedLocations provided
-		if (gridSpacingX == 0 && gridSpacingX == 0)
-        {
-			gridSpacingX = 100;
-			gridSpacingY = 100;
-		}
-		if(smoothingScaleX == 0 && smoothingScaleY == 0)
-		{
-			smoothingScaleX = 100;
-			smoothingScaleY = 100;
-		}
-		else if (smoothingScaleX < gridSpacingX || smoothingScaleY < gridSpacingY)
-		{
-			cout << "Grid spacing defaults to 100 making smoothing scales too small.  Make smoothing scales greater than the grid spacing." << endl;
-			return ARGS_ERROR;
-		}
+		cout << "\nComputing Offset between Data Sets" << endl;
+		computeOffset(inputData, x0, y0, x1, y1, &xMeshVector, &yMeshVector, smoothingScaleX*2.00, smoothingScaleY*2.00, &z, &e, &hErr, &vErr, kernelName, additionalOptions);
+		cout << "Done Computing Offset between Data Sets" << endl << endl;
+	}
+	//Done computing offset
 
-		meanXt = 0.00;
-		meanYt = 0.00;
+	newX0 = x0;
+	newY0 = y0;
+	newX1 = x1;
+	newY1 = y1;
+	cout << "Dimensions of Computational Area: " << endl;
+	cout << "\tRows: " << xMeshGrid.rows() << "\n\tCols: " << xMeshGrid.cols() << endl << endl;
 
-		//A. Calculate X
-		locationValue = x0 - gridSpacingX;
-		xtSize = 0;
-		while (locationValue <= (const double)(x1 + gridSpacingX)) {
-			xt.push_back(locationValue);
-			meanXt += locationValue;
-			locationValue += gridSpacingX;
-			xtSize += 1;
-		}
-		//Get the mean for later use
-		meanXt = meanXt / (double)xt.size();
+	// Perform the actual gridding of the data. Do a small amount
+	// of truncation (to mm precision) to allow for imprecise grids
+	double dRoundoff = 1e-3;
+	for(int i = 0; i < (const int)xMeshVector.size(); i++)
+	{
+		xMeshVector[i] = roundDouble(xMeshVector[i]/dRoundoff)*dRoundoff;
+		yMeshVector[i] = roundDouble(yMeshVector[i]/dRoundoff)*dRoundoff;
+	}
 
-		//B. Calculate Y
-		locationValue = y0 - gridSpacingY;
-		ytSize = 0;
-		while (locationValue <= (const double)(y1 + gridSpacingY)) {
-			yt.push_back(locationValue);
-			meanYt += locationValue;
-			locationValue += gridSpacingY;
-			ytSize += 1;
-		}
-		//Get the mean for later use
-		meanYt = meanYt / (double)yt.size();
+	Bathy_Grid* bathyGrid = new Bathy_Grid();
+	#pragma region -- Gridding
+	if(additionalOptions.find("-ZGrid")->second == 1 || additionalOptions.find("-GMTSurface")->second == 1)
+	{
+		bathyGrid->GriddingFlag = 1;
+		bathyGrid->Construct_Tin(&x, &y, &z, &hErr, &vErr);
+	} else bathyGrid->GriddingFlag = 0;
+	#pragma endregion
 
-		int temp = xtSize*ytSize;
-		xMeshVector = vector<double>(temp);
-		yMeshVector = vector<double>(temp);
-		xMeshGrid = dgrid(ytSize, xtSize);
-		yMeshGrid = dgrid(ytSize, xtSize);
+	//************************************************************************************
+	// IV. Call actual processing routines
+	//************************************************************************************
+	returnValue = run(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRefAll, UTMEastingRefAll, rotationAngle, refEllipsoid, UTMZoneRefAll, numMCRuns, MB_ZGridInput, GMTSurfaceInput, ALGSplineInput, bathyGrid, USE_UTM);
 
-		//C. Reform the data to a grid that we can use for calculations
-		int clx = 0;
-		int cly = 0;
-		currentLoc = 0;
-		for (int i = 0; i < ytSize; i++)
+	//if (numMCRuns == -1)
+	//{
+	//	//A. Call single run
+	//	returnValue = runSingle(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRefAll, UTMEastingRefAll, rotationAngle, refEllipsoid, UTMZoneRefAll, MB_ZGridInput, GMTSurfaceInput, ALGSplineInput, bathyGrid, USE_UTM);
+	//}else
+	//{
+	//	//B. Call Monte Carlo run
+	//	//returnValue = runMonteCarlo(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRef, UTMEastingRef, rotationAngle, refEllipsoid, UTMZoneRef, numMCRuns, MB_ZGridInput, GMTSurfaceInput);
+	//	returnValue = runMonteCarlo(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRef, UTMEastingRef, rotationAngle, refEllipsoid, UTMZoneRef, numMCRuns, MB_ZGridInput, GMTSurfaceInput, ALGSplineInput, bathyGrid);
+	//}
+
+	//************************************************************************************
+	// V. Clear up variables
+	//************************************************************************************
+	if(bathyGrid->GriddingFlag)
+		delete bathyGrid;
+	xMeshVector.clear();
+	yMeshVector.clear();
+	xt.clear();
+	yt.clear();
+	xMeshGrid.clear();
+	yMeshGrid.clear();
+	x.clear();
+	y.clear();
+	z.clear();
+	e.clear();
+	hErr.clear();
+	vErr.clear();
+	xyzOut.depth.clear();
+	xyzOut.error.clear();
+	xyzOut.nEi.clear();
+	xyzOut.rEi.clear();
+	//if (numMCRuns == -1)
+	{
+		xyzOut.depth0.clear();
+		xyzOut.depthK.clear();
+		xyzOut.errorK.clear();
+		xyzOut.standardDev.clear();
+	//	xyzOut.standardDev0.clear();
+	}
+	return returnValue;
+}
+
+//************************************************************************************
+// SUBROUTINE I.A: mergeBathy_PreCompute for input files read a block at a time.
+// The soundings are never all in memory; see streamingSubsample.h.
+//************************************************************************************
+int mergeBathy_PreComputeStreaming(string &inputFileList, BOUNDING_BOX bbox, double refLon, double refLat, double rotationAngle, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY, string kernelName, string outputFileName, map<string, int> additionalOptions, int numMCRuns, MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, FORCED_LOCATIONS *forcedLocationPositions, int usagePreInterpLocsLatLon)
+{
+	//************************************************************************************
+	// 0. Declare local variables and objects
+	//************************************************************************************
+	int returnValue = 0;
+	int refEllipsoid = 23;
+	int USE_UTM = 0;
+	int wrap = 0;
+
+	double longitudeMean = 0.00, latitudeMean = 0.00;
+	double UTMNorthingRef = 0, UTMEastingRef = 0, UTMNorthingRefAll = 0, UTMEastingRefAll = 0, UTMNorthing = 0, UTMEasting = 0;
+	double x0, x1, y0, y1, xMax, yMax, lonMin, lonMax;
+	char UTMZone[4]="";
+	char UTMZoneRef[4]="";
+	char UTMZoneRefAll[4]="";
+
+	//A. The soundings are only in the stream, so run gets empty data and the subsampled cells
+	vector<double> x, y, z, e, hErr, vErr;
+	vector< vector<double> > subsampledData = vector< vector<double> >(7);
+	vector<STREAM_FILE_SUMMARY> summaries;
+	vector<STREAM_PROJECTION> projections;
+	soundingStream stream(inputFileList, bbox, additionalOptions.find("-noerr")->second, additionalOptions.find("-nonegdepth")->second, additionalOptions.find("-useUnscaledAvgInputs")->second, additionalOptions.find("-multiThread")->second, additionalOptions.find("-indexInputs")->second);
+
+	//B. Variables for computed locations
+	double meanXt = 0.00;
+	double meanYt = 0.00;
+	vector<double> xt;
+	vector<double> yt;
+	vector<double> xMeshVector;
+	vector<double> yMeshVector;
+	dgrid xMeshGrid;
+	dgrid yMeshGrid;
+
+	double newX0;
+	double newY0;
+	double newX1;
+	double newY1;
+	double subX0;
+	double subY0;
+
+	//C. Wrap the rotation angle if greater than 360
+	rotationAngle = fmod(rotationAngle, 360);
+	if(rotationAngle < 0) rotationAngle += 360;
+
+	// Determine whether or not to use UTM grid zones
+	if(((refLat == 0) & (refLon == 0)) & (rotationAngle == 0))
+		USE_UTM = 1;
+
+	//D. First pass: the count, coordinate sums and longitude extents of each file
+	returnValue = stream.open();
+	if (returnValue != SUCCESS)
+		return returnValue;
+	returnValue = stream.summarize(&summaries);
+	if (returnValue != SUCCESS)
+		return returnValue;
+	projections = vector<STREAM_PROJECTION>(stream.size());
+	memset(&projections[0], 0, projections.size()*sizeof(STREAM_PROJECTION));
+
+	//************************************************************************************
+	// I. Decide how each file is projected, as mergeBathy_PreCompute converts Lat/Lon to UTM
+	//************************************************************************************
+	if (additionalOptions.find("-inputInMeters")->second == 0)
+	{
+		//A. Wrap negative longitudes when the data cross 180
+		lonMin = HUGE_VAL;
+		lonMax = -HUGE_VAL;
+		for(int count = 0; count < stream.size(); count++)
 		{
-			currentLoc = i;
-			for (int j = 0; j < xtSize; j++)
+			lonMin = min(lonMin, summaries[count].lonMin);
+			lonMax = max(lonMax, summaries[count].lonMax);
+		}
+		if(((((lonMin<0) & (lonMax>0)) & (0-lonMin > 180+lonMin)) || (additionalOptions.find("-preInterpolatedLocations")->second == 1 
+			&& (*max_element(forcedLocationPositions->forcedLonCoord.begin(), forcedLocationPositions->forcedLonCoord.end()) >=180 
+			&& *min_element(forcedLocationPositions->forcedLonCoord.begin(),forcedLocationPositions->forcedLonCoord.end()) >= 0))) && abs(usagePreInterpLocsLatLon) != 2)
+		{
+			wrap = 1;
+			for(int count = 0; count < stream.size(); count++)
+				summaries[count].longitudeSum = summaries[count].wrappedLongitudeSum;
+			if(refLon < 0)
+				refLon += 360;
+			if(additionalOptions.find("-preInterpolatedLocations")->second == 1)
 			{
-				xMeshGrid(i,j) = xt[clx] - meanXt;
-				yMeshGrid(i,j) = yt[cly] - meanYt;
-				xMeshVector[currentLoc] = xt[clx];
-				yMeshVector[currentLoc] = yt[cly];
-				currentLoc = currentLoc + ytSize;
-				clx += 1;
+				forcedLocationPositions->longitudeSum = 0;
+				for(int i = 0; i < (const int)forcedLocationPositions->forcedLonCoord.size(); i++)
+				{
+					if(forcedLocationPositions->forcedLonCoord[i] < 0)
+						forcedLocationPositions->forcedLonCoord[i] += 360;
+					forcedLocationPositions->longitudeSum += forcedLocationPositions->forcedLonCoord[i];
+				}
 			}
-			clx = 0;
-			cly += 1;
 		}
-		#pragma endregion
-	}
-	else
-	{
-		#pragma region --Dont compute grid, Use pre-interpolated locs
-		//D. Don't compute a grid, instead use the pre-interpolated locations
-		xMeshVector = vector<double>((*forcedLocationPositions).forcedLonCoord.size());
-		yMeshVector = vector<double>((*forcedLocationPositions).forcedLatCoord.size());
-		
-		//E. Convert the pre-interpolated lon-lat locations to meters in x and y
-		minLat = (*forcedLocationPositions).forcedLatCoord[0];
-		maxLat = (*forcedLocationPositions).forcedLatCoord[0];
-		strcpy(UTMZone,"\0"); // SJZ
-		longitudeMean = (*forcedLocationPositions).longitudeSum/(*forcedLocationPositions).forcedLonCoord.size();
-		latitudeMean = (*forcedLocationPositions).latitudeSum/(*forcedLocationPositions).forcedLatCoord.size(); // SJZ
-		LLtoUTM(refEllipsoid, latitudeMean, longitudeMean, UTMNorthing, UTMEasting, UTMZone, longitudeMean); // SJZ
-		strcpy(UTMZoneRef,UTMZone); // SJZ
 
-		if(!USE_UTM) // SJZ 
-			LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef, longitudeMean);
-		
-		for(int i = 0; i < (const int)(*forcedLocationPositions).forcedLonCoord.size(); i++)
+		//B. Reference for UTM2LL conversion of the results
+		LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRefAll, UTMEastingRefAll, UTMZoneRefAll);
+
+		//C. Each file in the zone of its mean latitude and mean longitude, about its own reference when rotated
+		for(int count = 0; count < stream.size(); count++)
 		{
-			if ((*forcedLocationPositions).forcedLatCoord[i] > maxLat)
-				maxLat = (*forcedLocationPositions).forcedLatCoord[i];
+			longitudeMean = summaries[count].longitudeSum/summaries[count].numRecords;
+			latitudeMean = summaries[count].latitudeSum/summaries[count].numRecords;
+			strcpy(UTMZone,"\0");
+			LLtoUTM(refEllipsoid, latitudeMean, longitudeMean, UTMNorthing, UTMEasting, UTMZone);
+			strcpy(UTMZoneRef,UTMZone);
+			if(!USE_UTM)
+				LLtoUTM(refEllipsoid, refLat, refLon, UTMNorthingRef, UTMEastingRef, UTMZoneRef);
+
+			projections[count].toUTM = 1;
+			projections[count].wrap = wrap;
+			strcpy(projections[count].zone, UTMZone);
+			projections[count].longitudeMean = longitudeMean;
+			projections[count].refEllipsoid = refEllipsoid;
+			projections[count].rotate = !USE_UTM;
+			projections[count].UTMNorthingRef = UTMNorthingRef;
+			projections[count].UTMEastingRef = UTMEastingRef;
+			projections[count].rotationAngle = rotationAngle;
+		}
+		cout << "Input Data UTM Zone: " << UTMZoneRef << endl;
 
-			if ((*forcedLocationPositions).forcedLatCoord[i] < minLat)
-				minLat = (*forcedLocationPositions).forcedLatCoord[i];
-			if(abs(usagePreInterpLocsLatLon) == 1)
+		//D. Make sure all datasets are referenced to the same UTM zone by re-projecting each "errant" dataset into the "majority" zone
+		if(USE_UTM)
+		{
+			strcpy(UTMZoneRefAll, projections[0].zone);
+			int REPROJECT = 0;
+			for(int count = 0; count < stream.size(); count++)
 			{
-				LLtoUTM(refEllipsoid, (*forcedLocationPositions).forcedLatCoord[i], (*forcedLocationPositions).forcedLonCoord[i], UTMNorthing, UTMEasting, UTMZone, longitudeMean);
-				if(!USE_UTM)// SJZ 
-				{
-					UTMEasting -= UTMEastingRef;
-					UTMNorthing -= UTMNorthingRef;
-
-					//i. Factor in the rotation angle to the UTM coordinates
-					xMeshVector[i] = (UTMEasting)*cos(deg2rad*rotationAngle) - (UTMNorthing)*sin(deg2rad*rotationAngle);
-					yMeshVector[i] = (UTMEasting)*sin(deg2rad*rotationAngle) + (UTMNorthing)*cos(deg2rad*rotationAngle);
-				}
-				else
-				{// SJZ 
-					xMeshVector[i] = (UTMEasting);
-					yMeshVector[i] = (UTMNorthing);
-				}
+				if(strcmp(projections[0].zone, projections[count].zone)!=0)
+					REPROJECT = 1;
 			}
-			else
+			if(REPROJECT)
 			{
-				xMeshVector[i] = (*forcedLocationPositions).forcedLonCoord[i];
-				yMeshVector[i] = (*forcedLocationPositions).forcedLatCoord[i];
-			}
-			strcpy((*forcedLocationPositions).utmzone, UTMZone);
-			if(!USE_UTM)// SJZ 
-				strcpy((*forcedLocationPositions).utmzone, "999");
-
-
-			//Commented out 11/11/14 SJZ 
-			//F. If we have the special case where we have positive and negative latitudes (i.e. we cross the equator or have a weird data set)
-			/*if ((minLat < 0) && (maxLat > 0)){
-				if(refLat >= 0){
-					for(int i = 0; i < (const int)(*forcedLocationPositions).forcedLatCoord.size(); i++){
-						if ((*forcedLocationPositions).forcedLatCoord[i] < 0){
-							yMeshVector[i] = yMeshVector[i] - 10000000.00;
-						}
+				cout << "UTM zone not consistent between datasets.  Please re-run mergeBathy with a non-zero reference position/rotation angle." << endl;
+
+				string zonestr;
+				size_t found;
+				int cnt, cntMax=0, idMax=0;
+				for(int count = 0; count < stream.size(); count++)
+					zonestr.append(projections[count].zone);
+				for(int count = 0; count < stream.size(); count++)
+				{
+					cnt = 0;
+					found = zonestr.find(projections[count].zone);
+					while(found != std::string::npos)
+					{
+						cnt++;
+						found = zonestr.find(projections[count].zone,found+1);
 					}
-				}else{
-					for(int i = 0; i < (const int)(*forcedLocationPositions).forcedLatCoord.size(); i++){
-						if ((*forcedLocationPositions).forcedLatCoord[i] >= 0){
-							yMeshVector[i] = yMeshVector[i] + 10000000.00;
-						}
+					if(cnt > cntMax)
+					{
+						cntMax = cnt;
+						idMax = count;
+					}
+				}
+				strcpy(UTMZoneRefAll, projections[idMax].zone);
+				longitudeMean = summaries[idMax].longitudeSum/summaries[idMax].numRecords;
+				for(int count = 0; count < stream.size(); count++)
+				{
+					if (strcmp(UTMZoneRefAll, projections[count].zone)!=0)
+					{
+						cout << "reprojecting UTM coordinates into majority zone." << endl;
+						strcpy(projections[count].zone, UTMZoneRefAll);
+						projections[count].longitudeMean = longitudeMean;
 					}
 				}
-			}	*/	
-		}
-		
-		//G. Get the mean data points for later use
-		meanXt = 0.00;
-		meanYt = 0.00;
-		for (int i = 0; i < (const int)xMeshVector.size(); i++)
-		{
-			meanXt = meanXt + xMeshVector[i];
-			meanYt = meanYt + yMeshVector[i];
+			}
 		}
-		meanXt = meanXt / (double)xMeshVector.size();
-		meanYt = meanYt / (double)yMeshVector.size();
-		#pragma endregion
 	}
+	else
+	{
+		//E. We aren't using Lat/Lon positions, instead we read in X and Y positions that were already in UTM
+		for(int count = 0; count < stream.size(); count++)
+			projections[count].toUTM = 0;
+	}
+
+	//F. Second pass: extents of the projected soundings
+	returnValue = stream.extents(projections, &x0, &xMax, &y0, &yMax);
+	if (returnValue != SUCCESS)
+		return returnValue;
+	x0 = floor(x0);
+	x1 = ceil(xMax);
+	y0 = floor(y0);
+	y1 = ceil(yMax);
 
 	//************************************************************************************
-	// III. Compute Offset
+	// II. If we are computing our own locations based on a smoothing scale then do those calculations here
 	//************************************************************************************
-	if (additionalOptions.find("-computeOffset")->second == 1)
-	{
-		cout << "\nComputing Offset between Data Sets" << endl;
-		computeOffset(inputData, x0, y0, x1, y1, &xMeshVector, &yMeshVector, smoothingScaleX*2.00, smoothingScaleY*2.00, &z, &e, &hErr, &vErr, kernelName, additionalOptions);
-		cout << "Done Computing Offset between Data Sets" << endl << endl;
-	}
-	//Done computing offset
+	returnValue = computeGridLocations(x0, y0, x1, y1, refLat, refLon, rotationAngle, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, additionalOptions, forcedLocationPositions, usagePreInterpLocsLatLon, USE_UTM, xt, yt, xMeshVector, yMeshVector, xMeshGrid, yMeshGrid, meanXt, meanYt);
+	if (returnValue != SUCCESS)
+		return returnValue;
 
 	newX0 = x0;
 	newY0 = y0;
@@ -751,8 +1046,7 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 	cout << "Dimensions of Computational Area: " << endl;
 	cout << "\tRows: " << xMeshGrid.rows() << "\n\tCols: " << xMeshGrid.cols() << endl << endl;
 
-	// Perform the actual gridding of the data. Do a small amount
-	// of truncation (to mm precision) to allow for imprecise grids
+	// Do a small amount of truncation (to mm precision) to allow for imprecise grids
 	double dRoundoff = 1e-3;
 	for(int i = 0; i < (const int)xMeshVector.size(); i++)
 	{
@@ -760,61 +1054,75 @@ int mergeBathy_PreCompute(vector<TRUE_DATA> *inputData, double refLon, double re
 		yMeshVector[i] = roundDouble(yMeshVector[i]/dRoundoff)*dRoundoff;
 	}
 
-	Bathy_Grid* bathyGrid = new Bathy_Grid();
-	#pragma region -- Gridding
-	if(additionalOptions.find("-ZGrid")->second == 1 || additionalOptions.find("-GMTSurface")->second == 1)
-	{
-		bathyGrid->GriddingFlag = 1;
-		bathyGrid->Construct_Tin(&x, &y, &z, &hErr, &vErr);
-	} else bathyGrid->GriddingFlag = 0;
-	#pragma endregion
-
 	//************************************************************************************
-	// IV. Call actual processing routines
+	// III. Last passes: subsample at the spacing bathyTool subsamples at
 	//************************************************************************************
-	returnValue = run(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRefAll, UTMEastingRefAll, rotationAngle, refEllipsoid, UTMZoneRefAll, numMCRuns, MB_ZGridInput, GMTSurfaceInput, ALGSplineInput, bathyGrid, USE_UTM);
+	subX0 = newX0;
+	subY0 = newY0;
+	returnValue = stream.subsample(projections, smoothingScaleX/Dscale, smoothingScaleY/Dscale, subX0, subY0, xMax, &subsampledData);
+	if (returnValue != SUCCESS)
+		return returnValue;
 
-	//if (numMCRuns == -1)
-	//{
-	//	//A. Call single run
-	//	returnValue = runSingle(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRefAll, UTMEastingRefAll, rotationAngle, refEllipsoid, UTMZoneRefAll, MB_ZGridInput, GMTSurfaceInput, ALGSplineInput, bathyGrid, USE_UTM);
-	//}else
-	//{
-	//	//B. Call Monte Carlo run
-	//	//returnValue = runMonteCarlo(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRef, UTMEastingRef, rotationAngle, refEllipsoid, UTMZoneRef, numMCRuns, MB_ZGridInput, GMTSurfaceInput);
-	//	returnValue = runMonteCarlo(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRef, UTMEastingRef, rotationAngle, refEllipsoid, UTMZoneRef, numMCRuns, MB_ZGridInput, GMTSurfaceInput, ALGSplineInput, bathyGrid);
-	//}
+	//************************************************************************************
+	// IV. Call actual processing routines.  The pre-spliners need the soundings, so there is no gridding.
+	//************************************************************************************
+	Bathy_Grid* bathyGrid = new Bathy_Grid();
+	bathyGrid->GriddingFlag = 0;
+	returnValue = run(&x, &y, &z, &e, &hErr, &vErr, &xMeshGrid, &yMeshGrid, &xt, &yt, &xMeshVector, &yMeshVector, gridSpacingX, gridSpacingY, smoothingScaleX, smoothingScaleY, newX0, newY0, newX1, newY1, meanXt, meanYt, kernelName,  additionalOptions, outputFileName, 1.00, UTMNorthingRefAll, UTMEastingRefAll, rotationAngle, refEllipsoid, UTMZoneRefAll, numMCRuns, MB_ZGridInput, GMTSurfaceInput, ALGSplineInput, bathyGrid, USE_UTM, &subsampledData);
 
 	//************************************************************************************
 	// V. Clear up variables
 	//************************************************************************************
-	if(bathyGrid->GriddingFlag)
-		delete bathyGrid;
-	xMeshVector.clear();
-	yMeshVector.clear();
-	xt.clear();
-	yt.clear();
-	xMeshGrid.clear();
-	yMeshGrid.clear();
-	x.clear();
-	y.clear();
-	z.clear();
-	e.clear();
-	hErr.clear();
-	vErr.clear();
-	xyzOut.depth.clear();
-	xyzOut.error.clear();
-	xyzOut.nEi.clear();
-	xyzOut.rEi.clear();
-	//if (numMCRuns == -1)
+	delete bathyGrid;
+	return returnValue;
+}
+
+//************************************************************************************
+// SUBROUTINE I.B: Interpolated locations back to Lon/Lat for output by runSingle and run.
+//************************************************************************************
+/**
+* Converts the computational X and Y of the interpolated locations to Lon and Lat.  The rotation
+* and reference offset are removed and the whole set is converted in one UTMtoLL batch.
+* @param xLocations - X of the locations; Longitudes on return. (Returned).
+* @param yLocations - Y of the locations; Latitudes on return. (Returned).
+* @param UTMEastings - UTM Eastings of the locations. (Returned).
+* @param UTMNorthings - UTM Northings of the locations. (Returned).
+* @param UTMNorthingRef - The reference UTM Northing.
+* @param UTMEastingRef - The reference UTM Easting.
+* @param rotAngle - The rotation angle of the computational grid.
+* @param RefEllip - The reference ellipsoid.
+* @param UTMZoneRef - The UTM zone of the locations.
+* @param USE_UTM - Whether X and Y are already UTM Eastings and Northings.
+* @param numThreads - Number of threads for the conversion.
+*/
+static void locationsToLL(vector<double> *xLocations, vector<double> *yLocations, vector<double> *UTMEastings, vector<double> *UTMNorthings, double UTMNorthingRef, double UTMEastingRef, double rotAngle, int RefEllip, char UTMZoneRef[4], int USE_UTM, int numThreads)
+{
+	int n = (const int)(*xLocations).size();
+	double cosAngle = cos(deg2rad*(-rotAngle));
+	double sinAngle = sin(deg2rad*(-rotAngle));
+
+	(*UTMEastings).resize(n);
+	(*UTMNorthings).resize(n);
+	for(int i = 0; i < n; i++)
 	{
-		xyzOut.depth0.clear();
-		xyzOut.depthK.clear();
-		xyzOut.errorK.clear();
-		xyzOut.standardDev.clear();
-	//	xyzOut.standardDev0.clear();
+		if(!USE_UTM) // SJZ
+		{
+			(*UTMEastings)[i] = (*xLocations)[i]*cosAngle - (*yLocations)[i]*sinAngle + UTMEastingRef;
+			(*UTMNorthings)[i] = (*xLocations)[i]*sinAngle + (*yLocations)[i]*cosAngle + UTMNorthingRef;
+		}
+		else
+		{ // SJZ
+			(*UTMEastings)[i] = (*xLocations)[i];
+			(*UTMNorthings)[i] = (*yLocations)[i];
+		}
+	}
+	if(n > 0)
+		UTMtoLL(RefEllip, &(*UTMNorthings)[0], &(*UTMEastings)[0], &(*yLocations)[0], &(*xLocations)[0], n, UTMZoneRef, numThreads);
+	for(int i = 0; i < n; i++)
+	{
+		if((*xLocations)[i] >= 180) // SJZ
+			(*xLocations)[i] -= 360;
 	}
-	return returnValue;
 }
 
 //************************************************************************************
@@ -828,10 +1136,6 @@ int runSingle(vector<double> *inputDataX, vector<double> *inputDataY, vector<dou
 	int returnValue = SUCCESS;
 	OUTPUT_DATA xyzOut;
 
-	double UTMEasting;
-	double UTMNorthing;
-	double newLon;
-	double newLat;
 	bool ensembleFlag = false;
 	#pragma region -- Gridding
 	if(bathyGrid->GriddingFlag)
@@ -924,7 +1228,7 @@ int runSingle(vector<double> *inputDataX, vector<double> *inputDataY, vector<dou
 			cout << "********************************************************" << endl;
 			cout << "\nComputing GMT Surface" << endl;
 			externalInterpolators extInterp(UTMNorthingRef, UTMEastingRef, rotAngle, RefEllip, UTMZoneRef);
-			bool gmtReturn = extInterp.run_Surface(inputDataX, inputDataY, inputDataZ, inputDataE, inputDataHErr, inputDataVErr, additionalOptions, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, (*GMTSurfaceInput).z_OutputFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage, bathyGrid);
+			bool gmtReturn = extInterp.run_Surface(inputDataX, inputDataY, inputDataZ, inputDataE, inputDataHErr, inputDataVErr, additionalOptions, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, (*GMTSurfaceInput).z_OutputFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage, (*GMTSurfaceInput).numThreads, bathyGrid);
 
 			if (!gmtReturn)
 			{
@@ -1255,27 +1559,7 @@ int runSingle(vector<double> *inputDataX, vector<double> *inputDataY, vector<dou
 	//************************************************************************************
 	if ((additionalOptions.find("-inputInMeters")->second == 0) && (additionalOptions.find("-outputRasterFile")->second == 0 && additionalOptions.find("-outputBagFile")->second == 0))
 	{
-		for(int i = 0; i < (const int)xInterpTemp.size(); i++)
-		{
-			if(!USE_UTM) // SJZ
-			{
-				UTMEasting = (xInterpTemp[i])*cos(deg2rad*(-rotAngle)) - (yInterpTemp[i])*sin(deg2rad*(-rotAngle));
-				UTMNorthing = (xInterpTemp[i])*sin(deg2rad*(-rotAngle)) + (yInterpTemp[i])*cos(deg2rad*(-rotAngle));
-
-				UTMNorthing += UTMNorthingRef;
-				UTMEasting += UTMEastingRef;
-			}
-			else
-			{ // SJZ
-				UTMEasting	= xInterpTemp[i];
-				UTMNorthing = yInterpTemp[i];
-			}
-			UTMtoLL(RefEllip, UTMNorthing, UTMEasting, UTMZoneRef, newLat, newLon);
-			if(newLon >= 180) // SJZ
-				newLon -= 360;
-			yInterpTemp[i] = newLat;
-			xInterpTemp[i] = newLon;
-		}
+		locationsToLL(&xInterpTemp, &yInterpTemp, &UTMEastings, &UTMNorthings, UTMNorthingRef, UTMEastingRef, rotAngle, RefEllip, UTMZoneRef, USE_UTM, additionalOptions.find("-multiThread")->second);
 		if (additionalOptions.find("-printMatlabMatch")->second == 1)
 		{
 			if (((rotAngle > 45) & (rotAngle <= 135)) | ((rotAngle > 225) & (rotAngle <= 315)))
@@ -1295,58 +1579,18 @@ int runSingle(vector<double> *inputDataX, vector<double> *inputDataY, vector<dou
 		double minYInterp	= (double)MAX_INT;
 		double maxXInterp	= (double)MIN_INT;
 		double maxYInterp	= (double)MIN_INT;*/
-		int INIT_TEMPS = 1;
 
 		//1. Remove the central point offset from the data for raster format grids
 		//A new raster grid will be created by interpolating from current data to raster grid locations
 		//Convert only points with data to UTM.
 		//for(int i = 0; i < (const int)xInterpVector->size(); i++)
-		for(int i = 0; i < (const int)xInterpTemp.size(); i++)
+		locationsToLL(&xInterpTemp, &yInterpTemp, &UTMEastings, &UTMNorthings, UTMNorthingRef, UTMEastingRef, rotAngle, RefEllip, UTMZoneRef, USE_UTM, additionalOptions.find("-multiThread")->second);
+		for(int i = 0; i < (const int)UTMNorthings.size(); i++)
 		{
-			if(!USE_UTM) // SJZ
-			{ 
-				UTMEasting = (xInterpTemp)[i]*cos(deg2rad*(-rotAngle)) - (yInterpTemp)[i]*sin(deg2rad*(-rotAngle));
-				UTMNorthing = (xInterpTemp)[i]*sin(deg2rad*(-rotAngle)) + (yInterpTemp)[i]*cos(deg2rad*(-rotAngle));
-
-				//UTMEasting = (*xInterpVector)[i]*cos(deg2rad*(-rotAngle)) - (*yInterpVector)[i]*sin(deg2rad*(-rotAngle));
-				//UTMNorthing = (*xInterpVector)[i]*sin(deg2rad*(-rotAngle)) + (*yInterpVector)[i]*cos(deg2rad*(-rotAngle));
-			
-				UTMNorthing += UTMNorthingRef;
-				UTMEasting  += UTMEastingRef;
-			}
-			else
-			{ // SJZ
-				UTMEasting	= xInterpTemp[i];
-				UTMNorthing = yInterpTemp[i];
-			}
-			if(INIT_TEMPS)
-			{
-				minNorthing	= UTMNorthing;
-				minEasting	= UTMEasting;
-				maxNorthing	= UTMNorthing;
-				maxEasting	= UTMEasting;
-			/*	minXInterp	= MAX_INT;
-				minYInterp	= MAX_INT;
-				maxXInterp	= MIN_INT;
-				maxYInterp	= MIN_INT;*/
-				INIT_TEMPS = 0;
-			}
-			UTMNorthings[i] = UTMNorthing;	//y
-			UTMEastings [i] = UTMEasting;	//x
-			//yInterpTemp2[i] = UTMNorthing;
-			//xInterpTemp2[i] = UTMEasting;
-			//(*yInterpVector)[i] = UTMNorthing;
-			//(*xInterpVector)[i] = UTMEasting; 
-			UTMtoLL(RefEllip, UTMNorthing, UTMEasting, UTMZoneRef, newLat, newLon);
-			if(newLon >= 180) // SJZ
-				newLon -= 360;
-			yInterpTemp[i] = newLat;
-			xInterpTemp[i] = newLon;
-
-			minEasting  = min(minEasting, UTMEasting);
-			maxEasting  = max(maxEasting, UTMEasting);
-			minNorthing = min(minNorthing, UTMNorthing);
-			maxNorthing = max(maxNorthing, UTMNorthing);
+			minEasting  = min(minEasting, UTMEastings[i]);
+			maxEasting  = max(maxEasting, UTMEastings[i]);
+			minNorthing = min(minNorthing, UTMNorthings[i]);
+			maxNorthing = max(maxNorthing, UTMNorthings[i]);
 		}
 		
 		int Ni = (const int)UTMNorthings.size();
@@ -1889,7 +2133,7 @@ int runMonteCarlo(vector<double> *inputDataX, vector<double> *inputDataY, vector
 				//B. Now call GMT Surface
 				externalInterpolators extInterp(UTMNorthingRef, UTMEastingRef, rotAngle, RefEllip, UTMZoneRef);
 				//bool mbzReturn = extInterp.run_Surface_ORIGINAL(&xMC, &yMC, &zMC, &eMC, inputDataHErr, inputDataVErr, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, extInterpFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage);
-				bool gmtReturn = extInterp.run_Surface(&xMC, &yMC, &zMC, &eMC, &hMC, &vMC, additionalOptions, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, extInterpFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage, bathyGrid);
+				bool gmtReturn = extInterp.run_Surface(&xMC, &yMC, &zMC, &eMC, &hMC, &vMC, additionalOptions, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, extInterpFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage, (*GMTSurfaceInput).numThreads, bathyGrid);
 
 				if (!gmtReturn)
 				{
@@ -2129,7 +2373,172 @@ int runMonteCarlo(vector<double> *inputDataX, vector<double> *inputDataY, vector
 
 
 
-int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, vector<double> *xSingleVector, vector<double> *ySingleVector, vector<double> *xInterpVector, vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY, double &x0, double &y0, double &x1, double &y1, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, string outputFileName, double subDataMulitplier, double UTMNorthingRef, double UTMEastingRef, double rotAngle, int RefEllip, char UTMZoneRef[4], int numMCRuns, MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, Bathy_Grid* bathyGrid, int USE_UTM)
+//************************************************************************************
+// SUBROUTINE III.A: Monte Carlo realizations for run.  Each realization interpolates its
+// own perturbed copy of the data, so several can be interpolated at once.  The perturbations
+// are drawn and the results are written by run in realization order.
+//************************************************************************************
+/**
+* One Monte Carlo realization.  The inputs are filled by run and the outputs by computeRealization.
+*/
+typedef struct
+{
+	/**
+	* The perturbed input data.
+	*/
+	vector<double> xMC;
+	vector<double> yMC;
+	vector<double> zMC;
+	vector<double> eMC;
+	vector<double> hMC;
+	vector<double> vMC;
+
+	/**
+	* The locations interpolated to.
+	*/
+	vector<double> xMeshVectorMC;
+	vector<double> yMeshVectorMC;
+
+	/**
+	* The interpolated values.
+	*/
+	OUTPUT_DATA xyzOut;
+
+	/**
+	* Return value of bathyTool.
+	*/
+	int returnValue;
+
+	/**
+	* The arguments of run shared by every realization.  Each realization copies what bathyTool may change.
+	*/
+	dgrid *xMeshGrid;
+	dgrid *yMeshGrid;
+	vector<double> *xSingleVector;
+	vector<double> *ySingleVector;
+	vector<double> *xInterpVector;
+	vector<double> *yInterpVector;
+	double smoothingScaleX;
+	double smoothingScaleY;
+	double x0;
+	double y0;
+	double meanXSingle;
+	double meanYSingle;
+	string kernelName;
+	map<string, int> additionalOptions;
+	vector< vector<double> > *subsampledInput;
+} MC_REALIZATION;
+
+/**
+* Estimates the memory held by one realization while it is interpolated: the perturbed copy and the
+* subsampled data made from it, and the copies of the locations and the interpolated values.
+* Only the arrays that grow with the data and the locations are counted.  The per-window matrices of
+* the tile and kriging interpolators, sized by the points within a smoothing window, and the binning
+* cells of the subsampler are not, so the budget must leave headroom for them.
+* @param numInputs - Number of input soundings.
+* @param numLocations - Number of locations interpolated to.
+* @return The estimate in bytes.
+*/
+static double realizationBytes(int numInputs, int numLocations)
+{
+	return sizeof(double)*(13.0*numInputs + 22.0*numLocations);
+}
+
+/**
+* @return Half of the physical memory in bytes, or 0 if it cannot be found.
+*/
+static double defaultMemoryBudget()
+{
+#ifdef WIN32
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	if (!GlobalMemoryStatusEx(&status))
+		return 0;
+	return 0.5*(double)status.ullTotalPhys;
+#else
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long pageSize = sysconf(_SC_PAGE_SIZE);
+	if (pages <= 0 || pageSize <= 0)
+		return 0;
+	return 0.5*(double)pages*(double)pageSize;
+#endif
+}
+
+/**
+* Interpolates one realization with bathyTool, or bathyToolPreDefined for pre-interpolated locations.
+* @param mc - The realization. (Returned).
+*/
+static void computeRealization(MC_REALIZATION *mc)
+{
+	(*mc).xMeshVectorMC = vector<double>(*(*mc).xInterpVector);
+	(*mc).yMeshVectorMC = vector<double>(*(*mc).yInterpVector);
+
+	if ((*mc).additionalOptions.find("-preInterpolatedLocations")->second == 0)
+	{
+		//A. Reassign for manipulation
+		dgrid xMeshGridMC = dgrid(*(*mc).xMeshGrid);
+		dgrid yMeshGridMC = dgrid(*(*mc).yMeshGrid);
+		vector<double> xtMC = vector<double>(*(*mc).xSingleVector);
+		vector<double> ytMC = vector<double>(*(*mc).ySingleVector);
+
+		(*mc).returnValue = bathyTool(&(*mc).xMC, &(*mc).yMC, &(*mc).zMC, &(*mc).eMC, &(*mc).hMC, &(*mc).vMC, &xMeshGridMC, &yMeshGridMC, &xtMC, &ytMC, (*mc).smoothingScaleX, (*mc).smoothingScaleY, (*mc).x0, (*mc).y0, (*mc).meanXSingle, (*mc).meanYSingle, (*mc).kernelName, (*mc).additionalOptions, 1.0, true, true, NEITOL, &(*mc).xyzOut, (*mc).subsampledInput);
+	}
+	else
+		(*mc).returnValue = bathyToolPreDefined(&(*mc).xMC, &(*mc).yMC, &(*mc).zMC, &(*mc).eMC, &(*mc).hMC, &(*mc).vMC, &(*mc).xMeshVectorMC, &(*mc).yMeshVectorMC, (*mc).smoothingScaleX, (*mc).smoothingScaleY, (*mc).x0, (*mc).y0, (*mc).meanXSingle, (*mc).meanYSingle, (*mc).kernelName, (*mc).additionalOptions, NEITOL, &(*mc).xyzOut, (*mc).subsampledInput);
+}
+
+#ifdef WIN32
+static DWORD WINAPI realizationThread(LPVOID lpParam)
+#else
+static void *realizationThread(void *lpParam)
+#endif
+{
+	computeRealization((MC_REALIZATION *)lpParam);
+	return 0;
+}
+
+/**
+* Interpolates the first n realizations, one thread each.  The calling thread takes the first.
+* A realization whose thread cannot be started is interpolated after the others are joined.
+* @param realizations - The realizations. (Returned).
+* @param n - Number of realizations to interpolate.
+*/
+static void computeRealizations(vector<MC_REALIZATION> *realizations, int n)
+{
+	vector<bool> started(n, false);
+#ifdef WIN32
+	vector<HANDLE> threads(n);
+#else
+	vector<pthread_t> threads(n);
+#endif
+
+	for (int t = 1; t < n; t++)
+	{
+#ifdef WIN32
+		threads[t] = CreateThread(NULL, 0, realizationThread, &(*realizations)[t], 0, NULL);
+		started[t] = (threads[t] != NULL);
+#else
+		started[t] = (pthread_create(&threads[t], NULL, realizationThread, &(*realizations)[t]) == 0);
+#endif
+	}
+	computeRealization(&(*realizations)[0]);
+	for (int t = 1; t < n; t++)
+	{
+		if (started[t])
+		{
+#ifdef WIN32
+			WaitForSingleObject(threads[t], INFINITE);
+			CloseHandle(threads[t]);
+#else
+			pthread_join(threads[t], NULL);
+#endif
+		}
+		else
+			computeRealization(&(*realizations)[t]);
+	}
+}
+
+int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, vector<double> *xSingleVector, vector<double> *ySingleVector, vector<double> *xInterpVector, vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY, double &x0, double &y0, double &x1, double &y1, double meanXSingle, double meanYSingle, string &kernelName,  map<string, int> additionalOptions, string outputFileName, double subDataMulitplier, double UTMNorthingRef, double UTMEastingRef, double rotAngle, int RefEllip, char UTMZoneRef[4], int numMCRuns, MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, Bathy_Grid* bathyGrid, int USE_UTM, vector< vector<double> > *subsampledInput)
 {
 	//MergeBathy used to be able to only run one gridding algorithm at a time.  
 	//These gridding algorithms spline sparse data in order to obtain more 
@@ -2157,12 +2566,6 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 	//************************************************************************************
 	int returnValue = SUCCESS;
 	int i, stdLoc;
-	OUTPUT_DATA xyzOut;
-
-	double UTMEasting;
-	double UTMNorthing;
-	double newLon;
-	double newLat;
 
 	RNG randomNumber;
 	stringstream ss;
@@ -2170,21 +2573,11 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 	string fileName, outputFileNameT;
 	string extInterpFileName;
 
-	vector<double> xMC = vector<double>((*inputDataX).size());
-	vector<double> yMC = vector<double>((*inputDataY).size());
-	vector<double> zMC = vector<double>((*inputDataX).size());
-	vector<double> eMC = vector<double>((*inputDataY).size());
-	//SJZ
-	vector<double> hMC = vector<double>((*inputDataY).size());
-	vector<double> vMC = vector<double>((*inputDataY).size());
+	int numThreads = additionalOptions.find("-multiThread")->second;
+	int mcConcurrent = 1;
+	int mcBatch = 0;
+	double memoryBudget, memoryPerRun;
 
-	dgrid xMeshGridMC;
-	dgrid yMeshGridMC;
-	vector<double> xtMC;
-	vector<double> ytMC;
-	vector<double> xMeshVectorMC;
-	vector<double> yMeshVectorMC;
-		
 	string ensembleFName = outputFileName;
 	ensembleFName.append("_Ensemble.txt");
 	dvector ziToStandardDeviation;
@@ -2211,12 +2604,64 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 		ziKToStandardDeviation = dvector((*xInterpVector).size()*numMCRuns);
 		eiKToStandardDeviation = dvector((*xInterpVector).size()*numMCRuns);
 	}
+
+	//Monte Carlo runs are interpolated mcConcurrent at a time, up to one per -multiThread thread.
+	//How many fit is set by the memory each holds and -mcMemoryBudget, or half of the physical memory if that is 0.
+	//The pre-spliners share bathyGrid and streamed subsampled data is used up by one run, so those go one at a time.
+	if (MCFlag && numThreads > 1 && numMCRuns > 1 && !bathyGrid->GriddingFlag && subsampledInput == NULL)
+	{
+		memoryBudget = 1048576.0*additionalOptions.find("-mcMemoryBudget")->second;
+		if (memoryBudget <= 0)
+			memoryBudget = defaultMemoryBudget();
+		memoryPerRun = realizationBytes((const int)(*inputDataX).size(), (const int)(*xInterpVector).size());
+
+		mcConcurrent = min(numThreads, numMCRuns);
+		if (memoryBudget > 0 && memoryPerRun*mcConcurrent > memoryBudget)
+			mcConcurrent = max(1, (int)(memoryBudget/memoryPerRun));
+	}
+	vector<MC_REALIZATION> realizations(mcConcurrent);
+	for (int b = 0; b < mcConcurrent; b++)
+	{
+		realizations[b].xMeshGrid = xMeshGrid;
+		realizations[b].yMeshGrid = yMeshGrid;
+		realizations[b].xSingleVector = xSingleVector;
+		realizations[b].ySingleVector = ySingleVector;
+		realizations[b].xInterpVector = xInterpVector;
+		realizations[b].yInterpVector = yInterpVector;
+		realizations[b].smoothingScaleX = smoothingScaleX;
+		realizations[b].smoothingScaleY = smoothingScaleY;
+		realizations[b].x0 = x0;
+		realizations[b].y0 = y0;
+		realizations[b].meanXSingle = meanXSingle;
+		realizations[b].meanYSingle = meanYSingle;
+		realizations[b].kernelName = kernelName;
+		realizations[b].additionalOptions = additionalOptions;
+		realizations[b].subsampledInput = subsampledInput;
+		realizations[b].returnValue = SUCCESS;
+		//Concurrent runs split the -multiThread threads between them.  A run left with one thread interpolates serially.
+		if (mcConcurrent > 1)
+			realizations[b].additionalOptions["-multiThread"] = (numThreads/mcConcurrent > 1) ? numThreads/mcConcurrent : 0;
+	}
+	if (mcConcurrent > 1)
+		printf("Interpolating %d Monte Carlo runs at a time\n", mcConcurrent);
+
 	//************************************************************************************
 	// I. Iterate over the number of Monte Carlo runs to be done
 	//************************************************************************************
 	stdLoc = 0;
 	for (int mcRunNum = 0; mcRunNum < numMCRuns; mcRunNum++)
 	{
+		MC_REALIZATION &mc = realizations[mcRunNum % mcConcurrent];
+		vector<double> &xMC = mc.xMC;
+		vector<double> &yMC = mc.yMC;
+		vector<double> &zMC = mc.zMC;
+		vector<double> &eMC = mc.eMC;
+		vector<double> &hMC = mc.hMC;
+		vector<double> &vMC = mc.vMC;
+		vector<double> &xMeshVectorMC = mc.xMeshVectorMC;
+		vector<double> &yMeshVectorMC = mc.yMeshVectorMC;
+		OUTPUT_DATA &xyzOut = mc.xyzOut;
+
 		if(MCFlag)
 		{
 			printf("\n\nEntering Monte Carlo Run Number: %d\n",(mcRunNum + 1));
@@ -2240,19 +2685,34 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 		}else 
 			outputFileNameT = outputFileName;
 
-		//C. Set disposable variables for each loop
-		for (i = 0; i < (const int)xMC.size(); i++){
-			if(MCFlag){
-				xMC[i] = (*inputDataX)[i] + (*inputDataHErr)[i]*randomNumber.normal();
-				yMC[i] = (*inputDataY)[i] + (*inputDataHErr)[i]*randomNumber.normal();
-			}else{
-				xMC[i] = (*inputDataX)[i];
-				yMC[i] = (*inputDataY)[i];
+		//C. Set disposable variables for each batch of runs.  The runs are perturbed in order so they
+		//draw the same random numbers as when they are run one at a time.
+		if (mcRunNum % mcConcurrent == 0)
+		{
+			mcBatch = min(mcConcurrent, numMCRuns - mcRunNum);
+			for (int b = 0; b < mcBatch; b++)
+			{
+				MC_REALIZATION &next = realizations[b];
+				next.xMC.resize((*inputDataX).size());
+				next.yMC.resize((*inputDataX).size());
+				next.zMC.resize((*inputDataX).size());
+				next.eMC.resize((*inputDataX).size());
+				next.hMC.resize((*inputDataX).size());
+				next.vMC.resize((*inputDataX).size());
+				for (i = 0; i < (const int)next.xMC.size(); i++){
+					if(MCFlag){
+						next.xMC[i] = (*inputDataX)[i] + (*inputDataHErr)[i]*randomNumber.normal();
+						next.yMC[i] = (*inputDataY)[i] + (*inputDataHErr)[i]*randomNumber.normal();
+					}else{
+						next.xMC[i] = (*inputDataX)[i];
+						next.yMC[i] = (*inputDataY)[i];
+					}
+					next.zMC[i] = (*inputDataZ)[i];
+					next.eMC[i] = (*inputDataE)[i];
+					next.hMC[i] = (*inputDataHErr)[i];
+					next.vMC[i] = (*inputDataVErr)[i];
+				}
 			}
-			zMC[i] = (*inputDataZ)[i];
-			eMC[i] = (*inputDataE)[i];
-			hMC[i] = (*inputDataHErr)[i];
-			vMC[i] = (*inputDataVErr)[i];
 		}
 		
 		if(MCFlag)
@@ -2373,7 +2833,7 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 				//B. Now call GMT Surface
 				externalInterpolators extInterp(UTMNorthingRef, UTMEastingRef, rotAngle, RefEllip, UTMZoneRef);
 				//bool mbzReturn = extInterp.run_Surface_ORIGINAL(&xMC, &yMC, &zMC, &eMC, inputDataHErr, inputDataVErr, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, extInterpFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage);
-				bool gmtReturn = extInterp.run_Surface(&xMC, &yMC, &zMC, &eMC, &hMC, &vMC, additionalOptions, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, extInterpFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage, bathyGrid);
+				bool gmtReturn = extInterp.run_Surface(&xMC, &yMC, &zMC, &eMC, &hMC, &vMC, additionalOptions, (*GMTSurfaceInput).spacingX, (*GMTSurfaceInput).spacingY, (*GMTSurfaceInput).tension, extInterpFileName, (*GMTSurfaceInput).scaleFactor, (*GMTSurfaceInput).alpha, (*GMTSurfaceInput).usage, (*GMTSurfaceInput).numThreads, bathyGrid);
 
 				if (!gmtReturn)
 				{
@@ -2478,34 +2938,13 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 		bathyGrid->clear();
 		#pragma endregion
 
-		xMeshVectorMC = vector<double>((*xInterpVector));
-		yMeshVectorMC = vector<double>((*yInterpVector));
-
 		//************************************************************************************
 		// IV. If we are computing the data points then run scalecInterpTile.  Otherwise go the longer route of scalecInterp.
+		// The first run of a batch interpolates the whole batch; each run is then written in order.
 		//************************************************************************************
-		if (additionalOptions.find("-preInterpolatedLocations")->second == 0)
-		{
-			//A. Reassign for manipulation
-			xMeshGridMC = dgrid((*xMeshGrid));
-			yMeshGridMC = dgrid((*yMeshGrid));
-			xtMC = vector<double>((*xSingleVector));
-			ytMC = vector<double>((*ySingleVector));
-
-			//returnValue = bathyTool_ORIGINAL(&xMC, &yMC, &zMC, &eMC, &xMeshGridMC, &yMeshGridMC, &xtMC, &ytMC, smoothingScaleX, smoothingScaleY, x0, y0, meanXSingle, meanYSingle, kernelName, additionalOptions, 1.0, true, true, NEITOL, &xyzOut);
-			returnValue = bathyTool(&xMC, &yMC, &zMC, &eMC, &hMC, &vMC, &xMeshGridMC, &yMeshGridMC, &xtMC, &ytMC, smoothingScaleX, smoothingScaleY, x0, y0, meanXSingle, meanYSingle, kernelName, additionalOptions, 1.0, true, true, NEITOL, &xyzOut);
-
-			//B. Clear so it can be used again
-			xMeshGridMC.clear();
-			yMeshGridMC.clear();
-			xtMC.clear();
-			ytMC.clear();
-		}
-		else
-		{
-			//returnValue = bathyToolPreDefined_ORIGINAL(&xMC, &yMC, inputDataZ, inputDataE, &xMeshVectorMC, &yMeshVectorMC, smoothingScaleX, smoothingScaleY, x0, y0, meanXSingle, meanYSingle, kernelName, additionalOptions, NEITOL, &xyzOut);
-			returnValue = bathyToolPreDefined(&xMC, &yMC, &zMC, &eMC, &hMC, &vMC, &xMeshVectorMC, &yMeshVectorMC, smoothingScaleX, smoothingScaleY, x0, y0, meanXSingle, meanYSingle, kernelName, additionalOptions, NEITOL, &xyzOut);
-		}
+		if (mcRunNum % mcConcurrent == 0)
+			computeRealizations(&realizations, mcBatch);
+		returnValue = mc.returnValue;
 
 		//C. Clear up the variables if something went wrong
 		if(returnValue != 0)
@@ -2724,27 +3163,7 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 		//************************************************************************************
 		if ((additionalOptions.find("-inputInMeters")->second == 0) && (additionalOptions.find("-outputRasterFile")->second == 0 && additionalOptions.find("-outputBagFile")->second == 0))
 		{
-			for(int i = 0; i < (const int)xInterpTemp.size(); i++)
-			{
-				if(!USE_UTM) // SJZ
-				{
-					UTMEasting = (xInterpTemp[i])*cos(deg2rad*(-rotAngle)) - (yInterpTemp[i])*sin(deg2rad*(-rotAngle));
-					UTMNorthing = (xInterpTemp[i])*sin(deg2rad*(-rotAngle)) + (yInterpTemp[i])*cos(deg2rad*(-rotAngle));
-
-					UTMNorthing += UTMNorthingRef;
-					UTMEasting += UTMEastingRef;
-				}
-				else
-				{ // SJZ
-					UTMEasting	= xInterpTemp[i];
-					UTMNorthing = yInterpTemp[i];
-				}
-				UTMtoLL(RefEllip, UTMNorthing, UTMEasting, UTMZoneRef, newLat, newLon);
-				if(newLon >= 180) // SJZ
-					newLon -= 360;
-				yInterpTemp[i] = newLat;
-				xInterpTemp[i] = newLon;
-			}
+			locationsToLL(&xInterpTemp, &yInterpTemp, &UTMEastings, &UTMNorthings, UTMNorthingRef, UTMEastingRef, rotAngle, RefEllip, UTMZoneRef, USE_UTM, additionalOptions.find("-multiThread")->second);
 			if (additionalOptions.find("-printMatlabMatch")->second == 1)
 			{
 				if (((rotAngle > 45) & (rotAngle <= 135)) | ((rotAngle > 225) & (rotAngle <= 315)))
@@ -2764,58 +3183,18 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 			double minYInterp	= (double)MAX_INT;
 			double maxXInterp	= (double)MIN_INT;
 			double maxYInterp	= (double)MIN_INT;*/
-			int INIT_TEMPS = 1;
 
 			//1. Remove the central point offset from the data for raster format grids
 			//A new raster grid will be created by interpolating from current data to raster grid locations
 			//Convert only points with data to UTM.
 			//for(int i = 0; i < (const int)xInterpVector->size(); i++)
-			for(int i = 0; i < (const int)xInterpTemp.size(); i++)
+			locationsToLL(&xInterpTemp, &yInterpTemp, &UTMEastings, &UTMNorthings, UTMNorthingRef, UTMEastingRef, rotAngle, RefEllip, UTMZoneRef, USE_UTM, additionalOptions.find("-multiThread")->second);
+			for(int i = 0; i < (const int)UTMNorthings.size(); i++)
 			{
-				if(!USE_UTM) // SJZ
-				{ 
-					UTMEasting = (xInterpTemp)[i]*cos(deg2rad*(-rotAngle)) - (yInterpTemp)[i]*sin(deg2rad*(-rotAngle));
-					UTMNorthing = (xInterpTemp)[i]*sin(deg2rad*(-rotAngle)) + (yInterpTemp)[i]*cos(deg2rad*(-rotAngle));
-
-					//UTMEasting = (*xInterpVector)[i]*cos(deg2rad*(-rotAngle)) - (*yInterpVector)[i]*sin(deg2rad*(-rotAngle));
-					//UTMNorthing = (*xInterpVector)[i]*sin(deg2rad*(-rotAngle)) + (*yInterpVector)[i]*cos(deg2rad*(-rotAngle));
-			
-					UTMNorthing += UTMNorthingRef;
-					UTMEasting  += UTMEastingRef;
-				}
-				else
-				{ // SJZ
-					UTMEasting	= xInterpTemp[i];
-					UTMNorthing = yInterpTemp[i];
-				}
-				if(INIT_TEMPS)
-				{
-					minNorthing	= UTMNorthing;
-					minEasting	= UTMEasting;
-					maxNorthing	= UTMNorthing;
-					maxEasting	= UTMEasting;
-				/*	minXInterp	= MAX_INT;
-					minYInterp	= MAX_INT;
-					maxXInterp	= MIN_INT;
-					maxYInterp	= MIN_INT;*/
-					INIT_TEMPS = 0;
-				}
-				UTMNorthings[i] = UTMNorthing;	//y
-				UTMEastings [i] = UTMEasting;	//x
-				//yInterpTemp2[i] = UTMNorthing;
-				//xInterpTemp2[i] = UTMEasting;
-				//(*yInterpVector)[i] = UTMNorthing;
-				//(*xInterpVector)[i] = UTMEasting; 
-				UTMtoLL(RefEllip, UTMNorthing, UTMEasting, UTMZoneRef, newLat, newLon);
-				if(newLon >= 180) // SJZ
-					newLon -= 360;
-				yInterpTemp[i] = newLat;
-				xInterpTemp[i] = newLon;
-
-				minEasting  = min(minEasting, UTMEasting);
-				maxEasting  = max(maxEasting, UTMEasting);
-				minNorthing = min(minNorthing, UTMNorthing);
-				maxNorthing = max(maxNorthing, UTMNorthing);
+				minEasting  = min(minEasting, UTMEastings[i]);
+				maxEasting  = max(maxEasting, UTMEastings[i]);
+				minNorthing = min(minNorthing, UTMNorthings[i]);
+				maxNorthing = max(maxNorthing, UTMNorthings[i]);
 			}
 		
 			int Ni = (const int)UTMNorthings.size();
@@ -3209,12 +3588,7 @@ int run(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *
 		}
 
 	}
-	xMC.clear();
-	yMC.clear();
-	zMC.clear();
-	eMC.clear();
-	hMC.clear();
-	vMC.clear();
+	realizations.clear();
 
 	return returnValue;
 }
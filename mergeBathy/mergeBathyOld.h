@@ -33,6 +33,16 @@
 */
 int mergeBathy_PreCompute( std::vector<TRUE_DATA> *inputData, double refLon, double refLat, double rotationAngle, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY,  std::string kernelName, std::string outputFileName, map<std::string, int> additionalOptions, int numMCRuns, MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, FORCED_LOCATIONS *forcedLocationPositions,int usagePreInterpLocsLatLon);
 
+/**
+* mergeBathy_PreCompute for input files too large to hold in memory.  The files in the list are read a block at a time, several times over, and subsampled as they are read, so only the subsampled cells are held.
+* Gives what mergeBathy_PreCompute gives for the same files, to rounding.  The pre-spliners, computing offsets and Monte Carlo runs need every sounding and are not available.
+* @param inputFileList - File name of the list file that contains each individual data set.
+* @param bbox - The bounding extents of the input data if it is to be cut.
+* The remaining parameters are those of mergeBathy_PreCompute.  The options of readFile are taken from additionalOptions.
+* @return Success or failure value.
+*/
+int mergeBathy_PreComputeStreaming(std::string &inputFileList, BOUNDING_BOX bbox, double refLon, double refLat, double rotationAngle, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY,  std::string kernelName, std::string outputFileName, map<std::string, int> additionalOptions, int numMCRuns, MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, FORCED_LOCATIONS *forcedLocationPositions, int usagePreInterpLocsLatLon);
+
 /**
 * Computing routine for merging analysis of bathymetry data.  Only used in single data runs.
 * @param inputDataX - Vector of input X data points.
@@ -73,7 +83,7 @@ int mergeBathy_PreCompute( std::vector<TRUE_DATA> *inputData, double refLon, dou
 int runSingle(std::vector<double> *inputDataX,  std::vector<double> *inputDataY, std::vector<double> *inputDataZ,  std::vector<double> *inputDataE,  std::vector<double> *inputDataHErr, std::vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, std::vector<double> *xSingleVector,  std::vector<double> *ySingleVector,  std::vector<double> *xInterpVector, std::vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY, double &x0, double &y0, double &x1, double &y1, double meanXSingle, double meanYSingle, std::string &kernelName,  map<std::string, int> additionalOptions, std::string outputFileName, double subDataMulitplier, double UTMNorthingRef, double UTMEastingRef, double rotAngle, int RefEllip, char UTMZoneRef[4], MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, Bathy_Grid* bathyGrid, int USE_UTM);
 
 
-int run(std::vector<double> *inputDataX,  std::vector<double> *inputDataY, std::vector<double> *inputDataZ,  std::vector<double> *inputDataE,  std::vector<double> *inputDataHErr, std::vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, std::vector<double> *xSingleVector,  std::vector<double> *ySingleVector,  std::vector<double> *xInterpVector, std::vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY, double &x0, double &y0, double &x1, double &y1, double meanXSingle, double meanYSingle, std::string &kernelName,  map<std::string, int> additionalOptions, std::string outputFileName, double subDataMulitplier, double UTMNorthingRef, double UTMEastingRef, double rotAngle, int RefEllip, char UTMZoneRef[4], int numMCRuns, MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, Bathy_Grid* bathyGrid, int USE_UTM);
+int run(std::vector<double> *inputDataX,  std::vector<double> *inputDataY, std::vector<double> *inputDataZ,  std::vector<double> *inputDataE,  std::vector<double> *inputDataHErr, std::vector<double> *inputDataVErr, dgrid *xMeshGrid, dgrid *yMeshGrid, std::vector<double> *xSingleVector,  std::vector<double> *ySingleVector,  std::vector<double> *xInterpVector, std::vector<double> *yInterpVector, double gridSpacingX, double gridSpacingY, double smoothingScaleX, double smoothingScaleY, double &x0, double &y0, double &x1, double &y1, double meanXSingle, double meanYSingle, std::string &kernelName,  map<std::string, int> additionalOptions, std::string outputFileName, double subDataMulitplier, double UTMNorthingRef, double UTMEastingRef, double rotAngle, int RefEllip, char UTMZoneRef[4], int numMCRuns, MB_ZGRID_DATA *MB_ZGridInput, GMT_SURFACE_DATA *GMTSurfaceInput, ALG_SPLINE_DATA *ALGSplineInput, Bathy_Grid* bathyGrid, int USE_UTM, std::vector< std::vector<double> > *subsampledInput = NULL);
 /**
 * Computing routine for merging analysis of bathmetry data.  Only used in single data runs.
 * @param inputDataX - Vector of input X data points.
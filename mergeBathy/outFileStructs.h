@@ -12,6 +12,8 @@
 #include <string>
 #include "grid.h"
 
+class mbTaskQueue;
+
 //#pragma region Define OUTPUT_DATA
 //************************************************************************
 // Used for returning the interpolated values so they can be printed.
@@ -210,9 +212,51 @@ typedef struct {
 	*/
 	vector<double> aiVector;
 
+	/**
+	* kernelType - KERNEL_TYPE of kernelName, resolved once by scalecInterpPerturbations_PreCompute.
+	*/
+	int kernelType;
+
+	/**
+	* The first radial distance and the inverse of the spacing of the increasing start of riVector, to index the tables directly.
+	*/
+	double riOrigin;
+	double riInverseStep;
+
 
 }PERTURBS;
 
+/*Working buffers of scalecInterpPerturbations_Compute, kept between the nodes a thread interpolates.
+  The buffers are cleared but never released, so once they have grown to the largest window a node no longer allocates.*/
+typedef struct {
+	/**
+	* r - Distances from the node to every data point, when no spatial index is used.
+	*/
+	vector<double> r;
+
+	/**
+	* aid, nearIdx - Indices of the points inside the window, and the candidates visited to find them.
+	*/
+	vector<int> aid;
+	vector<int> nearIdx;
+
+	/**
+	* nWeights, nWeights0, nDepths, nErrors - Weights, unscaled window weights, depths and errors of the points in aid.
+	*/
+	vector<double> nWeights;
+	vector<double> nWeights0;
+	vector<double> nDepths;
+	vector<double> nErrors;
+
+	/**
+	* rx0, newrx0, grow - Distances of the points in aid to the interpolation location, the nonzero ones, and their variance growth.
+	*/
+	vector<double> rx0;
+	vector<double> newrx0;
+	vector<double> grow;
+
+}PERTURB_SCRATCH;
+
 //#pragma region Define SCALEC_TILE_DATA, *SCALEC_TILE_DATA_POINTER
 //************************************************************************
 // Used for passing necessary data structures to the scalecInterpTile computation routines (Kriged or Non-Kriged).
@@ -421,6 +465,35 @@ typedef struct {
 	* KRIGING - Kriging flag.
 	*/bool KRIGING;
 
+	/**
+	* KRIGING_NEIGHBORS - Number of nearest residuals each location is kriged from.  0 kriges from every residual of the tile.
+	*/
+	int KRIGING_NEIGHBORS;
+
+	/**
+	* FFT_SMOOTHING - Convolve boxcar and hann windows over regular tiles by FFT flag.
+	*/
+	bool FFT_SMOOTHING;
+
+	/**
+	* fftTiles - Number of tiles each thread convolved by FFT. (Returned).
+	*/
+	vector<int> *fftTiles;
+
+	/**
+	* outerLoopIndexVectors - Vector of vectors of the X indices to interpolate in each tile column.
+	*/
+	const vector< vector<int> > *outerLoopIndexVectors;
+
+	/**
+	* outerLoopIdx - Vector of vectors of the subsampled data indices that fall within each tile column and its overlap.
+	*/
+	const vector< vector<int> > *outerLoopIdx;
+
+	/**
+	* tasks - Queue of (outerLoop, innerLoop) tiles shared by the processing threads.
+	*/
+	mbTaskQueue *tasks;
 
 } SCALEC_TILE_DATA, *SCALEC_TILE_DATA_POINTER;
 //#pragma endregion
@@ -544,6 +617,11 @@ typedef struct {
 	* KRIGING - Kriging flag.
 	*/bool KRIGING;
 
+	/**
+	* KRIGING_NEIGHBORS - Number of nearest residuals each location is kriged from.  0 kriges from every residual of the tile.
+	*/
+	int KRIGING_NEIGHBORS;
+
 	/**
 	* residualObservationsKrigedZ - Kriging Residuals.
 	*/
@@ -644,6 +722,10 @@ typedef struct {
 	//*/
 	//string errorInterpMethod;
 
+	/**
+	* tasks - Queue of interpolation location blocks shared by the processing threads.
+	*/
+	mbTaskQueue *tasks;
 
 } SCALEC_DATA, *SCALEC_DATA_POINTER;
 //#pragma endregion
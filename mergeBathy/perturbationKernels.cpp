@@ -0,0 +1,264 @@
+#include "perturbationKernels.h"
+#include <math.h>
+
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PERTURB_AVX2_TARGET
+#else
+#define PERTURB_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+//************************************************************************************
+// SUBROUTINE I: Run time CPU detection.
+//************************************************************************************
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+//The result is cached without synchronization.  Every thread computes the same value,
+//so a race only repeats the detection.
+static int avx2State = -1;
+
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER)
+	int CPUInfo[4];
+	__cpuid(CPUInfo, 0);
+	if (CPUInfo[0] < 7)
+		return false;
+	//A. AVX with its registers saved by the OS
+	__cpuid(CPUInfo, 1);
+	if ((CPUInfo[2] & 0x18000000) != 0x18000000)
+		return false;
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+	//B. AVX2
+	__cpuidex(CPUInfo, 7, 0);
+	return (CPUInfo[1] & 0x20) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+bool perturbationKernelsVectorized()
+{
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+	if (avx2State < 0)
+		avx2State = cpuHasAVX2() ? 1 : 0;
+	return avx2State == 1;
+#else
+	return false;
+#endif
+}
+
+//************************************************************************************
+// SUBROUTINE II: AVX2 passes.  Four lanes at a time; the last partial vector is
+//	loaded and stored through a lane mask so no scalar tail is needed.
+//************************************************************************************
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+static const long long laneMasks[8] = {-1, -1, -1, -1, 0, 0, 0, 0};
+
+//Mask of the first m lanes, 0 < m < 4.
+PERTURB_AVX2_TARGET static inline __m256i tailMask(int m)
+{
+	return _mm256_loadu_si256((const __m256i *)(laneMasks + 4 - m));
+}
+
+//Sum of the four lanes.
+PERTURB_AVX2_TARGET static inline double laneSum(__m256d v)
+{
+	double lanes[4];
+	_mm256_storeu_pd(lanes, v);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+PERTURB_AVX2_TARGET static void windowDistancesAVX2(const double *x, const double *y, int n, double x0, double y0, double *r)
+{
+	const __m256d vx0 = _mm256_set1_pd(x0);
+	const __m256d vy0 = _mm256_set1_pd(y0);
+	__m256d dx, dy;
+	int j;
+
+	for (j = 0; j + 4 <= n; j += 4)
+	{
+		dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), vx0);
+		dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), vy0);
+		_mm256_storeu_pd(r + j, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+	}
+	if (j < n)
+	{
+		const __m256i mask = tailMask(n - j);
+		dx = _mm256_sub_pd(_mm256_maskload_pd(x + j, mask), vx0);
+		dy = _mm256_sub_pd(_mm256_maskload_pd(y + j, mask), vy0);
+		_mm256_maskstore_pd(r + j, mask, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+	}
+}
+
+PERTURB_AVX2_TARGET static void windowSelectAVX2(const double *r, int n, double p, vector<int> *selected)
+{
+	const __m256d vp = _mm256_set1_pd(p);
+	int j, k, lanes;
+
+	for (j = 0; j < n; j += 4)
+	{
+		if (j + 4 <= n)
+			lanes = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(r + j), vp, _CMP_LT_OQ));
+		else
+		{
+			const __m256i mask = tailMask(n - j);
+			lanes = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(_mm256_maskload_pd(r + j, mask), vp, _CMP_LT_OQ), _mm256_castsi256_pd(mask)));
+		}
+		//Most blocks of a full scan lie outside the window.
+		for (k = 0; lanes != 0; k++, lanes >>= 1)
+		{
+			if (lanes & 1)
+				(*selected).push_back(j + k);
+		}
+	}
+}
+
+PERTURB_AVX2_TARGET static void windowNormalizeAVX2(double *w, const double *z, int n, double scale, double *sumWeights, double *sumSquares, double *sumDepths)
+{
+	const __m256d vs = _mm256_set1_pd(scale);
+	__m256d vw, vz;
+	__m256d accW = _mm256_setzero_pd();
+	__m256d accW2 = _mm256_setzero_pd();
+	__m256d accZ = _mm256_setzero_pd();
+	int j;
+
+	for (j = 0; j + 4 <= n; j += 4)
+	{
+		vw = _mm256_div_pd(_mm256_loadu_pd(w + j), vs);
+		vz = _mm256_loadu_pd(z + j);
+		_mm256_storeu_pd(w + j, vw);
+		accW = _mm256_add_pd(accW, vw);
+		accW2 = _mm256_add_pd(accW2, _mm256_mul_pd(vw, vw));
+		accZ = _mm256_add_pd(accZ, _mm256_mul_pd(vz, vw));
+	}
+	if (j < n)
+	{
+		//Masked lanes load as zero and add nothing.
+		const __m256i mask = tailMask(n - j);
+		vw = _mm256_div_pd(_mm256_maskload_pd(w + j, mask), vs);
+		vz = _mm256_maskload_pd(z + j, mask);
+		_mm256_maskstore_pd(w + j, mask, vw);
+		accW = _mm256_add_pd(accW, vw);
+		accW2 = _mm256_add_pd(accW2, _mm256_mul_pd(vw, vw));
+		accZ = _mm256_add_pd(accZ, _mm256_mul_pd(vz, vw));
+	}
+	(*sumWeights) = laneSum(accW);
+	(*sumSquares) = laneSum(accW2);
+	(*sumDepths) = laneSum(accZ);
+}
+
+PERTURB_AVX2_TARGET static void windowResidualsAVX2(const double *w, const double *z, const double *e, int n, double mean, double *sumResiduals, double *sumErrors)
+{
+	const __m256d vmean = _mm256_set1_pd(mean);
+	__m256d vw, vd;
+	__m256d accR = _mm256_setzero_pd();
+	__m256d accE = _mm256_setzero_pd();
+	int j;
+
+	for (j = 0; j + 4 <= n; j += 4)
+	{
+		vw = _mm256_loadu_pd(w + j);
+		vd = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(z + j), vmean), vw);
+		accR = _mm256_add_pd(accR, _mm256_mul_pd(vd, vd));
+		accE = _mm256_add_pd(accE, _mm256_mul_pd(vw, _mm256_loadu_pd(e + j)));
+	}
+	if (j < n)
+	{
+		//Masked lanes have a zero weight and add nothing.
+		const __m256i mask = tailMask(n - j);
+		vw = _mm256_maskload_pd(w + j, mask);
+		vd = _mm256_mul_pd(_mm256_sub_pd(_mm256_maskload_pd(z + j, mask), vmean), vw);
+		accR = _mm256_add_pd(accR, _mm256_mul_pd(vd, vd));
+		accE = _mm256_add_pd(accE, _mm256_mul_pd(vw, _mm256_maskload_pd(e + j, mask)));
+	}
+	(*sumResiduals) = laneSum(accR);
+	(*sumErrors) = laneSum(accE);
+}
+#endif
+
+//************************************************************************************
+// SUBROUTINE III: Passes.  The scalar versions are the loops of scalecInterpPerturbations_Compute.
+//************************************************************************************
+void windowDistances(const double *x, const double *y, int n, double x0, double y0, double *r)
+{
+	double valueCalculated1, valueCalculated2;
+
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+	if (perturbationKernelsVectorized())
+	{
+		windowDistancesAVX2(x, y, n, x0, y0, r);
+		return;
+	}
+#endif
+	for (int j = 0; j < n; j++)
+	{
+		valueCalculated1 = x[j] - x0;
+		valueCalculated2 = y[j] - y0;
+		r[j] = sqrt(valueCalculated1*valueCalculated1 + valueCalculated2*valueCalculated2);
+	}
+}
+
+void windowSelect(const double *r, int n, double p, vector<int> *selected)
+{
+	(*selected).clear();
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+	if (perturbationKernelsVectorized())
+	{
+		windowSelectAVX2(r, n, p, selected);
+		return;
+	}
+#endif
+	for (int j = 0; j < n; j++)
+	{
+		if (r[j] < p)
+			(*selected).push_back(j);
+	}
+}
+
+void windowNormalize(double *w, const double *z, int n, double scale, double *sumWeights, double *sumSquares, double *sumDepths)
+{
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+	if (perturbationKernelsVectorized())
+	{
+		windowNormalizeAVX2(w, z, n, scale, sumWeights, sumSquares, sumDepths);
+		return;
+	}
+#endif
+	(*sumWeights) = 0.0;
+	(*sumSquares) = 0.0;
+	(*sumDepths) = 0.0;
+	for (int j = 0; j < n; j++)
+	{
+		w[j] /= scale;
+		(*sumWeights) += w[j];
+		(*sumSquares) += w[j] * w[j];
+		(*sumDepths) += z[j] * w[j];
+	}
+}
+
+void windowResiduals(const double *w, const double *z, const double *e, int n, double mean, double *sumResiduals, double *sumErrors)
+{
+	double residual;
+
+#if defined(PERTURB_HAS_AVX2_INTRINSICS)
+	if (perturbationKernelsVectorized())
+	{
+		windowResidualsAVX2(w, z, e, n, mean, sumResiduals, sumErrors);
+		return;
+	}
+#endif
+	(*sumResiduals) = 0.0;
+	(*sumErrors) = 0.0;
+	for (int j = 0; j < n; j++)
+	{
+		residual = (z[j] - mean) * w[j];
+		(*sumResiduals) += residual * residual;
+		(*sumErrors) += w[j] * e[j];
+	}
+}
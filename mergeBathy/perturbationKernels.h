@@ -0,0 +1,76 @@
+/**
+* @file			perturbationKernels.h
+* @brief		Vectorized distance, selection and reduction passes of the scalecInterpPerturbations estimator.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* Each pass works on contiguous (structure of arrays) buffers.  When the compiler
+* can issue AVX2 code (PERTURB_HAS_AVX2_INTRINSICS) and the CPU supports it at
+* run time, four lanes are processed at a time and the last partial vector is
+* handled with masked loads and stores.  Otherwise a scalar pass is used that
+* adds up the terms in the same order as the loops it replaced.
+*
+* The distances and the selection are exact either way.  The AVX2 sums keep
+* four partial sums, so they may differ from the scalar ones in the last bits.
+*/
+#pragma once
+#include <vector>
+
+using namespace std;
+
+#if !defined(PERTURB_NO_SIMD)
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)) && (_MSC_VER >= 1600))
+#define PERTURB_HAS_AVX2_INTRINSICS
+#elif (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)) || defined(__clang__)))
+#define PERTURB_HAS_AVX2_INTRINSICS
+#endif
+#endif
+
+/**
+* @return True when the AVX2 passes are used.
+*/
+bool perturbationKernelsVectorized();
+
+/**
+* Radial distances from an interpolation location, r[j] = sqrt((x[j]-x0)^2 + (y[j]-y0)^2).
+* @param x - X locations.
+* @param y - Y locations.
+* @param n - Number of locations.
+* @param x0 - X of the interpolation location.
+* @param y0 - Y of the interpolation location.
+* @param r - Distances. (Returned).
+*/
+void windowDistances(const double *x, const double *y, int n, double x0, double y0, double *r);
+
+/**
+* Indices of the distances inside a window, r[j] < p, in ascending order.
+* @param r - Distances.
+* @param n - Number of distances.
+* @param p - Smoothing scale of the window.
+* @param selected - Indices j with r[j] < p. (Returned).
+*/
+void windowSelect(const double *r, int n, double p, vector<int> *selected);
+
+/**
+* Scales the window weights and sums them, their squares and the weighted depths in one pass.
+* @param w - Weights.  Divided by scale. (Returned).
+* @param z - Depths of the weighted points.
+* @param n - Number of weights.
+* @param scale - Divisor of the weights; 1 leaves them unchanged.
+* @param sumWeights - Sum of the scaled weights. (Returned).
+* @param sumSquares - Sum of the squares of the scaled weights. (Returned).
+* @param sumDepths - Sum of z times the scaled weights. (Returned).
+*/
+void windowNormalize(double *w, const double *z, int n, double scale, double *sumWeights, double *sumSquares, double *sumDepths);
+
+/**
+* Sums the squared weighted residuals and the weighted errors in one pass.
+* @param w - Normalized weights.
+* @param z - Depths of the weighted points.
+* @param e - Errors of the weighted points.
+* @param n - Number of weights.
+* @param mean - The interpolated depth the residuals are taken about.
+* @param sumResiduals - Sum of ((z - mean) * w)^2. (Returned).
+* @param sumErrors - Sum of w * e. (Returned).
+*/
+void windowResiduals(const double *w, const double *z, const double *e, int n, double mean, double *sumResiduals, double *sumErrors);
@@ -278,6 +278,7 @@ int scalecInterp(vector< vector<double> > *subsampledData, vector<double> *xInte
 	scalecInterpData.PROP_UNCERT	= PROP_UNCERT;
 	scalecInterpData.KALMAN			= KALMAN;
 	scalecInterpData.KRIGING		= KRIGING;
+	scalecInterpData.KRIGING_NEIGHBORS	= additionalOptions["-krigingNeighbors"];
 	scalecInterpData.residualObservationsKrigedZ		= new vector<double>(x_idxKriged.size(),0.00);
 	scalecInterpData.residualObservationsKrigedZ0		= new vector<double>(x_idxKriged.size(),0.00);
 	scalecInterpData.residualObservationsKrigedZK		= new vector<double>(x_idxKriged.size(),0.00);
@@ -286,34 +287,58 @@ int scalecInterp(vector< vector<double> > *subsampledData, vector<double> *xInte
 	#pragma endregion
 
 	//************************************************************************************
-	//IV. Check for multi-threading support and run the processing routines
+	//IV. Check for multi-threading support and run the processing routines.
+	//	Each threaded part pulls blocks of locations from a shared queue so
+	//	threads that finish early take over the remaining work of the others.
 	//************************************************************************************
+	int numThreads = additionalOptions["-multiThread"];
+	if (numThreads < 1)
+		numThreads = 1;
+	mbTaskQueue interpTasks(numThreads);
+	scalecInterpData.tasks = &interpTasks;
+
 	if (additionalOptions["-multiThread"] == 0)
 	{
 		if (additionalOptions["-kriging"] == 0)
 		{
+			interpTasks.addBlocks((const int)xInterpLocs0.size());
+			interpTasks.schedule();
 			scalecInterp_Process(&scalecInterpData, 0,1);
 		//	scalecInterp_Process2A(&scalecInterpData, 0,1);//handles w and w/o kriging 
+			interpTasks.addBlocks((const int)x_idx.size());
+			interpTasks.schedule();
 			scalecInterp_Process4A(&scalecInterpData, 0,1);//handles w and w/o kriging 
 			scalecInterp_Process5A(&scalecInterpData, 0,1);//handles w and w/o kriging 
+			interpTasks.addBlocks((const int)xInterpLocs0.size());
+			interpTasks.schedule();
 			scalecInterp_Process6A(&scalecInterpData, 0,1);//handles w and w/o kriging 
 			//scalecInterp_Process2(&scalecInterpData, 0,1);
 		}else
 		{
 			//scalecInterp_ProcessKrig(&scalecInterpData, 0,1);
+			interpTasks.addBlocks((const int)xInterpLocs0.size());
+			interpTasks.schedule();
 			scalecInterp_Process(&scalecInterpData, 0,1);
+			interpTasks.addBlocks((const int)x_idx.size());
+			interpTasks.schedule();
 			scalecInterp_Process4A(&scalecInterpData, 0,1);//handles w and w/o kriging 
 			scalecInterp_Process5A(&scalecInterpData, 0,1);//handles w and w/o kriging 
+			interpTasks.addBlocks((const int)xInterpLocs0.size());
+			interpTasks.schedule();
 			scalecInterp_Process6A(&scalecInterpData, 0,1);//handles w and w/o kriging 
 		}
 	}else
 	{
 		mbThreads mbT = mbThreads(additionalOptions["-multiThread"]);
 		mbT.makeMBThread(&scalecInterpData);
+		interpTasks.addBlocks((const int)xInterpLocs0.size());
+		interpTasks.schedule();
 		mbT.initMBThread(0); 
 //		mbT.initMBThread(additionalOptions["-kriging"]);
 		mbT.joinMBThread();
 
+		interpTasks.addBlocks((const int)x_idx.size());
+		interpTasks.schedule();
 		mbT.initMBThread2(0);
 		//mbT.initMBThread2(additionalOptions["-kriging"]);
 		mbT.joinMBThread();
@@ -321,6 +346,8 @@ int scalecInterp(vector< vector<double> > *subsampledData, vector<double> *xInte
 
 		scalecInterp_Process5A(&scalecInterpData, 0,1);//handles w and w/o kriging 
 
+		interpTasks.addBlocks((const int)xInterpLocs0.size());
+		interpTasks.schedule();
 		mbT.initMBThread6(0);
 		//mbT.initMBThread2(additionalOptions["-kriging"]);
 		mbT.joinMBThread();
@@ -383,96 +410,100 @@ int scalecInterp_Process(SCALEC_DATA_POINTER sdp, const int curIterNum, const in
 	//**********************************************************************
 	//I. Non gridded output assumed; Initiate Function with full dataset WEA
 	//**********************************************************************
-	for(int i = curIterNum; i < (const int)Ni; i += numCores)
+	MB_TASK block;
+	while ((*sdp->tasks).nextTask(curIterNum, &block))
 	{
-		//A. Obtain a Grid
-		// #points about expansion point; should be even
-		//I believe Will did this just to get the slope
-		ndipts = 4;
-		nxtxi  = MAX_INT;
-		for (int j = 0; j < (const int)Ni; j++)
+		for (int i = block.begin; i < block.end; i++)
 		{
-			sumCount = 0;
-			del1 = (*sdp->xInterpLocs0)[j] - (*sdp->xInterpLocs0)[i]; //vector difference
-			del2 = (*sdp->yInterpLocs0)[j] - (*sdp->yInterpLocs0)[i]; //vector difference
-			sumCount += pow(del1,2);
-			sumCount += pow(del2,2);
-			rdel.push_back(sqrt(sumCount));
-			if(rdel[j] != 0 && rdel[j] < nxtxi)
-				nxtxi = rdel[j];
-		}
+			//A. Obtain a Grid
+			// #points about expansion point; should be even
+			//I believe Will did this just to get the slope
+			ndipts = 4;
+			nxtxi  = MAX_INT;
+			for (int j = 0; j < (const int)Ni; j++)
+			{
+				sumCount = 0;
+				del1 = (*sdp->xInterpLocs0)[j] - (*sdp->xInterpLocs0)[i]; //vector difference
+				del2 = (*sdp->yInterpLocs0)[j] - (*sdp->yInterpLocs0)[i]; //vector difference
+				sumCount += pow(del1,2);
+				sumCount += pow(del2,2);
+				rdel.push_back(sqrt(sumCount));
+				if(rdel[j] != 0 && rdel[j] < nxtxi)
+					nxtxi = rdel[j];
+			}
 
-		// make delta for points in a temp sub-grid (rdelTemp) around
-		// the point of interest
-		delr = nxtxi*ndipts;
+			// make delta for points in a temp sub-grid (rdelTemp) around
+			// the point of interest
+			delr = nxtxi*ndipts;
 
-		// find the points in the temp sub-grid (rdelTemp)
-//		auto ior = remove_if(rdel.begin(), rdel.end(), [=](double k){return (k < delr);});
-//		rdel.resize(distance(rdel.begin(), ior));
+			// find the points in the temp sub-grid (rdelTemp)
+	//		auto ior = remove_if(rdel.begin(), rdel.end(), [=](double k){return (k < delr);});
+	//		rdel.resize(distance(rdel.begin(), ior));
 
-		for(it = rdel.begin(); it < rdel.end(); it++)
-		{
-			if(*it >= delr)//!= NaN) //UNIX c98
-				rdelTemp.push_back(*it);
-		}
+			for(it = rdel.begin(); it < rdel.end(); it++)
+			{
+				if(*it >= delr)//!= NaN) //UNIX c98
+					rdelTemp.push_back(*it);
+			}
 
-		// make the domain a tad bigger than the data extent
-		xii0_upper = ((*sdp->xInterpLocs0)[i] + delr);
-		xii0_lower = ((*sdp->xInterpLocs0)[i] - delr);
-		yii0_upper = ((*sdp->yInterpLocs0)[i] + delr);
-		yii0_lower = ((*sdp->yInterpLocs0)[i] - delr);
-		// Calculate x and y for our new grid where we go from
-		// xii0_lower to xii0_upper at a step size of nxtxi.
-		createMeshXYDims(xii0_lower, yii0_lower, xii0_upper, yii0_upper, nxtxi, nxtxi, &xt, &yt);
-
-		// get our new x,y dimensions
-		xSize = (const int)xt.size();
-		ySize = (const int)yt.size();
-		if (0)
-		{
-			cout << "Dimensions of Computational Area "<< i << ": " << endl;
-			cout << "\tRows: " << ySize << "\n\tCols: " << xSize << endl << endl;
-		}
+			// make the domain a tad bigger than the data extent
+			xii0_upper = ((*sdp->xInterpLocs0)[i] + delr);
+			xii0_lower = ((*sdp->xInterpLocs0)[i] - delr);
+			yii0_upper = ((*sdp->yInterpLocs0)[i] + delr);
+			yii0_lower = ((*sdp->yInterpLocs0)[i] - delr);
+			// Calculate x and y for our new grid where we go from
+			// xii0_lower to xii0_upper at a step size of nxtxi.
+			createMeshXYDims(xii0_lower, yii0_lower, xii0_upper, yii0_upper, nxtxi, nxtxi, &xt, &yt);
+
+			// get our new x,y dimensions
+			xSize = (const int)xt.size();
+			ySize = (const int)yt.size();
+			if (0)
+			{
+				cout << "Dimensions of Computational Area "<< i << ": " << endl;
+				cout << "\tRows: " << ySize << "\n\tCols: " << xSize << endl << endl;
+			}
 
-		// resize vectors to match our new dimensions
-		xMeshVector.resize(xSize*ySize, 0.00);
-		yMeshVector.resize(xSize*ySize, 0.00);
-		xx.resize(ySize, xSize, 0.00);
-		yy.resize(ySize, xSize, 0.00);
-		// now create grid with those dimensions
-		createMeshGrid(&xt, &yt, &xMeshVector, &yMeshVector, &xx, &yy);
-
-		newxx.resize(xx.rows(), xx.cols(),0.00);
-		newyy.resize(yy.rows(), yy.cols(),0.00);
-
-		// reshape grid
-		reshapeGrid(&xx, &newxx);
-		reshapeGrid(&yy, &newyy);
-		centpnt = (int)(fix(ndipts*2/2+1)-1);
-
-		//B. Estimate zz value
-		InterpGrid* new_gmt = new InterpGrid(GMT);
-		zz.resize((newxx.vec()).size(), 0.00);
-		(*new_gmt).estimate(&(newxx.vec()), &(newyy.vec()), &zz, 1.96, 2.00, *sdp->Lx, sdp->new_bathyGrid->getTin(), sdp->interpMethod, "", "");
-
-		//C. Find slope at grid points
-		slopes = (*new_gmt).getGrads()->getSlopeOut();
-		(*((*sdp)).slopeOut)[i] = (*slopes)(centpnt, centpnt);//*&
-
-		// clean up 
-		delete new_gmt;
-		zz.clear();
-		xx.clear();
-		yy.clear();
-		xMeshVector.clear();
-		yMeshVector.clear();
-		xt.clear();
-		yt.clear();
-		newxx.clear();
-		newyy.clear();
-		rdel.clear();
-		rdelTemp.clear();
-	} 
+			// resize vectors to match our new dimensions
+			xMeshVector.resize(xSize*ySize, 0.00);
+			yMeshVector.resize(xSize*ySize, 0.00);
+			xx.resize(ySize, xSize, 0.00);
+			yy.resize(ySize, xSize, 0.00);
+			// now create grid with those dimensions
+			createMeshGrid(&xt, &yt, &xMeshVector, &yMeshVector, &xx, &yy);
+
+			newxx.resize(xx.rows(), xx.cols(),0.00);
+			newyy.resize(yy.rows(), yy.cols(),0.00);
+
+			// reshape grid
+			reshapeGrid(&xx, &newxx);
+			reshapeGrid(&yy, &newyy);
+			centpnt = (int)(fix(ndipts*2/2+1)-1);
+
+			//B. Estimate zz value
+			InterpGrid* new_gmt = new InterpGrid(GMT);
+			zz.resize((newxx.vec()).size(), 0.00);
+			(*new_gmt).estimate(&(newxx.vec()), &(newyy.vec()), &zz, 1.96, 2.00, *sdp->Lx, sdp->new_bathyGrid->getTin(), sdp->interpMethod, "", "");
+
+			//C. Find slope at grid points
+			slopes = (*new_gmt).getGrads()->getSlopeOut();
+			(*((*sdp)).slopeOut)[i] = (*slopes)(centpnt, centpnt);//*&
+
+			// clean up 
+			delete new_gmt;
+			zz.clear();
+			xx.clear();
+			yy.clear();
+			xMeshVector.clear();
+			yMeshVector.clear();
+			xt.clear();
+			yt.clear();
+			newxx.clear();
+			newyy.clear();
+			rdel.clear();
+			rdelTemp.clear();
+		} 
+	}
 
 	return SUCCESS;
 }
@@ -491,6 +522,7 @@ int scalecInterp_Process2(SCALEC_DATA_POINTER sdp, const int curIterNum, const i
 	dgrid Xiii(1,2);	// current interpolation location
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
 	perturb.kernelName = *(*sdp).kernelName;
 
 	//3. Pre-compute the weights, riVector, and aiVector across the whole interpolation plane
@@ -523,7 +555,7 @@ int scalecInterp_Process2(SCALEC_DATA_POINTER sdp, const int curIterNum, const i
 		}
 		bool KRIGING = 0;
 		//4. Compute the value
-		scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, KRIGING);
+		scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, KRIGING, NULL, &scratch);
 
 		//5. Put assn grid calculation here..... do matrix * vector math.......
 		//	put trend back into this tile
@@ -569,6 +601,7 @@ int scalecInterp_Process4A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 	dgrid Xiii(1,2);	// current interpolation location
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
 	perturb.kernelName = *(*sdp).kernelName;
 
 	//3. Pre-compute the weights, riVector, and aiVector across the whole interpolation plane
@@ -581,50 +614,54 @@ int scalecInterp_Process4A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 		//I. Begin Residual Kriging.
 		//************************************************************************************
 		//for (int i = curIterNum; i < Ni; i += numCores)
-		for (int i = curIterNum; i < (const int)(*sdp->x_idx).size(); i += numCores)
+		MB_TASK block;
+		while ((*sdp->tasks).nextTask(curIterNum, &block))
 		{
-			#pragma region --Find the Residuals at Observations
-			//************************************************************************************
-			//4. Get interpolation values at observation locations; _Compute_ForKriging
-			//************************************************************************************
-			Xiii(0,0)		= (*sdp->x0_idx)[i]; //query pts will be the input locations of which we know the value.
-			Xiii(0,1)		= (*sdp->y0_idx)[i];
-		
-			tgs1_Compute = (*sdp->x_idx)[i];	//current input x value in tile shouldn't matter cause we have an irregular grid
-			tgs2_Compute = (*sdp->y_idx)[i];
-			perturb.perturbationZ	= 0.0;
-			perturb.perturbationE	= 1.0;
-			perturb.perturbationNEi = 1.0;
-			perturb.perturbationREi = 1.0;
-			if(sdp->PROP_UNCERT)
-			{
-				perturb.perturbationZ0 = 0.0;
-				perturb.perturbationE0 = 1.0;
-			}
-			if(sdp->KALMAN)
+			for (int i = block.begin; i < block.end; i++)
 			{
-				perturb.perturbationZK = 0.0;
-				perturb.perturbationEK = 1.0;
-			}
-			vector<double> slopesVec2 = vector<double>((*sdp->subsampledData)[0].size(), 1.00);
+				#pragma region --Find the Residuals at Observations
+				//************************************************************************************
+				//4. Get interpolation values at observation locations; _Compute_ForKriging
+				//************************************************************************************
+				Xiii(0,0)		= (*sdp->x0_idx)[i]; //query pts will be the input locations of which we know the value.
+				Xiii(0,1)		= (*sdp->y0_idx)[i];
+		
+				tgs1_Compute = (*sdp->x_idx)[i];	//current input x value in tile shouldn't matter cause we have an irregular grid
+				tgs2_Compute = (*sdp->y_idx)[i];
+				perturb.perturbationZ	= 0.0;
+				perturb.perturbationE	= 1.0;
+				perturb.perturbationNEi = 1.0;
+				perturb.perturbationREi = 1.0;
+				if(sdp->PROP_UNCERT)
+				{
+					perturb.perturbationZ0 = 0.0;
+					perturb.perturbationE0 = 1.0;
+				}
+				if(sdp->KALMAN)
+				{
+					perturb.perturbationZK = 0.0;
+					perturb.perturbationEK = 1.0;
+				}
+				vector<double> slopesVec2 = vector<double>((*sdp->subsampledData)[0].size(), 1.00);
 
-			//This was the __Compute_ForKriging call but was changed to use the current _Compute function.
-			//A. Estimate the depth and errors at the observation location.
-			scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (slopesVec2)[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, sdp->KRIGING);
+				//This was the __Compute_ForKriging call but was changed to use the current _Compute function.
+				//A. Estimate the depth and errors at the observation location.
+				scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (slopesVec2)[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, sdp->KRIGING, NULL, &scratch);
 		
-			//B. Find the residual from the depth estimation and the actual value at the observation
-			(*sdp->residualObservationsKrigedZ)[i] = ((*sdp->z_idx)[i] - perturb.perturbationZ);
-			if(sdp->PROP_UNCERT)
-				(*sdp->residualObservationsKrigedZ0)[i] = ((*sdp->z_idx)[i] - perturb.perturbationZ0);
-			if(sdp->KALMAN)
-				(*sdp->residualObservationsKrigedZK)[i] = ((*sdp->z_idx)[i] - perturb.perturbationZK);
+				//B. Find the residual from the depth estimation and the actual value at the observation
+				(*sdp->residualObservationsKrigedZ)[i] = ((*sdp->z_idx)[i] - perturb.perturbationZ);
+				if(sdp->PROP_UNCERT)
+					(*sdp->residualObservationsKrigedZ0)[i] = ((*sdp->z_idx)[i] - perturb.perturbationZ0);
+				if(sdp->KALMAN)
+					(*sdp->residualObservationsKrigedZK)[i] = ((*sdp->z_idx)[i] - perturb.perturbationZK);
 
-			//Add the observation location to a tile in order to subtile to reduce complexity.
-			//subX_indexKriged.push_back((*sdp->x_idxKriged)[i]); 
-			//subY_indexKriged.push_back((*sdp->y_idxKriged)[i]);
+				//Add the observation location to a tile in order to subtile to reduce complexity.
+				//subX_indexKriged.push_back((*sdp->x_idxKriged)[i]); 
+				//subY_indexKriged.push_back((*sdp->y_idxKriged)[i]);
 		
-			//end Get interpolation values at observation locations
-			#pragma endregion
+				//end Get interpolation values at observation locations
+				#pragma endregion
+			}
 		}
 	}
 	perturbWeights.clear();
@@ -658,7 +695,8 @@ int scalecInterp_Process5A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 	vector<double> twoGammaHatVector;
 	vector<double> distanceVectorBinCenters;
 	vector<double> aVectorFine;
-	dgrid invGammaDArray;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
 	dgrid AGrid;
 
 	vector<double> outputDepthKrig;
@@ -694,28 +732,37 @@ int scalecInterp_Process5A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 		if (sdp->x_idxKriged->size() >= 15)
 		{
 			//5. We need to subtile the kriged indexes; otherwise the matrix inversion takes too long -- TODO
-			if(sdp->x_idxKriged->size() > KRIGED_SIZE_THRESHOLD)
+			if((sdp->KRIGING_NEIGHBORS == 0 && sdp->x_idxKriged->size() > KRIGED_SIZE_THRESHOLD) || (sdp->KRIGING_NEIGHBORS > 0 && (const int)sdp->x_idxKriged->size() > sdp->KRIGING_NEIGHBORS))
 			{
 				#pragma region --Subtile Kriged Indices
 				
 				//Too large, need to subtile.
 				//6. Krige the residuals
 				//_PreComputeTile calls _PostCompute from within
-				ordinaryKrigingOfResiduals_PreComputeTile(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
+				if(sdp->KRIGING_NEIGHBORS > 0)
+					ordinaryKrigingOfResiduals_Local(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepthKrig, &outputErrorKrig);
+				else
+					ordinaryKrigingOfResiduals_PreComputeTile(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
 
 				sdp->outData->depth = outputDepthKrig;
 				sdp->outData->error = outputErrorKrig;
 
 				if(sdp->PROP_UNCERT)
 				{
-					ordinaryKrigingOfResiduals_PreComputeTile(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
+					if(sdp->KRIGING_NEIGHBORS > 0)
+						ordinaryKrigingOfResiduals_Local(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepth0Krig, &outputError0Krig);
+					else
+						ordinaryKrigingOfResiduals_PreComputeTile(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
 				
 					sdp->outData->depth0 = outputDepth0Krig;
 					sdp->outData->error0 = outputError0Krig;
 				}
 				if(sdp->KALMAN)
 				{
-					ordinaryKrigingOfResiduals_PreComputeTile(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+					if(sdp->KRIGING_NEIGHBORS > 0)
+						ordinaryKrigingOfResiduals_Local(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepthKKrig, &outputErrorKKrig);
+					else
+						ordinaryKrigingOfResiduals_PreComputeTile(&*sdp->x_idxKriged, &*sdp->y_idxKriged, sdp->residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
 
 					sdp->outData->depthK = outputDepthKKrig;
 					sdp->outData->errorK = outputErrorKKrig;
@@ -726,11 +773,11 @@ int scalecInterp_Process5A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 			{
 				#pragma region --Do Not Subtile Kriged Indices
 				//small enough to do all at once
-				ordinaryKrigingOfResiduals_PreCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+				ordinaryKrigingOfResiduals_PreCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 				if(sdp->PROP_UNCERT)
-					ordinaryKrigingOfResiduals_PreCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+					ordinaryKrigingOfResiduals_PreCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 				if(sdp->KALMAN)
-					ordinaryKrigingOfResiduals_PreCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+					ordinaryKrigingOfResiduals_PreCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 
 				//6. Krige the residuals
 				for (int i = 0; i < (const int)(*sdp->xInterpVector).size(); i++)
@@ -741,7 +788,7 @@ int scalecInterp_Process5A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 					zKriged = 0.00;
 					varZKriged = 0.00;
 					
-					ordinaryKrigingOfResiduals_PostCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKriged, &varZKriged);
+					ordinaryKrigingOfResiduals_PostCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKriged, &varZKriged);
 					
 					sdp->outData->depth[i] = zKriged;
 					sdp->outData->error[i] = varZKriged;
@@ -750,7 +797,7 @@ int scalecInterp_Process5A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 					{
 						z0Kriged = 0.00;
 						varZ0Kriged = 0.00;
-						ordinaryKrigingOfResiduals_PostCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &z0Kriged, &varZ0Kriged);
+						ordinaryKrigingOfResiduals_PostCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &z0Kriged, &varZ0Kriged);
 						
 						sdp->outData->depth0[i] = z0Kriged;
 						sdp->outData->error0[i] = varZ0Kriged;
@@ -759,7 +806,7 @@ int scalecInterp_Process5A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 					{
 						zKKriged = 0.00;
 						varZKKriged = 0.00;
-						ordinaryKrigingOfResiduals_PostCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKKriged, &varZKKriged);
+						ordinaryKrigingOfResiduals_PostCompute(sdp->x_idxKriged, sdp->y_idxKriged, sdp->residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKKriged, &varZKKriged);
 						
 						sdp->outData->depthK[i] = zKKriged;
 						sdp->outData->errorK[i] = varZKKriged;
@@ -768,7 +815,8 @@ int scalecInterp_Process5A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 				twoGammaHatVector.clear();
 				distanceVectorBinCenters.clear();
 				aVectorFine.clear();
-				invGammaDArray.clear();
+				luGammaDArray.clear();
+				gammaDPivots.clear();
 				AGrid.clear();
 				#pragma endregion
 			}
@@ -809,6 +857,7 @@ int scalecInterp_Process6A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 	dgrid Xiii(1,2);	// current interpolation location
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
 	perturb.kernelName = *(*sdp).kernelName;
 
 	vector<double> xIndexKriged_Vector;
@@ -824,55 +873,59 @@ int scalecInterp_Process6A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 	vector <double> perturbWeights(sdp->z_idx->size(),2);
 	scalecInterpPerturbations_PreCompute(sdp->z_idx, sdp->e_idx, &perturbWeights, &perturb);
 
-	for (int i = curIterNum; i < Ni; i += numCores)
+	MB_TASK block;
+	while ((*sdp->tasks).nextTask(curIterNum, &block))
 	{
-		//tgs1 = xIndexKriged_Vector[i];			//shouldn't use this because we have an irregular grid? same as xInterpsLocs0 and xInterpVector
-		//tgs2 = yIndexKriged_Vector[i];			//get current yValue
+		for (int i = block.begin; i < block.end; i++)
+		{
+			//tgs1 = xIndexKriged_Vector[i];			//shouldn't use this because we have an irregular grid? same as xInterpsLocs0 and xInterpVector
+			//tgs2 = yIndexKriged_Vector[i];			//get current yValue
 
-		tgs1			= (*sdp->xInterpVector)[i];		//get current xValue
-		tgs2			= (*sdp->yInterpVector)[i];		//get current yValue
-		tgs1_Compute	= tgs1 * (*sdp->Lx);			//scale xValue
-		tgs2_Compute	= tgs2 * (*sdp->Ly);			//scale yValue
-		Xiii(0,0)		= (*sdp->xInterpLocs0)[i];
-		Xiii(0,1)		= (*sdp->yInterpLocs0)[i];
+			tgs1			= (*sdp->xInterpVector)[i];		//get current xValue
+			tgs2			= (*sdp->yInterpVector)[i];		//get current yValue
+			tgs1_Compute	= tgs1 * (*sdp->Lx);			//scale xValue
+			tgs2_Compute	= tgs2 * (*sdp->Ly);			//scale yValue
+			Xiii(0,0)		= (*sdp->xInterpLocs0)[i];
+			Xiii(0,1)		= (*sdp->yInterpLocs0)[i];
 
-		//Initialize output fields
-		perturb.perturbationZ = 0.0;
-		perturb.perturbationE = 1.0;
-		perturb.perturbationNEi = 1.0;
-		perturb.perturbationREi = 1.0;
-		if(sdp->PROP_UNCERT)
-		{
-			perturb.perturbationZ0 = 0.0;
-			perturb.perturbationE0 = 1.0;
-		}
-		if(sdp->KALMAN)
-		{
-			perturb.perturbationZK = 0.0;
-			perturb.perturbationEK = 1.0;
-		}
+			//Initialize output fields
+			perturb.perturbationZ = 0.0;
+			perturb.perturbationE = 1.0;
+			perturb.perturbationNEi = 1.0;
+			perturb.perturbationREi = 1.0;
+			if(sdp->PROP_UNCERT)
+			{
+				perturb.perturbationZ0 = 0.0;
+				perturb.perturbationE0 = 1.0;
+			}
+			if(sdp->KALMAN)
+			{
+				perturb.perturbationZK = 0.0;
+				perturb.perturbationEK = 1.0;
+			}
 		
-		//4. Compute the value
-		scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, 0);//0 because were not kriging the residuals here... that's done above
-
-		//5. Put assn grid calculation here..... do matrix * vector math.......
-		//	put trend back into this tile
-		assnGridValue = tgs0*(*sdp->btrend)[0]+tgs1*(*sdp->btrend)[1]+tgs2*(*sdp->btrend)[2];		
-		(*sdp->outData).depth[i] += perturb.perturbationZ + assnGridValue;// + outDepthKrig;
-		(*sdp->outData).error[i] += perturb.perturbationE;// + outErrorKrig;
-		(*sdp->outData).nEi[i] = perturb.perturbationNEi;
-		(*sdp->outData).rEi[i] = perturb.perturbationREi;
-		(*sdp->outData).standardDev[i] = perturb.standardDev2;
-		if(sdp->PROP_UNCERT)
-		{
-			(*sdp->outData).depth0[i] += perturb.perturbationZ0 + assnGridValue;// + outDepth0Krig;
-			(*sdp->outData).error0[i] += perturb.perturbationE0;// + outError0Krig;
-		//	(*sdp->outData).standardDev0[i] = perturb.standardDev20;
-		}
-		if(sdp->KALMAN)
-		{
-			(*sdp->outData).depthK[i] += perturb.perturbationZK + assnGridValue;// + outDepthKKrig;
-			(*sdp->outData).errorK[i] += perturb.perturbationEK;// + outErrorKKrig;
+			//4. Compute the value
+			scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, 0, NULL, &scratch);//0 because were not kriging the residuals here... that's done above
+
+			//5. Put assn grid calculation here..... do matrix * vector math.......
+			//	put trend back into this tile
+			assnGridValue = tgs0*(*sdp->btrend)[0]+tgs1*(*sdp->btrend)[1]+tgs2*(*sdp->btrend)[2];		
+			(*sdp->outData).depth[i] += perturb.perturbationZ + assnGridValue;// + outDepthKrig;
+			(*sdp->outData).error[i] += perturb.perturbationE;// + outErrorKrig;
+			(*sdp->outData).nEi[i] = perturb.perturbationNEi;
+			(*sdp->outData).rEi[i] = perturb.perturbationREi;
+			(*sdp->outData).standardDev[i] = perturb.standardDev2;
+			if(sdp->PROP_UNCERT)
+			{
+				(*sdp->outData).depth0[i] += perturb.perturbationZ0 + assnGridValue;// + outDepth0Krig;
+				(*sdp->outData).error0[i] += perturb.perturbationE0;// + outError0Krig;
+			//	(*sdp->outData).standardDev0[i] = perturb.standardDev20;
+			}
+			if(sdp->KALMAN)
+			{
+				(*sdp->outData).depthK[i] += perturb.perturbationZK + assnGridValue;// + outDepthKKrig;
+				(*sdp->outData).errorK[i] += perturb.perturbationEK;// + outErrorKKrig;
+			}
 		}
 	}
 	perturbWeights.clear();
@@ -902,6 +955,7 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 	dgrid Xiii(1,2);	// current interpolation location
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
 	perturb.kernelName = *(*sdp).kernelName;
 
 	//Initialize some variables
@@ -934,7 +988,8 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 	vector<double> twoGammaHatVector;
 	vector<double> distanceVectorBinCenters;
 	vector<double> aVectorFine;
-	dgrid invGammaDArray;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
 	dgrid AGrid;
 
 	vector<double> outputDepthKrig;
@@ -1005,7 +1060,7 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 		bool KRIGING = 0;
 		//This was the __Compute_ForKriging call but was changed to use the current _Compute function.
 		//A. Estimate the depth and errors at the observation location.
-		scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, KRIGING);
+		scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, KRIGING, NULL, &scratch);
 		
 		//B. Find the residual from the depth estimation and the actual value at the observation
 		residualObservationsKrigedZ.push_back((*sdp->z_idx)[i] - perturb.perturbationZKriged);
@@ -1027,29 +1082,42 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 		if (subX_indexKriged.size() >= 15)
 		{
 			//5. We need to subtile the kriged indexes; otherwise the matrix inversion takes too long -- TODO
-			if(subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD)
+			if((sdp->KRIGING_NEIGHBORS == 0 && subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD) || (sdp->KRIGING_NEIGHBORS > 0 && (const int)subX_indexKriged.size() > sdp->KRIGING_NEIGHBORS))
 			{
 				#pragma region --Subtile Kriged Indices
 				//Too large, need to subtile.
 				//6. Krige the residuals
 				//_PreComputeTile calls _PostCompute from within
-				ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
+				if(sdp->KRIGING_NEIGHBORS > 0)
+					ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepthKrig, &outputErrorKrig);
+				else
+					ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
 
 				if(sdp->PROP_UNCERT)
-					ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
+				{
+					if(sdp->KRIGING_NEIGHBORS > 0)
+						ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepth0Krig, &outputError0Krig);
+					else
+						ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
+				}
 				if(sdp->KALMAN)
-					ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+				{
+					if(sdp->KRIGING_NEIGHBORS > 0)
+						ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepthKKrig, &outputErrorKKrig);
+					else
+						ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+				}
 				#pragma endregion
 			}
 			else
 			{
 				#pragma region --Do Not Subtile Kriged Indices
 				//small enough to do all at once
-				ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+				ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 				if(sdp->PROP_UNCERT)
-					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 				if(sdp->KALMAN)
-					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 
 				//6. Krige the residuals
 				for (int i = 0; i < (const int)(*sdp->xInterpVector).size(); i++)
@@ -1060,7 +1128,7 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 					zKriged = 0.00;
 					varZKriged = 0.00;
 					
-					ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKriged, &varZKriged);
+					ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKriged, &varZKriged);
 					outputDepthKrig[i] = zKriged;
 					outputErrorKrig[i] = varZKriged;
 	
@@ -1068,7 +1136,7 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 					{
 						z0Kriged = 0.00;
 						varZ0Kriged = 0.00;
-						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &z0Kriged, &varZ0Kriged);
+						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &z0Kriged, &varZ0Kriged);
 						outputDepth0Krig[i] = z0Kriged;
 						outputError0Krig[i] = varZ0Kriged;
 					}
@@ -1076,7 +1144,7 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 					{
 						zKKriged = 0.00;
 						varZKKriged = 0.00;
-						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKKriged, &varZKKriged);
+						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKKriged, &varZKKriged);
 						outputDepthKKrig[i] = zKKriged;
 						outputErrorKKrig[i] = varZKKriged;
 					}
@@ -1084,7 +1152,8 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 				twoGammaHatVector.clear();
 				distanceVectorBinCenters.clear();
 				aVectorFine.clear();
-				invGammaDArray.clear();
+				luGammaDArray.clear();
+				gammaDPivots.clear();
 				AGrid.clear();
 				#pragma endregion
 			}
@@ -1121,7 +1190,7 @@ int scalecInterp_ProcessKrig(SCALEC_DATA_POINTER sdp, const int curIterNum, cons
 
 			bool KRIGING = 0;
 			//7. Compute the value
-			scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, KRIGING);
+			scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, KRIGING, NULL, &scratch);
 
 			//8. Put assn grid calculation here..... do matrix * vector math.......
 			//put trend back into this tile
@@ -1561,6 +1630,7 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 	dgrid Xiii(1,2);	// current interpolation location
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
 	perturb.kernelName = *(*sdp).kernelName;
 
 	//Initialize kriging structures
@@ -1587,7 +1657,8 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 	vector<double> twoGammaHatVector;
 	vector<double> distanceVectorBinCenters;
 	vector<double> aVectorFine;
-	dgrid invGammaDArray;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
 	dgrid AGrid;
 
 	vector<double> outputDepthKrig;
@@ -1652,7 +1723,7 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 
 			//This was the __Compute_ForKriging call but was changed to use the current _Compute function.
 			//A. Estimate the depth and errors at the observation location.
-			scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (slopesVec2)[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, sdp->KRIGING);
+			scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (slopesVec2)[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, sdp->KRIGING, NULL, &scratch);
 		
 			//B. Find the residual from the depth estimation and the actual value at the observation
 			residualObservationsKrigedZ.push_back((*sdp->z_idx)[i] - perturb.perturbationZKriged);
@@ -1674,29 +1745,42 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 		if (subX_indexKriged.size() >= 15)
 		{
 			//5. We need to subtile the kriged indexes; otherwise the matrix inversion takes too long -- TODO
-			if(subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD)
+			if((sdp->KRIGING_NEIGHBORS == 0 && subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD) || (sdp->KRIGING_NEIGHBORS > 0 && (const int)subX_indexKriged.size() > sdp->KRIGING_NEIGHBORS))
 			{
 				#pragma region --Subtile Kriged Indices
 				//Too large, need to subtile.
 				//6. Krige the residuals
 				//_PreComputeTile calls _PostCompute from within
-				ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
+				if(sdp->KRIGING_NEIGHBORS > 0)
+					ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepthKrig, &outputErrorKrig);
+				else
+					ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
 
 				if(sdp->PROP_UNCERT)
-					ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
+				{
+					if(sdp->KRIGING_NEIGHBORS > 0)
+						ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepth0Krig, &outputError0Krig);
+					else
+						ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
+				}
 				if(sdp->KALMAN)
-					ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+				{
+					if(sdp->KRIGING_NEIGHBORS > 0)
+						ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, sdp->KRIGING_NEIGHBORS, &outputDepthKKrig, &outputErrorKKrig);
+					else
+						ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+				}
 				#pragma endregion
 			}
 			else
 			{
 				#pragma region --Do Not Subtile Kriged Indices
 				//small enough to do all at once
-				ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+				ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 				if(sdp->PROP_UNCERT)
-					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 				if(sdp->KALMAN)
-					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+					ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 
 				//6. Krige the residuals
 				for (int i = 0; i < (const int)(*sdp->xInterpVector).size(); i++)
@@ -1707,7 +1791,7 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 					zKriged = 0.00;
 					varZKriged = 0.00;
 					
-					ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKriged, &varZKriged);
+					ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKriged, &varZKriged);
 					outputDepthKrig[i] = zKriged;
 					outputErrorKrig[i] = varZKriged;
 	
@@ -1715,7 +1799,7 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 					{
 						z0Kriged = 0.00;
 						varZ0Kriged = 0.00;
-						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &z0Kriged, &varZ0Kriged);
+						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &z0Kriged, &varZ0Kriged);
 						outputDepth0Krig[i] = z0Kriged;
 						outputError0Krig[i] = varZ0Kriged;
 					}
@@ -1723,7 +1807,7 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 					{
 						zKKriged = 0.00;
 						varZKKriged = 0.00;
-						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKKriged, &varZKKriged);
+						ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &zKKriged, &varZKKriged);
 						outputDepthKKrig[i] = zKKriged;
 						outputErrorKKrig[i] = varZKKriged;
 					}
@@ -1731,7 +1815,8 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 				twoGammaHatVector.clear();
 				distanceVectorBinCenters.clear();
 				aVectorFine.clear();
-				invGammaDArray.clear();
+				luGammaDArray.clear();
+				gammaDPivots.clear();
 				AGrid.clear();
 				#pragma endregion
 			}
@@ -1801,7 +1886,7 @@ int scalecInterp_Process2A(SCALEC_DATA_POINTER sdp, const int curIterNum, const
 		}
 
 		//4. Compute the value
-		scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, 0);//0 because were not kriging the residuals here... that's done above
+		scalecInterpPerturbations_Compute(sdp->x_idx, sdp->y_idx, sdp->z_idx, sdp->e_idx, sdp->h_idx, sdp->v_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*sdp->neitol), dmin, (*(sdp->slopeOut))[i], sdp->x0_idx, sdp->y0_idx, &Xiii, &perturb, sdp->MSE, sdp->PROP_UNCERT, sdp->KALMAN, 0, NULL, &scratch);//0 because were not kriging the residuals here... that's done above
 
 		//5. Put assn grid calculation here..... do matrix * vector math.......
 		//	put trend back into this tile
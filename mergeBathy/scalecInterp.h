@@ -107,8 +107,28 @@ int scalecInterpTile(vector< std::vector<double> > *subsampledData, dgrid *xMesh
 * @param numCores - The number of total cores processing the data.  1 on single threaded runs.
 * return Success or failure value.
 */int scalecInterpTile_Process(SCALEC_TILE_DATA_POINTER stdp, const int curIterNum, const int numCores);
+
+/**
+* Processes the (outerLoop, innerLoop) tiles handed out by stdp->tasks, which are passed to scalecInterpPerturbations (which does not remove any trend).
+* Used for data runs with or without kriging.  The tiles must be queued with scalecInterpTile_ScheduleTiles first.
+* @param stdp - A SCALEC_TILE_DATA_POINTER for the input data structures.
+* @param curIterNum - The current core number.  0 on single threaded runs.
+* @param numCores - The number of total cores processing the data.  1 on single threaded runs.
+* return Success or failure value.
+*/
 int scalecInterpTile_ProcessA(SCALEC_TILE_DATA_POINTER stdp, const int curIterNum, const int numCores);
 
+/**
+* Splits the interpolation grid into (outerLoop, innerLoop) tiles and queues every tile holding enough data to interpolate.
+* Each tile's cost is estimated from the number of subsampled points it pulls in times the number of grid nodes it covers, so the most expensive tiles are started first.
+* @param stdp - A SCALEC_TILE_DATA_POINTER for the input data structures.
+* @param outerLoopIndexVectors - Vector of vectors of the X indices to interpolate in each tile column. (Returned).
+* @param outerLoopIdx - Vector of vectors of the subsampled data indices that fall within each tile column and its overlap. (Returned).
+* @param tasks - Queue to fill with the tiles. (Returned).
+* return Success or failure value.
+*/
+int scalecInterpTile_ScheduleTiles(SCALEC_TILE_DATA_POINTER stdp, vector< vector<int> > *outerLoopIndexVectors, vector< vector<int> > *outerLoopIdx, mbTaskQueue *tasks);
+
 
 /**
 * Catches regular grid output and breaks into bite-size tiles, which are passed to scalecInterpPerturbations (which does not remove any trend).  Used in when Kriging is being done.
@@ -1,6 +1,8 @@
 #include "scalecInterp.h"
 #include "regr_xzw.h"
 #include "standardOperations.h"
+#include "perturbationKernels.h"
+#include "ALG/fasttransforms.h"
 #include <fstream>
 #include <time.h>
 #include <math.h>
@@ -30,6 +32,96 @@ double interp1(double x, const vector<double> *xi, const vector<double> *yi){
 	return y;
 }
 
+double interp1Uniform(double x, const vector<double> *xi, const vector<double> *yi, double xOrigin, double xInverseStep){
+	const int last = (const int)(*xi).size() - 1;
+	int j;
+
+	//A. if x is outside the xi[] interval take a boundary value (left or right)
+	if (x <= (*xi)[0])
+		return (*yi)[0];
+	if (x >= (*xi)[last])
+		return (*yi)[last];
+
+	//B. Index the bracket from the spacing, then step to the first x[j] >= x as interp1 finds it,
+	//	since the table was built by adding up the spacing and is not exactly uniform.
+	j = (int)ceil((x - xOrigin) * xInverseStep);
+	if (j < 1)
+		j = 1;
+	else if (j > last)
+		j = last;
+	while ((j > 1) && ((*xi)[j-1] >= x))
+		j = j - 1;
+	while ((*xi)[j] < x)
+		j = j + 1;
+	return (*yi)[j-1] + ((*yi)[j] - (*yi)[j-1])*(x - (*xi)[j-1])/((*xi)[j]-(*xi)[j-1]);
+}
+
+//************************************************************************************
+// SUBROUTINE I.A: Window weights specialized on the kernel type.
+//************************************************************************************
+//Weight of the window at a radius x normalized by the smoothing scale.
+template<int KERNEL> static inline double windowWeight(double x, const PERTURBS *perturb){
+	return interp1Uniform(x, &(*perturb).riVector, &(*perturb).aiVector, (*perturb).riOrigin, (*perturb).riInverseStep);
+}
+
+//The boxcar table is all ones.
+template<> inline double windowWeight<KERNEL_BOXCAR>(double x, const PERTURBS *perturb){
+	return 1.0;
+}
+
+//Find the points inside the window of scale p and their weights, step II.A of scalecInterpPerturbations_Compute.
+//The depths and errors of the points are gathered alongside their weights so that the
+//reductions of scalecInterpPerturbations_Compute run over contiguous buffers.
+template<int KERNEL> static void windowWeights(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, double xGridValue, double yGridValue, const vector<double> *weights, const vector<double> *r, double p, const PERTURBS *perturb, const spatialIndex *dataIndex, vector<int> *nearIdx, vector<int> *aid, vector<double> *nWeights, vector<double> *nWeights0, vector<double> *nDepths, vector<double> *nErrors, double *sumNormWeights_init)
+{
+	double sumCount, valueCalculated1, valueCalculated2;
+	double rCompute, rCompute0;
+
+	if (dataIndex != NULL)
+	{
+		//Only visit the points within reach of the window. The index returns
+		//them in ascending order so aid matches the full scan exactly.
+		(*dataIndex).radiusQuery(xGridValue, yGridValue, p, nearIdx);
+		for (int k = 0; k < (const int)(*nearIdx).size(); k++){
+			int j = (*nearIdx)[k];
+			sumCount = 0;
+			valueCalculated1 = ((*subDataX)[j]) - (xGridValue);
+			valueCalculated2 = ((*subDataY)[j]) - (yGridValue);
+			sumCount += pow(valueCalculated1,2);
+			sumCount += pow(valueCalculated2,2);
+			double rj = sqrt(sumCount);
+			if (rj < p){
+				rCompute0 = windowWeight<KERNEL>((rj / p), perturb);
+				rCompute = rCompute0 * (*weights)[j]; 
+				(*aid).push_back(j); 
+				(*nWeights).push_back(rCompute); 
+				(*nWeights0).push_back(rCompute0); 
+				(*nDepths).push_back((*subDataZ)[j]);
+				(*nErrors).push_back((*subDataE)[j]);
+				(*sumNormWeights_init) = (*sumNormWeights_init) + rCompute;
+			}
+		}
+	}
+	else
+	{
+		//Select the points inside the window a vector of distances at a time, then weight them.
+		(*nearIdx).clear();
+		if (!(*r).empty())
+			windowSelect(&(*r)[0], (const int)(*r).size(), p, nearIdx);
+		for (int k = 0; k < (const int)(*nearIdx).size(); k++){
+			int j = (*nearIdx)[k];
+			rCompute0 = windowWeight<KERNEL>(((*r)[j] / p), perturb);
+			rCompute = rCompute0 * (*weights)[j]; 
+			(*aid).push_back(j); 
+			(*nWeights).push_back(rCompute); 
+			(*nWeights0).push_back(rCompute0); 
+			(*nDepths).push_back((*subDataZ)[j]);
+			(*nErrors).push_back((*subDataE)[j]);
+			(*sumNormWeights_init) = (*sumNormWeights_init) + rCompute;
+		}
+	}
+}
+
 //************************************************************************************
 // SUBROUTINE II: Function call for doing loess weighting.
 // This function was just transplanted from the old version of
@@ -250,6 +342,7 @@ void scalecInterpPerturbations_PreCompute(const vector<double> *subDataZ, const
 	//************************************************************************************
 	if ((*perturb).kernelName== "hanning" || (*perturb).kernelName == "hann"){
 		double rItem = 0;
+		(*perturb).kernelType = KERNEL_HANN;
 		(*perturb).riVector = vector<double>((int)((RMAX + DR) / DR) + 1, 0);
 		(*perturb).aiVector = vector<double>((int)((RMAX + DR) / DR) + 1, 0);
 
@@ -275,6 +368,7 @@ void scalecInterpPerturbations_PreCompute(const vector<double> *subDataZ, const
 	//B. Boxcar window
 	}else if ((*perturb).kernelName == "boxcar"){
 		double rItem = 0;
+		(*perturb).kernelType = KERNEL_BOXCAR;
 		(*perturb).riVector = vector<double>((int)((RMAX + DR) / DR) + 1, 0);
 		(*perturb).aiVector = vector<double>((int)((RMAX + DR) / DR) + 1, 1);
 
@@ -288,6 +382,7 @@ void scalecInterpPerturbations_PreCompute(const vector<double> *subDataZ, const
 		(*perturb).aiVector = vector<double>((int)((RMAX + DR) / DR) + 1, 1);
 
 		loessKernel(2, 2, &(*perturb).riVector, &(*perturb).aiVector);
+		(*perturb).kernelType = KERNEL_QUADLOESS;
 
 	//D. Linear loess window
 	}else if ((*perturb).kernelName == "loess"){//linloess
@@ -295,6 +390,7 @@ void scalecInterpPerturbations_PreCompute(const vector<double> *subDataZ, const
 		(*perturb).aiVector = vector<double>((int)((RMAX + DR) / DR) + 1, 1);
 
 		loessKernel(2, 1, &(*perturb).riVector, &(*perturb).aiVector);
+		(*perturb).kernelType = KERNEL_LOESS;
 
 	//E. Error message
 	}else{
@@ -302,24 +398,41 @@ void scalecInterpPerturbations_PreCompute(const vector<double> *subDataZ, const
 		printf("Aborting data run.\n");
 		exit(1);
 	}
+
+	//F. The spacing interp1Uniform indexes the table with.  The hann, boxcar and gaussian tables are
+	//	uniform throughout.  loessKernel only fills the first entries, -1.05 to 1.05 by 0.05, and the rest
+	//	of the table keeps its fill of 1, so the spacing is taken from the increasing run at the start.
+	int populated = 1;
+	while (populated < (const int)(*perturb).riVector.size() && (*perturb).riVector[populated] > (*perturb).riVector[populated - 1])
+		populated++;
+	(*perturb).riOrigin = (*perturb).riVector[0];
+	(*perturb).riInverseStep = (double)(populated - 1) / ((*perturb).riVector[populated - 1] - (*perturb).riVector[0]);
 }
 
 //************************************************************************************
 // SUBROUTINE IV: Primary computation routine.
 //************************************************************************************
-void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, double *xGridValue, double *yGridValue, const vector<double> *weights, const double neitol, double dmin, double slope, const vector<double> *subDataX0, const vector<double> *subDataY0, dgrid *Xiii, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, bool KRIGING)
+void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, double *xGridValue, double *yGridValue, const vector<double> *weights, const double neitol, double dmin, double slope, const vector<double> *subDataX0, const vector<double> *subDataY0, dgrid *Xiii, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, bool KRIGING, const spatialIndex *dataIndex, PERTURB_SCRATCH *scratch)
 {
 	//************************************************************************************
 	// 0. Declare local variables and objects
 	//************************************************************************************
 	int count;
 	const int idySize = (const int)(*subDataX).size();
-	vector<int> aid; 
-	vector<double> nWeights;	//a 
-	vector<double> nWeights0;	//a0 
-	vector<double> r = vector<double>(idySize, 0.00);
-	vector<double> rx0;
-	vector<double> newrx0;
+
+	//Work in the caller's buffers when given so the node does not allocate.
+	PERTURB_SCRATCH localScratch;
+	if (scratch == NULL)
+		scratch = &localScratch;
+	vector<int> &aid = (*scratch).aid; 
+	vector<double> &nWeights = (*scratch).nWeights;		//a 
+	vector<double> &nWeights0 = (*scratch).nWeights0;	//a0 
+	vector<double> &nDepths = (*scratch).nDepths;		//depths of the points in aid
+	vector<double> &nErrors = (*scratch).nErrors;		//errors of the points in aid
+	vector<double> &r = (*scratch).r;
+	vector<int> &nearIdx = (*scratch).nearIdx;			//candidates returned by dataIndex
+	vector<double> &rx0 = (*scratch).rx0;
+	vector<double> &newrx0 = (*scratch).newrx0;
 
 	double p;
 	double q;
@@ -329,9 +442,9 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 	double sumNormWeights_init;	//suma
 	double sumNormWeights;
 	double valueCalculated1, valueCalculated2;
-	double rCompute, rCompute0;
 	double matMultValue, matMultValue2;
-	vector<double> grow;
+	double sumDepths = 0.0;
+	vector<double> &grow = (*scratch).grow;
 
 	//Safety Check vU and hU
 	if((*subDataV).empty())
@@ -345,24 +458,21 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 		cerr << "scalecInterpPerturbations Error: hU is wrong size.";
 
 	//************************************************************************************
-	//I. Begin interpolation loop over the Ni interpolation points. Establish the values to be used in r
+	//I. Begin interpolation loop over the Ni interpolation points. Establish the values to be used in r.
+	//	With a spatial index r is only computed for the points gathered in each pass below.
 	//************************************************************************************
-	for (int j = 0; j < idySize; j++)
+	r.clear();
+	rx0.clear();
+	newrx0.clear();
+	if ((dataIndex == NULL) && (idySize > 0))
 	{
-		sumCount = 0;
-		valueCalculated1 = ((*subDataX)[j]) - ((*xGridValue));
-		valueCalculated2 = ((*subDataY)[j]) - ((*yGridValue));
-		sumCount += pow(valueCalculated1,2);
-		sumCount += pow(valueCalculated2,2);
-		r[j] = sqrt(sumCount);
+		r.resize(idySize);
+		windowDistances(&(*subDataX)[0], &(*subDataY)[0], idySize, (*xGridValue), (*yGridValue), &r[0]);
 	}
 
 	count = 0;
 	naTmp = 0;
 	na = 0;
-	aid = vector<int>();
-	nWeights = vector<double>();
-	nWeights0 = vector<double>();
 
 	//************************************************************************************
 	//II. THIS PART IS IMPORTANT! We must expand smoothing scales if error
@@ -379,6 +489,8 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 		aid.clear();
 		nWeights.clear();
 		nWeights0.clear();
+		nDepths.clear();
+		nErrors.clear();
 		if(KRIGING)
 			count = count + 1;
 		p = pow(2.00,count);
@@ -387,17 +499,20 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 		sumNormWeights = 0.0;
 		sumNormWeights_init = 0;
 		matMultValue = 0.0;
+		sumDepths = 0.0;
 
 		//A. Find the weights inside the linear regression
-		for (int j = 0; j < idySize; j++){
-			if (r[j] < p){
-				rCompute0 = interp1((r[j] / p), &(*perturb).riVector, &(*perturb).aiVector);
-				rCompute = rCompute0 * (*weights)[j]; 
-				aid.push_back(j); 
-				nWeights.push_back(rCompute); 
-				nWeights0.push_back(rCompute0); 
-				sumNormWeights_init = sumNormWeights_init + rCompute;
-			}
+		switch ((*perturb).kernelType)
+		{
+		case KERNEL_BOXCAR:
+			windowWeights<KERNEL_BOXCAR>(subDataX, subDataY, subDataZ, subDataE, (*xGridValue), (*yGridValue), weights, &r, p, perturb, dataIndex, &nearIdx, &aid, &nWeights, &nWeights0, &nDepths, &nErrors, &sumNormWeights_init);
+			break;
+		case KERNEL_HANN:
+			windowWeights<KERNEL_HANN>(subDataX, subDataY, subDataZ, subDataE, (*xGridValue), (*yGridValue), weights, &r, p, perturb, dataIndex, &nearIdx, &aid, &nWeights, &nWeights0, &nDepths, &nErrors, &sumNormWeights_init);
+			break;
+		default:
+			windowWeights<KERNEL_LOESS>(subDataX, subDataY, subDataZ, subDataE, (*xGridValue), (*yGridValue), weights, &r, p, perturb, dataIndex, &nearIdx, &aid, &nWeights, &nWeights0, &nDepths, &nErrors, &sumNormWeights_init);
+			break;
 		}
 		na = (const int)aid.size(); 
 
@@ -406,22 +521,9 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 		if (na == 0)
 			continue;
 
-		//B. Normalize if we have some weights
-		if (abs(sumNormWeights_init) > 0) 
-		{
-			for (int j = 0; j < (const int)na; j++){
-				nWeights[j] /= sumNormWeights_init;
-				sumNormWeights += nWeights[j];
-				matMultValue = matMultValue + nWeights[j] * nWeights[j]; //nmsei
-			}
-		}else
-		{
-			//weights not normalized
-			for (int j = 0; j < (const int)na; j++){
-				sumNormWeights += nWeights[j];
-				matMultValue = matMultValue + nWeights[j] * nWeights[j];
-			}
-		}
+		//B. Normalize if we have some weights, otherwise the weights are not normalized.
+		//	The weighted depth of step III is summed in the same pass.
+		windowNormalize(&nWeights[0], &nDepths[0], na, (abs(sumNormWeights_init) > 0) ? sumNormWeights_init : 1.0, &sumNormWeights, &matMultValue, &sumDepths); //nmsei
 
 		//C. Check weights for error calculations. NP note: actual error is
 		//	the noised passed (nmsei*s) + signal reduced (1-nmsei)*s. In the
@@ -460,7 +562,7 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 			cerr<<"newrx0 is empty!!"<<endl;
 		else dmin = median(newrx0);
 
-	grow = vector<double>((*subDataE).size(),1);
+	grow.assign(na, 1);
 	double tempVal = 0.0;
 	double matMultVal3 = 0.0;
 
@@ -471,12 +573,8 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 		//	depths.  This is a matrix multiplication operation, so we need C-code
 		//for doing that.
 		//************************************************************************************
-		matMultValue = 0;
-		for (int j = 0; j < (const int)na; j++)
-		{
-			matMultValue += ((*subDataZ)[aid[j]]  *  nWeights[j]);
-		}
-		(*perturb).perturbationZ = matMultValue; 
+		//	Summed with the normalization in step II.B.
+		(*perturb).perturbationZ = sumDepths; 
 
 		//Linear estimators hann, loess, quadloess, boxcar
 		if(PROP_UNCERT)
@@ -509,15 +607,7 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 			if (  ( (*perturb).perturbationNEi < 1 ) && ( na > 0 )  )
 			{
 				//B. Calculate weighted residuals
-				matMultValue = 0;
-				matMultValue2 = 0;
-
-				for (int j = 0; j < (const int)na; j++)
-				{
-					sumCount = ((*subDataZ)[aid[j]] -  (*perturb).perturbationZ)  *  nWeights[j]; 
-					matMultValue = matMultValue + sumCount*sumCount; 
-					matMultValue2 = matMultValue2 + (nWeights[j] * (*subDataE)[ aid[j] ] );
-				}
+				windowResiduals(&nWeights[0], &nDepths[0], &nErrors[0], na, (*perturb).perturbationZ, &matMultValue, &matMultValue2);
 
 				//C. Calculate weighted mean square residual, msri
 				(*perturb).perturbationREi = matMultValue / (*perturb).perturbationNEi;
@@ -610,6 +700,8 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 	aid.clear();
 	nWeights.clear();
 	nWeights0.clear();
+	nDepths.clear();
+	nErrors.clear();
 	grow.clear();
 	rx0.clear();
 	newrx0.clear();
@@ -618,6 +710,695 @@ void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vec
 }
 
 
+//************************************************************************************
+// SUBROUTINE IV.A: Point-centric version of SUBROUTINE IV over every node of a tile.
+//************************************************************************************
+//Sweep the data points once and record every (point, node) pair inside the first window,
+//with its window weight, in point order.  Each node's sum of weights is accumulated in the
+//order scalecInterpPerturbations_Compute gathers its points.
+template<int KERNEL> static void splatWeights(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *nodeX, const vector<double> *nodeY, const vector<double> *weights, double p, const PERTURBS *perturb, const spatialIndex *nodeIndex, vector<int> *nearNodes, vector<int> *pairStart, vector<int> *pairNode, vector<double> *pairWeight0, vector<double> *sumNormWeights_init, vector<int> *na)
+{
+	double sumCount, valueCalculated1, valueCalculated2;
+	double rCompute0;
+	const int nPoints = (const int)(*subDataX).size();
+
+	(*pairStart).assign(nPoints + 1, 0);
+	for (int j = 0; j < nPoints; j++)
+	{
+		(*pairStart)[j] = (const int)(*pairNode).size();
+		(*nodeIndex).radiusQuery((*subDataX)[j], (*subDataY)[j], p, nearNodes);
+		for (int k = 0; k < (const int)(*nearNodes).size(); k++){
+			int n = (*nearNodes)[k];
+			sumCount = 0;
+			valueCalculated1 = ((*subDataX)[j]) - ((*nodeX)[n]);
+			valueCalculated2 = ((*subDataY)[j]) - ((*nodeY)[n]);
+			sumCount += pow(valueCalculated1,2);
+			sumCount += pow(valueCalculated2,2);
+			double rj = sqrt(sumCount);
+			if (rj < p){
+				rCompute0 = windowWeight<KERNEL>((rj / p), perturb);
+				(*pairNode).push_back(n);
+				(*pairWeight0).push_back(rCompute0);
+				(*sumNormWeights_init)[n] = (*sumNormWeights_init)[n] + rCompute0 * (*weights)[j];
+				(*na)[n] = (*na)[n] + 1;
+			}
+		}
+	}
+	(*pairStart)[nPoints] = (const int)(*pairNode).size();
+}
+
+//Interpolate node n of a tile through SUBROUTINE IV from the values the tile routines reset
+//perturb to, and store its outputs.  standardDev2 carries from node to node through perturb.
+static void computeTileNode(int n, const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, const vector<double> *nodeX, const vector<double> *nodeY, const vector<double> *nodeX0, const vector<double> *nodeY0, const vector<double> *nodeSlopes, const vector<double> *weights, const double neitol, double dmin, const vector<double> *subDataX0, const vector<double> *subDataY0, dgrid *Xiii, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, OUTPUT_DATA *tileOut, const spatialIndex *dataIndex, PERTURB_SCRATCH *scratch, double *standardDev2)
+{
+	double xGridValue = (*nodeX)[n];
+	double yGridValue = (*nodeY)[n];
+	(*Xiii)(0,0) = (*nodeX0)[n];
+	(*Xiii)(0,1) = (*nodeY0)[n];
+	(*perturb).perturbationZ = 0.0;
+	(*perturb).perturbationE = 1.0;
+	(*perturb).perturbationNEi = 1.0;
+	(*perturb).perturbationREi = 1.0;
+	(*perturb).perturbationZ0 = 0.0;
+	(*perturb).perturbationE0 = 1.0;
+	(*perturb).perturbationZK = 0.0;
+	(*perturb).perturbationEK = 1.0;
+	(*perturb).standardDev2 = (*standardDev2);
+	scalecInterpPerturbations_Compute(subDataX, subDataY, subDataZ, subDataE, subDataH, subDataV, &xGridValue, &yGridValue, weights, neitol, dmin, (*nodeSlopes)[n], subDataX0, subDataY0, Xiii, perturb, MSE, PROP_UNCERT, KALMAN, 0, dataIndex, scratch);
+	(*standardDev2) = (*perturb).standardDev2;
+	(*tileOut).depth[n] = (*perturb).perturbationZ;
+	(*tileOut).error[n] = (*perturb).perturbationE;
+	(*tileOut).nEi[n] = (*perturb).perturbationNEi;
+	(*tileOut).rEi[n] = (*perturb).perturbationREi;
+	(*tileOut).standardDev[n] = (*standardDev2);
+	if (PROP_UNCERT)
+	{
+		(*tileOut).depth0[n] = (*perturb).perturbationZ0;
+		(*tileOut).error0[n] = (*perturb).perturbationE0;
+	}
+	if (KALMAN)
+	{
+		(*tileOut).depthK[n] = (*perturb).perturbationZK;
+		(*tileOut).errorK[n] = (*perturb).perturbationEK;
+	}
+}
+
+void scalecInterpPerturbations_ComputeTile(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, const vector<double> *nodeX, const vector<double> *nodeY, const vector<double> *nodeX0, const vector<double> *nodeY0, const vector<double> *nodeSlopes, const vector<double> *weights, const double neitol, double dmin, const vector<double> *subDataX0, const vector<double> *subDataY0, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, OUTPUT_DATA *tileOut, const spatialIndex *dataIndex, PERTURB_SCRATCH *scratch)
+{
+	//************************************************************************************
+	// 0. Declare local variables and objects
+	//************************************************************************************
+	const int nNodes = (const int)(*nodeX).size();
+	const int nPoints = (const int)(*subDataX).size();
+	const double p = 1.0;		//the first smoothing scale, pow(2.00,0)
+	const double S_H = 1.0;
+	spatialIndex nodeIndex;
+	vector<int> nearNodes;
+	vector<int> pairStart, pairNode;
+	vector<double> pairWeight0;
+	vector<int> na(nNodes, 0);
+	vector<double> sumNormWeights_init(nNodes, 0.0);
+	vector<double> sumNormWeights, sumSquares, sumDepths;
+	vector<double> sumDepths0, sumErrors0;
+	vector<double> sumResiduals, sumErrors;
+	vector<double> kalmanZ, kalmanE;
+	vector<char> splat(nNodes, 0);
+	double valueCalculated1, valueCalculated2, sumCount;
+	double rx0, grows, nWeight, var_meas, K;
+	double standardDev2 = (*perturb).standardDev2;
+	bool haveStandardDev = false;
+	dgrid Xiii(1,2);
+	int j, k, n;
+
+	(*tileOut).depth.assign(nNodes, 0.0);
+	(*tileOut).error.assign(nNodes, 1.0);
+	(*tileOut).nEi.assign(nNodes, 1.0);
+	(*tileOut).rEi.assign(nNodes, 1.0);
+	(*tileOut).standardDev.assign(nNodes, 0.0);
+	(*tileOut).depth0.assign(nNodes, 0.0);
+	(*tileOut).error0.assign(nNodes, 1.0);
+	(*tileOut).depthK.assign(nNodes, 0.0);
+	(*tileOut).errorK.assign(nNodes, 1.0);
+
+	//************************************************************************************
+	//I. Splat the data points onto the nodes within the first smoothing scale.
+	//	Without a dmin to grow the variance by, every node is left to SUBROUTINE IV.
+	//************************************************************************************
+	if ((dmin != NaN) && (nNodes > 0))
+	{
+		nodeIndex.build(nodeX, nodeY, 1.0);
+		switch ((*perturb).kernelType)
+		{
+		case KERNEL_BOXCAR:
+			splatWeights<KERNEL_BOXCAR>(subDataX, subDataY, nodeX, nodeY, weights, p, perturb, &nodeIndex, &nearNodes, &pairStart, &pairNode, &pairWeight0, &sumNormWeights_init, &na);
+			break;
+		case KERNEL_HANN:
+			splatWeights<KERNEL_HANN>(subDataX, subDataY, nodeX, nodeY, weights, p, perturb, &nodeIndex, &nearNodes, &pairStart, &pairNode, &pairWeight0, &sumNormWeights_init, &na);
+			break;
+		default:
+			splatWeights<KERNEL_LOESS>(subDataX, subDataY, nodeX, nodeY, weights, p, perturb, &nodeIndex, &nearNodes, &pairStart, &pairNode, &pairWeight0, &sumNormWeights_init, &na);
+			break;
+		}
+		nodeIndex.clear();
+
+		//A. Only nodes with normalized weights are splatted.  Empty windows and all zero
+		//	weights expand the smoothing scale, so they are left to SUBROUTINE IV.
+		for (n = 0; n < nNodes; n++)
+			splat[n] = (na[n] > 0) && (abs(sumNormWeights_init[n]) > 0);
+
+		//************************************************************************************
+		//II. Normalize the weights and accumulate each node's sums in point order:
+		//	steps II.B and III of SUBROUTINE IV, the propagated uncertainty and the Kalman recursion.
+		//************************************************************************************
+		sumNormWeights.assign(nNodes, 0.0);
+		sumSquares.assign(nNodes, 0.0);
+		sumDepths.assign(nNodes, 0.0);
+		if (PROP_UNCERT)
+		{
+			sumDepths0.assign(nNodes, 0.0);
+			sumErrors0.assign(nNodes, 0.0);
+		}
+		if (KALMAN)
+		{
+			kalmanZ.assign(nNodes, 0.0);
+			kalmanE.assign(nNodes, 0.0);
+		}
+		vector<int> seen(nNodes, 0);
+		for (j = 0; j < nPoints; j++)
+		{
+			for (k = pairStart[j]; k < pairStart[j+1]; k++)
+			{
+				n = pairNode[k];
+				if (!splat[n])
+					continue;
+				nWeight = pairWeight0[k] * (*weights)[j];
+				nWeight /= sumNormWeights_init[n];
+				sumNormWeights[n] += nWeight;
+				sumSquares[n] += nWeight * nWeight;
+				sumDepths[n] += (*subDataZ)[j] * nWeight;
+
+				if (PROP_UNCERT || KALMAN)
+				{
+					sumCount = 0;
+					valueCalculated1 = (*subDataX0)[j] - (*nodeX0)[n];
+					valueCalculated2 = (*subDataY0)[j] - (*nodeY0)[n];
+					sumCount += pow(valueCalculated1,2);
+					sumCount += pow(valueCalculated2,2);
+					rx0 = sqrt(sumCount);
+					grows = 1 + pow(((rx0 + S_H * (*subDataH)[j])/dmin),2);
+					var_meas = pow((*subDataV)[j], 2) * grows + pow( (*subDataH)[j] * tan((PI/180) * (*nodeSlopes)[n]), 2);
+					if (PROP_UNCERT)
+					{
+						sumDepths0[n] += pairWeight0[k] * (*subDataZ)[j];
+						sumErrors0[n] += pow(pairWeight0[k], 2) * ( grows * pow((*subDataV)[j],2 ) + pow( (*subDataH)[j] * tan((PI/180) * (*nodeSlopes)[n]), 2));
+					}
+					if (KALMAN)
+					{
+						if (seen[n] == 0)
+						{
+							kalmanZ[n] = (*subDataZ)[j];
+							kalmanE[n] = var_meas;
+						}
+						else
+						{
+							if(kalmanE[n] + var_meas == 0)
+								K = 0;
+							else
+								K = kalmanE[n]/(kalmanE[n] + var_meas);
+							kalmanZ[n] = kalmanZ[n] + K*((*subDataZ)[j] - kalmanZ[n]);
+							kalmanE[n] = K*var_meas;
+						}
+					}
+				}
+				seen[n]++;
+			}
+		}
+
+		//A. Step II.C of SUBROUTINE IV.  Nodes that miss the tolerance expand the smoothing scale.
+		for (n = 0; n < nNodes; n++)
+		{
+			if (!splat[n])
+				continue;
+			if (sumNormWeights[n] > 0)
+				(*tileOut).nEi[n] = sumSquares[n] * (1.00 - eps);
+			else
+				(*tileOut).nEi[n] = 1;
+			if ((*tileOut).nEi[n] > neitol)
+				splat[n] = 0;
+		}
+
+		//************************************************************************************
+		//III. Weighted residuals about each node's depth, step III.B of SUBROUTINE IV.
+		//************************************************************************************
+		if (MSE)
+		{
+			sumResiduals.assign(nNodes, 0.0);
+			sumErrors.assign(nNodes, 0.0);
+			for (j = 0; j < nPoints; j++)
+			{
+				for (k = pairStart[j]; k < pairStart[j+1]; k++)
+				{
+					n = pairNode[k];
+					if (!splat[n])
+						continue;
+					nWeight = pairWeight0[k] * (*weights)[j];
+					nWeight /= sumNormWeights_init[n];
+					sumCount = ((*subDataZ)[j] - sumDepths[n]) * nWeight;
+					sumResiduals[n] += sumCount * sumCount;
+					sumErrors[n] += nWeight * (*subDataE)[j];
+				}
+			}
+		}
+	}
+
+	//************************************************************************************
+	//IV. Finish each node in order.  Nodes that were not splatted go through SUBROUTINE IV;
+	//	standardDev2 carries from node to node as it does through perturb.
+	//************************************************************************************
+	for (n = 0; n < nNodes; n++)
+	{
+		if (!splat[n])
+		{
+			computeTileNode(n, subDataX, subDataY, subDataZ, subDataE, subDataH, subDataV, nodeX, nodeY, nodeX0, nodeY0, nodeSlopes, weights, neitol, dmin, subDataX0, subDataY0, &Xiii, perturb, MSE, PROP_UNCERT, KALMAN, tileOut, dataIndex, scratch, &standardDev2);
+			continue;
+		}
+
+		if (PROP_UNCERT || MSE)
+		{
+			(*tileOut).depth[n] = sumDepths[n];
+			if (PROP_UNCERT)
+			{
+				(*tileOut).depth0[n] = sumDepths0[n];
+				(*tileOut).error0[n] = sumErrors0[n];
+				if(0>((*tileOut).error0[n]))
+				{
+					cerr << "Nan";
+				}
+			}
+			if (MSE)
+			{
+				//q = pow(p,-2) is one at the first smoothing scale
+				(*tileOut).nEi[n] = 1.00 - pow(p, -2) * (1.00 - (*tileOut).nEi[n]);
+				if ((*tileOut).nEi[n] < 1)
+				{
+					(*tileOut).rEi[n] = sumResiduals[n] / (*tileOut).nEi[n];
+					(*tileOut).rEi[n] = (((na[n]-1) * ((*tileOut).rEi[n])) + sumErrors[n] ) / ((double)na[n]);
+					(*tileOut).error[n] = (*tileOut).rEi[n] * ((*tileOut).nEi[n]) / double(1.00 - (*tileOut).nEi[n]);
+					if (!haveStandardDev)
+					{
+						standardDev2 = standardDeviation((dvector*)(subDataZ));
+						haveStandardDev = true;
+					}
+				}
+				else
+					(*tileOut).nEi[n] = 1;
+			}
+		}
+		(*tileOut).standardDev[n] = standardDev2;
+		if (KALMAN)
+		{
+			(*tileOut).depthK[n] = kalmanZ[n];
+			(*tileOut).errorK[n] = kalmanE[n];
+		}
+	}
+	(*perturb).standardDev2 = standardDev2;
+}
+
+
+//************************************************************************************
+// SUBROUTINE IV.B: Lattice convolution version of SUBROUTINE IV.A for the boxcar and hann windows.
+//************************************************************************************
+//Smallest length of at least n whose only prime factors are 2, 3 and 5, which the FFT handles fastest.
+static int smoothFFTLength(int n)
+{
+	int m, k;
+	for (m = max(n, 1); ; m++)
+	{
+		k = m;
+		while (k % 2 == 0)
+			k /= 2;
+		while (k % 3 == 0)
+			k /= 3;
+		while (k % 5 == 0)
+			k /= 5;
+		if (k == 1)
+			return m;
+	}
+}
+
+//In place 2D FFT of an nx by ny grid stored by rows: the rows, then the columns.
+static void fft2D(vector<alglib::complex> *grid, int nx, int ny, bool inverse, alglib::complex_1d_array *line)
+{
+	int a, b;
+
+	(*line).setlength(nx);
+	for (b = 0; b < ny; b++)
+	{
+		for (a = 0; a < nx; a++)
+			(*line)[a] = (*grid)[b*nx + a];
+		if (inverse)
+			alglib::fftc1dinv(*line, nx);
+		else
+			alglib::fftc1d(*line, nx);
+		for (a = 0; a < nx; a++)
+			(*grid)[b*nx + a] = (*line)[a];
+	}
+	(*line).setlength(ny);
+	for (a = 0; a < nx; a++)
+	{
+		for (b = 0; b < ny; b++)
+			(*line)[b] = (*grid)[b*nx + a];
+		if (inverse)
+			alglib::fftc1dinv(*line, ny);
+		else
+			alglib::fftc1d(*line, ny);
+		for (b = 0; b < ny; b++)
+			(*grid)[b*nx + a] = (*line)[b];
+	}
+}
+
+//Transforms of the window, its square and its support r < 1 sampled on the lattice and centered on
+//cell 0 with wrap around.  The windows are real and even, so their transforms are real and the first
+//two are taken together as the real and imaginary parts of one grid.
+static void latticeKernels(double hx, double hy, int mx, int my, int nx, int ny, const PERTURBS *perturb, vector<double> *windowHat, vector<double> *squareHat, vector<double> *supportHat, vector<alglib::complex> *grid, alglib::complex_1d_array *line)
+{
+	double r, w;
+	int a, b, c;
+
+	//A. Window and its square
+	(*grid).assign(nx * ny, alglib::complex(0.0));
+	for (b = -my; b <= my; b++)
+	{
+		for (a = -mx; a <= mx; a++)
+		{
+			r = sqrt(pow(a * hx, 2) + pow(b * hy, 2));
+			if (!(r < 1.0))
+				continue;
+			if ((*perturb).kernelType == KERNEL_BOXCAR)
+				w = windowWeight<KERNEL_BOXCAR>(r, perturb);
+			else
+				w = windowWeight<KERNEL_HANN>(r, perturb);
+			(*grid)[((b + ny) % ny)*nx + ((a + nx) % nx)] = alglib::complex(w, w * w);
+		}
+	}
+	fft2D(grid, nx, ny, false, line);
+	(*windowHat).resize(nx * ny);
+	(*squareHat).resize(nx * ny);
+	for (c = 0; c < nx * ny; c++)
+	{
+		(*windowHat)[c] = (*grid)[c].x;
+		(*squareHat)[c] = (*grid)[c].y;
+	}
+
+	//B. Support
+	(*grid).assign(nx * ny, alglib::complex(0.0));
+	for (b = -my; b <= my; b++)
+	{
+		for (a = -mx; a <= mx; a++)
+		{
+			if (sqrt(pow(a * hx, 2) + pow(b * hy, 2)) < 1.0)
+				(*grid)[((b + ny) % ny)*nx + ((a + nx) % nx)] = alglib::complex(1.0);
+		}
+	}
+	fft2D(grid, nx, ny, false, line);
+	(*supportHat).resize(nx * ny);
+	for (c = 0; c < nx * ny; c++)
+		(*supportHat)[c] = (*grid)[c].x;
+}
+
+//Spread two point values bilinearly onto the lattice as the real and imaginary parts of one grid,
+//convolve each with its own window and read both back at the nodes.  With P the transform of the
+//grid and P* the conjugate of its mirror, the transforms of the two values are (P + P*)/2 and
+//(P - P*)/2i, so the product is P (Ka + Kb)/2 + P* (Ka - Kb)/2.  valueB may be NULL.
+static void convolveAtNodes(const vector<int> *pointCell, const vector<double> *pointFx, const vector<double> *pointFy, const vector<double> *valueA, const vector<double> *kernelA, const vector<double> *valueB, const vector<double> *kernelB, int nx, int ny, const vector<int> *nodeCell, vector<alglib::complex> *grid, alglib::complex_1d_array *line, vector<double> *sumA, vector<double> *sumB)
+{
+	double fx, fy, va, vb, ka, kb;
+	alglib::complex pc, pm;
+	int a, b, c, m, k;
+
+	if (valueB == NULL)
+		kernelB = kernelA;
+	(*grid).assign(nx * ny, alglib::complex(0.0));
+	for (k = 0; k < (const int)(*pointCell).size(); k++)
+	{
+		c = (*pointCell)[k];
+		fx = (*pointFx)[k];
+		fy = (*pointFy)[k];
+		va = (*valueA)[k];
+		vb = (valueB != NULL) ? (*valueB)[k] : 0.0;
+		(*grid)[c].x += (1 - fx) * (1 - fy) * va;
+		(*grid)[c].y += (1 - fx) * (1 - fy) * vb;
+		(*grid)[c+1].x += fx * (1 - fy) * va;
+		(*grid)[c+1].y += fx * (1 - fy) * vb;
+		(*grid)[c+nx].x += (1 - fx) * fy * va;
+		(*grid)[c+nx].y += (1 - fx) * fy * vb;
+		(*grid)[c+nx+1].x += fx * fy * va;
+		(*grid)[c+nx+1].y += fx * fy * vb;
+	}
+	fft2D(grid, nx, ny, false, line);
+
+	//A. Each frequency is updated together with its mirror
+	for (b = 0; b < ny; b++)
+	{
+		for (a = 0; a < nx; a++)
+		{
+			c = b*nx + a;
+			m = ((ny - b) % ny)*nx + ((nx - a) % nx);
+			if (m < c)
+				continue;
+			pc = (*grid)[c];
+			pm = (*grid)[m];
+			ka = (*kernelA)[c];
+			kb = (*kernelB)[c];
+			(*grid)[c] = pc * (0.5 * (ka + kb)) + alglib::conj(pm) * (0.5 * (ka - kb));
+			if (m != c)
+			{
+				ka = (*kernelA)[m];
+				kb = (*kernelB)[m];
+				(*grid)[m] = pm * (0.5 * (ka + kb)) + alglib::conj(pc) * (0.5 * (ka - kb));
+			}
+		}
+	}
+	fft2D(grid, nx, ny, true, line);
+	(*sumA).resize((*nodeCell).size());
+	if (sumB != NULL)
+		(*sumB).resize((*nodeCell).size());
+	for (k = 0; k < (const int)(*nodeCell).size(); k++)
+	{
+		(*sumA)[k] = (*grid)[(*nodeCell)[k]].x;
+		if (sumB != NULL)
+			(*sumB)[k] = (*grid)[(*nodeCell)[k]].y;
+	}
+}
+
+bool scalecInterpPerturbations_ComputeTileFFT(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, const vector<double> *nodeX, const vector<double> *nodeY, const vector<double> *nodeX0, const vector<double> *nodeY0, const vector<double> *nodeSlopes, int nodeRows, const vector<double> *weights, const double neitol, double dmin, const vector<double> *subDataX0, const vector<double> *subDataY0, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, OUTPUT_DATA *tileOut, const spatialIndex *dataIndex, PERTURB_SCRATCH *scratch)
+{
+	//************************************************************************************
+	// 0. Declare local variables and objects
+	//************************************************************************************
+	const int nNodes = (const int)(*nodeX).size();
+	const int nPoints = (const int)(*subDataX).size();
+	const double p = 1.0;		//the first smoothing scale, pow(2.00,0)
+	int nodeCols = 0;
+	double dx = 0, dy = 0;
+	bool regular;
+	int i, j, k, n;
+
+	//************************************************************************************
+	//I. Only the boxcar and hann windows on a regular grid of nodes are convolved.  The
+	//	propagated uncertainty and the Kalman recursion depend on the distance from each point
+	//	to each node and on the point order, so tiles that need them are swept instead.
+	//************************************************************************************
+	regular = ((*perturb).kernelType == KERNEL_BOXCAR || (*perturb).kernelType == KERNEL_HANN) && !PROP_UNCERT && !KALMAN && (nodeRows >= 2) && (nNodes % nodeRows == 0);
+	if (regular)
+	{
+		nodeCols = nNodes / nodeRows;
+		regular = (nodeCols >= 2);
+	}
+	if (regular)
+	{
+		dx = (*nodeX)[nodeRows] - (*nodeX)[0];
+		dy = (*nodeY)[1] - (*nodeY)[0];
+		regular = (dx > 0) && (dy > 0);
+		for (i = 0; regular && i < nodeCols; i++)
+		{
+			for (j = 0; regular && j < nodeRows; j++)
+			{
+				k = i*nodeRows + j;
+				regular = (abs((*nodeX)[k] - ((*nodeX)[0] + i*dx)) <= 1e-6 * dx) && (abs((*nodeY)[k] - ((*nodeY)[0] + j*dy)) <= 1e-6 * dy);
+			}
+		}
+	}
+
+	//A. Lattice of FFT_SMOOTHING_CELLS_PER_SCALE cells per smoothing scale with the nodes on its
+	//	cells, and a margin of one smoothing scale.  It is padded so the convolution does not wrap.
+	int sx = 0, sy = 0, mx = 0, my = 0, gx = 0, gy = 0, nx = 0, ny = 0;
+	double hx = 0, hy = 0;
+	if (regular)
+	{
+		sx = max(1, (int)ceil(FFT_SMOOTHING_CELLS_PER_SCALE * dx / p));
+		sy = max(1, (int)ceil(FFT_SMOOTHING_CELLS_PER_SCALE * dy / p));
+		hx = dx / sx;
+		hy = dy / sy;
+		mx = (int)ceil(p / hx);
+		my = (int)ceil(p / hy);
+		gx = (nodeCols - 1) * sx + 1 + 2 * mx;
+		gy = (nodeRows - 1) * sy + 1 + 2 * my;
+		nx = smoothFFTLength(gx + mx);
+		ny = smoothFFTLength(gy + my);
+		regular = ((double)nx * (double)ny <= FFT_SMOOTHING_MAX_CELLS);
+	}
+	if (!regular)
+	{
+		scalecInterpPerturbations_ComputeTile(subDataX, subDataY, subDataZ, subDataE, subDataH, subDataV, nodeX, nodeY, nodeX0, nodeY0, nodeSlopes, weights, neitol, dmin, subDataX0, subDataY0, perturb, MSE, PROP_UNCERT, KALMAN, tileOut, dataIndex, scratch);
+		return false;
+	}
+
+	vector<int> nodeCell(nNodes);
+	vector<int> pointCell;
+	vector<double> pointFx, pointFy;
+	vector<double> valueA, valueB;
+	vector<double> sumWeights, sumDepths, sumErrors;
+	vector<double> sumSquares, sumSquareDepths, sumSquareDepths2;
+	vector<double> count;
+	vector<double> windowHat, squareHat, supportHat;
+	vector<alglib::complex> grid;
+	alglib::complex_1d_array line;
+	vector<int> pointIdx;
+	double u, v, zRef = 0.0, weightTotal = 0.0;
+	double S, Zr, sumResiduals;
+	double standardDev2 = (*perturb).standardDev2;
+	bool haveStandardDev = false;
+	dgrid Xiii(1,2);
+	int na;
+
+	//************************************************************************************
+	//II. Bin the points within reach of a node onto the lattice.  Points outside the margin
+	//	are at least a smoothing scale from every node.  Depths are taken about the mean of the
+	//	binned points to keep the squared sums well conditioned.
+	//************************************************************************************
+	for (j = 0; j < nPoints; j++)
+	{
+		u = ((*subDataX)[j] - (*nodeX)[0]) / hx + mx;
+		v = ((*subDataY)[j] - (*nodeY)[0]) / hy + my;
+		if (!(u >= 0) || !(v >= 0) || !(u < gx - 1) || !(v < gy - 1))
+			continue;
+		pointIdx.push_back(j);
+		pointCell.push_back((int)v * nx + (int)u);
+		pointFx.push_back(u - (int)u);
+		pointFy.push_back(v - (int)v);
+		zRef += (*subDataZ)[j];
+		weightTotal += abs((*weights)[j]);
+	}
+	if (!pointIdx.empty())
+		zRef /= (double)pointIdx.size();
+
+	//A. The sweep of SUBROUTINE IV.A visits each point once for every node within a smoothing
+	//	scale of it, the convolutions every cell of the lattice a fixed number of times.
+	const int nBinned = (const int)pointIdx.size();
+	if ((double)nBinned * PI * p * p / (dx * dy) < FFT_SMOOTHING_PAIRS_PER_CELL * (double)nx * (double)ny)
+	{
+		scalecInterpPerturbations_ComputeTile(subDataX, subDataY, subDataZ, subDataE, subDataH, subDataV, nodeX, nodeY, nodeX0, nodeY0, nodeSlopes, weights, neitol, dmin, subDataX0, subDataY0, perturb, MSE, PROP_UNCERT, KALMAN, tileOut, dataIndex, scratch);
+		return false;
+	}
+
+	(*tileOut).depth.assign(nNodes, 0.0);
+	(*tileOut).error.assign(nNodes, 1.0);
+	(*tileOut).nEi.assign(nNodes, 1.0);
+	(*tileOut).rEi.assign(nNodes, 1.0);
+	(*tileOut).standardDev.assign(nNodes, 0.0);
+	(*tileOut).depth0.assign(nNodes, 0.0);
+	(*tileOut).error0.assign(nNodes, 1.0);
+	(*tileOut).depthK.assign(nNodes, 0.0);
+	(*tileOut).errorK.assign(nNodes, 1.0);
+
+	for (i = 0; i < nodeCols; i++)
+		for (j = 0; j < nodeRows; j++)
+			nodeCell[i*nodeRows + j] = (my + j*sy)*nx + (mx + i*sx);
+
+	//************************************************************************************
+	//III. Convolve the weighted sums of SUBROUTINE IV with the window, its square and its
+	//	support, two sums to a transform.
+	//************************************************************************************
+	latticeKernels(hx, hy, mx, my, nx, ny, perturb, &windowHat, &squareHat, &supportHat, &grid, &line);
+	valueA.resize(nBinned);
+	valueB.resize(nBinned);
+
+	//A. Sums of weights and of weighted depths
+	for (k = 0; k < nBinned; k++)
+	{
+		j = pointIdx[k];
+		valueA[k] = (*weights)[j];
+		valueB[k] = (*weights)[j] * ((*subDataZ)[j] - zRef);
+	}
+	convolveAtNodes(&pointCell, &pointFx, &pointFy, &valueA, &windowHat, &valueB, &windowHat, nx, ny, &nodeCell, &grid, &line, &sumWeights, &sumDepths);
+
+	//B. Sums of squared weights and the number of points in each window.  The mean square error
+	//	also needs the weighted errors and the squared weights times the depths and their squares.
+	if (MSE)
+	{
+		for (k = 0; k < nBinned; k++)
+		{
+			j = pointIdx[k];
+			valueA[k] = pow((*weights)[j], 2);
+			valueB[k] = valueA[k] * ((*subDataZ)[j] - zRef);
+		}
+		convolveAtNodes(&pointCell, &pointFx, &pointFy, &valueA, &squareHat, &valueB, &squareHat, nx, ny, &nodeCell, &grid, &line, &sumSquares, &sumSquareDepths);
+		for (k = 0; k < nBinned; k++)
+		{
+			j = pointIdx[k];
+			valueA[k] = valueB[k] * ((*subDataZ)[j] - zRef);
+		}
+		convolveAtNodes(&pointCell, &pointFx, &pointFy, &valueA, &squareHat, NULL, NULL, nx, ny, &nodeCell, &grid, &line, &sumSquareDepths2, NULL);
+		for (k = 0; k < nBinned; k++)
+		{
+			j = pointIdx[k];
+			valueA[k] = (*weights)[j] * (*subDataE)[j];
+			valueB[k] = 1.0;
+		}
+		convolveAtNodes(&pointCell, &pointFx, &pointFy, &valueA, &windowHat, &valueB, &supportHat, nx, ny, &nodeCell, &grid, &line, &sumErrors, &count);
+	}
+	else
+	{
+		for (k = 0; k < nBinned; k++)
+		{
+			j = pointIdx[k];
+			valueA[k] = pow((*weights)[j], 2);
+			valueB[k] = 1.0;
+		}
+		convolveAtNodes(&pointCell, &pointFx, &pointFy, &valueA, &squareHat, &valueB, &supportHat, nx, ny, &nodeCell, &grid, &line, &sumSquares, &count);
+	}
+	grid.clear();
+
+	//************************************************************************************
+	//IV. Finish each node in order as SUBROUTINE IV.A does.  Nodes with an empty or nearly
+	//	empty window, or that miss neitol and must expand the smoothing scale, go through
+	//	SUBROUTINE IV.
+	//************************************************************************************
+	for (n = 0; n < nNodes; n++)
+	{
+		na = (int)floor(count[n] + 0.5);
+		S = sumWeights[n];
+		if ((na > 0) && (S > FFT_SMOOTHING_MIN_WEIGHT * weightTotal))
+			(*tileOut).nEi[n] = sumSquares[n] / (S * S) * (1.00 - eps);
+		if ((na <= 0) || !(S > FFT_SMOOTHING_MIN_WEIGHT * weightTotal) || ((*tileOut).nEi[n] > neitol))
+		{
+			computeTileNode(n, subDataX, subDataY, subDataZ, subDataE, subDataH, subDataV, nodeX, nodeY, nodeX0, nodeY0, nodeSlopes, weights, neitol, dmin, subDataX0, subDataY0, &Xiii, perturb, MSE, PROP_UNCERT, KALMAN, tileOut, dataIndex, scratch, &standardDev2);
+			continue;
+		}
+
+		if (MSE)
+		{
+			Zr = sumDepths[n] / S;
+			(*tileOut).depth[n] = Zr + zRef;
+
+			//q = pow(p,-2) is one at the first smoothing scale
+			(*tileOut).nEi[n] = 1.00 - pow(p, -2) * (1.00 - (*tileOut).nEi[n]);
+			if ((*tileOut).nEi[n] < 1)
+			{
+				//Sum of ((z - Z) w)^2 expanded about zRef.  Round off can leave it slightly negative.
+				sumResiduals = (sumSquareDepths2[n] - 2 * Zr * sumSquareDepths[n] + Zr * Zr * sumSquares[n]) / (S * S);
+				if (sumResiduals < 0)
+					sumResiduals = 0;
+				(*tileOut).rEi[n] = sumResiduals / (*tileOut).nEi[n];
+				(*tileOut).rEi[n] = (((na-1) * ((*tileOut).rEi[n])) + sumErrors[n] / S ) / ((double)na);
+				(*tileOut).error[n] = (*tileOut).rEi[n] * ((*tileOut).nEi[n]) / double(1.00 - (*tileOut).nEi[n]);
+				if (!haveStandardDev)
+				{
+					standardDev2 = standardDeviation((dvector*)(subDataZ));
+					haveStandardDev = true;
+				}
+			}
+			else
+				(*tileOut).nEi[n] = 1;
+		}
+		(*tileOut).standardDev[n] = standardDev2;
+	}
+	(*perturb).standardDev2 = standardDev2;
+	return true;
+}
+
+
 //From _Serial and is the same as mergeBathy_v3.7.1_Paul which is modified to pass standardDev in the Perturbations call
 void scalecInterpPerturbations_Compute_ForKriging(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, double *xGridValue, double *yGridValue, const vector<double> *weights, const vector<double> *ri, const vector<double> *ai, const double neitol, double *perturbationZ, double *perturbationE, double *perturbationNEi, double *perturbationREi, double *standardDev)
 {
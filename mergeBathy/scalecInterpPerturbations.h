@@ -13,6 +13,7 @@
 #include "inFileStructs.h"
 #include "outFileStructs.h"
 #include "consistentWeights.h"
+#include "spatialIndex.h"
 
 
 /**
@@ -26,6 +27,23 @@
 */
 double interp1(double x, const vector<double> *xi, const vector<double> *yi);
 
+/**
+* interp1 for a table whose xi are uniformly spaced.  The bracket is found directly from the spacing instead of by scanning xi, and the
+* result is the same as that of interp1.
+* @param x - Weighting scale factor.
+* @param xi - Vector of computed radial points, uniformly spaced.
+* @param yi - Vector of computed window weights.
+* @param xOrigin - xi[0].
+* @param xInverseStep - The inverse of the spacing of xi.
+* @return The 1-D interpolated double value of the weighting factor applied to xi and yi.
+*/
+double interp1Uniform(double x, const vector<double> *xi, const vector<double> *yi, double xOrigin, double xInverseStep);
+
+/**
+* Smoothing windows.  scalecInterpPerturbations_PreCompute resolves the kernel name to one of these once, so the interpolation loop never compares names.
+*/
+enum KERNEL_TYPE { KERNEL_HANN, KERNEL_BOXCAR, KERNEL_QUADLOESS, KERNEL_LOESS };
+
 /**
 * This function is used to calculate the weights for linear and quadratic loess windows, formed from an impulse response away from edges.
 * Reference: Cleveland, W. S. (1979). "ROBUST LOCALLY WEIGHTED REGRESSION AND SMOOTHING SCATTERPLOTS." Journal of the American Statistical Association 74(368): 829-836.
@@ -68,8 +86,44 @@ void scalecInterpPerturbations_PreCompute(const vector<double> *subDataZ, const
 * @param perturbationE - Interpolated Error value. (Returned).
 * @param perturbationNEi - Interpolated Normalized Error value. (Returned).
 * @param perturbationREi - Interpolated Residual Error value. (Returned).
+* @param dataIndex - Optional spatial index built over subDataX and subDataY.  When given, each smoothing scale expansion only visits the data points within reach of the window instead of every point in the tile.
+* @param scratch - Optional working buffers reused from node to node, one per thread.  When NULL the buffers are allocated for this node alone.
+*/
+void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, double *xGridValue, double *yGridValue, const vector<double> *weights, const double neitol, double dmin, double slopeVector, const vector<double> *subDataX0, const vector<double> *subDataY0, dgrid *Xiii, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, bool KRIGING, const spatialIndex *dataIndex = NULL, PERTURB_SCRATCH *scratch = NULL);
+
+/**
+* scalecInterpPerturbations_Compute for every node of a tile at once.
+* The data points are swept once and each is added to the nodes within the first smoothing scale, instead of each node
+* gathering its points.  A node whose window is empty or misses neitol at the first smoothing scale, which must then be
+* expanded, goes through scalecInterpPerturbations_Compute instead.  Each node starts from the values the tile routines reset
+* perturb to, and the outputs are those of calling scalecInterpPerturbations_Compute on the nodes in order with KRIGING off.
+* @param nodeX - X of each node multiplied by 1/gridSpacing, in the units of subDataX.
+* @param nodeY - Y of each node multiplied by 1/gridSpacing, in the units of subDataY.
+* @param nodeX0 - X of each node in the units of subDataX0, the interpolation location Xiii of scalecInterpPerturbations_Compute.
+* @param nodeY0 - Y of each node in the units of subDataY0.
+* @param nodeSlopes - Slope at each node.
+* @param perturb - Window tables from scalecInterpPerturbations_PreCompute.  standardDev2 carries in and out as it does through scalecInterpPerturbations_Compute.
+* @param tileOut - depth, error, nEi, rEi, standardDev, depth0, error0, depthK and errorK of each node, in the order of nodeX. (Returned).
+* @param dataIndex - Optional spatial index over subDataX and subDataY, used for the nodes left to scalecInterpPerturbations_Compute.
+* @param scratch - Optional working buffers for the nodes left to scalecInterpPerturbations_Compute.
+*/
+void scalecInterpPerturbations_ComputeTile(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, const vector<double> *nodeX, const vector<double> *nodeY, const vector<double> *nodeX0, const vector<double> *nodeY0, const vector<double> *nodeSlopes, const vector<double> *weights, const double neitol, double dmin, const vector<double> *subDataX0, const vector<double> *subDataY0, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, OUTPUT_DATA *tileOut, const spatialIndex *dataIndex = NULL, PERTURB_SCRATCH *scratch = NULL);
+
+/**
+* scalecInterpPerturbations_ComputeTile for the boxcar and hann windows on a regular grid of nodes, by FFT convolution.
+* The data points are spread bilinearly onto a lattice of FFT_SMOOTHING_CELLS_PER_SCALE cells per smoothing scale that
+* holds the nodes, and the sums of weights, weighted depths and errors and squared weights of every node are convolved
+* at once with the window sampled on the lattice.  This is an approximation: each point is weighted by the window
+* interpolated between the lattice cells around it instead of at its own distance.  Nodes whose window is empty or
+* misses neitol at the first smoothing scale go through scalecInterpPerturbations_Compute.  Tiles with another window,
+* irregular nodes, a lattice larger than FFT_SMOOTHING_MAX_CELLS, fewer than FFT_SMOOTHING_PAIRS_PER_CELL (point, node)
+* pairs per lattice cell, or PROP_UNCERT or KALMAN on go through scalecInterpPerturbations_ComputeTile.
+* @param nodeRows - Number of nodes in each column of the grid.  Node k is in column k / nodeRows and row k % nodeRows,
+*	with X constant down a column and Y constant along a row.
+* Otherwise the parameters are those of scalecInterpPerturbations_ComputeTile.
+* @return - true if the tile was convolved, false if it went through scalecInterpPerturbations_ComputeTile.
 */
-void scalecInterpPerturbations_Compute(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, double *xGridValue, double *yGridValue, const vector<double> *weights, const double neitol, double dmin, double slopeVector, const vector<double> *subDataX0, const vector<double> *subDataY0, dgrid *Xiii, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, bool KRIGING);
+bool scalecInterpPerturbations_ComputeTileFFT(const vector<double> *subDataX, const vector<double> *subDataY, const vector<double> *subDataZ, const vector<double> *subDataE, const vector<double> *subDataH, const vector<double> *subDataV, const vector<double> *nodeX, const vector<double> *nodeY, const vector<double> *nodeX0, const vector<double> *nodeY0, const vector<double> *nodeSlopes, int nodeRows, const vector<double> *weights, const double neitol, double dmin, const vector<double> *subDataX0, const vector<double> *subDataY0, PERTURBS *perturb, bool MSE, bool PROP_UNCERT, bool KALMAN, OUTPUT_DATA *tileOut, const spatialIndex *dataIndex = NULL, PERTURB_SCRATCH *scratch = NULL);
 
 /**
 * This is the secondary interpolation function for mergeBathy when kriging is being used.
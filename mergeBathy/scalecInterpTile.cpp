@@ -302,6 +302,23 @@ int scalecInterpTile(vector< vector<double> > *subsampledData, dgrid *xMeshGrid,
 	scalecInterpTileData.PROP_UNCERT			= PROP_UNCERT;
 	scalecInterpTileData.KALMAN					= KALMAN;
 	scalecInterpTileData.KRIGING				= KRIGING;
+	scalecInterpTileData.KRIGING_NEIGHBORS		= additionalOptions["-krigingNeighbors"];
+	scalecInterpTileData.FFT_SMOOTHING			= (additionalOptions["-fftSmoothing"] == 1);
+
+	//C. Split the grid into tiles and queue them by estimated cost. Threads pull
+	//	tiles from the queue instead of taking every numCores-th column.
+	int numThreads = additionalOptions["-multiThread"];
+	if (numThreads < 1)
+		numThreads = 1;
+	vector< vector<int> > outerLoopIndexVectors;
+	vector< vector<int> > outerLoopIdx;
+	mbTaskQueue tileTasks(numThreads);
+	vector<int> fftTiles(numThreads, 0);
+	scalecInterpTileData.outerLoopIndexVectors	= &outerLoopIndexVectors;
+	scalecInterpTileData.outerLoopIdx			= &outerLoopIdx;
+	scalecInterpTileData.tasks					= &tileTasks;
+	scalecInterpTileData.fftTiles				= &fftTiles;
+	scalecInterpTile_ScheduleTiles(&scalecInterpTileData, &outerLoopIndexVectors, &outerLoopIdx, &tileTasks);
 
 	#pragma endregion
 
@@ -331,7 +348,11 @@ int scalecInterpTile(vector< vector<double> > *subsampledData, dgrid *xMeshGrid,
 //		mbT.initMBThread_Tile(additionalOptions["-kriging"]);
 		mbT.joinMBThread();
 		mbT.terminateMBThread();
+		if (dispIntermResults)
+			cout << "Tiles stolen between threads: " << tileTasks.steals() << endl;
 	}
+	outerLoopIndexVectors.clear();
+	outerLoopIdx.clear();
 
 	innerLoopIndexVector.clear();
 	xInterpLocs0.clear();
@@ -346,6 +367,13 @@ int scalecInterpTile(vector< vector<double> > *subsampledData, dgrid *xMeshGrid,
 	double t = (stopT-startT)/CLOCKS_PER_SEC;
 	cout << "Interpolated "<< fix(nyi*nxi/t) << " points per second (tiled)."<< endl;
 
+	//A. Only tiles that were convolved are approximate; the rest were swept exactly.
+	int numFFTTiles = 0;
+	for (i = 0; i < (const int)fftTiles.size(); i++)
+		numFFTTiles += fftTiles[i];
+	if (numFFTTiles > 0)
+		cout << "Convolved " << numFFTTiles << " tiles by FFT; their depths and errors are approximate." << endl;
+
 	cout<<"Store Output"<<endl;
 	#pragma region --Store output
 	//************************************************************************************
@@ -452,6 +480,93 @@ int scalecInterpTile(vector< vector<double> > *subsampledData, dgrid *xMeshGrid,
 
 
 
+int scalecInterpTile_ScheduleTiles(SCALEC_TILE_DATA_POINTER stdp, vector< vector<int> > *outerLoopIndexVectors, vector< vector<int> > *outerLoopIdx, mbTaskQueue *tasks)
+{
+	const int subDataXLength = (const int)(*stdp->subsampledData)[0].size();
+	const int kx = (const int)(*stdp->kx);
+	const int ky = (const int)(*stdp->ky);
+	double xmin, xmax, ymin, ymax;
+	double overlap;
+	int nPoints;
+	MB_TASK tile;
+
+	(*outerLoopIndexVectors) = vector< vector<int> >(kx);
+	(*outerLoopIdx) = vector< vector<int> >(kx);
+
+	//loop x tiles, columns
+	for (int outerLoop = 0; outerLoop < kx; outerLoop++) 
+	{
+		vector<int> &outerLoopIndexVector = (*outerLoopIndexVectors)[outerLoop];
+		vector<int> &idx = (*outerLoopIdx)[outerLoop];
+
+		outerLoopIndexVector = vector<int>((*stdp->nkx));
+		//A. Get indices in XI, which gives x-locations, to interpolate on this loop.
+		for (int i = 0; i < (const int)(*stdp->nkx); i++)
+		{
+			// indices to interpolate this time
+			outerLoopIndexVector[i] = ( i + ((outerLoop) * (int)(*stdp->nkx))); 
+		}
+		if((outerLoop == (int)((*stdp->kx) - 1)) && (outerLoopIndexVector[outerLoopIndexVector.size() - 1] != (int)((*stdp->xSingleVector).size() - 1)))
+		{
+			for (int i = outerLoopIndexVector[outerLoopIndexVector.size() - 1] + 1; i < (const int)(*stdp->xSingleVector).size(); i++)
+			{
+				// catch the end here
+				outerLoopIndexVector.push_back(i); 
+			}
+		}
+		//B. Compute appropriate overlap between tiles horizontally and get the
+		//	useful data. Recall that we scaled xi-array by 1./std(x). Then,
+		//	get indices of x-coordinates in x-array for the data to be
+		//	interpolated. Indices to be filtered further for useful y-coordinates.
+		// find tile limits
+		//xmin = (*stdp->xSingleVector)[(int)outerLoopIndexVector[0]] - (*stdp->LMAX_x); 
+		//xmax = (*stdp->xSingleVector)[(int)outerLoopIndexVector[outerLoopIndexVector.size()-1]] + (*stdp->LMAX_x);
+		
+		/*Optimal overlap is half the distance of the tile according to Numerical Recipes.
+		  This appears to run faster than LMAX but produces relatively the same results. -- SJZ*/
+		overlap = ((*stdp->xSingleVector)[(int)outerLoopIndexVector[outerLoopIndexVector.size()-1]] - (*stdp->xSingleVector)[(int)outerLoopIndexVector[0]])/2;
+		xmin = (*stdp->xSingleVector)[(int)outerLoopIndexVector[0]] - overlap; 
+		xmax = (*stdp->xSingleVector)[(int)outerLoopIndexVector[outerLoopIndexVector.size()-1]] + overlap;
+		
+		for (int i = 0; i < subDataXLength; i++){
+			if (((*stdp->subsampledData)[0][i] < xmax) && ((*stdp->subsampledData)[0][i] > xmin))
+					idx.push_back(i);
+		}
+		if (idx.empty())
+			continue;
+
+		//C. Queue each tile in the column with a cost estimated from the data
+		//	it will pull in. The same y limits are used by _ProcessA.
+		for (int innerLoop = 0; innerLoop < ky; innerLoop++) 
+		{
+			const vector<int> &innerLoopIndexVector = (*stdp->innerLoopIndexVector)[innerLoop];
+			overlap = ( (*stdp->ySingleVector)[innerLoopIndexVector[innerLoopIndexVector.size()-1]] - (*stdp->ySingleVector)[innerLoopIndexVector[0]] )/2;
+			ymin = (*stdp->ySingleVector)[innerLoopIndexVector[0]] - overlap;
+			ymax = (*stdp->ySingleVector)[innerLoopIndexVector[innerLoopIndexVector.size()-1]] + overlap;
+
+			nPoints = 0;
+			for (int i = 0; i < (const int)idx.size(); i++)
+			{
+				if ( ((*stdp->subsampledData)[1][idx[i]] < ymax) && ((*stdp->subsampledData)[1][idx[i]] > ymin) )
+					nPoints++;
+			}
+
+			//Tiles with too few points are not interpolated; leave them out.
+			if (nPoints > 2)
+			{
+				tile.outerLoop = outerLoop;
+				tile.innerLoop = innerLoop;
+				tile.begin = 0;
+				tile.end = 0;
+				tile.cost = (double)nPoints * (double)(outerLoopIndexVector.size() * innerLoopIndexVector.size());
+				(*tasks).addTask(tile);
+			}
+		}
+	}
+	(*tasks).schedule();
+	return SUCCESS;
+}
+
 int scalecInterpTile_ProcessA(SCALEC_TILE_DATA_POINTER stdp, const int curIterNum, const int numCores)
 {
 	//************************************************************************************
@@ -464,19 +579,18 @@ int scalecInterpTile_ProcessA(SCALEC_TILE_DATA_POINTER stdp, const int curIterNu
 	vector<double> subYInterpLocs0_Vec;
 	dgrid Xiii(1,2);						// current interpolation location
 
-	vector<int> outerLoopIndexVector;
-	vector<int> idx;
 	vector<double> subX_idy;				
 	vector<double> subY_idy;
 	vector<double> subZ_idy;
 	vector<double> subE_idy;
 	vector<double> subH_idy;
 	vector<double> subV_idy;
-	double xmin, xmax, ymin, ymax;
+	double ymin, ymax;
 	double diffXi, diffYi;
 	double dmin;
 
 	vector <double> perturbWeights;
+	spatialIndex dataIndex;					// neighbor lookup over subX_idy, subY_idy
 	const int subDataXLength = (const int)(*stdp->subsampledData)[0].size();
 	int iliv_Loc;
 	int oliv_Loc;
@@ -487,6 +601,13 @@ int scalecInterpTile_ProcessA(SCALEC_TILE_DATA_POINTER stdp, const int curIterNu
 	double assnGridValue;
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
+	OUTPUT_DATA tileOut;					// interpolated values of the independent points of a tile
+	vector<double> nodeX;					// independent points of a tile, scaled, unscaled, and their slopes
+	vector<double> nodeY;
+	vector<double> nodeX0;
+	vector<double> nodeY0;
+	vector<double> nodeSlopes;
 	perturb.kernelName = *(*stdp).kernelName;
 
 	//Initialize Kriging vars
@@ -498,14 +619,7 @@ int scalecInterpTile_ProcessA(SCALEC_TILE_DATA_POINTER stdp, const int curIterNu
 	
 	vector<double> outputDepthKKrig = vector<double>((*stdp->xMeshGrid).rows()*(*stdp->xMeshGrid).cols(),0);
 	vector<double> outputErrorKKrig = vector<double>((*stdp->xMeshGrid).rows()*(*stdp->xMeshGrid).cols(),0);
-	double zKriged;
-	double varZKriged;
-	double z0Kriged;
-	double varZ0Kriged;
-	double zKKriged;
-	double varZKKriged;
-	double xGrid_indexKriged;
-	double yGrid_indexKriged;
+	int nKrigNodes;
 	vector<double> subX_idyKriged;
 	vector<double> subY_idyKriged;
 	vector<double> subX_idy0Kriged;
@@ -529,7 +643,8 @@ int scalecInterpTile_ProcessA(SCALEC_TILE_DATA_POINTER stdp, const int curIterNu
 	vector<double> twoGammaHatVector;
 	vector<double> distanceVectorBinCenters;
 	vector<double> aVectorFine;
-	dgrid invGammaDArray;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
 	dgrid AGrid;
 	double locSpacingX = (*stdp->spacingX);
 	double locSpacingY = (*stdp->spacingY);
@@ -542,442 +657,428 @@ int scalecInterpTile_ProcessA(SCALEC_TILE_DATA_POINTER stdp, const int curIterNu
 	//************************************************************************************
 	// I. Interpolate the data
 	//************************************************************************************
-	//loop x tiles, columns
-	for (int outerLoop = curIterNum; outerLoop < (const int)(*stdp->kx); outerLoop+=numCores) 
+	//loop over the tiles handed to this thread; idle threads steal tiles from busy ones
+	MB_TASK tile;
+	while ((*stdp->tasks).nextTask(curIterNum, &tile))
 	{
-		outerLoopIndexVector = vector<int>((*stdp->nkx));
-		//A. Get indices in XI, which gives x-locations, to interpolate on this loop.
-		for (int i = 0; i < (const int)(*stdp->nkx); i++)
-		{
-			// indices to interpolate this time
-			outerLoopIndexVector[i] = ( i + ((outerLoop) * (int)(*stdp->nkx))); 
-		}
-		if((outerLoop == (int)((*stdp->kx) - 1)) && (outerLoopIndexVector[outerLoopIndexVector.size() - 1] != (int)((*stdp->xSingleVector).size() - 1)))
-		{
-			for (int i = outerLoopIndexVector[outerLoopIndexVector.size() - 1] + 1; i < (const int)(*stdp->xSingleVector).size(); i++)
-			{
-				// catch the end here
-				outerLoopIndexVector.push_back(i); 
-			}
-		}
-		//B. Compute appropriate overlap between tiles horizontally and get the
-		//	useful data. Recall that we scaled xi-array by 1./std(x). Then,
-		//	get indices of x-coordinates in x-array for the data to be
-		//	interpolated. Indices to be filtered further for useful y-coordinates.
-		// find tile limits
-		//xmin = (*stdp->xSingleVector)[(int)outerLoopIndexVector[0]] - (*stdp->LMAX_x); 
-		//xmax = (*stdp->xSingleVector)[(int)outerLoopIndexVector[outerLoopIndexVector.size()-1]] + (*stdp->LMAX_x);
+		const int innerLoop = tile.innerLoop;
+		const vector<int> &outerLoopIndexVector = (*stdp->outerLoopIndexVectors)[tile.outerLoop];
+		const vector<int> &idx = (*stdp->outerLoopIdx)[tile.outerLoop];
+		double overlap;
+
+		/*This section uses the window size suggested in Calder's paper: ten times the largest sample spacing.*/
+		//C. Do the same as above but for the y coordinates
+		/*ymin = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[0]] - (*stdp->LMAX_y);
+		ymax = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[(*stdp->innerLoopIndexVector)[innerLoop].size()-1]] + (*stdp->LMAX_y);
+		*/
 		
 		/*Optimal overlap is half the distance of the tile according to Numerical Recipes.
 		  This appears to run faster than LMAX but produces relatively the same results. -- SJZ*/
-		double overlap = 0;
-		overlap = ((*stdp->xSingleVector)[(int)outerLoopIndexVector[outerLoopIndexVector.size()-1]] - (*stdp->xSingleVector)[(int)outerLoopIndexVector[0]])/2;
-		xmin = (*stdp->xSingleVector)[(int)outerLoopIndexVector[0]] - overlap; 
-		xmax = (*stdp->xSingleVector)[(int)outerLoopIndexVector[outerLoopIndexVector.size()-1]] + overlap;
+		overlap = 0;
+		overlap =  ( (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[(*stdp->innerLoopIndexVector)[innerLoop].size()-1]] - (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[0]] )/2;
+		ymin = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[0]] - overlap;
+		ymax = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[(*stdp->innerLoopIndexVector)[innerLoop].size()-1]] + overlap;
 		
-		for (int i = 0; i < subDataXLength; i++){
-			if (((*stdp->subsampledData)[0][i] < xmax) && ((*stdp->subsampledData)[0][i] > xmin))
-					idx.push_back(i);
-		}
-		#pragma region --idxSize
-		if (idx.size() > 0) 
+		//D. Get all of the original data that falls within the current tile to be interpolated.
+		//	The buffers keep their memory from tile to tile; reserving the column's point count
+		//	means they grow at most once per tile instead of doubling through push_back.
+		subX_idy.reserve(idx.size());
+		subY_idy.reserve(idx.size());
+		subZ_idy.reserve(idx.size());
+		subE_idy.reserve(idx.size());
+		subH_idy.reserve(idx.size());
+		subV_idy.reserve(idx.size());
+		subX0.reserve(idx.size());
+		subY0.reserve(idx.size());
+		for (int i = 0; i < (const int)idx.size(); i++)
 		{
-			//loop y tiles, blocks in columns
-			for (int innerLoop = 0; innerLoop < (const int)(*stdp->ky); innerLoop++) 
+			if ( ((*stdp->subsampledData)[1][(int)idx[i]] < ymax) && ((*stdp->subsampledData)[1][(int)idx[i]] > ymin) )
 			{
-				/*This section uses the window size suggested in Calder's paper: ten times the largest sample spacing.*/
-				//C. Do the same as above but for the y coordinates
-				/*ymin = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[0]] - (*stdp->LMAX_y);
-				ymax = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[(*stdp->innerLoopIndexVector)[innerLoop].size()-1]] + (*stdp->LMAX_y);
-				*/
+				subX_idy.push_back((*stdp->subsampledData)[0][idx[i]] * (*stdp->Lx));	
+				subY_idy.push_back((*stdp->subsampledData)[1][idx[i]] * (*stdp->Ly));
+				subZ_idy.push_back((*stdp->subsampledData)[2][idx[i]]);
+				subE_idy.push_back((*stdp->subsampledData)[4][idx[i]]);
+				subH_idy.push_back((*stdp->subsampledData)[5][idx[i]]);
+				subV_idy.push_back((*stdp->subsampledData)[6][idx[i]]);
 				
-				/*Optimal overlap is half the distance of the tile according to Numerical Recipes.
-				  This appears to run faster than LMAX but produces relatively the same results. -- SJZ*/
-				overlap = 0;
-				overlap =  ( (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[(*stdp->innerLoopIndexVector)[innerLoop].size()-1]] - (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[0]] )/2;
-				ymin = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[0]] - overlap;
-				ymax = (*stdp->ySingleVector)[(int)((*stdp->innerLoopIndexVector)[innerLoop])[(*stdp->innerLoopIndexVector)[innerLoop].size()-1]] + overlap;
-				
-				//D. Get all of the original data that falls within the current tile to be interpolated
-				for (int i = 0; i < (const int)idx.size(); i++)
+				if(stdp->KRIGING)
 				{
-					if ( ((*stdp->subsampledData)[1][(int)idx[i]] < ymax) && ((*stdp->subsampledData)[1][(int)idx[i]] > ymin) )
-					{
-						subX_idy.push_back((*stdp->subsampledData)[0][idx[i]] * (*stdp->Lx));	
-						subY_idy.push_back((*stdp->subsampledData)[1][idx[i]] * (*stdp->Ly));
-						subZ_idy.push_back((*stdp->subsampledData)[2][idx[i]]);
-						subE_idy.push_back((*stdp->subsampledData)[4][idx[i]]);
-						subH_idy.push_back((*stdp->subsampledData)[5][idx[i]]);
-						subV_idy.push_back((*stdp->subsampledData)[6][idx[i]]);
-						
-						if(stdp->KRIGING)
-						{
-							subX_idyKriged.push_back((*stdp->subsampledData)[0][idx[i]]); //x for kriging
-							subY_idyKriged.push_back((*stdp->subsampledData)[1][idx[i]]);
-						}
-						subX0.push_back((*stdp->x0)[idx[i]]);	//scattered input data sub-tile
-						subY0.push_back((*stdp->y0)[idx[i]]);
-					}
+					subX_idyKriged.push_back((*stdp->subsampledData)[0][idx[i]]); //x for kriging
+					subY_idyKriged.push_back((*stdp->subsampledData)[1][idx[i]]);
 				}
-				idySize = (const int)subX_idy.size();
-
-				#pragma region idySize
-				if (idySize > 2)
-				{
-					//E. Obtain a regular grid
-					// get number of indices in tile. idyi, col. idxi, row.
-					uint idyi = (uint)(*stdp->innerLoopIndexVector)[innerLoop].size(); 
-					uint idxi = (uint)outerLoopIndexVector.size(); 
+				subX0.push_back((*stdp->x0)[idx[i]]);	//scattered input data sub-tile
+				subY0.push_back((*stdp->y0)[idx[i]]);
+			}
+		}
+		idySize = (const int)subX_idy.size();
 
-					// get starting indices of tile. i, col. j, row
-					int i = ((*stdp->innerLoopIndexVector)[innerLoop])[0];
-					int j = outerLoopIndexVector[0];
+		#pragma region idySize
+		if (idySize > 2)
+		{
+			//E. Obtain a regular grid
+			// get number of indices in tile. idyi, col. idxi, row.
+			uint idyi = (uint)(*stdp->innerLoopIndexVector)[innerLoop].size(); 
+			uint idxi = (uint)outerLoopIndexVector.size(); 
+
+			// get starting indices of tile. i, col. j, row
+			int i = ((*stdp->innerLoopIndexVector)[innerLoop])[0];
+			int j = outerLoopIndexVector[0];
+
+			// get sub-tile of grid interpolation locations.
+			dgrid subXInterpLocs0;
+			dgrid subYInterpLocs0;
+			(*stdp->xInterpLocs0).subgrid(subXInterpLocs0, i, j, idyi, idxi);
+			(*stdp->yInterpLocs0).subgrid(subYInterpLocs0, i, j, idyi, idxi);
+
+			//F. Create Delaunay Tri from scattered input data sub-tile.
+			Bathy_Grid new_bathyGrid = Bathy_Grid();
+			new_bathyGrid.Construct_Tin(&subX0, &subY0, &subZ_idy, &subH_idy, &subV_idy);
+			
+			//G. Estimate depths at regular grid points
+			InterpGrid		new_gmt			= InterpGrid(GMT);					
+			vector<double>	subZInterpLocs0 = vector<double> ((subXInterpLocs0.vec()).size(), 0.00);
+			new_gmt.estimate(&subXInterpLocs0.vec(), &subYInterpLocs0.vec(), &subZInterpLocs0, 1.96, 2.00, *stdp->Lx, new_bathyGrid.getTin(), stdp->interpMethod, "", "");
+
+			//H. Find slopes at grid points
+			slopes = new_gmt.getGrads()->getSlopeOut();
+
+			//I. Find dmin
+			subXInterpLocs0_Vec = subXInterpLocs0.vec();
+			subYInterpLocs0_Vec = subYInterpLocs0.vec();
+			double minXi		= abs(subXInterpLocs0_Vec[1] - subXInterpLocs0_Vec[0]);
+			double minYi		= abs(subYInterpLocs0_Vec[1] - subYInterpLocs0_Vec[0]);
+			dmin				= 0.0;
+			for(int j = 1; j < (const int)subXInterpLocs0_Vec.size()-1; j++)
+			{
+				diffXi = abs(subXInterpLocs0_Vec[j+1] - subXInterpLocs0_Vec[j]);
+				diffYi = abs(subYInterpLocs0_Vec[j+1] - subYInterpLocs0_Vec[j]);
+				if(!(minXi > 0) && diffXi > 0)
+					minXi = diffXi;
+				else if(diffXi < minXi && diffXi > 0)
+					minXi = diffXi;
+
+				if(!(minYi > 0) && diffYi > 0)
+					minYi = diffYi;
+				else if(diffYi < minYi && diffYi > 0)
+					minYi = diffYi;
+
+				dmin = min(minXi, minYi);
+			}
 
-					// get sub-tile of grid interpolation locations.
-					dgrid subXInterpLocs0;
-					dgrid subYInterpLocs0;
-					(*stdp->xInterpLocs0).subgrid(subXInterpLocs0, i, j, idyi, idxi);
-					(*stdp->yInterpLocs0).subgrid(subYInterpLocs0, i, j, idyi, idxi);
+			if(dmin == 0)
+				cerr << "dmin equals 0";
 
-					//F. Create Delaunay Tri from scattered input data sub-tile.
-					Bathy_Grid new_bathyGrid = Bathy_Grid();
-					new_bathyGrid.Construct_Tin(&subX0, &subY0, &subZ_idy, &subH_idy, &subV_idy);
-					
-					//G. Estimate depths at regular grid points
-					InterpGrid		new_gmt			= InterpGrid(GMT);					
-					vector<double>	subZInterpLocs0 = vector<double> ((subXInterpLocs0.vec()).size(), 0.00);
-					new_gmt.estimate(&subXInterpLocs0.vec(), &subYInterpLocs0.vec(), &subZInterpLocs0, 1.96, 2.00, *stdp->Lx, new_bathyGrid.getTin(), stdp->interpMethod, "", "");
+			//J. Pre-compute the weights, riVector, and aiVector across the whole interpolation plane
+			perturbWeights.assign(idySize,2);
+			scalecInterpPerturbations_PreCompute(&subZ_idy, &subE_idy, &perturbWeights, &perturb);
 
-					//H. Find slopes at grid points
-					slopes = new_gmt.getGrads()->getSlopeOut();
+			//Index the tile data once so each node only visits points inside its window.
+			//	Coordinates are scaled by the smoothing scale so the narrowest window has radius 1.
+			dataIndex.build(&subX_idy, &subY_idy, 1.0);
 
-					//I. Find dmin
-					subXInterpLocs0_Vec = subXInterpLocs0.vec();
-					subYInterpLocs0_Vec = subYInterpLocs0.vec();
-					double minXi		= abs(subXInterpLocs0_Vec[1] - subXInterpLocs0_Vec[0]);
-					double minYi		= abs(subYInterpLocs0_Vec[1] - subYInterpLocs0_Vec[0]);
-					dmin				= 0.0;
-					for(int j = 1; j < (const int)subXInterpLocs0_Vec.size()-1; j++)
+			if(stdp->KRIGING)
+			{
+				#pragma region Interpolate --_Compute_ForKriging (the same as _Compute)
+				iliv_Loc0 = ((*stdp->innerLoopIndexVector)[innerLoop])[0];	//first innerLoopIndexVector location
+				oliv_Loc0 = outerLoopIndexVector[0];						//first outerLoopIndexVector location
+				tgs1_first = (*stdp->xMeshGrid)(iliv_Loc0, oliv_Loc0);		//get first xValue for xa+yb+c
+				tgs2_first = (*stdp->yMeshGrid)(iliv_Loc0, oliv_Loc0);		//get first yValue
+
+				iliv_Loc1 = ((*stdp->innerLoopIndexVector)[innerLoop])[((*stdp->innerLoopIndexVector)[innerLoop]).size() - 1]; //first innerLoopIndexVector loc
+				oliv_Loc1 = outerLoopIndexVector[outerLoopIndexVector.size()-1];	//first outerLoopIndexVector loc
+				tgs1_last = (*stdp->xMeshGrid)(iliv_Loc1, oliv_Loc1);				//get last xValue for xa+yb+c
+				tgs2_last = (*stdp->yMeshGrid)(iliv_Loc1, oliv_Loc1);				//get last yValue
+				vector<double> slopesVec2 = vector<double>((*stdp->subsampledData)[0].size(), 1.00);
+
+				//F. Get interpolation values at observation locations
+				//We are doing input values here!
+				for (int i = 0; i < (const int)idySize; i++)
+				{
+					Xiii(0,0) = subX0[i];				//doesn't matter cause we have a regular grid
+					Xiii(0,1) = subX0[i];
+
+					tgs1_Compute = subX_idy[i];			//current input xValue in tile
+					tgs2_Compute = subY_idy[i];
+					perturb.perturbationZKriged	= 0.0;
+					perturb.perturbationEKriged	= 1.0;
+					perturb.perturbationNEiKriged = 1.0;
+					perturb.perturbationREiKriged = 1.0;
+					if(stdp->PROP_UNCERT)
 					{
-						diffXi = abs(subXInterpLocs0_Vec[j+1] - subXInterpLocs0_Vec[j]);
-						diffYi = abs(subYInterpLocs0_Vec[j+1] - subYInterpLocs0_Vec[j]);
-						if(!(minXi > 0) && diffXi > 0)
-							minXi = diffXi;
-						else if(diffXi < minXi && diffXi > 0)
-							minXi = diffXi;
-
-						if(!(minYi > 0) && diffYi > 0)
-							minYi = diffYi;
-						else if(diffYi < minYi && diffYi > 0)
-							minYi = diffYi;
-
-						dmin = min(minXi, minYi);
+						perturb.perturbationZ0Kriged = 0.0;
+						perturb.perturbationE0Kriged = 1.0;
+					}
+					if(stdp->KALMAN)
+					{
+						perturb.perturbationZKKriged = 0.0;
+						perturb.perturbationEKKriged = 1.0;
 					}
 
-					if(dmin == 0)
-						cerr << "dmin equals 0";
+					//We are doing the input data 
+					//This is calls the original kriging function which does not have the new functionality and bug fixes.
+					//scalecInterpPerturbations_Compute_ForKriging(&subX_idx, &subY_idx, &z_idx, &e_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, &perturb.riVector, &perturb.aiVector, (*sdp->neitol), &perturb.perturbationZKriged, &perturbationEKriged, &perturb.perturbationNEiKriged, &perturb.perturbationREiKriged, &standardDevKriged);
 
-					//J. Pre-compute the weights, riVector, and aiVector across the whole interpolation plane
-					perturbWeights = vector<double>(idySize,2);
-					scalecInterpPerturbations_PreCompute(&subZ_idy, &subE_idy, &perturbWeights, &perturb);
+					//Current function
+					scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (slopesVec2)[i], &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, stdp->KRIGING, &dataIndex, &scratch);
+				
+					//COMPARE THE DIFFERENCE BETWEEN SUBTILES: xMeshGrid AND subY_idyKriged AND 
+					//Keep (un-scaled subtile input) kriged indices within MeshGrid (interpolation) subtile and remove kriged depth. 
+					// We want to capture data in the tile that is not part of the
+					// overlap.
+					if ( (subY_idyKriged[i] > tgs2_first) && (subY_idyKriged[i] < tgs2_last)
+					  && (subX_idyKriged[i] > tgs1_first) && (subX_idyKriged[i] < tgs1_last))
+					{
+						residualObservationsKrigedZ.push_back(subZ_idy[i] - perturb.perturbationZKriged);
+						subX_indexKriged.push_back(subX_idyKriged[i]);
+						subY_indexKriged.push_back(subY_idyKriged[i]);			
 
-					if(stdp->KRIGING)
+						//NEED TO CHECK TO SEE IF subX_indexKriged ARE THE SAME FOR ALL
+						if(stdp->PROP_UNCERT)
+							residualObservationsKrigedZ0.push_back(subZ_idy[i] - perturb.perturbationZ0Kriged);
+						if(stdp->KALMAN)
+							residualObservationsKrigedZK.push_back(subZ_idy[i] - perturb.perturbationZKKriged);
+					}
+				} //idySize
+				#pragma endregion Interpolate _Compute_ForKriging
+
+				#pragma region --ordinaryKrigingOfResiduals_PreCompute, Subtile Kriged Indices if if too large 
+				//Tiles with too few residuals are not kriged; clear the previous tile's kriged values so they add nothing.
+				nKrigNodes = (const int)(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
+				fill(outputDepthKrig.begin(), outputDepthKrig.begin() + nKrigNodes, 0.0);
+				fill(outputErrorKrig.begin(), outputErrorKrig.begin() + nKrigNodes, 0.0);
+				fill(outputDepth0Krig.begin(), outputDepth0Krig.begin() + nKrigNodes, 0.0);
+				fill(outputError0Krig.begin(), outputError0Krig.begin() + nKrigNodes, 0.0);
+				fill(outputDepthKKrig.begin(), outputDepthKKrig.begin() + nKrigNodes, 0.0);
+				fill(outputErrorKKrig.begin(), outputErrorKKrig.begin() + nKrigNodes, 0.0);
+				if (subX_indexKriged.size() >= 15)
+				{
+					//G. We need to subtile the kriged indices otherwise the matrix inversion takes too long -- TODO
+					if((stdp->KRIGING_NEIGHBORS == 0 && subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD) || (stdp->KRIGING_NEIGHBORS > 0 && (const int)subX_indexKriged.size() > stdp->KRIGING_NEIGHBORS))
 					{
-						#pragma region Interpolate --_Compute_ForKriging (the same as _Compute)
-						iliv_Loc0 = ((*stdp->innerLoopIndexVector)[innerLoop])[0];	//first innerLoopIndexVector location
-						oliv_Loc0 = outerLoopIndexVector[0];						//first outerLoopIndexVector location
-						tgs1_first = (*stdp->xMeshGrid)(iliv_Loc0, oliv_Loc0);		//get first xValue for xa+yb+c
-						tgs2_first = (*stdp->yMeshGrid)(iliv_Loc0, oliv_Loc0);		//get first yValue
-
-						iliv_Loc1 = ((*stdp->innerLoopIndexVector)[innerLoop])[((*stdp->innerLoopIndexVector)[innerLoop]).size() - 1]; //first innerLoopIndexVector loc
-						oliv_Loc1 = outerLoopIndexVector[outerLoopIndexVector.size()-1];	//first outerLoopIndexVector loc
-						tgs1_last = (*stdp->xMeshGrid)(iliv_Loc1, oliv_Loc1);				//get last xValue for xa+yb+c
-						tgs2_last = (*stdp->yMeshGrid)(iliv_Loc1, oliv_Loc1);				//get last yValue
-						vector<double> slopesVec2 = vector<double>((*stdp->subsampledData)[0].size(), 1.00);
-
-						//F. Get interpolation values at observation locations
-						//We are doing input values here!
-						for (int i = 0; i < (const int)idySize; i++)
+						#pragma region --Subtile Kriged Indices
+						k = 0;
+						xIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
+						yIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
+						for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
 						{
-							Xiii(0,0) = subX0[i];				//doesn't matter cause we have a regular grid
-							Xiii(0,1) = subX0[i];
-
-							tgs1_Compute = subX_idy[i];			//current input xValue in tile
-							tgs2_Compute = subY_idy[i];
-							perturb.perturbationZKriged	= 0.0;
-							perturb.perturbationEKriged	= 1.0;
-							perturb.perturbationNEiKriged = 1.0;
-							perturb.perturbationREiKriged = 1.0;
-							if(stdp->PROP_UNCERT)
+							for (int j = 0; j < (const int)((*stdp->innerLoopIndexVector)[innerLoop]).size(); j++)
 							{
-								perturb.perturbationZ0Kriged = 0.0;
-								perturb.perturbationE0Kriged = 1.0;
-							}
-							if(stdp->KALMAN)
-							{
-								perturb.perturbationZKKriged = 0.0;
-								perturb.perturbationEKKriged = 1.0;
+								iliv_Loc = ((*stdp->innerLoopIndexVector)[innerLoop])[j];
+								oliv_Loc = outerLoopIndexVector[i];
+								xIndexKriged_Vector[k] = (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);	//kriged indices subtile (interpolation locations)
+								yIndexKriged_Vector[k] = (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);
+								k++;
+
 							}
+						}
 
-							//We are doing the input data 
-							//This is calls the original kriging function which does not have the new functionality and bug fixes.
-							//scalecInterpPerturbations_Compute_ForKriging(&subX_idx, &subY_idx, &z_idx, &e_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, &perturb.riVector, &perturb.aiVector, (*sdp->neitol), &perturb.perturbationZKriged, &perturbationEKriged, &perturb.perturbationNEiKriged, &perturb.perturbationREiKriged, &standardDevKriged);
+						if(stdp->KRIGING_NEIGHBORS > 0)
+						{
+							//Krige each location from its nearest residuals
+							ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, stdp->KRIGING_NEIGHBORS, &outputDepthKrig, &outputErrorKrig);
+							if(stdp->PROP_UNCERT)
+								ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, stdp->KRIGING_NEIGHBORS, &outputDepth0Krig, &outputError0Krig);
+							if(stdp->KALMAN)
+								ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, stdp->KRIGING_NEIGHBORS, &outputDepthKKrig, &outputErrorKKrig);
+						}
+						else
+						{
+							//cout << "To Tile Call" << endl;
+							ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
 
-							//Current function
-							scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (slopesVec2)[i], &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, stdp->KRIGING);
-						
-							//COMPARE THE DIFFERENCE BETWEEN SUBTILES: xMeshGrid AND subY_idyKriged AND 
-							//Keep (un-scaled subtile input) kriged indices within MeshGrid (interpolation) subtile and remove kriged depth. 
-							// We want to capture data in the tile that is not part of the
-							// overlap.
-							if ( (subY_idyKriged[i] > tgs2_first) && (subY_idyKriged[i] < tgs2_last)
-							  && (subX_idyKriged[i] > tgs1_first) && (subX_idyKriged[i] < tgs1_last))
-							{
-								residualObservationsKrigedZ.push_back(subZ_idy[i] - perturb.perturbationZKriged);
-								subX_indexKriged.push_back(subX_idyKriged[i]);
-								subY_indexKriged.push_back(subY_idyKriged[i]);			
+							if(stdp->PROP_UNCERT)
+								ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
+							if(stdp->KALMAN)
+								ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+						}
 
-								//NEED TO CHECK TO SEE IF subX_indexKriged ARE THE SAME FOR ALL
-								if(stdp->PROP_UNCERT)
-									residualObservationsKrigedZ0.push_back(subZ_idy[i] - perturb.perturbationZ0Kriged);
-								if(stdp->KALMAN)
-									residualObservationsKrigedZK.push_back(subZ_idy[i] - perturb.perturbationZKKriged);
-							}
-						} //idySize
-						#pragma endregion Interpolate _Compute_ForKriging
+						xIndexKriged_Vector.clear();
+						yIndexKriged_Vector.clear();
+						#pragma endregion Subtile Kriged Indices
+					}
+					else
+					{
+						#pragma region --Do Not Subtile Kriged Indices
+						//small enough to do all at once
+						ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
+					
+						if(stdp->PROP_UNCERT)
+							ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
+						if(stdp->KALMAN)
+							ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 
-						#pragma region --ordinaryKrigingOfResiduals_PreCompute, Subtile Kriged Indices if if too large 
-						if (subX_indexKriged.size() >= 15)
+						k = 0;
+						//H. Krig the data.  Gather the interpolation locations so each set of residuals is solved against the factored system in batches.
+						xIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
+						yIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
+						for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
 						{
-							//G. We need to subtile the kriged indices otherwise the matrix inversion takes too long -- TODO
-							if(subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD)
+							for (int j = 0; j < (const int)((*stdp->innerLoopIndexVector)[innerLoop]).size(); j++)
 							{
-								#pragma region --Subtile Kriged Indices
-								k = 0;
-								xIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
-								yIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
-								for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
-								{
-									for (int j = 0; j < (const int)((*stdp->innerLoopIndexVector)[innerLoop]).size(); j++)
-									{
-										iliv_Loc = ((*stdp->innerLoopIndexVector)[innerLoop])[j];
-										oliv_Loc = outerLoopIndexVector[i];
-										xIndexKriged_Vector[k] = (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);	//kriged indices subtile (interpolation locations)
-										yIndexKriged_Vector[k] = (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);
-										k++;
-
-									}
-								}
-
-								//cout << "To Tile Call" << endl;
-								ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
+								iliv_Loc = ((*stdp->innerLoopIndexVector)[innerLoop])[j];
+								oliv_Loc = outerLoopIndexVector[i];
+								xIndexKriged_Vector[k] = (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);
+								yIndexKriged_Vector[k] = (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);
+								k++;
+							} // innerLoopIndexVector
+						} // outerLoopInde
+
+						//Compute the residual values
+						ordinaryKrigingOfResiduals_PostComputeBatch(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &outputDepthKrig, &outputErrorKrig);
+						if(stdp->PROP_UNCERT)
+							ordinaryKrigingOfResiduals_PostComputeBatch(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &outputDepth0Krig, &outputError0Krig);
+						if(stdp->KALMAN)
+							ordinaryKrigingOfResiduals_PostComputeBatch(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &outputDepthKKrig, &outputErrorKKrig);
+
+						xIndexKriged_Vector.clear();
+						yIndexKriged_Vector.clear();
+						twoGammaHatVector.clear();
+						distanceVectorBinCenters.clear();
+						aVectorFine.clear();
+						luGammaDArray.clear();
+						gammaDPivots.clear();
+						AGrid.clear();
+						#pragma endregion Do Not Subtile Kriged Indices
+					} 
+				} 
+				#pragma endregion ordinaryKrigingOfResiduals_PreCompute
+			}
 
-								if(stdp->PROP_UNCERT)
-									ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
-								if(stdp->KALMAN)
-									ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+			//Continue normal processing
+			double outDepthKrig;
+			double outErrorKrig;
+			double outDepth0Krig;
+			double outError0Krig;
+			double outDepthKKrig;
+			double outErrorKKrig;
+			#pragma region Interpolate 
+			//K. Gather the independent points of the tile in the order they are written
+			const int innerSize = (const int)(*stdp->innerLoopIndexVector)[innerLoop].size();
+			const int nNodes = (const int)outerLoopIndexVector.size() * innerSize;
+			nodeX.resize(nNodes);
+			nodeY.resize(nNodes);
+			nodeX0.resize(nNodes);
+			nodeY0.resize(nNodes);
+			nodeSlopes.resize(nNodes);
+			k=0;
+			for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
+			{
+				for (int j = 0; j < innerSize; j++)
+				{
+					iliv_Loc		= ((*stdp->innerLoopIndexVector)[innerLoop])[j];
+					oliv_Loc		= outerLoopIndexVector[i];
+					nodeX[k]		= (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc) * (*stdp->Lx);	//scale xValue
+					nodeY[k]		= (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc) * (*stdp->Ly);	//scale yValue
+					nodeX0[k]		= subXInterpLocs0(j, i);								// current interpolation location
+					nodeY0[k]		= subYInterpLocs0(j, i);
+					nodeSlopes[k]	= (*slopes)(j,i);
+					k++;
+				}
+			}
 
-								xIndexKriged_Vector.clear();
-								yIndexKriged_Vector.clear();
-								#pragma endregion Subtile Kriged Indices
-							}
-							else
-							{
-								#pragma region --Do Not Subtile Kriged Indices
-								//small enough to do all at once
-								ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
-							
-								if(stdp->PROP_UNCERT)
-									ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
-								if(stdp->KALMAN)
-									ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+			//L. Compute the values of every point in one sweep of the tile data, or by convolution
+			if(stdp->FFT_SMOOTHING)
+			{
+				if (scalecInterpPerturbations_ComputeTileFFT(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &nodeX, &nodeY, &nodeX0, &nodeY0, &nodeSlopes, innerSize, &perturbWeights, (*stdp->neitol), dmin, &subX0, &subY0, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, &tileOut, &dataIndex, &scratch))
+					(*stdp->fftTiles)[curIterNum]++;
+			}
+			else
+				scalecInterpPerturbations_ComputeTile(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &nodeX, &nodeY, &nodeX0, &nodeY0, &nodeSlopes, &perturbWeights, (*stdp->neitol), dmin, &subX0, &subY0, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, &tileOut, &dataIndex, &scratch);
 
-								k = 0;
-								//H. Krig the data
-								for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
-								{
-									for (int j = 0; j < (const int)((*stdp->innerLoopIndexVector)[innerLoop]).size(); j++)
-									{
-										zKriged = 0.00;
-										varZKriged = 0.00;
-										iliv_Loc = ((*stdp->innerLoopIndexVector)[innerLoop])[j];
-										oliv_Loc = outerLoopIndexVector[i];
-										xGrid_indexKriged = (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);
-										yGrid_indexKriged = (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);
-									
-										//Compute the residual value
-										ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKriged, &varZKriged);
-									
-										outputDepthKrig[k] = zKriged;
-										outputErrorKrig[k] = varZKriged;
-
-										if(stdp->PROP_UNCERT)
-										{
-											z0Kriged = 0.00;
-											varZ0Kriged = 0.00;
-
-											ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &z0Kriged, &varZ0Kriged);
-									
-											outputDepth0Krig[k] = z0Kriged;
-											outputError0Krig[k] = varZ0Kriged;
-										}
-										if(stdp->KALMAN)
-										{
-											zKKriged = 0.00;
-											varZKKriged = 0.00;
-										
-											ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKKriged, &varZKKriged);
-									
-											outputDepthKKrig[k] = zKKriged;
-											outputErrorKKrig[k] = varZKKriged;
-										}
-
-										k++;
-									} // innerLoopIndexVector
-								} // outerLoopInde
-								twoGammaHatVector.clear();
-								distanceVectorBinCenters.clear();
-								aVectorFine.clear();
-								invGammaDArray.clear();
-								AGrid.clear();
-								#pragma endregion Do Not Subtile Kriged Indices
-							} 
-						} 
-						#pragma endregion ordinaryKrigingOfResiduals_PreCompute
-					}
+			k=0;
+			for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
+			{
+				for (int j = 0; j < innerSize; j++)
+				{
+					iliv_Loc		= ((*stdp->innerLoopIndexVector)[innerLoop])[j];
+					oliv_Loc		= outerLoopIndexVector[i];
+					tgs1			= (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);	//get current xValue
+					tgs2			= (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);	//get current yValue
 
-					//Continue normal processing
-					double outDepthKrig;
-					double outErrorKrig;
-					double outDepth0Krig;
-					double outError0Krig;
-					double outDepthKKrig;
-					double outErrorKKrig;
-					#pragma region Interpolate 
-					k=0;
-					//K. Do the interpolation over each independent point
-					for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
+					if(stdp->KRIGING)
 					{
-						for (int j = 0; j < (const int)(*stdp->innerLoopIndexVector)[innerLoop].size(); j++)
+						outDepthKrig  = outputDepthKrig[k];
+						outErrorKrig  = outputErrorKrig[k];
+						if(stdp->PROP_UNCERT)
 						{
-							// current interpolation location
-							Xiii(0,0) = subXInterpLocs0(j, i);
-							Xiii(0,1) = subYInterpLocs0(j, i);
-						
-							iliv_Loc		= ((*stdp->innerLoopIndexVector)[innerLoop])[j];
-							oliv_Loc		= outerLoopIndexVector[i];
-							tgs1			= (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);	//get current xValue
-							tgs2			= (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);	//get current yValue
-							tgs1_Compute	= tgs1 * (*stdp->Lx);						//scale xValue
-							tgs2_Compute	= tgs2 * (*stdp->Ly);						//scale yValue
-
-							perturb.perturbationZ	= 0.0;
-							perturb.perturbationE	= 1.0;
-							perturb.perturbationNEi = 1.0;
-							perturb.perturbationREi = 1.0;
-							if(stdp->PROP_UNCERT)
-							{
-								perturb.perturbationZ0 = 0.0;
-								perturb.perturbationE0 = 1.0;
-							}
-							if(stdp->KALMAN)
-							{
-								perturb.perturbationZK = 0.0;
-								perturb.perturbationEK = 1.0;
-							}
-							if(stdp->KRIGING)
-							{
-								outDepthKrig  = outputDepthKrig[k];
-								outErrorKrig  = outputErrorKrig[k];
-								if(stdp->PROP_UNCERT)
-								{
-									outDepth0Krig = outputDepth0Krig[k];
-									outError0Krig = outputError0Krig[k];
-								}
-								if(stdp->KALMAN)
-								{
-									outDepthKKrig = outputDepthKKrig[k];
-									outErrorKKrig = outputErrorKKrig[k];
-								}
-							}
-							else
-							{
-								outDepthKrig  = 0;
-								outErrorKrig  = 0;
-								outDepth0Krig = 0;
-								outError0Krig = 0;
-								outDepthKKrig = 0;
-								outErrorKKrig = 0;
-							}
-							//L. Compute the value
-							scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (*slopes)(j,i), &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, 0); //0 because were not kriging the residuals here... that's done above
+							outDepth0Krig = outputDepth0Krig[k];
+							outError0Krig = outputError0Krig[k];
+						}
+						if(stdp->KALMAN)
+						{
+							outDepthKKrig = outputDepthKKrig[k];
+							outErrorKKrig = outputErrorKKrig[k];
+						}
+					}
+					else
+					{
+						outDepthKrig  = 0;
+						outErrorKrig  = 0;
+						outDepth0Krig = 0;
+						outError0Krig = 0;
+						outDepthKKrig = 0;
+						outErrorKKrig = 0;
+					}
 
-							//M. Put trend back into this tile.
-							assnGridValue = tgs0*(*stdp->btrend)[0]+tgs1*(*stdp->btrend)[1]+tgs2*(*stdp->btrend)[2];
-							if((*stdp->outputNEi)(iliv_Loc,oliv_Loc)!=1)
-								int stop=1;
+					//M. Put trend back into this tile.
+					assnGridValue = tgs0*(*stdp->btrend)[0]+tgs1*(*stdp->btrend)[1]+tgs2*(*stdp->btrend)[2];
 
-							(*stdp->outputDepth)(iliv_Loc,oliv_Loc) = perturb.perturbationZ + assnGridValue + outDepthKrig;
-							(*stdp->outputError)(iliv_Loc,oliv_Loc) = perturb.perturbationE + outErrorKrig;
-							(*stdp->outputNEi)(iliv_Loc,oliv_Loc)	= perturb.perturbationNEi;
-							(*stdp->outputREi)(iliv_Loc,oliv_Loc)	= perturb.perturbationREi;
-							(*stdp->standardDev)(iliv_Loc,oliv_Loc) = perturb.standardDev2;
-							if(stdp->PROP_UNCERT)
-							{
-								(*stdp->outputDepth0)(iliv_Loc,oliv_Loc) = perturb.perturbationZ0 + assnGridValue + outDepth0Krig;
-								(*stdp->outputError0)(iliv_Loc,oliv_Loc) = perturb.perturbationE0 + outError0Krig;
-		//						(*stdp->standardDev0)(iliv_Loc,oliv_Loc) = perturb.standardDev20;
-							}
-							if(stdp->KALMAN)
-							{
-								(*stdp->outputDepthK)(iliv_Loc,oliv_Loc) = perturb.perturbationZK + assnGridValue + outDepthKKrig;
-								(*stdp->outputErrorK)(iliv_Loc,oliv_Loc) = perturb.perturbationEK + outErrorKKrig;
-							}
-							k++;
-						}
+					(*stdp->outputDepth)(iliv_Loc,oliv_Loc) = tileOut.depth[k] + assnGridValue + outDepthKrig;
+					(*stdp->outputError)(iliv_Loc,oliv_Loc) = tileOut.error[k] + outErrorKrig;
+					(*stdp->outputNEi)(iliv_Loc,oliv_Loc)	= tileOut.nEi[k];
+					(*stdp->outputREi)(iliv_Loc,oliv_Loc)	= tileOut.rEi[k];
+					(*stdp->standardDev)(iliv_Loc,oliv_Loc) = tileOut.standardDev[k];
+					if(stdp->PROP_UNCERT)
+					{
+						(*stdp->outputDepth0)(iliv_Loc,oliv_Loc) = tileOut.depth0[k] + assnGridValue + outDepth0Krig;
+						(*stdp->outputError0)(iliv_Loc,oliv_Loc) = tileOut.error0[k] + outError0Krig;
 					}
-					#pragma endregion Interpolate
-					//required clears!
-					perturbWeights.clear();
-					perturb.riVector.clear();
-					perturb.aiVector.clear();
-					new_bathyGrid.clear();
-					new_gmt.clear();
-					subXInterpLocs0.clear();
-					subYInterpLocs0.clear();
-					slopes = NULL;
-					if(stdp->KRIGING)
+					if(stdp->KALMAN)
 					{
-						residualObservationsKrigedZ.clear();
-						subX_indexKriged.clear();
-						subY_indexKriged.clear();
-						if(stdp->PROP_UNCERT)
-							residualObservationsKrigedZ0.clear();
-						if(stdp->KALMAN)
-							residualObservationsKrigedZK.clear();
+						(*stdp->outputDepthK)(iliv_Loc,oliv_Loc) = tileOut.depthK[k] + assnGridValue + outDepthKKrig;
+						(*stdp->outputErrorK)(iliv_Loc,oliv_Loc) = tileOut.errorK[k] + outErrorKKrig;
 					}
-				} //idySize
-				#pragma endregion idySize
-				//required clears!
-				subX_idy.clear();
-				subY_idy.clear();
-				subZ_idy.clear();
-				subE_idy.clear();
-				subH_idy.clear();
-				subV_idy.clear();
-				subX0.clear();
-				subY0.clear();
-				if(stdp->KRIGING)
-				{
-					subX_idyKriged.clear();
-					subY_idyKriged.clear();
+					k++;
 				}
-			} //innerloop
-		} //idxSize
-		#pragma endregion idxSize
-		outerLoopIndexVector.clear();
-		idx.clear();
-	} //outerloop
+			}
+			#pragma endregion Interpolate
+			//required clears!
+			perturbWeights.clear();
+			dataIndex.clear();
+			perturb.riVector.clear();
+			perturb.aiVector.clear();
+			new_bathyGrid.clear();
+			new_gmt.clear();
+			subXInterpLocs0.clear();
+			subYInterpLocs0.clear();
+			slopes = NULL;
+			if(stdp->KRIGING)
+			{
+				residualObservationsKrigedZ.clear();
+				subX_indexKriged.clear();
+				subY_indexKriged.clear();
+				if(stdp->PROP_UNCERT)
+					residualObservationsKrigedZ0.clear();
+				if(stdp->KALMAN)
+					residualObservationsKrigedZK.clear();
+			}
+		} //idySize
+		#pragma endregion idySize
+		//required clears!
+		subX_idy.clear();
+		subY_idy.clear();
+		subZ_idy.clear();
+		subE_idy.clear();
+		subH_idy.clear();
+		subV_idy.clear();
+		subX0.clear();
+		subY0.clear();
+		if(stdp->KRIGING)
+		{
+			subX_idyKriged.clear();
+			subY_idyKriged.clear();
+		}
+	} //tiles
 	if(stdp->KRIGING)
 	{
 		outputDepthKrig.clear();
@@ -1043,6 +1144,7 @@ int scalecInterpTile_Process(SCALEC_TILE_DATA_POINTER stdp, const int curIterNum
 	double assnGridValue;
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
 	perturb.kernelName = *(*stdp).kernelName;
 
 	//************************************************************************************
@@ -1163,7 +1265,7 @@ int scalecInterpTile_Process(SCALEC_TILE_DATA_POINTER stdp, const int curIterNum
 						cerr << "dmin equals 0";
 
 					//J. Pre-compute the weights, riVector, and aiVector across the whole interpolation plane
-					perturbWeights = vector<double>(idySize,2);
+					perturbWeights.assign(idySize,2);
 					scalecInterpPerturbations_PreCompute(&subZ_idy, &subE_idy, &perturbWeights, &perturb);
 
 					#pragma region Interpolate 
@@ -1200,7 +1302,7 @@ int scalecInterpTile_Process(SCALEC_TILE_DATA_POINTER stdp, const int curIterNum
 
 							bool KRIGING = 0;
 							//L. Compute the value
-							scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (*slopes)(j,i), &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, KRIGING);
+							scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (*slopes)(j,i), &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, KRIGING, NULL, &scratch);
 
 							//M. Put trend back into this tile.
 							assnGridValue = tgs0*(*stdp->btrend)[0]+tgs1*(*stdp->btrend)[1]+tgs2*(*stdp->btrend)[2];
@@ -1269,8 +1371,10 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 	
 	vector<double> outputDepthKKrig = vector<double>((*stdp->xMeshGrid).rows()*(*stdp->xMeshGrid).cols(),0);
 	vector<double> outputErrorKKrig = vector<double>((*stdp->xMeshGrid).rows()*(*stdp->xMeshGrid).cols(),0);
+	int nKrigNodes;
 
 	PERTURBS perturb;
+	PERTURB_SCRATCH scratch;				// working buffers of scalecInterpPerturbations_Compute, reused by every node
 	perturb.kernelName=*(*stdp).kernelName;
 	bool KRIGING = true;
 
@@ -1294,14 +1398,6 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 	//double perturbationNEiKriged;
 	//double perturbationREiKriged;
 	//double thetaM, phi_2;
-	double zKriged;
-	double varZKriged;
-	double z0Kriged;
-	double varZ0Kriged;
-	double zKKriged;
-	double varZKKriged;
-	double xGrid_indexKriged;
-	double yGrid_indexKriged;
 //	double standardDevKriged;
 
 	vector<int> outerLoopIndexVector;
@@ -1337,7 +1433,8 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 	vector<double> twoGammaHatVector;
 	vector<double> distanceVectorBinCenters;
 	vector<double> aVectorFine;
-	dgrid invGammaDArray;
+	dgrid luGammaDArray;
+	ivector gammaDPivots;
 	dgrid AGrid;
 
 
@@ -1492,7 +1589,7 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 						cerr << "dmin equals 0";
 
 					//E. Precompute the weights, riVector, and aiVector across the whole interpolation plane
-					perturbWeights = vector<double>(idySize,2);
+					perturbWeights.assign(idySize,2);
 					scalecInterpPerturbations_PreCompute(&subZ_idy, &subE_idy, &perturbWeights, &perturb);
 					#pragma endregion
 
@@ -1537,7 +1634,7 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 						//scalecInterpPerturbations_Compute_ForKriging(&subX_idx, &subY_idx, &z_idx, &e_idx, &tgs1_Compute, &tgs2_Compute, &perturbWeights, &perturb.riVector, &perturb.aiVector, (*sdp->neitol), &perturb.perturbationZKriged, &perturbationEKriged, &perturb.perturbationNEiKriged, &perturb.perturbationREiKriged, &standardDevKriged);
 
 						//Current function
-						scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (slopesVec2)[i], &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, KRIGING=1);
+						scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (slopesVec2)[i], &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, KRIGING=1, NULL, &scratch);
 						
 						//COMPARE THE DIFFERENCE BETWEEN SUBTILES: xMeshGrid AND subY_idyKriged AND 
 						//Keep (un-scaled subtile input) kriged indices within MeshGrid (interpolation) subtile and remove kriged depth. 
@@ -1558,10 +1655,18 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 					#pragma endregion Interpolate _Compute_ForKriging
 
 					#pragma region --ordinaryKrigingOfResiduals_PreCompute, Subtile Kriged Indices if if too large 
+					//Tiles with too few residuals are not kriged; clear the previous tile's kriged values so they add nothing.
+					nKrigNodes = (const int)(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
+					fill(outputDepthKrig.begin(), outputDepthKrig.begin() + nKrigNodes, 0.0);
+					fill(outputErrorKrig.begin(), outputErrorKrig.begin() + nKrigNodes, 0.0);
+					fill(outputDepth0Krig.begin(), outputDepth0Krig.begin() + nKrigNodes, 0.0);
+					fill(outputError0Krig.begin(), outputError0Krig.begin() + nKrigNodes, 0.0);
+					fill(outputDepthKKrig.begin(), outputDepthKKrig.begin() + nKrigNodes, 0.0);
+					fill(outputErrorKKrig.begin(), outputErrorKKrig.begin() + nKrigNodes, 0.0);
 					if (subX_indexKriged.size() >= 15)
 					{
 						//G. We need to subtile the kriged indices otherwise the matrix inversion takes too long -- TODO
-						if(subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD)
+						if((stdp->KRIGING_NEIGHBORS == 0 && subX_indexKriged.size() > KRIGED_SIZE_THRESHOLD) || (stdp->KRIGING_NEIGHBORS > 0 && (const int)subX_indexKriged.size() > stdp->KRIGING_NEIGHBORS))
 						{
 							#pragma region --Subtile Kriged Indices
 							k = 0;
@@ -1580,13 +1685,25 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 								}
 							}
 
-							//cout << "To Tile Call" << endl;
-							ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
+							if(stdp->KRIGING_NEIGHBORS > 0)
+							{
+								//Krige each location from its nearest residuals
+								ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, stdp->KRIGING_NEIGHBORS, &outputDepthKrig, &outputErrorKrig);
+								if(stdp->PROP_UNCERT)
+									ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, stdp->KRIGING_NEIGHBORS, &outputDepth0Krig, &outputError0Krig);
+								if(stdp->KALMAN)
+									ordinaryKrigingOfResiduals_Local(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, stdp->KRIGING_NEIGHBORS, &outputDepthKKrig, &outputErrorKKrig);
+							}
+							else
+							{
+								//cout << "To Tile Call" << endl;
+								ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKrig, &outputErrorKrig);
 
-							if(stdp->PROP_UNCERT)
-								ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
-							if(stdp->KALMAN)
-								ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+								if(stdp->PROP_UNCERT)
+									ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepth0Krig, &outputError0Krig);
+								if(stdp->KALMAN)
+									ordinaryKrigingOfResiduals_PreComputeTile(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, locSpacingX, locSpacingY, &outputDepthKKrig, &outputErrorKKrig);
+							}
 
 							xIndexKriged_Vector.clear();
 							yIndexKriged_Vector.clear();
@@ -1596,60 +1713,43 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 						{
 							#pragma region --Do Not Subtile Kriged Indices
 							//small enough to do all at once
-							ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+							ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 							
 							if(stdp->PROP_UNCERT)
-								ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+								ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 							if(stdp->KALMAN)
-								ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid);
+								ordinaryKrigingOfResiduals_PreCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid);
 
 							k = 0;
-							//H. Krig the data
+							//H. Krig the data.  Gather the interpolation locations so each set of residuals is solved against the factored system in batches.
+							xIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
+							yIndexKriged_Vector = vector<double>(outerLoopIndexVector.size()*((*stdp->innerLoopIndexVector)[innerLoop]).size());
 							for (int i = 0; i < (const int)outerLoopIndexVector.size(); i++)
 							{
 								for (int j = 0; j < (const int)((*stdp->innerLoopIndexVector)[innerLoop]).size(); j++)
 								{
-									zKriged = 0.00;
-									varZKriged = 0.00;
 									iliv_Loc = ((*stdp->innerLoopIndexVector)[innerLoop])[j];
 									oliv_Loc = outerLoopIndexVector[i];
-									xGrid_indexKriged = (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);
-									yGrid_indexKriged = (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);
-									
-									//Compute the residual value
-									ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKriged, &varZKriged);
-									
-									outputDepthKrig[k] = zKriged;
-									outputErrorKrig[k] = varZKriged;
-
-									if(stdp->PROP_UNCERT)
-									{
-										z0Kriged = 0.00;
-										varZ0Kriged = 0.00;
-
-										ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &z0Kriged, &varZ0Kriged);
-									
-										outputDepth0Krig[k] = z0Kriged;
-										outputError0Krig[k] = varZ0Kriged;
-									}
-									if(stdp->KALMAN)
-									{
-										zKKriged = 0.00;
-										varZKKriged = 0.00;
-										
-										ordinaryKrigingOfResiduals_PostCompute(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xGrid_indexKriged, &yGrid_indexKriged, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &invGammaDArray, &AGrid, &zKKriged, &varZKKriged);
-									
-										outputDepthKKrig[k] = zKKriged;
-										outputErrorKKrig[k] = varZKKriged;
-									}
-
+									xIndexKriged_Vector[k] = (*stdp->xMeshGrid)(iliv_Loc,oliv_Loc);
+									yIndexKriged_Vector[k] = (*stdp->yMeshGrid)(iliv_Loc,oliv_Loc);
 									k++;
 								} // innerLoopIndexVector
 							} // outerLoopInde
+
+							//Compute the residual values
+							ordinaryKrigingOfResiduals_PostComputeBatch(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ, &xIndexKriged_Vector, &yIndexKriged_Vector, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &outputDepthKrig, &outputErrorKrig);
+							if(stdp->PROP_UNCERT)
+								ordinaryKrigingOfResiduals_PostComputeBatch(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZ0, &xIndexKriged_Vector, &yIndexKriged_Vector, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &outputDepth0Krig, &outputError0Krig);
+							if(stdp->KALMAN)
+								ordinaryKrigingOfResiduals_PostComputeBatch(&subX_indexKriged, &subY_indexKriged, &residualObservationsKrigedZK, &xIndexKriged_Vector, &yIndexKriged_Vector, &twoGammaHatVector, &distanceVectorBinCenters, &aVectorFine, &luGammaDArray, &gammaDPivots, &AGrid, &outputDepthKKrig, &outputErrorKKrig);
+
+							xIndexKriged_Vector.clear();
+							yIndexKriged_Vector.clear();
 							twoGammaHatVector.clear();
 							distanceVectorBinCenters.clear();
 							aVectorFine.clear();
-							invGammaDArray.clear();
+							luGammaDArray.clear();
+							gammaDPivots.clear();
 							AGrid.clear();
 							#pragma endregion Do Not Subtile Kriged Indices
 						} 
@@ -1695,7 +1795,7 @@ int scalecInterpTile_ProcessKrig(SCALEC_TILE_DATA_POINTER stdp, const int curIte
 							}
 
 							//I. Compute the value
-							scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (*slopes)(j,i), &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, KRIGING=0);
+							scalecInterpPerturbations_Compute(&subX_idy, &subY_idy, &subZ_idy, &subE_idy, &subH_idy, &subV_idy, &tgs1_Compute, &tgs2_Compute, &perturbWeights, (*stdp->neitol), dmin, (*slopes)(j,i), &subX0, &subY0, &Xiii, &perturb, stdp->MSE, stdp->PROP_UNCERT, stdp->KALMAN, KRIGING=0, NULL, &scratch);
 
 							//J. Put assn grid calculation here..... do matrix * vector math.......
 							//put trend back into this tile
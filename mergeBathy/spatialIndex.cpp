@@ -0,0 +1,137 @@
+#include "spatialIndex.h"
+#include <algorithm>
+#include <math.h>
+
+//************************************************************************************
+// SUBROUTINE I: Constructor.
+//************************************************************************************
+spatialIndex::spatialIndex()
+{
+	px = NULL;
+	py = NULL;
+	x0 = 0;
+	y0 = 0;
+	cell = 1;
+	invCell = 1;
+	nx = 0;
+	ny = 0;
+	nPoints = 0;
+}
+
+//************************************************************************************
+// SUBROUTINE II: Hash the points into a uniform grid of cells.
+//************************************************************************************
+void spatialIndex::build(const vector<double> *x, const vector<double> *y, double cellSize)
+{
+	clear();
+	px = x;
+	py = y;
+	nPoints = (const int)(*x).size();
+	if (nPoints == 0)
+		return;
+
+	//A. Find the extent of the data
+	double xmin = (*x)[0], xmax = (*x)[0];
+	double ymin = (*y)[0], ymax = (*y)[0];
+	for (int i = 1; i < nPoints; i++)
+	{
+		xmin = min(xmin, (*x)[i]); xmax = max(xmax, (*x)[i]);
+		ymin = min(ymin, (*y)[i]); ymax = max(ymax, (*y)[i]);
+	}
+
+	//B. Size the cells.  Sparse data spread over a large area would produce
+	//	mostly empty cells, so grow the cells until there are no more than
+	//	about four per point.
+	cell = (cellSize > 0) ? cellSize : 1.0;
+	double maxCells = 4.0 * nPoints + 16;
+	while (((floor((xmax - xmin) / cell) + 1) * (floor((ymax - ymin) / cell) + 1)) > maxCells)
+		cell *= 2;
+	invCell = 1.0 / cell;
+	x0 = xmin;
+	y0 = ymin;
+	nx = (int)floor((xmax - xmin) * invCell) + 1;
+	ny = (int)floor((ymax - ymin) * invCell) + 1;
+
+	//C. Counting sort of the points by cell.  Points are visited in index
+	//	order so each cell list is already ascending.
+	vector<int> pointCell = vector<int>(nPoints);
+	cellStart = vector<int>(nx * ny + 1, 0);
+	for (int i = 0; i < nPoints; i++)
+	{
+		int cx = min((int)(((*x)[i] - x0) * invCell), nx - 1);
+		int cy = min((int)(((*y)[i] - y0) * invCell), ny - 1);
+		pointCell[i] = cy * nx + cx;
+		cellStart[pointCell[i] + 1]++;
+	}
+	for (int c = 0; c < nx * ny; c++)
+		cellStart[c + 1] += cellStart[c];
+
+	vector<int> fill = vector<int>(cellStart.begin(), cellStart.end() - 1);
+	cellPoints = vector<int>(nPoints);
+	for (int i = 0; i < nPoints; i++)
+		cellPoints[fill[pointCell[i]]++] = i;
+}
+
+//************************************************************************************
+// SUBROUTINE III: Gather the points within a radius of a location.
+//************************************************************************************
+void spatialIndex::radiusQuery(double xq, double yq, double radius, vector<int> *idx) const
+{
+	(*idx).clear();
+	if (nPoints == 0)
+		return;
+
+	//A. Clamp the bounding box of the query circle to the grid
+	int cx0 = (int)floor((xq - radius - x0) * invCell);
+	int cx1 = (int)floor((xq + radius - x0) * invCell);
+	int cy0 = (int)floor((yq - radius - y0) * invCell);
+	int cy1 = (int)floor((yq + radius - y0) * invCell);
+	if (cx1 < 0 || cy1 < 0 || cx0 >= nx || cy0 >= ny)
+		return;
+	cx0 = max(cx0, 0); cx1 = min(cx1, nx - 1);
+	cy0 = max(cy0, 0); cy1 = min(cy1, ny - 1);
+
+	//B. Collect the points of the overlapping cells that fall inside the circle.
+	//	The radius is padded slightly so rounding never drops a point the caller's own distance test would keep.
+	double r2 = radius * radius * (1.0 + 1e-12);
+	double dx, dy;
+	int ptIdx;
+	bool sorted = true;
+	for (int cy = cy0; cy <= cy1; cy++)
+	{
+		for (int cx = cx0; cx <= cx1; cx++)
+		{
+			int c = cy * nx + cx;
+			for (int k = cellStart[c]; k < cellStart[c + 1]; k++)
+			{
+				ptIdx = cellPoints[k];
+				dx = (*px)[ptIdx] - xq;
+				dy = (*py)[ptIdx] - yq;
+				if (dx*dx + dy*dy <= r2)
+				{
+					if (!(*idx).empty() && (*idx).back() > ptIdx)
+						sorted = false;
+					(*idx).push_back(ptIdx);
+				}
+			}
+		}
+	}
+
+	//C. Return the indices in the same order a full scan would visit them
+	if (!sorted)
+		sort((*idx).begin(), (*idx).end());
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Discard the index.
+//************************************************************************************
+void spatialIndex::clear()
+{
+	px = NULL;
+	py = NULL;
+	nx = 0;
+	ny = 0;
+	nPoints = 0;
+	cellStart.clear();
+	cellPoints.clear();
+}
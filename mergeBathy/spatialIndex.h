@@ -0,0 +1,84 @@
+/**
+* @file			spatialIndex.h
+* @brief		Uniform grid-bucket index used to find the scattered data points near an interpolation location.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+*/
+#pragma once
+#include <vector>
+
+using namespace std;
+
+/**
+* A uniform grid-bucket spatial index over a set of 2-D points.
+* The points are hashed into square cells of a fixed size once, after which
+* radius queries only visit the cells overlapping the query circle instead of
+* scanning every point.  The index stores point indices only; the coordinate
+* vectors must stay alive and unchanged for as long as the index is queried.
+*/
+class spatialIndex
+{
+
+public:
+
+	/**
+	* A constructor for spatialIndex.
+	* Creates an empty index.  build must be called before querying.
+	*/
+	spatialIndex();
+
+	/**
+	* Hashes the points into grid cells.  Any previous contents are discarded.
+	* @param x - Vector of X coordinates of the points to index.
+	* @param y - Vector of Y coordinates of the points to index.
+	* @param cellSize - Side length of a grid cell in the same units as x and y.  Should be on the order of the smallest query radius.
+	*/
+	void build(const vector<double> *x, const vector<double> *y, double cellSize);
+
+	/**
+	* Finds every point that may lie within radius of (xq, yq).
+	* All cells overlapping the bounding box of the query circle are visited and only points
+	* with (x-xq)^2 + (y-yq)^2 <= radius^2 (padded for rounding) are returned, so callers
+	* that need a strict distance test must still apply it.  Indices are returned in ascending order so the
+	* result can be used in place of a full in-order scan.
+	* @param xq - X coordinate of the query location.
+	* @param yq - Y coordinate of the query location.
+	* @param radius - Search radius.
+	* @param idx - Indices into x and y of the points found. (Returned).
+	*/
+	void radiusQuery(double xq, double yq, double radius, vector<int> *idx) const;
+
+	/**
+	* Discards the index contents.
+	*/
+	void clear();
+
+	/**
+	* @return The number of points in the index.
+	*/
+	int size() const { return nPoints; }
+
+private:
+
+	/**
+	* Coordinates of the indexed points.
+	*/
+	const vector<double> *px;
+	const vector<double> *py;
+
+	/**
+	* Grid origin, cell size and dimensions.
+	*/
+	double x0, y0;
+	double cell;
+	double invCell;
+	int nx, ny;
+	int nPoints;
+
+	/**
+	* Compressed cell lists.  The points of cell c are cellPoints[cellStart[c] .. cellStart[c+1]-1], in ascending order.
+	*/
+	vector<int> cellStart;
+	vector<int> cellPoints;
+};
@@ -0,0 +1,340 @@
+#include "streamingSubsample.h"
+#include "fileReader.h"
+#include "binaryBathyFile.h"
+#include "supportedFileTypes.h"
+#include "LatLong-UTMconversion.h"
+#include "constants.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdio.h>
+
+//Convergence criterion of the consistent weights, as in subsampleData
+const double STREAM_WEIGHT_TOLERANCE = 0.10000;
+
+//Most iterations of the consistent weights, as in consistentWeights
+const int STREAM_WEIGHT_ITERATIONS = 10;
+
+//************************************************************************************
+// SUBROUTINE I: Constructor and file list.
+//************************************************************************************
+soundingStream::soundingStream(const string &listFileName, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, int indexInputs)
+{
+	this->listFileName = listFileName;
+	this->bbox = bbox;
+	this->noerr = noerr;
+	this->nonegdepth = nonegdepth;
+	this->unScaledAvgInputs = unScaledAvgInputs;
+	this->numThreads = numThreads;
+	this->indexInputs = indexInputs;
+	converged = false;
+	numSoundings = 0;
+	zRef = 0.00;
+	sumE = sumW = sumWZ = sumW2 = sumW2Z = sumW2Z2 = tempMax = 0.00;
+}
+
+int soundingStream::open()
+{
+	int retVal = readFileList(listFileName, &inputFiles);
+	if (retVal != SUCCESS)
+		return retVal;
+	cout << "Number of Input Files to Stream: " << inputFiles.size() << endl;
+
+	//A. The block reader of a .mbb file takes the name and tide correction apart from the list modifiers
+	binaryNames = vector<string>(inputFiles.size());
+	tideCorrections = vector<double>(inputFiles.size(), 0.00);
+	for (int f = 0; f < (const int)inputFiles.size(); f++)
+	{
+		if (inputFiles[f].find(binaryBathy) == string::npos)
+			continue;
+		double wMultiplier = 0.00, maximumDataOffset = INT_MAX;
+		binaryNames[f] = inputFiles[f];
+		parseFileModifiers(binaryNames[f], &wMultiplier, &tideCorrections[f], &maximumDataOffset);
+	}
+	return SUCCESS;
+}
+
+//************************************************************************************
+// SUBROUTINE II: Read the next block of a file.
+//************************************************************************************
+int soundingStream::readBlock(int f, int64_t *next, TRUE_DATA *block)
+{
+	int retVal;
+
+	//A. A .mbb file a block of records at a time
+	if (!binaryNames[f].empty())
+	{
+		int64_t numRecords = 0;
+		retVal = readMBBBlock(binaryNames[f], bbox, block, *next, STREAM_RECORDS_PER_BLOCK, nonegdepth, tideCorrections[f], &numRecords);
+		(*next) += STREAM_RECORDS_PER_BLOCK;
+		if ((*next) >= numRecords)
+			(*next) = -1;
+		return retVal;
+	}
+
+	//B. Any other file whole
+	retVal = readListedFile(inputFiles[f], bbox, block, noerr, nonegdepth, unScaledAvgInputs, numThreads, indexInputs);
+	(*next) = -1;
+	return retVal;
+}
+
+//************************************************************************************
+// SUBROUTINE III: Consistent weights computed over the blocks.
+//************************************************************************************
+void soundingStream::iterateWeight(double e2, int iteration, double *winit, double *w) const
+{
+	//Handle division by 0 as consistentWeights does
+	double eTemp = (e2 == 0) ? DEFAULT_E : e2;
+	(*winit) = 1.00;
+	(*w) = 1.00;
+	for (int k = 1; k <= iteration; k++)
+	{
+		if (k > 1)
+			(*winit) = ((*w) + (*winit)) / 2.00;
+		(*w) = sqrt(s3[k-1] / (s3[k-1] + eTemp));
+	}
+}
+
+void soundingStream::addWeightSums(const TRUE_DATA &block)
+{
+	int iteration = (int)s3.size();
+	double winit, w, e2, dz;
+
+	if (numSoundings == 0 && !block.depth.empty())
+		zRef = block.depth[0];
+	for (int i = 0; i < (const int)block.depth.size(); i++)
+	{
+		//A. The starting weight of the next iteration, and how far the last one moved
+		e2 = pow(block.error[i], 2);
+		iterateWeight(e2, iteration, &winit, &w);
+		if (iteration > 0)
+		{
+			tempMax = max(tempMax, std::abs(w - winit));
+			winit = (w + winit) / 2.00;
+		}
+
+		//B. The weighted mean and mean squared residual are finished from these once every sounding is in
+		dz = block.depth[i] - zRef;
+		sumW += winit;
+		sumWZ += winit * dz;
+		sumW2 += winit * winit;
+		sumW2Z += winit * winit * dz;
+		sumW2Z2 += (winit * dz) * (winit * dz);
+		sumE += e2;
+		numSoundings++;
+	}
+}
+
+void soundingStream::endWeightIteration()
+{
+	//A. The last iteration moved no weight more than the tolerance
+	if (!s3.empty() && tempMax <= STREAM_WEIGHT_TOLERANCE)
+	{
+		converged = true;
+		return;
+	}
+
+	//B. Weighted mean, weighted mean squared residual and true variance of this iteration
+	double N = (double)numSoundings;
+	double mu = sumWZ / sumW;
+	double s2 = (sumW2Z2 - (2.00 * mu * sumW2Z) + (mu * mu * sumW2)) / N;
+	s3.push_back(((N - 1.00) * s2 + sumE / N) / N);
+	if ((int)s3.size() >= STREAM_WEIGHT_ITERATIONS)
+		converged = true;
+
+	numSoundings = 0;
+	sumE = sumW = sumWZ = sumW2 = sumW2Z = sumW2Z2 = tempMax = 0.00;
+}
+
+//************************************************************************************
+// SUBROUTINE IV: First pass.  Counts and sums of each file.
+//************************************************************************************
+int soundingStream::summarize(vector<STREAM_FILE_SUMMARY> *summaries)
+{
+	int retVal = SUCCESS;
+	int64_t next, total = 0;
+	TRUE_DATA block;
+
+	printf("Streaming Pass 1: Summarizing Input Files\n");
+	(*summaries) = vector<STREAM_FILE_SUMMARY>(inputFiles.size());
+	for (int f = 0; f < (const int)inputFiles.size(); f++)
+	{
+		STREAM_FILE_SUMMARY &summary = (*summaries)[f];
+		memset(&summary, 0, sizeof(STREAM_FILE_SUMMARY));
+		summary.lonMin = HUGE_VAL;
+		summary.lonMax = -HUGE_VAL;
+		next = 0;
+		while (next >= 0)
+		{
+			retVal = readBlock(f, &next, &block);
+			if (retVal != SUCCESS)
+				return retVal;
+			summary.numRecords += (int64_t)block.lon.size();
+			summary.longitudeSum += block.longitudeSum;
+			summary.latitudeSum += block.latitudeSum;
+			for (int i = 0; i < (const int)block.lon.size(); i++)
+			{
+				summary.wrappedLongitudeSum += (block.lon[i] < 0) ? block.lon[i] + 360 : block.lon[i];
+				summary.lonMin = min(summary.lonMin, block.lon[i]);
+				summary.lonMax = max(summary.lonMax, block.lon[i]);
+			}
+			addWeightSums(block);
+		}
+		total += summary.numRecords;
+	}
+
+	if (total == 0)
+	{
+		cerr << "No soundings were read from the input files!" << endl;
+		return IN_FILE_ERROR;
+	}
+	endWeightIteration();
+	printf("Streaming Pass 1: %lld Soundings\n\n", (long long)total);
+	return retVal;
+}
+
+//************************************************************************************
+// SUBROUTINE V: Second pass.  Extents of the projected soundings.
+//************************************************************************************
+int soundingStream::extents(const vector<STREAM_PROJECTION> &projections, double *xMin, double *xMax, double *yMin, double *yMax)
+{
+	int retVal = SUCCESS;
+	int64_t next;
+	TRUE_DATA block;
+
+	printf("Streaming Pass 2: Projecting Input Files\n");
+	(*xMin) = (*yMin) = HUGE_VAL;
+	(*xMax) = (*yMax) = -HUGE_VAL;
+	for (int f = 0; f < (const int)inputFiles.size(); f++)
+	{
+		next = 0;
+		while (next >= 0)
+		{
+			retVal = readBlock(f, &next, &block);
+			if (retVal != SUCCESS)
+				return retVal;
+			projectBlock(projections[f], &block, numThreads);
+			for (int i = 0; i < (const int)block.x.size(); i++)
+			{
+				(*xMin) = min((*xMin), block.x[i]);
+				(*xMax) = max((*xMax), block.x[i]);
+				(*yMin) = min((*yMin), block.y[i]);
+				(*yMax) = max((*yMax), block.y[i]);
+			}
+			if (!converged)
+				addWeightSums(block);
+		}
+	}
+	if (!converged)
+		endWeightIteration();
+	printf("Streaming Pass 2: Done\n\n");
+	return retVal;
+}
+
+//************************************************************************************
+// SUBROUTINE VI: Last passes.  Finish the weights, then bin every sounding.
+//************************************************************************************
+int soundingStream::subsample(const vector<STREAM_PROJECTION> &projections, double gridSpacingX, double gridSpacingY, double &inX0, double &inY0, double xMax, vector< vector<double> > *subsampledData)
+{
+	int retVal = SUCCESS;
+	int pass = 3;
+	int64_t next;
+	TRUE_DATA block;
+
+	//A. One pass for each weight iteration still to do
+	while (!converged)
+	{
+		printf("Streaming Pass %d: Weight Iteration %d\n", pass++, (int)s3.size() + 1);
+		for (int f = 0; f < (const int)inputFiles.size(); f++)
+		{
+			next = 0;
+			while (next >= 0)
+			{
+				retVal = readBlock(f, &next, &block);
+				if (retVal != SUCCESS)
+					return retVal;
+				addWeightSums(block);
+			}
+		}
+		endWeightIteration();
+	}
+
+	//B. The cell grid of subsampleData.  Its size in X comes from the largest projected X.
+	double DX = gridSpacingX;
+	double DY = gridSpacingY;
+	double x0 = (floor(inX0/DX))*(DX);
+	double y0 = (floor(inY0/DY))*(DY);
+	double jMaxX = round(1.00+((xMax - x0)/DX));
+	int iteration = (int)s3.size();
+	vector<double> e2, weights;
+	double winit;
+	cellBins bins;
+
+	//C. Bin each block with its final weights
+	printf("Streaming Pass %d: Subsampling Data\n", pass);
+	for (int f = 0; f < (const int)inputFiles.size(); f++)
+	{
+		next = 0;
+		while (next >= 0)
+		{
+			retVal = readBlock(f, &next, &block);
+			if (retVal != SUCCESS)
+				return retVal;
+			projectBlock(projections[f], &block, numThreads);
+			e2.resize(block.error.size());
+			weights.resize(block.error.size());
+			for (int i = 0; i < (const int)block.error.size(); i++)
+			{
+				e2[i] = pow(block.error[i], 2);
+				iterateWeight(e2[i], iteration, &winit, &weights[i]);
+			}
+			binDataBlock(&block.x, &block.y, &block.depth, &e2, &block.h_Error, &block.v_Error, &weights, x0, y0, DX, DY, (double)(int)jMaxX, numThreads, &bins);
+		}
+	}
+	block = TRUE_DATA();
+	subsampleCells(bins, subsampledData);
+	printf("Streaming Pass %d: %d Cells after %d Weight Iterations\n\n", pass, (int)(*subsampledData)[0].size(), iteration);
+
+	inX0 = x0;
+	inY0 = y0;
+	return retVal;
+}
+
+//************************************************************************************
+// SUBROUTINE VII: Project the soundings of a block.
+//************************************************************************************
+void projectBlock(const STREAM_PROJECTION &projection, TRUE_DATA *block, int numThreads)
+{
+	double UTMNorthing, UTMEasting;
+	double cosRotation = cos(deg2rad*projection.rotationAngle);
+	double sinRotation = sin(deg2rad*projection.rotationAngle);
+	char UTMZone[4];
+	int n = (int)(*block).lon.size();
+
+	(*block).x.resize(n);
+	(*block).y.resize(n);
+	strcpy(UTMZone, projection.zone);
+	for (int i = 0; i < n; i++)
+	{
+		(*block).x[i] = (*block).lon[i];
+		if (projection.wrap && (*block).x[i] < 0)
+			(*block).x[i] += 360;
+		if (!projection.toUTM)
+			(*block).y[i] = (*block).lat[i];
+	}
+	if (!projection.toUTM || n == 0)
+		return;
+
+	//The whole block is projected at once, in place over the wrapped longitudes.
+	LLtoUTM(projection.refEllipsoid, &(*block).lat[0], &(*block).x[0], &(*block).y[0], &(*block).x[0], n, UTMZone, numThreads);
+	if (projection.rotate)
+	{
+		for (int i = 0; i < n; i++)
+		{
+			UTMEasting = (*block).x[i] - projection.UTMEastingRef;
+			UTMNorthing = (*block).y[i] - projection.UTMNorthingRef;
+			(*block).x[i] = (UTMEasting)*cosRotation - (UTMNorthing)*sinRotation;
+			(*block).y[i] = (UTMEasting)*sinRotation + (UTMNorthing)*cosRotation;
+		}
+	}
+}
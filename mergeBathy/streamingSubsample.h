@@ -0,0 +1,209 @@
+/**
+* @file			streamingSubsample.h
+* @brief		Subsamples the input files a block of soundings at a time, so that the raw soundings of a merge are never all held in memory.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+* subsampleData needs the whole data set twice over: the origin and size of its
+* cell grid come from the extents of every projected sounding, and the
+* consistent weights are iterated over every depth and error.  Both are sums and
+* extrema, so the input files are instead read several times:
+*	1. the count, coordinate sums and longitude extents of each file, with the
+*	   sums of the first weight iteration;
+*	2. the extents of the projected soundings, with the sums of the second;
+*	3. one pass for each further weight iteration until the weights converge,
+*	   as consistentWeights decides;
+*	4. the soundings are projected, weighted and binned into cellBins.
+* Only the cells and one block are in memory.  A .mbb file is read
+* STREAM_RECORDS_PER_BLOCK records at a time; any other file is read whole, one
+* file at a time, since its reader scales average errors over the whole file.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "inFileStructs.h"
+#include "subSampleData.h"
+
+using namespace std;
+
+/**
+* Number of records of a .mbb file read at a time.
+*/
+const int64_t STREAM_RECORDS_PER_BLOCK = 1048576;
+
+/**
+* Counts and sums of the soundings of one input file, as read.
+*/
+typedef struct
+{
+	/**
+	* Number of soundings kept by the reader.
+	*/
+	int64_t numRecords;
+
+	/**
+	* Sums of the longitudes and latitudes, as the readers compute TRUE_DATA longitudeSum and latitudeSum.
+	*/
+	double longitudeSum;
+	double latitudeSum;
+
+	/**
+	* Sum of the longitudes with 360 added to the negative ones.
+	*/
+	double wrappedLongitudeSum;
+
+	/**
+	* Smallest and largest longitude.
+	*/
+	double lonMin;
+	double lonMax;
+
+} STREAM_FILE_SUMMARY;
+
+/**
+* How the soundings of one input file are projected to the computational X and Y, as mergeBathy_PreCompute projects them.
+*/
+typedef struct
+{
+	/**
+	* 1 to convert Longitude and Latitude to UTM, 0 when the input is already in meters.
+	*/
+	int toUTM;
+
+	/**
+	* 1 to add 360 to negative longitudes first.
+	*/
+	int wrap;
+
+	/**
+	* UTM zone the soundings are projected into, and the mean longitude passed to LLtoUTM.
+	*/
+	char zone[4];
+	double longitudeMean;
+	int refEllipsoid;
+
+	/**
+	* 1 to subtract the reference position and rotate, when a reference position or rotation angle is given.
+	*/
+	int rotate;
+	double UTMNorthingRef;
+	double UTMEastingRef;
+	double rotationAngle;
+
+} STREAM_PROJECTION;
+
+/**
+* The input files of a file list read a block at a time.
+* The passes must be called in order: summarize, extents, subsample.
+*/
+class soundingStream
+{
+
+public:
+
+	/**
+	* A constructor for soundingStream.  The options are those of readFile.
+	* @param listFileName - File name of the list file that contains each individual data set.
+	* @param bbox - The bounding extents of the input data if it is to be cut.
+	*/
+	soundingStream(const string &listFileName, BOUNDING_BOX bbox, int noerr, int nonegdepth, int unScaledAvgInputs, int numThreads, int indexInputs);
+
+	/**
+	* Reads the file list.
+	* @return Success or failure value.
+	*/
+	int open();
+
+	/**
+	* @return The number of input files.
+	*/
+	int size() const { return (int)inputFiles.size(); }
+
+	/**
+	* First pass: counts and sums of each file.
+	* @param summaries - Summary of each input file, in list order. (Returned).
+	* @return Success or failure value.  Fails when no soundings are read.
+	*/
+	int summarize(vector<STREAM_FILE_SUMMARY> *summaries);
+
+	/**
+	* Second pass: extents of the projected soundings.
+	* @param projections - Projection of each input file.
+	* @param xMin - Smallest projected X. (Returned).
+	* @param xMax - Largest projected X. (Returned).
+	* @param yMin - Smallest projected Y. (Returned).
+	* @param yMax - Largest projected Y. (Returned).
+	* @return Success or failure value.
+	*/
+	int extents(const vector<STREAM_PROJECTION> &projections, double *xMin, double *xMax, double *yMin, double *yMax);
+
+	/**
+	* Last passes: finish the consistent weights and bin every sounding, giving what subsampleData gives for the same soundings.
+	* @param projections - Projection of each input file.
+	* @param gridSpacingX - Size of a cell in the X direction.
+	* @param gridSpacingY - Size of a cell in the Y direction.
+	* @param inX0 - Smallest projected X.  Returned as the X location of the first cell. (Returned).
+	* @param inY0 - Smallest projected Y.  Returned as the Y location of the first cell. (Returned).
+	* @param xMax - Largest projected X.
+	* @param subsampledData - A n by 7 vector containing the subsampled data, as returned by subsampleData. (Returned).
+	* @return Success or failure value.
+	*/
+	int subsample(const vector<STREAM_PROJECTION> &projections, double gridSpacingX, double gridSpacingY, double &inX0, double &inY0, double xMax, vector< vector<double> > *subsampledData);
+
+private:
+
+	/**
+	* Reads the next block of a file.
+	* @param f - Index of the file in the list.
+	* @param next - Index of the first record of the block.  Returned as that of the next block, or -1 after the last. (Returned).
+	* @param block - Soundings of the block. (Returned).
+	* @return Success or failure value.
+	*/
+	int readBlock(int f, int64_t *next, TRUE_DATA *block);
+
+	/**
+	* Adds the soundings of a block to the sums of the next weight iteration.
+	*/
+	void addWeightSums(const TRUE_DATA &block);
+
+	/**
+	* Ends a weight iteration: decides convergence as consistentWeights does, or computes the true variance s3 of the iteration.
+	*/
+	void endWeightIteration();
+
+	/**
+	* The starting weight winit and weight w of a sounding in a weight iteration.
+	* @param e2 - Squared error of the sounding.
+	* @param iteration - Iteration, from 1; s3 must hold its true variance.  0 gives the initial guess.
+	*/
+	void iterateWeight(double e2, int iteration, double *winit, double *w) const;
+
+	string listFileName;
+	BOUNDING_BOX bbox;
+	int noerr;
+	int nonegdepth;
+	int unScaledAvgInputs;
+	int numThreads;
+	int indexInputs;
+
+	vector<string> inputFiles;
+	vector<string> binaryNames;
+	vector<double> tideCorrections;
+
+	//Consistent weights.  The sums are taken about zRef, the first depth, to keep their precision.
+	vector<double> s3;
+	bool converged;
+	int64_t numSoundings;
+	double zRef;
+	double sumE, sumW, sumWZ, sumW2, sumW2Z, sumW2Z2, tempMax;
+};
+
+/**
+* Projects the soundings of a block to the computational X and Y.
+* @param projection - Projection of the file the block is from.
+* @param block - Soundings; x and y are set. (Returned).
+* @param numThreads - Number of threads for the projection.
+*/
+void projectBlock(const STREAM_PROJECTION &projection, TRUE_DATA *block, int numThreads);
@@ -1,6 +1,38 @@
 #include "subSampleData.h"
 #include "consistentWeights.h"
 #include <math.h>
+#include <string.h>
+#include <algorithm>
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+//Fewest data points given to each thread when binning; fewer are binned by the calling thread
+#define SUBSAMPLE_POINTS_PER_THREAD 262144
+
+/**
+* Arguments passed to each thread binning data points.  A thread only adds points begin to end-1 to its own bins.
+*/
+typedef struct
+{
+	vector<double> *inputDataX;
+	vector<double> *inputDataY;
+	vector<double> *inputDataZ;
+	vector<double> *inputDataE;
+	vector<double> *inputDataHErr;
+	vector<double> *inputDataVErr;
+	vector<double> *weights;
+	double x0;
+	double y0;
+	double DX;
+	double DY;
+	double jProd;
+	int begin;
+	int end;
+	cellBins *bins;
+} SUBSAMPLE_BINNING_DATA;
 
 //************************************************************************************
 //SUBROUTINE I: Partition2: This subroutine partitions the grid data for
@@ -107,11 +139,294 @@ void Quicksort2( vector<double> *sX, vector<double> *sY, vector<double> *sZ, vec
 	else SelectionSort2(sX, sY, sZ, sE, sE2, left, right);
 }
 
+//************************************************************************************
+//SUBROUTINE III.A: cellBins: Weighted sums of the data points in each subsampling cell,
+//kept by column and found through an open addressing hash table on the cell index Ji.
+//************************************************************************************
+cellBins::cellBins()
+{
+	bits = 10;
+	table = vector<int>((size_t)1 << bits, -1);
+}
+
+int cellBins::find(long long Ji)
+{
+	size_t mask = table.size() - 1;
+	size_t slot = (size_t)(((unsigned long long)Ji * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+	while (table[slot] != -1)
+	{
+		if (key[table[slot]] == Ji)
+			return table[slot];
+		slot = (slot + 1) & mask;
+	}
+
+	//A. A new cell; keep the table at most half full
+	int bin = (int)key.size();
+	table[slot] = bin;
+	key.push_back(Ji);
+	n.push_back(0.0);
+	w.push_back(0.0);
+	w2.push_back(0.0);
+	wz.push_back(0.0);
+	w2z.push_back(0.0);
+	wz2.push_back(0.0);
+	w2e.push_back(0.0);
+	wx.push_back(0.0);
+	wy.push_back(0.0);
+	wh2.push_back(0.0);
+	wv2.push_back(0.0);
+	if (2 * key.size() > table.size())
+		grow();
+	return bin;
+}
+
+void cellBins::grow()
+{
+	bits++;
+	table = vector<int>((size_t)1 << bits, -1);
+	size_t mask = table.size() - 1;
+	for (int bin = 0; bin < (int)key.size(); bin++)
+	{
+		size_t slot = (size_t)(((unsigned long long)key[bin] * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+		while (table[slot] != -1)
+			slot = (slot + 1) & mask;
+		table[slot] = bin;
+	}
+}
+
+void cellBins::merge(const cellBins &other)
+{
+	for (int b = 0; b < (int)other.key.size(); b++)
+	{
+		int c = find(other.key[b]);
+		n[c] += other.n[b];
+		w[c] += other.w[b];
+		w2[c] += other.w2[b];
+		wz[c] += other.wz[b];
+		w2z[c] += other.w2z[b];
+		wz2[c] += other.wz2[b];
+		w2e[c] += other.w2e[b];
+		wx[c] += other.wx[b];
+		wy[c] += other.wy[b];
+		wh2[c] += other.wh2[b];
+		wv2[c] += other.wv2[b];
+	}
+}
+
+void cellBins::sortedOrder(vector<int> *order) const
+{
+	vector< std::pair<long long, int> > keyBin = vector< std::pair<long long, int> >(key.size());
+	for (int b = 0; b < (int)key.size(); b++)
+		keyBin[b] = std::pair<long long, int>(key[b], b);
+	std::sort(keyBin.begin(), keyBin.end());
+	(*order).resize(key.size());
+	for (int b = 0; b < (int)key.size(); b++)
+		(*order)[b] = keyBin[b].second;
+}
+
+//************************************************************************************
+//SUBROUTINE III.B: Add the data points begin to end-1 to their cells.
+//************************************************************************************
+static void binDataRange(const SUBSAMPLE_BINNING_DATA *sbd, int begin, int end, cellBins *bins)
+{
+	for (int i = begin; i < end; i++)
+	{
+		double jx = round(1.00+(((*sbd->inputDataX)[i] - sbd->x0)/sbd->DX));
+		double jy = round(1.00+(((*sbd->inputDataY)[i] - sbd->y0)/sbd->DY));
+		int c = (*bins).find((long long)(1.00 + (jx - 1) + (jy - 1) * sbd->jProd));
+
+		double weight = (*sbd->weights)[i];
+		double z = (*sbd->inputDataZ)[i];
+		double w2 = weight * weight;
+		(*bins).n[c] += 1;
+		(*bins).w[c] += weight;
+		(*bins).w2[c] += w2;
+		(*bins).wz[c] += z * weight;
+		(*bins).w2z[c] += z * w2;
+		(*bins).wz2[c] += (z * weight) * (z * weight);
+		(*bins).w2e[c] += (*sbd->inputDataE)[i] * w2;
+		(*bins).wx[c] += (*sbd->inputDataX)[i] * weight;
+		(*bins).wy[c] += (*sbd->inputDataY)[i] * weight;
+		(*bins).wh2[c] += ((*sbd->inputDataHErr)[i] * weight) * ((*sbd->inputDataHErr)[i] * weight);
+		(*bins).wv2[c] += ((*sbd->inputDataVErr)[i] * weight) * ((*sbd->inputDataVErr)[i] * weight);
+	}
+}
+
+//************************************************************************************
+//SUBROUTINE III.C: Thread function that bins its share of the data points.
+//************************************************************************************
+#ifdef WIN32
+static DWORD WINAPI threadBinData(LPVOID lpParam)
+#else
+static void *threadBinData(void *lpParam)
+#endif
+{
+	SUBSAMPLE_BINNING_DATA *sbd = (SUBSAMPLE_BINNING_DATA*)lpParam;
+	binDataRange(sbd, sbd->begin, sbd->end, sbd->bins);
+	return 0;
+}
+
+//************************************************************************************
+//SUBROUTINE III.D: Bin all of the data points.  With several threads each bins a contiguous
+//share of the points into its own cells, and the cells are then merged in thread order.
+//Cells already in bins keep their sums.
+//************************************************************************************
+static void binDataPoints(SUBSAMPLE_BINNING_DATA *sbd, int numThreads, cellBins *bins)
+{
+	int numPoints = (int)(*sbd->inputDataX).size();
+	int numWorkers = std::min(numThreads, numPoints / SUBSAMPLE_POINTS_PER_THREAD);
+	if (numWorkers <= 1)
+	{
+		binDataRange(sbd, 0, numPoints, bins);
+		return;
+	}
+
+	vector<cellBins> partialBins = vector<cellBins>(numWorkers);
+	vector<SUBSAMPLE_BINNING_DATA> tsbd = vector<SUBSAMPLE_BINNING_DATA>(numWorkers, *sbd);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		tsbd[t].begin = (int)(((long long)numPoints * t) / numWorkers);
+		tsbd[t].end = (int)(((long long)numPoints * (t + 1)) / numWorkers);
+		tsbd[t].bins = &partialBins[t];
+	}
+
+#ifdef WIN32
+	vector<HANDLE> hThreadArray = vector<HANDLE>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		hThreadArray[t] = CreateThread(NULL, 0, threadBinData, &tsbd[t], 0, NULL);
+		if (hThreadArray[t] == NULL)
+		{
+			cerr << "Unable to create a subsampling thread!" << endl;
+			ExitProcess(3);
+		}
+	}
+	WaitForMultipleObjects(numWorkers, &hThreadArray[0], TRUE, INFINITE);
+	for (int t = 0; t < numWorkers; t++)
+		CloseHandle(hThreadArray[t]);
+#else
+	vector<pthread_t> hThreadArray = vector<pthread_t>(numWorkers);
+	for (int t = 0; t < numWorkers; t++)
+	{
+		int rc = pthread_create(&hThreadArray[t], NULL, threadBinData, (void *) &tsbd[t]);
+		if (rc)
+		{
+			fprintf(stderr, "Error - pthread_create() return code: %d\n %s", rc, strerror(rc));
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (int t = 0; t < numWorkers; t++)
+		pthread_join(hThreadArray[t], NULL);
+#endif
+
+	//A. Merge, taking over the first thread's cells rather than copying them when there are none yet
+	int t0 = 0;
+	if ((*bins).key.empty())
+	{
+		std::swap(*bins, partialBins[0]);
+		t0 = 1;
+	}
+	for (int t = t0; t < numWorkers; t++)
+	{
+		(*bins).merge(partialBins[t]);
+		partialBins[t] = cellBins();
+	}
+}
+
+//************************************************************************************
+//SUBROUTINE III.E: Add a block of data points to the cells of a subsampling.
+//************************************************************************************
+void binDataBlock(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, vector<double> *weights, double x0, double y0, double DX, double DY, double jProd, int numThreads, cellBins *bins)
+{
+	SUBSAMPLE_BINNING_DATA sbd;
+	sbd.inputDataX = inputDataX;
+	sbd.inputDataY = inputDataY;
+	sbd.inputDataZ = inputDataZ;
+	sbd.inputDataE = inputDataE;
+	sbd.inputDataHErr = inputDataHErr;
+	sbd.inputDataVErr = inputDataVErr;
+	sbd.weights = weights;
+	sbd.x0 = x0;
+	sbd.y0 = y0;
+	sbd.DX = DX;
+	sbd.DY = DY;
+	sbd.jProd = jProd;
+	binDataPoints(&sbd, numThreads, bins);
+}
+
+//************************************************************************************
+//SUBROUTINE III.F: Compute the subsampled data from the sums of each cell.
+//************************************************************************************
+void subsampleCells(const cellBins &bins, vector< vector<double> > *subsampledData)
+{
+	unsigned int i;
+
+	//A. The cells are output in ascending order of Ji
+	vector<int> order;
+	bins.sortedOrder(&order);
+	size_t JiVectorSize = order.size();
+
+	//B. Set up the output vectors
+	//The mean position of the data in each cell
+	(*subsampledData)[0] = vector<double>(JiVectorSize, 0.0); //x
+	(*subsampledData)[1] = vector<double>(JiVectorSize, 0.0); //y
+	//The mean value at each interp. cell
+	(*subsampledData)[2] = vector<double>(JiVectorSize, 0.0); //z
+	//The standard error (=std. dev./sqrt(n))
+	//(or, if ni<3, insert average value of all other si values)
+	//ONLY COMPUTED FOR z(:,1), others are weighted identically
+	(*subsampledData)[3] = vector<double>(JiVectorSize, 0.0); //e
+	(*subsampledData)[4] = vector<double>(JiVectorSize, 0.0); //w
+	(*subsampledData)[5] = vector<double>(JiVectorSize, 0.0); //hu
+	(*subsampledData)[6] = vector<double>(JiVectorSize, 0.0); //vu
+
+	//C. Compute the weighted means and standard errors of each cell
+	for (i = 0; i < (uint)JiVectorSize; i++){
+		int c = order[i];
+		double ni = bins.n[c];
+		double wi = bins.w[c];
+		double w2i = bins.w2[c];
+		double zi, si;
+
+		// Handle division by 0.
+		if(wi==0){
+			zi = 0;
+			(*subsampledData)[0][i] = 0;
+			(*subsampledData)[1][i] = 0;
+			(*subsampledData)[5][i] = 0;
+			(*subsampledData)[6][i] = sqrt(DEFAULT_E);
+		}
+		else{
+			zi = bins.wz[c] / wi;
+			(*subsampledData)[0][i] = bins.wx[c] / wi;
+			(*subsampledData)[1][i] = bins.wy[c] / wi;
+			(*subsampledData)[5][i] = sqrt(bins.wh2[c] / w2i);
+			(*subsampledData)[6][i] = sqrt(bins.wv2[c] / w2i);
+		}
+
+		si = (bins.wz2[c] - (2.00 * zi * bins.w2z[c]) + (w2i * pow(zi,2)))/(ni);
+		si = (si)/(1.00 + ni);
+
+		//Handle division by 0.
+		if(w2i==0)
+			si = ((ni - 1.00) * si)/(ni);
+		else
+			si = (((ni - 1.00) * si) + (bins.w2e[c]/w2i))/(ni);
+
+		//The real part of the complex square root, which is 0 for a variance that rounded below 0
+		si = (si <= 0) ? 0.0 : sqrt(si);
+
+		(*subsampledData)[2][i] = zi;
+		(*subsampledData)[3][i] = si;
+		(*subsampledData)[4][i] = pow(si,2);
+	}
+}
+
 //************************************************************************************
 //SUBROUTINE IV: subsampleData:
 //This subsamples and spaces the data points.
 //************************************************************************************
-int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, double gridSpacingX, double gridSpacingY, double &inX0, double &inY0, double meanX, double meanY, bool dispIntermResults, vector< vector<double> > *subsampledData)
+int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, double gridSpacingX, double gridSpacingY, double &inX0, double &inY0, double meanX, double meanY, bool dispIntermResults, vector< vector<double> > *subsampledData, int numThreads)
 {
 	//************************************************************************************
 	//0. Declare local variables and objects.
@@ -134,16 +449,9 @@ int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector
 	double y0 = (floor(inY0/DY))*(DY);
 
 	double s3Value;
-	int jProd = 1;
-	unsigned int i, j;
-	unsigned int count;
+	unsigned int i;
 	uint inputDataXSize = (uint)(*inputDataX).size();
 
-	//The array of indices into each cell
-	dgrid Ji(inputDataXSize,2,1);
-	dgrid J(inputDataXSize,2,0);
-
-	vector<int>::iterator iter;
 	vector<double> weights = vector<double>(inputDataXSize, 2.00);
 
 	if (dispIntermResults)
@@ -175,27 +483,16 @@ int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector
 	value for each index such that indices are unique
 	*/
 
-	//B. Initialize the Ji, and J dgrids with coordinate data
+	//B. Find the largest cell in each dimension and square the errors
 	//map data to scaled points
 	//J = 1,1...,1 is location X0(1,1,...,1)
 	//subtract the min to get the range and scale by Dx, then add 1 and round
-	J(0,0) = round(1.00+(((*inputDataX)[0] - x0)/DX));
-	J(0,1) = round(1.00+(((*inputDataY)[0] - y0)/DY));
-	jMaxX = J(0,0);
-	jMaxY = J(0,1);
-
-	//C. Now loop to set the values and square the errors
+	jMaxX = round(1.00+(((*inputDataX)[0] - x0)/DX));
+	jMaxY = round(1.00+(((*inputDataY)[0] - y0)/DY));
 	for (i = 0; i < inputDataXSize; i++){
 		(*inputDataE)[i] = pow((*inputDataE)[i], 2);
-		Ji(i,0) = 1;
-		Ji(i,1) = i;
-		J(i,0) = round(1.00+(((*inputDataX)[i] - x0)/DX));
-		J(i,1) = round(1.00+(((*inputDataY)[i] - y0)/DY));
-
-		if (J(i,0) > jMaxX)
-			jMaxX = J(i,0);
-		if (J(i,1) > jMaxY)
-			jMaxY = J(i,1);
+		jMaxX = std::max(jMaxX, round(1.00+(((*inputDataX)[i] - x0)/DX)));
+		jMaxY = std::max(jMaxY, round(1.00+(((*inputDataY)[i] - y0)/DY)));
 	}
 	if (dispIntermResults)
 		printf(".");
@@ -207,144 +504,19 @@ int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector
 	consistentWeights(inputDataZ, inputDataE, &wtol, &weights, &s3Value);
 
 	//************************************************************************************
-	//II. Fill Ji and get jProd
+	//II. Bin the data
 	//************************************************************************************
-	//A. Map J to index of a multi-D array of unique indices. Jprod will store
-	//rescaled versions of multi-D array J into a M*N x 1 vector Ji. We repeat
-	//the multiplication process to ensure that different N-blocks of indices
-	//have different numbers (i.e. no way to repeat an x and y index due to
-	//resetting JProd on first go and then multiplication of y-indices by JProd
-	//on second go. The whole point of this is to count the number of unique
-	//DX cell distances.
-	jProd = 1;
-
-	for (i = 0; i < 2; i++){
-		for (j = 0; j < (uint)inputDataXSize; j++){
-			Ji(j,0) = Ji(j,0) + ((J(j,i) - 1) * (double)jProd);
-		}
-		if (i == 0)
-			jProd = jProd * (int)jMaxX;
-		else
-			jProd = jProd * (int)jMaxY;
-	}
+	//A. Each data point goes to the cell Ji = 1 + (J(:,1)-1) + (J(:,2)-1)*Jmax.  The cells are
+	//found by hashing Ji in one pass over the data, with no sort of the data points.
+	cellBins bins;
+	binDataBlock(inputDataX, inputDataY, inputDataZ, inputDataE, inputDataHErr, inputDataVErr, &weights, x0, y0, DX, DY, (double)(int)jMaxX, numThreads, &bins);
 	if (dispIntermResults)
-		printf(".");
-
-	//B. Sort data in ascending order and keep track of the indexes
-	Quicksort(&Ji, 0, inputDataXSize - 1);
-	
-	if (dispIntermResults)
-		printf("...");
+		printf("....");
 
 	//************************************************************************************
-	//III. Remove repeated points
+	//III. Compute the weighted means and standard errors of each cell, in ascending order of Ji
 	//************************************************************************************
-	//A. Resize the vector and remove unique elements
-	vector<int> JiVector = vector<int>(inputDataXSize,0);
-	for (i = 0; i < inputDataXSize; i++){
-		JiVector[i] = (int)Ji(i,0);
-	}
-	iter = unique(JiVector.begin(), JiVector.end());
-	JiVector.resize(iter-JiVector.begin());
-
-	if (dispIntermResults)
-		printf(".");
-
-	//B. Set up the computation vectors
-	size_t	JiVectorSize = JiVector.size();
-	zvector zi(JiVectorSize,0.0);
-	zvector ni(JiVectorSize,0.0);		//The number of observations going into each cell
-	zvector wi(JiVectorSize,0.0);
-	zvector w2zi(JiVectorSize,0.0);		// weights against data
-	zvector w2ei(JiVectorSize,0.0);		// weights against a priori errors
-	zvector w2i(JiVectorSize,0.0);		// sum of squared weights
-	zvector si(JiVectorSize,0.0);		// holds weighted sum of squares, initially
-	dvector JiNew(JiVectorSize,0.0);	//Reset vector Ji for new use; The array of indices into each cell
-
-	JiNew[0] = Ji(0,0);
-
-	//C. Set up the output vectors
-	//The mean position of the data in each cell
-	(*subsampledData)[0] = vector<double>(JiVectorSize, 0.0); //x
-	(*subsampledData)[1] = vector<double>(JiVectorSize, 0.0); //y
-	//The mean value at each interp. cell
-	(*subsampledData)[2] = vector<double>(JiVectorSize, 0.0); //z
-	//The standard error (=std. dev./sqrt(n))
-	//(or, if ni<3, insert average value of all other si values)
-	//ONLY COMPUTED FOR z(:,1), others are weighted identically
-	(*subsampledData)[3] = vector<double>(JiVectorSize, 0.0); //e
-	(*subsampledData)[4] = vector<double>(JiVectorSize, 0.0); //w
-	(*subsampledData)[5] = vector<double>(JiVectorSize, 0.0); //hu
-	(*subsampledData)[6] = vector<double>(JiVectorSize, 0.0); //vu
-	count = 0;
-	int cur_position=0;
-	double hval=0,vval=0;
-	//************************************************************************************
-	//IV. Subsample and apply weights
-	//************************************************************************************
-	//A. Loop through and set values
-	for (i = 0; i < inputDataXSize; i++){
-		if(Ji(i,0) > JiNew[count]){ //Jisort(i) > Ji(cnt)
-			count = count + 1;
-			JiNew[count] = Ji(i,0); //Ji(cnt) = Jisort(i)
-		}
-
-		cur_position=Ji(i,1);
-		vval=(*inputDataVErr)[(int)Ji(i,1)];
-		hval=(*inputDataVErr)[(int)Ji(i,1)];
-
-		// Ji(:,0) is Jisort, Ji(:,1) is sortid(i)
-		ni[count] = ni[count].real() + 1;
-		wi[count] =  wi[count].real() + weights[(int)Ji(i,1)];
-		w2i[count] =  w2i[count].real() + pow(weights[(int)Ji(i,1)],2);
-		zi[count] =  zi[count].real() + (*inputDataZ)[(int)Ji(i,1)] * weights[(int)Ji(i,1)];
-		w2zi[count] =  w2zi[count].real() + (*inputDataZ)[(int)Ji(i,1)] * pow(weights[(int)Ji(i,1)],2);
-		si[count] =  si[count].real() + pow((*inputDataZ)[(int)Ji(i,1)] * weights[(int)Ji(i,1)], 2);
-		w2ei[count] = w2ei[count] + (*inputDataE)[(int)Ji(i,1)] * pow(weights[(int)Ji(i,1)],2);
-		(*subsampledData)[0][count] = (*subsampledData)[0][count] + (*inputDataX)[(int)Ji(i,1)] * weights[(int)Ji(i,1)];
-		(*subsampledData)[1][count] = (*subsampledData)[1][count] + (*inputDataY)[(int)Ji(i,1)] * weights[(int)Ji(i,1)];
-		(*subsampledData)[5][count] = (*subsampledData)[5][count] + pow((*inputDataHErr)[(int)Ji(i,1)] * weights[(int)Ji(i,1)],2);
-		(*subsampledData)[6][count] = (*subsampledData)[6][count] + pow((*inputDataVErr)[(int)Ji(i,1)] * weights[(int)Ji(i,1)],2);
-	}
-	if (dispIntermResults)
-		printf("...");
-
-	//B. Set the subdata values with the real data from the zgrid complex data
-	for (i = 0; i < (uint)JiVectorSize; i++){
-		// Handle division by 0.
-		if(wi[i].real()==0){
-			zi[i] = 0;
-			(*subsampledData)[0][i] = 0;
-			(*subsampledData)[1][i] = 0;
-			(*subsampledData)[5][i] = 0;
-			(*subsampledData)[6][i] = sqrt(DEFAULT_E);
-		}
-		else{
-			zi[i] = zi[i].real() / wi[i].real();
-			(*subsampledData)[0][i] = (*subsampledData)[0][i] / wi[i].real();
-			(*subsampledData)[1][i] = (*subsampledData)[1][i] / wi[i].real();
-			(*subsampledData)[5][i] = sqrt((*subsampledData)[5][i] / w2i[i].real());
-			(*subsampledData)[6][i] = sqrt((*subsampledData)[6][i] / w2i[i].real());
-		}
-
-		si[i] = (si[i].real() - (2.00 * zi[i].real() * w2zi[i].real()) + (w2i[i].real() * pow(zi[i].real(),2)))/(ni[i].real());
-		si[i] = (si[i].real())/(1.00 + ni[i].real());
-
-		//Handle division by 0.
-		if(w2i[i].real()==0)
-			si[i] = ((ni[i].real() - 1.00) * si[i])/(ni[i].real());
-		else
-			si[i] = (((ni[i].real() - 1.00) * si[i]) + (w2ei[i].real()/w2i[i].real()))/(ni[i].real());
-
-		si[i] = (std::complex<double>)sqrt(si[i]);
-
-		(*subsampledData)[2][i] = (double)zi[i].real();
-		(*subsampledData)[3][i] = (double)si[i].real();
-		(*subsampledData)[4][i] = pow((double)si[i].real(),2);
-	}
-
-	//C. Do a second quicksort to get all of the X values in a row and maintain the rest of the data in the proper indexes
-	//Quicksort2(&(*subsampledData)[0], &(*subsampledData)[1], &(*subsampledData)[2], &(*subsampledData)[3], &(*subsampledData)[4], 0, JiVectorSize);
+	subsampleCells(bins, subsampledData);
 	if (dispIntermResults)
 		printf("..");
 
@@ -352,20 +524,9 @@ int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector
 	inY0 = y0;
 	
 	//************************************************************************************
-	//V. Clean up variables and return.
+	//IV. Clean up variables and return.
 	//************************************************************************************
-	Ji.clear();
-	J.clear();
 	weights.clear();
-	JiVector.clear();
-	zi.clear();
-	ni.clear();
-	wi.clear();
-	w2zi.clear();
-	w2ei.clear();
-	w2i.clear();
-	si.clear();
-	JiNew.clear();
 
 	if (dispIntermResults)
 		printf(" Done Subsampling Data\n");
@@ -26,9 +26,93 @@
 * @param meanX - Mean value of inputDataY.
 * @param dispIntermResults - Determine if intermediate output should be displayed to the command line.
 * @param subsampledData - A n by 5 vector containing the subsampled data.  Index 0 contains the X data normalized to the mean of X. Index 1 contains the Y data normalized to the mean of Y. Index 2 contains the Depth data. Index 3 contains the Error data.  Index 4 contains the Error data squared. (Returned).
+* @param numThreads - Number of threads binning the data points.  Each bins its own share of the points and the cells are merged afterwards.
 * @return Success or failure value.
 */
-int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, double gridSpacingX, double gridSpacingY, double &inX0, double &inY0, double meanX, double meanY, bool dispIntermResults, vector< vector<double> > *subsampledData);
+int subsampleData(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, double gridSpacingX, double gridSpacingY, double &inX0, double &inY0, double meanX, double meanY, bool dispIntermResults, vector< vector<double> > *subsampledData, int numThreads);
+
+/**
+* The weighted sums of the data points in each subsampling cell, stored by column.
+* Cells are found by their index Ji through an open addressing hash table and are numbered in the order they were first seen.
+*/
+class cellBins
+{
+
+public:
+
+	/**
+	* A constructor for cellBins.  There are no cells at first.
+	*/
+	cellBins();
+
+	/**
+	* Finds a cell, adding it with all sums 0 if it is new.
+	* @param Ji - Cell index.
+	* @return The number of the cell, the position of its sums in the columns.
+	*/
+	int find(long long Ji);
+
+	/**
+	* Adds the sums of every cell of another set of bins to the same cells of this one.
+	* @param other - Bins to add.
+	*/
+	void merge(const cellBins &other);
+
+	/**
+	* Gets the cells in ascending order of Ji.
+	* @param order - Cell numbers in ascending order of their Ji. (Returned).
+	*/
+	void sortedOrder(vector<int> *order) const;
+
+	/**
+	* Cell index Ji of each cell.
+	*/
+	vector<long long> key;
+
+	/**
+	* Sums over the points in each cell of 1, w, w^2, w*z, w^2*z, (w*z)^2, w^2*e (e already squared), w*x, w*y, (w*h)^2 and (w*v)^2.
+	*/
+	vector<double> n, w, w2, wz, w2z, wz2, w2e, wx, wy, wh2, wv2;
+
+private:
+
+	/**
+	* Doubles the hash table and reinserts every cell.
+	*/
+	void grow();
+
+	/**
+	* Hash table of cell numbers, -1 when empty, with 2^bits slots.
+	*/
+	vector<int> table;
+	int bits;
+};
+
+/**
+* Adds a block of data points to the cells of a subsampling.  subsampleData bins all of its points at once; this lets data read a block at a time be subsampled without holding every point.
+* @param inputDataX - Vector of input X data points.
+* @param inputDataY - Vector of input Y data points.
+* @param inputDataZ - Vector of input Depth data points.
+* @param inputDataE - Vector of input Error data points, already squared.
+* @param inputDataH - Vector of input Horizontal Error data points.
+* @param inputDataV - Vector of input Vertical Error data points.
+* @param weights - Consistent weight of each data point.
+* @param x0 - X location of the first cell, a multiple of DX.
+* @param y0 - Y location of the first cell, a multiple of DY.
+* @param DX - Size of a cell in the X direction.
+* @param DY - Size of a cell in the Y direction.
+* @param jProd - Number of cells in the X direction.
+* @param numThreads - Number of threads binning the data points.
+* @param bins - Cells the data points are added to. (Returned).
+*/
+void binDataBlock(vector<double> *inputDataX, vector<double> *inputDataY, vector<double> *inputDataZ, vector<double> *inputDataE, vector<double> *inputDataHErr, vector<double> *inputDataVErr, vector<double> *weights, double x0, double y0, double DX, double DY, double jProd, int numThreads, cellBins *bins);
+
+/**
+* Computes the subsampled data from the sums of each cell, in ascending order of the cell index.
+* @param bins - Sums of the data points in each cell.
+* @param subsampledData - A n by 7 vector containing the subsampled data, as returned by subsampleData. (Returned).
+*/
+void subsampleCells(const cellBins &bins, vector< vector<double> > *subsampledData);
 
 /**
 * Round a double value up or down.
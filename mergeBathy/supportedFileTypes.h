@@ -95,3 +95,17 @@ const string raster = ".grd";
 */
 const string raster2 = ".asc";
 
+/**
+* Define mergeBathy binary extensions. Allow .mbb files.
+* Contents of the file are the columns of one data set as described in binaryBathyFile.h:
+*	@n A fixed size header followed by the Longitude, Latitude, Depth, Error, Horizontal_Error and Vertical_Error columns.
+* Written by the -writeBinaryInputs option from any of the other supported types.
+*/
+const string binaryBathy = ".mbb";
+
+
+/**
+* Define the extension of the sidecar spatial index written next to a text input file, <input file>.mbi.
+* Contents of the file are described in inputFileIndex.h.  It is not an input type and is never named in a file list.
+*/
+const string spatialIndexSidecar = ".mbi";
@@ -0,0 +1,301 @@
+#include "textRecordReader.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#define fseek64 _fseeki64
+#else
+#define fseek64 fseeko
+#endif
+
+//Exactly representable powers of ten used by the fast path of parseDouble
+static const double powersOfTen[23] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static inline bool isFieldSpace(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\r');
+}
+
+//************************************************************************************
+// SUBROUTINE I: Constructor and destructor.
+//************************************************************************************
+textRecordReader::textRecordReader(size_t blockSize)
+{
+	fp = NULL;
+	block = (blockSize > 0) ? blockSize : 1;
+	head = 0;
+	tail = 0;
+	atEnd = true;
+	base = 0;
+	recordBegin = 0;
+	recordEnd = 0;
+	rangeNum = 0;
+	remaining = -1;
+}
+
+textRecordReader::~textRecordReader()
+{
+	close();
+}
+
+//************************************************************************************
+// SUBROUTINE II: Open and close the file.
+//************************************************************************************
+bool textRecordReader::open(const string &fileName)
+{
+	close();
+	fp = fopen(fileName.c_str(), "rb");
+	if (fp == NULL)
+		return false;
+	buffer = vector<char>(block + 1, 0);
+	head = 0;
+	tail = 0;
+	atEnd = false;
+	base = 0;
+	recordBegin = 0;
+	recordEnd = 0;
+	ranges.clear();
+	rangeNum = 0;
+	remaining = -1;
+	return true;
+}
+
+void textRecordReader::close()
+{
+	if (fp != NULL)
+		fclose(fp);
+	fp = NULL;
+	vector<char>().swap(buffer);
+	head = 0;
+	tail = 0;
+	atEnd = true;
+	ranges.clear();
+	rangeNum = 0;
+	remaining = -1;
+}
+
+bool textRecordReader::setRanges(const vector< pair<int64_t, int64_t> > &byteRanges)
+{
+	if (fp == NULL)
+		return false;
+	ranges = byteRanges;
+	rangeNum = 0;
+	//Nothing is left of the current range, so the next read starts the first one
+	head = 0;
+	tail = 0;
+	atEnd = true;
+	return true;
+}
+
+//************************************************************************************
+// SUBROUTINE III: Read the next block of the file.
+//************************************************************************************
+void textRecordReader::fill()
+{
+	//A. Keep the partial line that is left
+	if (head > 0)
+	{
+		memmove(&buffer[0], &buffer[head], tail - head);
+		base += head;
+		tail -= head;
+		head = 0;
+	}
+	if (buffer.size() < tail + block + 1)
+		buffer.resize(tail + block + 1);
+
+	//B. Read after it, stopping at the end of the current range
+	size_t toRead = block;
+	if (remaining >= 0 && (int64_t)toRead > remaining)
+		toRead = (size_t)remaining;
+	size_t numRead = fread(&buffer[tail], 1, toRead, fp);
+	tail += numRead;
+	buffer[tail] = 0;
+	if (remaining >= 0)
+		remaining -= numRead;
+	if (numRead < toRead || remaining == 0)
+		atEnd = true;
+}
+
+bool textRecordReader::nextRange()
+{
+	while (rangeNum < ranges.size())
+	{
+		const pair<int64_t, int64_t> &range = ranges[rangeNum++];
+		if (range.second <= 0)
+			continue;
+		if (fseek64(fp, range.first, SEEK_SET) != 0)
+			return false;
+		base = range.first;
+		head = 0;
+		tail = 0;
+		buffer[0] = 0;
+		remaining = range.second;
+		atEnd = false;
+		return true;
+	}
+	return false;
+}
+
+//************************************************************************************
+// SUBROUTINE IV: Parse the fields of the next line.
+//************************************************************************************
+int textRecordReader::nextRecord(double *values, int maxValues)
+{
+	if (buffer.empty())
+		return -1;
+
+	while (true)
+	{
+		//A. Find the end of the line, reading more of the file until it is in the buffer
+		char *line = &buffer[head];
+		char *lineEnd = (char*)memchr(line, '\n', tail - head);
+		if (lineEnd == NULL)
+		{
+			if (!atEnd)
+			{
+				fill();
+				continue;
+			}
+			if (head == tail)
+			{
+				if (nextRange())
+					continue;
+				return -1;
+			}
+			//The last line has no newline; buffer[tail] ends it
+			lineEnd = &buffer[tail];
+			head = tail;
+		}
+		else
+			head = (lineEnd - &buffer[0]) + 1;
+
+		//B. Skip blank lines
+		const char *p = line;
+		while (p < lineEnd && isFieldSpace(*p))
+			p++;
+		if (p == lineEnd)
+			continue;
+		recordBegin = base + (line - &buffer[0]);
+		recordEnd = base + head;
+
+		//C. Parse the fields
+		int numValues = 0;
+		while (numValues < maxValues && p < lineEnd)
+		{
+			if (!parseDouble(&p, lineEnd, &values[numValues]))
+				break;
+			numValues++;
+			while (p < lineEnd && !isFieldSpace(*p))
+				p++;
+			while (p < lineEnd && isFieldSpace(*p))
+				p++;
+		}
+		return numValues;
+	}
+}
+
+//************************************************************************************
+// SUBROUTINE V: Parse one number.
+//************************************************************************************
+bool parseDouble(const char **text, const char *end, double *value)
+{
+	const char *start = *text;
+	const char *p = start;
+	unsigned long long mantissa = 0;
+	int significant = 0;
+	int exponent = 0;
+	bool negative = false;
+	bool anyDigits = false;
+	bool exact = true;
+
+	//A. Sign, integer and fraction digits.  Leading zeros are not significant.
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		p++;
+	}
+	while (p < end && *p >= '0' && *p <= '9')
+	{
+		if (significant < 19)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa != 0)
+				significant++;
+		}
+		else
+		{
+			exponent++;
+			exact = exact && (*p == '0');
+		}
+		anyDigits = true;
+		p++;
+	}
+	if (p < end && *p == '.')
+	{
+		p++;
+		while (p < end && *p >= '0' && *p <= '9')
+		{
+			if (significant < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa != 0)
+					significant++;
+				exponent--;
+			}
+			else
+				exact = exact && (*p == '0');
+			anyDigits = true;
+			p++;
+		}
+	}
+
+	//B. Exponent.  An 'e' without digits after it is not part of the number.
+	if (anyDigits && p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char *e = p + 1;
+		bool negativeExponent = false;
+		int exponentDigits = 0, decimalExponent = 0;
+		if (e < end && (*e == '-' || *e == '+'))
+		{
+			negativeExponent = (*e == '-');
+			e++;
+		}
+		while (e < end && *e >= '0' && *e <= '9')
+		{
+			if (decimalExponent < 100000)
+				decimalExponent = decimalExponent * 10 + (*e - '0');
+			exponentDigits++;
+			e++;
+		}
+		if (exponentDigits > 0)
+		{
+			exponent += negativeExponent ? -decimalExponent : decimalExponent;
+			p = e;
+		}
+	}
+
+	//C. Fast path.  Both the mantissa and the power of ten are exact doubles, so one
+	//	multiply or divide gives the correctly rounded result, the same as strtod.
+	if (anyDigits && exact && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+	{
+		double v = (double)mantissa;
+		if (exponent < 0)
+			v /= powersOfTen[-exponent];
+		else
+			v *= powersOfTen[exponent];
+		*value = negative ? -v : v;
+		*text = p;
+		return true;
+	}
+
+	//D. Everything else, including nan and inf
+	char *stop;
+	double v = strtod(start, &stop);
+	if (stop == start)
+		return false;
+	*value = v;
+	*text = stop;
+	return true;
+}
@@ -0,0 +1,133 @@
+/**
+* @file			textRecordReader.h
+* @brief		Block buffered reader for the white space delimited text sounding files.
+* @author		mergeBathy Development Team
+* @date			17 October 2026
+*
+*/
+#pragma once
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+* Reads lines of numeric fields from a text file.
+* The file is read in large blocks and each line is parsed in place, so there is
+* no limit on the length of a line and no per-field sscanf.  Fields may be separated
+* by any mix of spaces and tabs, and a trailing carriage return is ignored.
+*/
+class textRecordReader
+{
+
+public:
+
+	/**
+	* A constructor for textRecordReader.
+	* @param blockSize - Number of bytes read from the file at a time.
+	*/
+	textRecordReader(size_t blockSize = 1 << 20);
+
+	/**
+	* A destructor for textRecordReader.  Closes the file.
+	*/
+	~textRecordReader();
+
+	/**
+	* Opens a file for reading.  Any file already open is closed.
+	* @param fileName - File name of the text file.
+	* @return True if the file was opened.
+	*/
+	bool open(const string &fileName);
+
+	/**
+	* Closes the file.
+	*/
+	void close();
+
+	/**
+	* Parses the next line that is not blank.
+	* Fields are parsed from the start of the line until maxValues have been read, the line ends, or a field does
+	* not begin with a number.  As with sscanf, a field only has to begin with a number; the rest of it is skipped.
+	* @param values - Array of at least maxValues doubles holding the fields read. (Returned).
+	* @param maxValues - Number of fields wanted.  Any further fields on the line are ignored.
+	* @return The number of fields read from the line, or -1 at the end of the file.
+	*/
+	int nextRecord(double *values, int maxValues);
+
+	/**
+	* Reads only the given parts of the open file from now on, in the order given.
+	* Each range must begin at the start of a line and end just after a newline or at the end of the file.
+	* @param byteRanges - Byte offset and length of each part to read.
+	* @return True if the file is open.
+	*/
+	bool setRanges(const vector< pair<int64_t, int64_t> > &byteRanges);
+
+	/**
+	* @return The byte offset in the file of the line last returned by nextRecord.
+	*/
+	int64_t recordOffset() const { return recordBegin; }
+
+	/**
+	* @return The byte offset in the file just past the line last returned by nextRecord, including its newline.
+	*/
+	int64_t recordEndOffset() const { return recordEnd; }
+
+private:
+
+	/**
+	* Copying would share the file.
+	*/
+	textRecordReader(const textRecordReader &);
+	textRecordReader &operator=(const textRecordReader &);
+
+	/**
+	* Moves the unread bytes to the front of the buffer and reads the next block after them.
+	* The buffer grows when a single line does not fit.
+	*/
+	void fill();
+
+	/**
+	* Moves to the start of the next range given to setRanges.
+	* @return False when there are no more ranges.
+	*/
+	bool nextRange();
+
+	FILE *fp;
+	size_t block;
+
+	/**
+	* Bytes read from the file.  buffer[head] .. buffer[tail-1] have not been parsed yet and buffer[tail] is always 0.
+	*/
+	vector<char> buffer;
+	size_t head;
+	size_t tail;
+	bool atEnd;
+
+	/**
+	* Byte offset in the file of buffer[0], and of the start and end of the line last returned.
+	*/
+	int64_t base;
+	int64_t recordBegin;
+	int64_t recordEnd;
+
+	/**
+	* Ranges still to read after the current one, and the bytes left in the current one (-1 to read to the end of the file).
+	*/
+	vector< pair<int64_t, int64_t> > ranges;
+	size_t rangeNum;
+	int64_t remaining;
+};
+
+/**
+* Parses a number at the start of text, as strtod would.
+* Numbers with no more than 19 significant digits and a decimal exponent within +/-22 are converted exactly with one
+* multiply or divide, which covers the coordinates and depths found in sounding files.  Anything else is passed to strtod.
+* @param text - Start of the number.  Moved past the number when one is read. (Returned).
+* @param end - End of the text.  The character at end must not be a digit.
+* @param value - The number read. (Returned).
+* @return True if a number was read.
+*/
+bool parseDouble(const char **text, const char *end, double *value);